@@ -112,6 +112,7 @@
 %token SEMICOLON ";"
 %token COMMA ","
 %token PERIOD "."
+%token DOUBLEPERIOD ".."
 %token AT "@"
 %token QUICKPRINTBEGIN "<%="
 %token <GTA_Parser_Unicode_String> QUICKPRINTBEGINANDSTRING "template string followed by <%="
@@ -163,6 +164,7 @@
 %left "&&"
 %left "==" "!="
 %left "<" "<=" ">" ">="
+%nonassoc ".."
 %left "+" "-"
 %left "*" "/" "%"
 %right UMINUS AS "!"
@@ -1267,6 +1269,18 @@ expression
     {
       BINARY_TEMPLATE(GTA_BINARY_TYPE_GREATER_THAN_EQUAL,$1,@1,$3,@3,$$);
     }
+  | expression ".." expression
+    {
+      // Verify that there have been no memory errors.
+      VERIFY2($1,$3,$$);
+
+      LOCATION(@1, @3);
+      $$ = (GTA_Ast_Node *)gta_ast_node_range_create($1, $3, location);
+      if (!$$) {
+        parseError = &ErrorOutOfMemory;
+        break;
+      }
+    }
   | expression "==" expression
     {
       BINARY_TEMPLATE(GTA_BINARY_TYPE_EQUAL,$1,@1,$3,@3,$$);
@@ -62,6 +62,16 @@ typedef enum GTA_Ast_Possible_Type {
  */
 #define GTA_AST_POSSIBLE_TYPE_ALL (GTA_AST_POSSIBLE_TYPE_ERROR | GTA_AST_POSSIBLE_TYPE_NULL | GTA_AST_POSSIBLE_TYPE_BOOLEAN | GTA_AST_POSSIBLE_TYPE_INTEGER | GTA_AST_POSSIBLE_TYPE_FLOAT | GTA_AST_POSSIBLE_TYPE_STRING)
 
+/**
+ * Determine whether or not a possible type is known to be a boolean.
+ *
+ * An error is also allowed, since errors are always falsy.
+ *
+ * @param X The possible type.
+ * @return True if the value must be either a boolean or an error.
+ */
+#define GTA_AST_POSSIBLE_TYPE_IS_BOOLEAN(X) (((X) & ~GTA_AST_POSSIBLE_TYPE_ERROR) == GTA_AST_POSSIBLE_TYPE_BOOLEAN)
+
 /**
  * The vtable for the GTA_Ast_Node class.
  */
@@ -28,6 +28,7 @@
 #include <tang/ast/astNodeParseError.h>
 #include <tang/ast/astNodePeriod.h>
 #include <tang/ast/astNodePrint.h>
+#include <tang/ast/astNodeRange.h>
 #include <tang/ast/astNodeRangedFor.h>
 #include <tang/ast/astNodeReturn.h>
 #include <tang/ast/astNodeSlice.h>
@@ -156,6 +156,20 @@ bool gta_ast_node_binary_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_C
  */
 GTA_NO_DISCARD GTA_Ast_Node * gta_ast_node_binary_analyze(GTA_Ast_Node * self, GTA_Program * program, GTA_Variable_Scope * scope);
 
+/**
+ * Determine the possible type of a binary operation from its operands.
+ *
+ * Only the combinations whose result type is certain are recognized.  All
+ * others are left as GTA_AST_POSSIBLE_TYPE_UNKNOWN.
+ *
+ * This is called by gta_ast_node_binary_analyze(), and again by the type
+ * inference if the possible types of the operands have been refined.
+ *
+ * @param self The binary node.
+ * @return The possible type of the result.
+ */
+GTA_Ast_Possible_Type gta_ast_node_binary_infer_possible_type(GTA_Ast_Node_Binary * self);
+
 #ifdef __cplusplus
 }
 #endif //__cplusplus
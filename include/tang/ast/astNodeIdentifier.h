@@ -97,6 +97,14 @@ struct GTA_Ast_Node_Identifier {
    * how to resolve a variable name.
    */
   GTA_Variable_Scope * scope;
+  /**
+   * Whether or not the variable is declared `global` by some function.
+   *
+   * A shared variable may be changed by any function call, so its value is
+   * never propagated during simplification.  This is set by
+   * gta_tang_simplify().
+   */
+  bool is_shared;
 };
 
 /**
@@ -34,8 +34,15 @@ struct GTA_Ast_Node_Ranged_For {
   GTA_Ast_Node * expression;
   /**
    * A shadow variable to hold the iterator.
+   *
+   * An array is iterated directly, so the array itself is held instead.
    */
   GTA_Ast_Node * iterator;
+  /**
+   * A shadow variable to hold the position of the next element, when an
+   * array is being iterated.
+   */
+  GTA_Ast_Node * index;
   /**
    * The block of the ranged for loop.
    */
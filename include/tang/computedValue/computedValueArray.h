@@ -20,6 +20,15 @@ extern GTA_Computed_Value_VTable gta_computed_value_array_vtable;
 
 /**
  * The computed value for an array.
+ *
+ * Copies of an array share the `elements` vector (copy-on-write) until one of
+ * them is written to, at which point the array being written to is given a
+ * vector of its own.  An array never writes to a vector that it shares.
+ *
+ * Arrays and maps held by a shared vector may be reached by any of the
+ * arrays which share it, so they are never modified while shared.  Instead,
+ * an array which returns one of them (so that it may be written to) first
+ * takes a vector of its own, holding copies of them.
  */
 struct GTA_Computed_Value_Array {
   /**
@@ -30,6 +39,14 @@ struct GTA_Computed_Value_Array {
    * The values in the array.
    */
   GTA_VectorX * elements;
+  /**
+   * The number of arrays which share the `elements` vector, or NULL if the
+   * vector has never been shared.
+   *
+   * The count is shared by all of the arrays which share the vector, and it
+   * is modified atomically.
+   */
+  GTA_ATOMIC(size_t) * shared_count;
 };
 
 /**
@@ -84,6 +84,39 @@ extern GTA_Computed_Value * gta_computed_value_error_argument_count_mismatch;
  */
 extern GTA_Computed_Value * gta_computed_value_error_global_rng_seed_not_changeable;
 
+/**
+ * Indicates that execution was aborted because the program passed more
+ * safepoints (loop iterations and function calls) than its execution budget
+ * allows.
+ *
+ * @see gta_execution_context_set_budget()
+ */
+extern GTA_Computed_Value * gta_computed_value_error_execution_budget_exceeded;
+
+/**
+ * Indicates that execution was aborted because the deadline of its execution
+ * budget had passed.
+ *
+ * @see gta_execution_context_set_budget()
+ */
+extern GTA_Computed_Value * gta_computed_value_error_execution_deadline_exceeded;
+
+/**
+ * Indicates that execution was aborted because the computed values that it
+ * kept alive exceeded the memory quota of the execution context.
+ *
+ * @see gta_garbage_collector_set_quota()
+ */
+extern GTA_Computed_Value * gta_computed_value_error_memory_quota_exceeded;
+
+/**
+ * Indicates that the output sink of the execution context reported a failure
+ * while printed output was being passed to it.
+ *
+ * @see gta_execution_context_set_output_sink()
+ */
+extern GTA_Computed_Value * gta_computed_value_error_output_sink_failed;
+
 /**
  * Represents an error value.
  */
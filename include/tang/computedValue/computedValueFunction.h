@@ -23,10 +23,12 @@ extern GTA_Computed_Value_VTable gta_computed_value_function_vtable;
  * is not called in the same way that a native function would be called.
  * It is more of a "jump here, do something, and jump back" behavior.
  *
- * The object itself only knows the number of arguments that it expects and the
- * pointer to the function.  The pointer is a bytecode offset when using the
- * bytecode interpreter and a pointer to the binary code when using the binary
- * JIT compiler.
+ * The object itself only knows the number of arguments that it expects and
+ * where the function begins: `pointer` is the offset of the function in the
+ * bytecode, and `binary` is the address of the function in the binary.  A
+ * program may have both (e.g., a tiered program which has been compiled to
+ * binary while other threads are still executing its bytecode), so the two
+ * are kept separately.
  *
  * Regardless of the method used, a function call should follow this pattern:
  * 1. Evaluate the function arguments.
@@ -71,9 +73,23 @@ struct GTA_Computed_Value_Function {
    */
   size_t num_arguments;
   /**
-   * The pointer to the function (either bytecode or binary).
+   * The offset of the first instruction of the function in the bytecode.
    */
   size_t pointer;
+  /**
+   * The address of the first instruction of the function in the binary, or 0
+   * if the program has not been compiled to binary.
+   */
+  size_t binary;
+  /**
+   * The number of times that the function has been called by the bytecode
+   * interpreter while its program is warming up.
+   *
+   * This is accessed atomically.
+   *
+   * @see GTA_PROGRAM_FLAG_TIERED
+   */
+  GTA_ATOMIC(size_t) invocations;
 };
 
 /**
@@ -81,7 +97,8 @@ struct GTA_Computed_Value_Function {
  *
  * @param value The GTA_Computed_Value_Function project.
  * @param num_arguments The number of arguments expected.
- * @param pointer The address of the first instruction of the function.
+ * @param pointer The offset of the first instruction of the function in the
+ *   bytecode.
  * @param context The execution context to create the value in.
  * @return The new object.
  */
@@ -92,7 +109,8 @@ GTA_Computed_Value_Function * GTA_CALL gta_computed_value_function_create(size_t
  *
  * @param self The memory address of the object.
  * @param num_arguments The number of arguments expected.
- * @param pointer The address of the first instruction of the function.
+ * @param pointer The offset of the first instruction of the function in the
+ *   bytecode.
  * @param context The execution context to create the value in.
  * @return True if the operation was successful, false otherwise.
  */
@@ -9,6 +9,7 @@
 extern "C" {
 #endif // __cplusplus
 
+#include <stdint.h>
 #include <tang/computedValue/computedValue.h>
 
 /**
@@ -27,13 +28,72 @@ extern GTA_Computed_Value * gta_computed_value_error_map_key_not_found;
 extern GTA_Computed_Value * gta_computed_value_error_map_key_not_string;
 
 /**
- * An object that maps identifiers to computed values.
+ * A key/value pair of a map.
+ */
+typedef struct GTA_Computed_Value_Map_Entry {
+  /**
+   * The key, which is always a GTA_Computed_Value_String.
+   */
+  GTA_Computed_Value * key;
+  /**
+   * The value.
+   */
+  GTA_Computed_Value * value;
+  /**
+   * The hash of the key.
+   */
+  uint64_t hash;
+} GTA_Computed_Value_Map_Entry;
+
+/**
+ * The storage of a map.
  *
- * Internally, the map's key/value pairs are stored in a pair of hash tables, a
- * key hash and a value hash.  The two hash tables are kept in sync with each
- * other.  They use the same hash value (from the key-string) to refer to both
- * the key and the value.  The reason for this is so that the map can be
- * iterated over and that the actual key string value is recoverable.
+ * The entries are kept in a dense array, in the order in which their keys
+ * were first inserted, which is the order in which a map is iterated.  They
+ * are found through an open addressing (linear probing) table of slots, each
+ * of which holds the position of an entry plus one, or 0 if the slot is
+ * empty.  A lookup compares the cached hash and then the full key, so keys
+ * whose hashes collide are kept apart.
+ *
+ * The table, its entries, and its slots are a single allocation.
+ */
+typedef struct GTA_Computed_Value_Map_Table {
+  /**
+   * The number of maps which share the table.
+   *
+   * Modified atomically.
+   */
+  GTA_ATOMIC(size_t) references;
+  /**
+   * The number of entries.
+   */
+  size_t count;
+  /**
+   * The number of entries that the table can hold before it must grow.
+   */
+  size_t capacity;
+  /**
+   * The number of slots minus one (the number of slots is a power of 2).
+   */
+  size_t slot_mask;
+  /**
+   * The entries, in insertion order.
+   */
+  GTA_Computed_Value_Map_Entry * entries;
+  /**
+   * The slots.
+   */
+  uint32_t * slots;
+} GTA_Computed_Value_Map_Table;
+
+/**
+ * An object that maps strings to computed values.
+ *
+ * Copies of a map share the table (copy-on-write) until one of them is
+ * written to, at which point the map being written to is given a table of its
+ * own.  As with arrays, a map which returns an array or map value from a
+ * shared table first takes a table of its own, holding copies of those
+ * values.
  */
 struct GTA_Computed_Value_Map {
   /**
@@ -41,13 +101,9 @@ struct GTA_Computed_Value_Map {
    */
   GTA_Computed_Value base;
   /**
-   * The hash table for the keys.
+   * The key/value pairs of the map.
    */
-  GTA_HashX * key_hash;
-  /**
-   * The hash table for the values.
-   */
-  GTA_HashX * value_hash;
+  GTA_Computed_Value_Map_Table * table;
 };
 
 /**
@@ -131,6 +187,18 @@ GTA_NO_DISCARD GTA_Computed_Value * GTA_CALL gta_computed_value_map_assign_index
  */
 GTA_NO_DISCARD GTA_Computed_Value * GTA_CALL gta_computed_value_map_index(GTA_Computed_Value * self, GTA_Computed_Value * index, GTA_Execution_Context * context);
 
+/**
+ * Gets an iterator from a computed value.
+ *
+ * The iterator yields a [key, value] array for each entry, in the order in
+ * which the keys were inserted.
+ *
+ * @param self The object to get the value from.
+ * @param context The execution context of the program.
+ * @return The value of the iterator or NULL if the operation failed.
+ */
+GTA_NO_DISCARD GTA_Computed_Value * GTA_CALL gta_computed_value_map_iterator_get(GTA_Computed_Value * self, GTA_Execution_Context * context);
+
 /**
  * Get the computed value for a key in the map.
  * 
@@ -0,0 +1,140 @@
+/**
+ * @file
+ *
+ * Header file for the ComputedValueRange class.
+ */
+
+#ifndef TANG_COMPUTED_VALUE_RANGE_H
+#define TANG_COMPUTED_VALUE_RANGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <tang/computedValue/computedValue.h>
+
+/**
+ * The VTable for the ComputedValueRange class.
+ */
+extern GTA_Computed_Value_VTable gta_computed_value_range_vtable;
+
+/**
+ * A Computed Value Error for when the bounds of a range are not integers.
+ */
+extern GTA_Computed_Value * gta_computed_value_error_range_bounds_not_integer;
+
+/**
+ * A lazy sequence of consecutive integers, created by `start..end`.
+ *
+ * The range includes `start` and excludes `end`, so it is empty if `end` is
+ * not greater than `start`.  The integers are never stored: they are produced
+ * one at a time as the range is iterated over.
+ */
+struct GTA_Computed_Value_Range {
+  /**
+   * The base class for the computed value.
+   */
+  GTA_Computed_Value base;
+  /**
+   * The first integer of the range.
+   */
+  GTA_Integer start;
+  /**
+   * The integer after the last integer of the range.
+   */
+  GTA_Integer end;
+};
+
+/**
+ * Create a new computed value for a range.
+ *
+ * @param start The first integer of the range.
+ * @param end The integer after the last integer of the range.
+ * @param context The execution context to create the value in.
+ * @return The new computed value for the range.
+ */
+GTA_NO_DISCARD GTA_Computed_Value_Range * GTA_CALL gta_computed_value_range_create(GTA_Integer start, GTA_Integer end, GTA_Execution_Context * context);
+
+/**
+ * Create a new computed value for a range in place.
+ *
+ * @param self The memory address of the computed value.
+ * @param start The first integer of the range.
+ * @param end The integer after the last integer of the range.
+ * @param context The execution context to create the value in.
+ * @return True if the operation was successful, false otherwise.
+ */
+bool GTA_CALL gta_computed_value_range_create_in_place(GTA_Computed_Value_Range * self, GTA_Integer start, GTA_Integer end, GTA_Execution_Context * context);
+
+/**
+ * Create a new computed value for a range from the computed values of its
+ * bounds.
+ *
+ * This is the operation performed by the `start..end` expression.
+ *
+ * @param start The first integer of the range.
+ * @param end The integer after the last integer of the range.
+ * @param context The execution context to create the value in.
+ * @return The new computed value for the range, or an error if the bounds
+ *   are not integers or memory could not be allocated.
+ */
+GTA_NO_DISCARD GTA_Computed_Value * GTA_CALL gta_computed_value_range_create_from_values(GTA_Computed_Value * start, GTA_Computed_Value * end, GTA_Execution_Context * context);
+
+/**
+ * Destroy a computed value for a range.
+ *
+ * @see gta_computed_value_destroy
+ *
+ * @param self The computed value for the range.
+ */
+void GTA_CALL gta_computed_value_range_destroy(GTA_Computed_Value * self);
+
+/**
+ * Destroy a computed value for a range in place.
+ *
+ * @see gta_computed_value_destroy_in_place
+ *
+ * @param self The computed value for the range.
+ */
+void GTA_CALL gta_computed_value_range_destroy_in_place(GTA_Computed_Value * self);
+
+/**
+ * Deep copy a computed value for a range.
+ *
+ * @see gta_computed_value_deep_copy
+ *
+ * @param value The computed value to be copied.
+ * @param context The execution context of the program.
+ * @return The deep copy of the ComputedValueRange or NULL if an error occurred.
+ */
+GTA_NO_DISCARD GTA_Computed_Value * GTA_CALL gta_computed_value_range_deep_copy(GTA_Computed_Value * value, GTA_Execution_Context * context);
+
+/**
+ * Get a string representation of the computed value for a range.
+ *
+ * The caller is responsible for freeing the returned string.
+ *
+ * @see gta_computed_value_to_string
+ *
+ * @param self The computed value for the range.
+ * @return The string representation of the computed value for the range.
+ */
+GTA_NO_DISCARD char * GTA_CALL gta_computed_value_range_to_string(GTA_Computed_Value * self);
+
+/**
+ * Gets an iterator from a computed value.
+ *
+ * The iterator yields each integer of the range in increasing order.
+ * Ranged-for loops do not use it: they read the bounds of the range directly.
+ *
+ * @param self The object to get the value from.
+ * @param context The execution context of the program.
+ * @return The value of the iterator or NULL if the operation failed.
+ */
+GTA_NO_DISCARD GTA_Computed_Value * GTA_CALL gta_computed_value_range_iterator_get(GTA_Computed_Value * self, GTA_Execution_Context * context);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // TANG_COMPUTED_VALUE_RANGE_H
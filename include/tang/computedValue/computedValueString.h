@@ -11,6 +11,7 @@
 extern "C" {
 #endif // __cplusplus
 
+#include <stdint.h>
 #include <tang/computedValue/computedValue.h>
 #include <tang/unicodeString.h>
 
@@ -42,6 +43,19 @@ struct GTA_Computed_Value_String {
    * string is also a singleton.
    */
   bool is_owned;
+  /**
+   * Whether or not `hash` holds the hash of the string.
+   *
+   * Strings are immutable, so the hash is computed at most once.  Modified
+   * atomically, because constant strings may be shared between threads.
+   */
+  GTA_ATOMIC(bool) is_hashed;
+  /**
+   * The hash of the string, once it has been computed.
+   *
+   * @see gta_computed_value_string_hash()
+   */
+  uint64_t hash;
 };
 
 /**
@@ -49,6 +63,12 @@ struct GTA_Computed_Value_String {
  */
 extern GTA_Computed_Value * gta_computed_value_string_empty;
 
+/**
+ * A Computed Value Error for when a string must be split into graphemes
+ * (e.g., to index or slice it), but it is not valid UTF-8.
+ */
+extern GTA_Computed_Value * gta_computed_value_error_string_invalid_utf8;
+
 /**
  * Creates a new GTA_Computed_Value_String object.
  *
@@ -166,6 +186,27 @@ GTA_NO_DISCARD GTA_Computed_Value * GTA_CALL gta_computed_value_string_index(GTA
  */
 GTA_NO_DISCARD GTA_Computed_Value * GTA_CALL gta_computed_value_string_slice(GTA_Computed_Value * self, GTA_Computed_Value * start, GTA_Computed_Value * end, GTA_Computed_Value * step, GTA_Execution_Context * context);
 
+/**
+ * Gets an iterator from a computed value.
+ *
+ * The iterator yields each grapheme of the string as a new string.
+ *
+ * @param self The object to get the value from.
+ * @param context The execution context of the program.
+ * @return The value of the iterator or NULL if the operation failed.
+ */
+GTA_NO_DISCARD GTA_Computed_Value * GTA_CALL gta_computed_value_string_iterator_get(GTA_Computed_Value * self, GTA_Execution_Context * context);
+
+/**
+ * Get the hash of the string, computing and caching it if needed.
+ *
+ * The hash is the same as `gcu_string_hash_64()` of the string's bytes.
+ *
+ * @param self The string.
+ * @return The hash of the string.
+ */
+uint64_t GTA_CALL gta_computed_value_string_hash(GTA_Computed_Value_String * self);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -87,6 +87,51 @@ extern "C" {
 #endif
 
 
+/**
+ * A cross-compiler macro for marking an intentional switch case fall-through.
+ */
+#if defined(__cplusplus) && __cplusplus >= 201703L
+#define GTA_FALLTHROUGH [[fallthrough]]
+
+#elif defined(__GNUC__) || defined(__clang__)
+#define GTA_FALLTHROUGH __attribute__((fallthrough))
+
+#else
+#define GTA_FALLTHROUGH
+
+#endif
+
+
+/**
+ * A cross-compiler macro for declaring a variable with thread storage
+ * duration.
+ */
+#if defined(_MSC_VER)
+#define GTA_THREAD_LOCAL __declspec(thread)
+
+#else
+#define GTA_THREAD_LOCAL _Thread_local
+
+#endif
+
+
+/**
+ * A macro for declaring an atomic member of a public struct.
+ *
+ * The library accesses these members with the functions of <stdatomic.h>.
+ * C++ (before C++23) cannot name a C atomic type, so C++ code sees the plain
+ * type, which has the same size and alignment on the supported platforms.
+ * C++ code must only read such a member while no other thread may write it.
+ */
+#ifdef __cplusplus
+#define GTA_ATOMIC(T) T
+
+#else
+#define GTA_ATOMIC(T) _Atomic(T)
+
+#endif
+
+
 /**
  * A cross-compiler macro for identifying the system is big endian.
  */
@@ -281,6 +326,7 @@ typedef GCU_Hash64_Value GTA_HashX_Value;
 #define GTA_AST_IS_PARSE_ERROR(X) (((GTA_Ast_Node *) X)->vtable == &gta_ast_node_parse_error_vtable)
 #define GTA_AST_IS_PERIOD(X) (((GTA_Ast_Node *) X)->vtable == &gta_ast_node_period_vtable)
 #define GTA_AST_IS_PRINT(X) (((GTA_Ast_Node *) X)->vtable == &gta_ast_node_print_vtable)
+#define GTA_AST_IS_RANGE(X) (((GTA_Ast_Node *) X)->vtable == &gta_ast_node_range_vtable)
 #define GTA_AST_IS_RANGED_FOR(X) (((GTA_Ast_Node *) X)->vtable == &gta_ast_node_ranged_for_vtable)
 #define GTA_AST_IS_RETURN(X) (((GTA_Ast_Node *) X)->vtable == &gta_ast_node_return_vtable)
 #define GTA_AST_IS_SLICE(X) (((GTA_Ast_Node *) X)->vtable == &gta_ast_node_slice_vtable)
@@ -312,6 +358,7 @@ typedef GCU_Hash64_Value GTA_HashX_Value;
 #define GTA_COMPUTED_VALUE_IS_LIBRARY(X) (((GTA_Computed_Value *) X)->vtable == &gta_computed_value_library_vtable)
 #define GTA_COMPUTED_VALUE_IS_MAP(X) (((GTA_Computed_Value *) X)->vtable == &gta_computed_value_map_vtable)
 #define GTA_COMPUTED_VALUE_IS_NULL(X) (((GTA_Computed_Value *) X)->vtable == &gta_computed_value_null_vtable)
+#define GTA_COMPUTED_VALUE_IS_RANGE(X) (((GTA_Computed_Value *) X)->vtable == &gta_computed_value_range_vtable)
 #define GTA_COMPUTED_VALUE_IS_RNG(X) (((GTA_Computed_Value *) X)->vtable == &gta_computed_value_rng_vtable)
 #define GTA_COMPUTED_VALUE_IS_STRING(X) (((GTA_Computed_Value *) X)->vtable == &gta_computed_value_string_vtable)
 /**
@@ -350,6 +397,7 @@ typedef struct GTA_Ast_Node_Map_Pair GTA_Ast_Node_Map_Pair;
 typedef struct GTA_Ast_Node_Parse_Error GTA_Ast_Node_Parse_Error;
 typedef struct GTA_Ast_Node_Period GTA_Ast_Node_Period;
 typedef struct GTA_Ast_Node_Print GTA_Ast_Node_Print;
+typedef struct GTA_Ast_Node_Range GTA_Ast_Node_Range;
 typedef struct GTA_Ast_Node_Ranged_For GTA_Ast_Node_Ranged_For;
 typedef struct GTA_Ast_Node_Return GTA_Ast_Node_Return;
 typedef struct GTA_Ast_Node_Slice GTA_Ast_Node_Slice;
@@ -359,7 +407,10 @@ typedef struct GTA_Ast_Node_Unary GTA_Ast_Node_Unary;
 typedef struct GTA_Ast_Node_Use GTA_Ast_Node_Use;
 typedef struct GTA_Ast_Node_VTable GTA_Ast_Node_VTable;
 typedef struct GTA_Ast_Node_While GTA_Ast_Node_While;
+typedef struct GTA_Bundle GTA_Bundle;
+typedef struct GTA_Bundle_Builder GTA_Bundle_Builder;
 typedef struct GTA_Bytecode_Compiler_Context GTA_Bytecode_Compiler_Context;
+typedef struct GTA_Code_Arena GTA_Code_Arena;
 typedef struct GTA_Compiler_Context GTA_Compiler_Context;
 typedef struct GTA_Computed_Value GTA_Computed_Value;
 typedef struct GTA_Computed_Value_Attribute_Pair GTA_Computed_Value_Attribute_Pair;
@@ -374,10 +425,12 @@ typedef struct GTA_Computed_Value_Iterator GTA_Computed_Value_Iterator;
 typedef struct GTA_Computed_Value_Library GTA_Computed_Value_Library;
 typedef struct GTA_Computed_Value_Library_Attribute_Pair GTA_Computed_Value_Library_Attribute_Pair;
 typedef struct GTA_Computed_Value_Map GTA_Computed_Value_Map;
+typedef struct GTA_Computed_Value_Range GTA_Computed_Value_Range;
 typedef struct GTA_Computed_Value_RNG GTA_Computed_Value_RNG;
 typedef struct GTA_Computed_Value_String GTA_Computed_Value_String;
 typedef struct GTA_Computed_Value_VTable GTA_Computed_Value_VTable;
 typedef struct GTA_Execution_Context GTA_Execution_Context;
+typedef struct GTA_Inline_Cache GTA_Inline_Cache;
 typedef struct GTA_Language GTA_Language;
 typedef struct GTA_Library GTA_Library;
 typedef struct GTA_Program GTA_Program;
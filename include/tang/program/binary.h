@@ -252,6 +252,27 @@ bool gta_binary_call_reg__x86_64(GCU_Vector8 * vector, GTA_Register reg);
  */
 bool gta_binary_adopt__x86_64(GTA_Compiler_Context * context, GTA_Register target_reg, GTA_Register scratch_1, GTA_Register scratch_2, GTA_Register scratch_3);
 
+/**
+ * Helper function to add the commands for a safepoint.
+ *
+ * If enough memory has been allocated since the last collection, then a
+ * garbage collection is performed.  The native stack is scanned for roots,
+ * so this must only be emitted where every live value is on the stack (e.g.,
+ * at the start of a loop iteration or a function).
+ *
+ * The safepoint is then counted against the execution budget, after the
+ * collection so that the memory quota is checked against what survived it.
+ * If the budget has run out (or the quota is exceeded), then the program is
+ * aborted by jumping to `context->abort_label` with the error in RAX.
+ *
+ * RAX is preserved.  The scratch registers and the argument registers are
+ * clobbered.
+ *
+ * @param context The compiler context.
+ * @return True on success, false on failure.
+ */
+bool gta_binary_safepoint__x86_64(GTA_Compiler_Context * context);
+
 /**
  * x86_64 instruction: ADD reg, imm
  *
@@ -262,6 +283,28 @@ bool gta_binary_adopt__x86_64(GTA_Compiler_Context * context, GTA_Register targe
  */
 bool gta_add_reg_imm__x86_64(GCU_Vector8 * vector, GTA_Register dst, int32_t immediate);
 
+/**
+ * x86_64 instruction: ADD reg, reg
+ *
+ * @param vector The vector in which to store the instruction.
+ * @param dst The destination register.
+ * @param src The source register.
+ * @return True on success, false on failure.
+ */
+bool gta_add_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src);
+
+/**
+ * x86_64 instruction: ADDSD xmm, xmm
+ *
+ * Adds the low double precision values of the registers.
+ *
+ * @param vector The vector in which to store the instruction.
+ * @param dst The destination register.
+ * @param src The source register.
+ * @return True on success, false on failure.
+ */
+bool gta_addsd_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src);
+
 /**
  * x86_64 instruction: AND reg, imm
  *
@@ -326,6 +369,18 @@ bool gta_cmp_ind8_imm8__x86_64(GCU_Vector8 * vector, GTA_Register base, GTA_Regi
  */
 bool gta_cmp_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register op1, GTA_Register op2);
 
+/**
+ * x86_64 instruction: IMUL reg, reg
+ *
+ * Signed multiplication, keeping only the low bits of the result.
+ *
+ * @param vector The vector in which to store the instruction.
+ * @param dst The destination register.
+ * @param src The source register.
+ * @return True on success, false on failure.
+ */
+bool gta_imul_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src);
+
 /**
  * x86_64 instruction: Jcc offset
  *
@@ -459,6 +514,18 @@ bool gta_mov_reg_ind__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Registe
  */
 bool gta_movq_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src);
 
+/**
+ * x86_64 instruction: MULSD xmm, xmm
+ *
+ * Multiplies the low double precision values of the registers.
+ *
+ * @param vector The vector in which to store the instruction.
+ * @param dst The destination register.
+ * @param src The source register.
+ * @return True on success, false on failure.
+ */
+bool gta_mulsd_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src);
+
 /**
  * x86_64 instruction: NOP
  *
@@ -505,6 +572,28 @@ bool gta_push_reg__x86_64(GCU_Vector8 * vector, GTA_Register reg);
  */
 bool gta_ret__x86_64(GCU_Vector8 * vector);
 
+/**
+ * x86_64 instruction: SUB reg, reg
+ *
+ * @param vector The vector in which to store the instruction.
+ * @param dst The destination register.
+ * @param src The source register.
+ * @return True on success, false on failure.
+ */
+bool gta_sub_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src);
+
+/**
+ * x86_64 instruction: SUBSD xmm, xmm
+ *
+ * Subtracts the low double precision value of `src` from that of `dst`.
+ *
+ * @param vector The vector in which to store the instruction.
+ * @param dst The destination register.
+ * @param src The source register.
+ * @return True on success, false on failure.
+ */
+bool gta_subsd_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src);
+
 /**
  * x86_64 instruction: TEST reg, reg
  *
@@ -515,6 +604,19 @@ bool gta_ret__x86_64(GCU_Vector8 * vector);
  */
 bool gta_test_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register op1, GTA_Register op2);
 
+/**
+ * x86_64 instruction: UCOMISD xmm, xmm
+ *
+ * Compares the low double precision values of the registers, setting ZF, PF,
+ * and CF.  PF is set if either value is NaN.
+ *
+ * @param vector The vector in which to store the instruction.
+ * @param op1 The first operand register.
+ * @param op2 The second operand register.
+ * @return True on success, false on failure.
+ */
+bool gta_ucomisd_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register op1, GTA_Register op2);
+
 /**
  * x86_64 instruction: XOR reg
  *
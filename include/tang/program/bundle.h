@@ -0,0 +1,203 @@
+/**
+ * @file
+ *
+ * Header file for template bundles, which hold the bytecode images of many
+ * programs in a single file.
+ *
+ * A bundle is built once (e.g., at build time) with a GTA_Bundle_Builder, and
+ * is then opened by each worker process with gta_bundle_create().  The file is
+ * memory mapped read-only, so it is shared between all of the processes which
+ * have it open, and only the pages of the programs that are actually loaded
+ * are ever read from disk.  Opening a bundle does not allocate memory for its
+ * contents, no matter how many programs it holds.
+ *
+ * Programs are loaded on demand with gta_bundle_load_program().  The bytecode
+ * of an image is position independent (see bytecodeImage.h), so a loaded
+ * program executes the bytecode and reads its string literals directly from
+ * the mapping, and only allocates its constant values and inline caches.
+ * Programs which are never used cost nothing.
+ *
+ * A bundle is reference counted.  Each loaded program holds a reference, so
+ * the file stays mapped until the bundle has been destroyed and every program
+ * that was loaded from it has also been destroyed.
+ *
+ * A bundle is a sequence of 64-bit words in the byte order of the machine
+ * that created it:
+ *   - Header: magic, version, byte order marker, the size of GTA_UInteger,
+ *     and the number of programs.
+ *   - Index: for each program, the hash of its name, the byte offset and
+ *     length of the name, and the byte offset and length of its image.  The
+ *     index is sorted by hash, so that a name can be found with a binary
+ *     search of the mapped file.
+ *   - Data: the names and images, each padded to a whole number of words.
+ */
+
+#ifndef G_TANG_BUNDLE_H
+#define G_TANG_BUNDLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <tang/macros.h>
+#include <tang/program/program.h>
+
+/**
+ * The first word of every bundle ("GTABUNDL" on little endian machines).
+ */
+#define GTA_BUNDLE_MAGIC UINT64_C(0x4C444E5542415447)
+
+/**
+ * The version of the bundle format.
+ */
+#define GTA_BUNDLE_VERSION 1
+
+/**
+ * Create a new, empty bundle builder.
+ *
+ * @return The new builder or NULL on failure.
+ */
+GTA_NO_DISCARD GTA_Bundle_Builder * gta_bundle_builder_create(void);
+
+/**
+ * Destroy a bundle builder.
+ *
+ * @param self The builder to destroy.
+ */
+void gta_bundle_builder_destroy(GTA_Bundle_Builder * self);
+
+/**
+ * Add a program to a bundle builder.
+ *
+ * The image of the program is created immediately, so the program may be
+ * destroyed once this function returns.  The program must be able to be
+ * saved (see gta_bytecode_image_create()).
+ *
+ * @param self The builder.
+ * @param name The name of the program, which must be unique in the bundle.
+ * @param program The program to add.
+ * @return True on success, false if the name is already in use, the program
+ *   cannot be saved, or memory could not be allocated.
+ */
+bool gta_bundle_builder_add(GTA_Bundle_Builder * self, const char * name, GTA_Program * program);
+
+/**
+ * Add an existing bytecode image to a bundle builder.
+ *
+ * The image is copied, and is not validated until it is loaded.
+ *
+ * @param self The builder.
+ * @param name The name of the program, which must be unique in the bundle.
+ * @param data The bytecode image.
+ * @param length The length of the image in bytes.
+ * @return True on success, false if the name is already in use, the length is
+ *   not a whole number of words, or memory could not be allocated.
+ */
+bool gta_bundle_builder_add_image(GTA_Bundle_Builder * self, const char * name, const void * data, size_t length);
+
+/**
+ * Write the bundle to a file.
+ *
+ * @param self The builder.
+ * @param path The path of the file to write.
+ * @return True on success, false otherwise.
+ */
+bool gta_bundle_builder_save(GTA_Bundle_Builder * self, const char * path);
+
+/**
+ * Open a bundle file.
+ *
+ * @param path The path of the file, which was written by
+ *   gta_bundle_builder_save().
+ * @return The bundle or NULL if the file could not be mapped or is not a
+ *   valid bundle.
+ */
+GTA_NO_DISCARD GTA_Bundle * gta_bundle_create(const char * path);
+
+/**
+ * Close a bundle.
+ *
+ * This releases the reference of the creator (see gta_bundle_release()).
+ * Programs that were loaded from the bundle remain valid, and the file is
+ * unmapped once the last of them has been destroyed.
+ *
+ * @param self The bundle to close.
+ */
+void gta_bundle_destroy(GTA_Bundle * self);
+
+/**
+ * Take a reference to a bundle, so that its file remains mapped.
+ *
+ * This may be called from any thread.
+ *
+ * @param self The bundle.
+ * @return The bundle.
+ */
+GTA_Bundle * gta_bundle_retain(GTA_Bundle * self);
+
+/**
+ * Release a reference to a bundle.
+ *
+ * When the last reference is released, the file is unmapped and the bundle
+ * is freed.  This may be called from any thread.
+ *
+ * @param self The bundle.
+ */
+void gta_bundle_release(GTA_Bundle * self);
+
+/**
+ * Get the number of programs in a bundle.
+ *
+ * @param self The bundle.
+ * @return The number of programs.
+ */
+size_t gta_bundle_count(GTA_Bundle * self);
+
+/**
+ * Get the name of a program in a bundle.
+ *
+ * The programs are in the order of the bundle index, which is not the order
+ * in which they were added.
+ *
+ * @param self The bundle.
+ * @param index The index of the program, less than gta_bundle_count().
+ * @param length Set to the length of the name in bytes.
+ * @return The name of the program.  It is not null terminated, and is only
+ *   valid until the bundle is destroyed.
+ */
+const char * gta_bundle_get_name(GTA_Bundle * self, size_t index, size_t * length);
+
+/**
+ * Determine whether or not a bundle contains a program.
+ *
+ * @param self The bundle.
+ * @param name The name of the program.
+ * @return True if the bundle contains the program, false otherwise.
+ */
+bool gta_bundle_contains(GTA_Bundle * self, const char * name);
+
+/**
+ * Load a program from a bundle.
+ *
+ * The program uses the bytecode in the mapped file, and holds a reference to
+ * the bundle until the program is destroyed.
+ *
+ * @see gta_program_create_from_bundle_image()
+ *
+ * @param self The bundle.
+ * @param language The language with which the program should be executed.
+ * @param name The name of the program.
+ * @param flags The flags to create the program with.
+ * @return The new program, or NULL if the bundle does not contain the program
+ *   or the program could not be created.  The caller is responsible for
+ *   destroying the program.
+ */
+GTA_NO_DISCARD GTA_Program * gta_bundle_load_program(GTA_Bundle * self, GTA_Language * language, const char * name, GTA_Program_Flags flags);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // G_TANG_BUNDLE_H
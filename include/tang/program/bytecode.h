@@ -23,6 +23,13 @@ extern "C" {
  * The S/I order in the Opcode indicates the nature (stack or index) of the
  * associated values.  For example, ADD_SS will add a lhs + rhs.  The lhs
  * will have been pushed onto the stack first, followed by the rhs.
+ *
+ * Opcodes with a type suffix (e.g., JMPF_BOOLEAN) are specialized versions of
+ * a generic opcode, which the compiler emits only when the type of the operand
+ * is proven (see GTA_Ast_Possible_Type).  JMPF_BOOLEAN does not check the type
+ * at runtime.  The _INT_INT opcodes check that both operands are immediate
+ * integers (a proven integer may still be boxed, if it is too large), and
+ * otherwise fall back to the behavior of the generic opcode.
  */
 typedef enum GTA_Bytecode {
   GTA_BYTECODE_RETURN,         ///< Restore fp, restore pc. Does not pop.
@@ -37,7 +44,8 @@ typedef enum GTA_Bytecode {
                                ///<   order.
   GTA_BYTECODE_MAP,            ///< Get len, pop `len` value then key pairs,
                                ///<   putting them into a map.
-  GTA_BYTECODE_CAST,           ///< Get type, pop val, push type(val)
+  GTA_BYTECODE_CAST,           ///< Get type index (into gta_bytecode_cast_types),
+                               ///<   pop val, push type(val)
   GTA_BYTECODE_SET_NOT_TEMP,   ///< Set the top of the stack to not be a temporary value
   GTA_BYTECODE_ADOPT,          ///< Pop val. Val will be adopted by the next
                                ///<   operation.  If temp, set not temp.  Otherwise,
@@ -55,7 +63,8 @@ typedef enum GTA_Bytecode {
   GTA_BYTECODE_MARK_FP,        ///< Mark the current stack pointer as the frame pointer
   GTA_BYTECODE_PUSH_FP,        ///< Push the frame pointer onto the stack
   GTA_BYTECODE_POP_FP,         ///< Pop the frame pointer from the stack
-  GTA_BYTECODE_LOAD,           ///< Get pointer, push on stack
+  GTA_BYTECODE_LOAD,           ///< Get index into the program constants, push
+                               ///<   the constant on stack
   GTA_BYTECODE_LOAD_LIBRARY,   ///< Get identifier hash and load a library value
   GTA_BYTECODE_NEGATIVE,       ///< Perform a negation
   GTA_BYTECODE_NOT,            ///< Perform a logical not
@@ -77,8 +86,9 @@ typedef enum GTA_Bytecode {
   GTA_BYTECODE_JMPT,           ///< PC offset: pop val, if true, set pc + offset
   GTA_BYTECODE_PRINT,          ///< Pop val, print(val), push error or NULL
   GTA_BYTECODE_INDEX,          ///< Pop index, pop collection, push collection[index]
-  GTA_BYTECODE_PERIOD,         ///< Get attribute hash, attribute string name,
-                               ///<   pop object, push object.attr
+  GTA_BYTECODE_PERIOD,         ///< Get attribute hash, index of the inline
+                               ///<   cache in the program constants, pop object,
+                               ///<   push object.attr
   GTA_BYTECODE_SLICE,          ///< Pop skip, pop end, pop begin, pop collection,
                                ///<   push collection[begin:end:skip]
   GTA_BYTECODE_ASSIGN_INDEX,   ///< Pop value, pop index, pop collection,
@@ -88,8 +98,56 @@ typedef enum GTA_Bytecode {
   GTA_BYTECODE_ITERATOR_NEXT,  ///< Pop an iterator, push the next value, push true
                                ///<   if there is a next value, false otherwise
   GTA_BYTECODE_CALL,           ///< argc: pop a function, prepare and call function
+  GTA_BYTECODE_ADD_INT_INT,    ///< ADD, specialized for two integers
+  GTA_BYTECODE_LESS_THAN_INT_INT,///< LESS_THAN, specialized for two integers
+  GTA_BYTECODE_JMPF_BOOLEAN,   ///< JMPF, specialized for a boolean condition
+  GTA_BYTECODE_INC_LOCAL_IMM,  ///< Stack # (from fp), integer: add the integer
+                               ///<   to the local variable in place.  Fused
+                               ///<   from PEEK_LOCAL, INTEGER, ADD, POKE_LOCAL,
+                               ///<   POP.
+  GTA_BYTECODE_CMP_LOCAL_IMM_JMPF,///< Stack # (from fp), comparison opcode,
+                               ///<   integer, PC offset: push the result of
+                               ///<   comparing the local variable to the
+                               ///<   integer, if false, set pc + offset.  Fused
+                               ///<   from PEEK_LOCAL, INTEGER, comparison, JMPF.
+  GTA_BYTECODE_ITERATOR_LOCAL, ///< Stack # (from fp) of iterator, Stack # (from
+                               ///<   fp) of index: pop a collection, store it
+                               ///<   (if it is an array or range) or an
+                               ///<   iterator over it in the iterator slot,
+                               ///<   and store 0 in the index slot.
+  GTA_BYTECODE_ITERATOR_NEXT_LOCAL,///< Stack # (from fp) of iterator, Stack #
+                               ///<   (from fp) of index, PC offset: push the
+                               ///<   next value from the iterator slot, if
+                               ///<   there is none, push the reason and set
+                               ///<   pc + offset.
+  GTA_BYTECODE_RANGE,          ///< Pop end, pop start, push start..end
+  GTA_BYTECODE_COUNT,          ///< The number of bytecodes.  Not a bytecode.
 } GTA_Bytecode;
 
+/**
+ * The number of types that may be the target of a CAST instruction.
+ */
+#define GTA_BYTECODE_CAST_TYPE_COUNT 4
+
+/**
+ * The types that may be the target of a CAST instruction, indexed by its
+ * operand, which is a GTA_Cast_Type.
+ *
+ * Using an index rather than the address of the vtable keeps the bytecode
+ * free of pointers, so that it can be saved in an image (see
+ * bytecodeImage.h).
+ */
+extern GTA_Computed_Value_VTable * const gta_bytecode_cast_types[GTA_BYTECODE_CAST_TYPE_COUNT];
+
+/**
+ * Get the number of words used by a bytecode instruction.
+ *
+ * @param opcode The opcode of the instruction.
+ * @return The number of words used by the opcode and its operands, or 0 if the
+ *   opcode is not valid.
+ */
+size_t gta_bytecode_instruction_size(GTA_UInteger opcode);
+
 /**
  * Print the given bytecode to stdout.
  *
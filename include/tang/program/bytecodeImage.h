@@ -0,0 +1,115 @@
+/**
+ * @file
+ *
+ * Header file for bytecode images, which allow a compiled program to be saved
+ * and loaded again without parsing, analyzing, or compiling its source code.
+ *
+ * The bytecode of a program does not hold any pointers.  The operands of LOAD
+ * and PERIOD are indices into the constants of the program (the values that
+ * are loaded and the inline caches), and the operand of CAST is an index into
+ * gta_bytecode_cast_types.  An image therefore stores the constants, which
+ * are rebuilt when it is loaded, and the bytecode exactly as it is in memory,
+ * so that a loaded program may execute the bytecode directly from the image
+ * (see gta_bytecode_image_load_in_place()).
+ *
+ * An image is a sequence of 64-bit words in the byte order of the machine
+ * that created it.  Byte strings are stored as a length word followed by the
+ * bytes, padded with zeros to a whole number of words, with at least one zero
+ * byte after the string so that it is null terminated.
+ *
+ *   - Header: magic, version, byte order marker, the size of GTA_UInteger,
+ *     the size of GTA_Float, the program flags, the number of constants, and
+ *     the number of bytecode words.
+ *   - Constants: in the order of the constants of the program, a kind word
+ *     followed by the value.  Integers and floats are a single word.  Strings
+ *     are the number of string type parts, the (type, offset) parts, and the
+ *     byte string.  Functions are the number of arguments and the bytecode
+ *     offset.  Inline caches are the hash of the attribute name.
+ *   - Bytecode: the instructions.
+ *
+ * The operand of LOAD_LIBRARY is the hash of the library name, which is the
+ * same in every process of a platform with the same word size (bundles rely
+ * on this as well).
+ *
+ * Images can only be loaded on a platform with the same byte order and word
+ * size as the one which created them.
+ */
+
+#ifndef G_TANG_BYTECODEIMAGE_H
+#define G_TANG_BYTECODEIMAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <cutil/vector.h>
+#include <tang/macros.h>
+
+/**
+ * The first word of every bytecode image ("GTAIMAGE" on little endian
+ * machines).
+ */
+#define GTA_BYTECODE_IMAGE_MAGIC UINT64_C(0x4547414D49415447)
+
+/**
+ * The version of the bytecode image format.
+ *
+ * This must be incremented whenever the format or the bytecode changes.
+ */
+#define GTA_BYTECODE_IMAGE_VERSION 5
+
+/**
+ * Create a bytecode image of a program.
+ *
+ * The program must have been compiled to bytecode (e.g., by creating it with
+ * the GTA_PROGRAM_FLAG_DISABLE_BINARY flag).
+ *
+ * @param program The program to save.
+ * @return A vector of the words of the image, or NULL if the program cannot be
+ *   saved or memory could not be allocated.  The caller is responsible for
+ *   destroying the vector.
+ */
+GTA_NO_DISCARD GCU_Vector64 * gta_bytecode_image_create(GTA_Program * program);
+
+/**
+ * Load a bytecode image into a program.
+ *
+ * The program must have been initialized, but must not have any code.  The
+ * image is not referenced after this function returns.  Any values that are
+ * created are owned by the program, even if the load fails, so the program
+ * must be destroyed on failure.
+ *
+ * @param program The program to load the image into.
+ * @param data The image.
+ * @param length The length of the image in bytes.
+ * @return True on success, false if the image is not valid or if memory could
+ *   not be allocated.
+ */
+bool gta_bytecode_image_load(GTA_Program * program, const void * data, size_t length);
+
+/**
+ * Load a bytecode image into a program, using the image in place.
+ *
+ * This is the same as gta_bytecode_image_load(), except that the program
+ * keeps using the image: the string literals refer to the bytes of the image,
+ * and, if the image is aligned to a word and the words of the bytecode are
+ * 64 bits wide, the program executes the bytecode of the image directly.
+ * The bytecode vector is then a single allocation, which must be freed with
+ * gcu_free() rather than destroyed.  The image must remain valid and
+ * unchanged until the program has been destroyed.
+ *
+ * @param program The program to load the image into.
+ * @param data The image.
+ * @param length The length of the image in bytes.
+ * @return True on success, false if the image is not valid or if memory could
+ *   not be allocated.
+ */
+bool gta_bytecode_image_load_in_place(GTA_Program * program, const void * data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // G_TANG_BYTECODEIMAGE_H
@@ -0,0 +1,46 @@
+/**
+ * @file
+ *
+ * Header file for the peephole optimizer which is applied to the bytecode of a
+ * program after it has been compiled.
+ *
+ * The optimizer makes a single pass over the bytecode, and:
+ *   - Threads jumps whose destination is another jump, so that they go
+ *     directly to the final destination.
+ *   - Fuses common instruction sequences into superinstructions, so that
+ *     fewer instructions must be dispatched (e.g., `i = i + 1;` becomes a
+ *     single INC_LOCAL_IMM).
+ *   - Removes SET_NOT_TEMP instructions that follow an instruction which can
+ *     only push a value that is never temporary.
+ *
+ * Sequences are never fused if a jump lands in the middle of them.
+ */
+
+#ifndef G_TANG_BYTECODEOPTIMIZER_H
+#define G_TANG_BYTECODEOPTIMIZER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stdbool.h>
+#include <tang/macros.h>
+
+/**
+ * Optimize the bytecode of the program being compiled.
+ *
+ * This must be called after all jump offsets have been resolved.  The
+ * program's bytecode is replaced, and the function entry points, as well as
+ * the bytecode offsets of the compiler context, are updated to match.
+ *
+ * @param context The compiler context that was used to produce the bytecode.
+ * @return True on success, false if memory could not be allocated.  The
+ *   bytecode is still valid (but may not be optimized) on failure.
+ */
+bool gta_bytecode_optimizer_optimize(GTA_Compiler_Context * context);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // G_TANG_BYTECODEOPTIMIZER_H
@@ -0,0 +1,139 @@
+/**
+ * @file
+ *
+ * Header file for the code arena, which holds the JIT compiled code of all of
+ * the programs of a language.
+ *
+ * Rather than mapping separate executable pages for every program, the code
+ * is packed into large chunks.  New code is placed in the first free block
+ * that is large enough (blocks are returned to the arena when a program is
+ * destroyed, and neighbouring free blocks are merged), or else at the end of
+ * a chunk.  A new chunk is only mapped when no existing chunk has room.
+ *
+ * The chunks are never writable and executable at the same time:
+ *   - Where possible (Linux), each chunk is mapped twice, once writable and
+ *     once executable, so code is written through one view and executed
+ *     through the other.  Code is packed on GTA_CODE_ARENA_ALIGNMENT byte
+ *     boundaries.
+ *   - Otherwise, the pages of a block are made writable while the code is
+ *     copied in, and then made executable again.  So that code which is
+ *     running on another thread is never made unexecutable, blocks are
+ *     rounded up to whole pages.
+ *
+ * The arena may be used by any number of threads at the same time.
+ */
+
+#ifndef G_TANG_CODEARENA_H
+#define G_TANG_CODEARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <tang/macros.h>
+
+/**
+ * The minimum size of a chunk of the code arena, in bytes.
+ *
+ * Code which is larger than this is given a chunk of its own.
+ */
+#ifndef GTA_CODE_ARENA_CHUNK_SIZE
+#define GTA_CODE_ARENA_CHUNK_SIZE (1024 * 1024)
+#endif // GTA_CODE_ARENA_CHUNK_SIZE
+
+/**
+ * The alignment of code in the arena, in bytes.
+ */
+#define GTA_CODE_ARENA_ALIGNMENT 16
+
+/**
+ * The memory usage of a code arena.
+ *
+ * @see gta_code_arena_get_stats()
+ */
+typedef struct GTA_Code_Arena_Stats {
+  /**
+   * The number of chunks that are mapped.
+   */
+  size_t chunks;
+  /**
+   * The total size of the chunks, in bytes.
+   */
+  size_t bytes_reserved;
+  /**
+   * The number of bytes that hold code, including alignment padding.
+   */
+  size_t bytes_used;
+  /**
+   * The number of bytes that are available, either in free blocks or at the
+   * end of a chunk.
+   */
+  size_t bytes_free;
+  /**
+   * The size of the largest available block, in bytes.
+   */
+  size_t largest_free_block;
+  /**
+   * The number of blocks of code in the arena.
+   */
+  size_t allocations;
+  /**
+   * The fraction of the available bytes which are not in the largest
+   * available block, from 0 (no fragmentation) to 1.
+   */
+  double fragmentation;
+} GTA_Code_Arena_Stats;
+
+/**
+ * Create a new, empty code arena.
+ *
+ * No memory is mapped until code is added to the arena.
+ *
+ * @return The new arena or NULL on failure.
+ */
+GTA_NO_DISCARD GTA_Code_Arena * gta_code_arena_create(void);
+
+/**
+ * Destroy a code arena, unmapping all of its chunks.
+ *
+ * Any code that is still in the arena becomes invalid.
+ *
+ * @param self The arena to destroy.
+ */
+void gta_code_arena_destroy(GTA_Code_Arena * self);
+
+/**
+ * Copy code into executable memory in the arena.
+ *
+ * @param self The arena.
+ * @param code The machine code.
+ * @param length The length of the code in bytes.
+ * @return The address of the executable copy of the code, or NULL on failure.
+ *   The block must be returned with gta_code_arena_free().
+ */
+GTA_NO_DISCARD void * gta_code_arena_allocate(GTA_Code_Arena * self, const void * code, size_t length);
+
+/**
+ * Return a block of code to the arena so that its memory may be reused.
+ *
+ * @param self The arena.
+ * @param code The address returned by gta_code_arena_allocate().
+ * @param length The length that was passed to gta_code_arena_allocate().
+ */
+void gta_code_arena_free(GTA_Code_Arena * self, void * code, size_t length);
+
+/**
+ * Get the memory usage of a code arena.
+ *
+ * @param self The arena.
+ * @param stats Set to the memory usage of the arena.
+ */
+void gta_code_arena_get_stats(GTA_Code_Arena * self, GTA_Code_Arena_Stats * stats);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // G_TANG_CODEARENA_H
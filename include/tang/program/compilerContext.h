@@ -14,6 +14,7 @@ extern "C" {
 #include <cutil/vector.h>
 #include <tang/program/bytecode.h>
 #include <tang/program/program.h>
+#include <tang/program/registerCache.h>
 
 #define GTA_BYTECODE_APPEND(X,Y) \
   GTA_VECTORX_APPEND(X, GTA_TYPEX_MAKE_UI(Y))
@@ -46,6 +47,11 @@ struct GTA_Compiler_Context {
    * the bytecode later.
    */
   GTA_VectorX * bytecode_offsets;
+  /**
+   * Maps the address of an object to its index in the constants of the
+   * program, so that each object is only added once.
+   */
+  GTA_HashX * constant_indices;
   /**
    * Tracking the current stack depth so that the stack can be properly byte
    * aligned.
@@ -99,6 +105,19 @@ struct GTA_Compiler_Context {
    * The code should ensure that a value is on the stack, ready for a POP.
    */
   GTA_Integer return_label;
+  /**
+   * The label to which the execution should jump to abort the program (x86_64
+   * only).
+   *
+   * The code should put the reason for the abort in RAX.  The native stack
+   * may be in any state, as it is discarded.
+   */
+  GTA_Integer abort_label;
+  /**
+   * The variables of the stack frame currently being compiled which are held
+   * in registers (x86_64 only).
+   */
+  GTA_Register_Cache register_cache;
 };
 
 /**
@@ -176,6 +195,23 @@ bool gta_compiler_context_add_label_jump(GTA_Compiler_Context * context, GTA_Int
  */
 bool gta_compiler_context_set_label(GTA_Compiler_Context * context, GTA_Integer label, GTA_Integer byte_offset);
 
+/**
+ * Get the index of an object in the constants of the program, which is how
+ * the bytecode refers to it (e.g., the operand of a LOAD instruction).
+ *
+ * The object is added to the constants if it is not already there.  It is not
+ * owned by the constants, so it must be owned by the program in some other
+ * way (e.g., as a singleton).
+ *
+ * Note: 0 is a valid index, so the return value should be checked against
+ * -1.
+ *
+ * @param context The compiler context.
+ * @param object The object.
+ * @return The index of the object, or -1 on failure.
+ */
+GTA_NO_DISCARD GTA_Integer gta_compiler_context_add_constant(GTA_Compiler_Context * context, void * object);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
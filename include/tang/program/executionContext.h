@@ -15,6 +15,8 @@ extern "C" {
 #endif // __cplusplus
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <cutil/vector.h>
 #include <tang/macros.h>
 #include <tang/unicodeString.h>
@@ -33,6 +35,59 @@ extern "C" {
  */
 typedef GTA_Computed_Value * GTA_CALL (*GTA_Execution_Context_Global_Create) (GTA_Execution_Context * context);
 
+/**
+ * Output sink function.
+ *
+ * An output sink receives the rendered (i.e., already encoded) bytes of the
+ * program output as the program runs, rather than having the output collected
+ * in the execution context.
+ *
+ * @see gta_execution_context_set_output_sink()
+ *
+ * @param sink_data The user-defined pointer provided with the sink.
+ * @param buffer The rendered bytes.  They are not null-terminated.
+ * @param length The number of bytes in the buffer.
+ * @return True on success, false on failure.
+ */
+typedef bool (*GTA_Execution_Context_Output_Sink) (void * sink_data, const char * buffer, size_t length);
+
+/**
+ * The default size of the buffer used by an output sink.
+ */
+#define GTA_EXECUTION_CONTEXT_OUTPUT_SINK_DEFAULT_BUFFER_SIZE 4096
+
+/**
+ * The maximum number of idle execution contexts kept by the pool of each
+ * thread.
+ *
+ * @see gta_execution_context_pool_acquire()
+ */
+#define GTA_EXECUTION_CONTEXT_POOL_SIZE 8
+
+/**
+ * An execution budget which does not limit the number of safepoints.
+ *
+ * @see gta_execution_context_set_budget()
+ */
+#define GTA_EXECUTION_CONTEXT_BUDGET_UNLIMITED UINT64_MAX
+
+/**
+ * The number of safepoints that may be passed between checks of the
+ * execution budget, and so between readings of the clock.
+ */
+#define GTA_EXECUTION_CONTEXT_BUDGET_SLICE 1024
+
+/**
+ * Count a safepoint against the execution budget.
+ *
+ * This is the decrement-and-branch that is performed at every loop back-edge
+ * and function call.  JIT-compiled code performs the same operation inline.
+ *
+ * @param context The execution context.
+ * @return True if gta_execution_context_budget_check() must be called.
+ */
+#define GTA_EXECUTION_CONTEXT_BUDGET_TICK(context) (--(context)->budget_countdown < 0)
+
 /**
  * The Context class.
  *
@@ -45,9 +100,39 @@ struct GTA_Execution_Context {
   */
   GTA_Program * program;
   /**
-   * The output string.
+   * The output that has been printed, as a list of chunks.
+   *
+   * Each entry is a GTA_Unicode_String owned by the context.  Use
+   * gta_execution_context_get_output() to combine them into a single string.
+   */
+  GTA_VectorX * output;
+  /**
+   * The total number of bytes in `output`.
+   */
+  size_t output_byte_length;
+  /**
+   * The function which receives the rendered output, or NULL if the output
+   * is collected in `output`.
+   *
+   * @see gta_execution_context_set_output_sink()
+   */
+  GTA_Execution_Context_Output_Sink output_sink;
+  /**
+   * The user-defined pointer that is passed to `output_sink`.
+   */
+  void * output_sink_data;
+  /**
+   * The rendered output that has not yet been passed to `output_sink`.
+   */
+  char * output_sink_buffer;
+  /**
+   * The capacity of `output_sink_buffer`.
+   */
+  size_t output_sink_buffer_size;
+  /**
+   * The number of bytes in `output_sink_buffer`.
    */
-  GTA_Unicode_String * output;
+  size_t output_sink_buffer_length;
   /**
    * The result of the last operation.
    */
@@ -64,6 +149,79 @@ struct GTA_Execution_Context {
    * The garbage collection list.
    */
   GTA_VectorX * garbage_collection;
+  /**
+   * The approximate size in bytes of each entry in `garbage_collection`.
+   *
+   * This vector is kept parallel to `garbage_collection`.
+   */
+  GTA_VectorX * garbage_collection_sizes;
+  /**
+   * The approximate number of bytes held by registered computed values.
+   */
+  size_t gc_bytes_live;
+  /**
+   * The number of bytes allocated since the last garbage collection.
+   */
+  size_t gc_bytes_since_collection;
+  /**
+   * The number of bytes that may be allocated before the next garbage
+   * collection is attempted.
+   */
+  size_t gc_next_collection;
+  /**
+   * The minimum number of bytes that may be allocated between garbage
+   * collections.
+   *
+   * @see gta_garbage_collector_set_threshold()
+   */
+  size_t gc_threshold;
+  /**
+   * The largest value that `gc_bytes_live` has reached since the context was
+   * created or last reset.
+   */
+  size_t gc_bytes_peak;
+  /**
+   * The number of bytes that registered computed values may hold before the
+   * execution is aborted, or SIZE_MAX if there is no quota.
+   *
+   * @see gta_garbage_collector_set_quota()
+   */
+  size_t gc_quota;
+  /**
+   * The base of the native stack used by JIT-compiled code, or NULL if no
+   * JIT-compiled code is executing.
+   */
+  void * gc_stack_base;
+  /**
+   * The number of safepoints that may be passed before the execution budget
+   * must be checked again.
+   *
+   * @see GTA_EXECUTION_CONTEXT_BUDGET_TICK()
+   */
+  int64_t budget_countdown;
+  /**
+   * The number of safepoints of the current execution which have not yet
+   * been added to `budget_countdown`.
+   */
+  uint64_t budget_steps_remaining;
+  /**
+   * The time (in nanoseconds, on a monotonic clock) at which the current
+   * execution is aborted, or 0 if there is no deadline.
+   */
+  uint64_t budget_deadline;
+  /**
+   * The number of safepoints that each execution may pass.
+   *
+   * @see gta_execution_context_set_budget()
+   */
+  uint64_t budget_steps;
+  /**
+   * The number of nanoseconds that each execution may take, or 0 if there is
+   * no limit.
+   *
+   * @see gta_execution_context_set_budget()
+   */
+  uint64_t budget_timeout;
   /**
    * A hash table used to store libraries and user-defined global variables.
    */
@@ -128,6 +286,228 @@ void gta_execution_context_destroy(GTA_Execution_Context * context);
  */
 void gta_execution_context_destroy_in_place(GTA_Execution_Context * context);
 
+/**
+ * Clear the state of a Context object so that the program can be executed
+ * again, without releasing the memory that the context has already
+ * allocated.
+ *
+ * All computed values created by the previous execution are destroyed, and
+ * the output, the result, and the stacks are emptied (but keep their
+ * capacity).  Any output still buffered for the output sink is first passed
+ * to the sink (see gta_execution_context_flush_output()).
+ *
+ * The configuration of the context is kept: the program, the libraries, the
+ * output sink, the garbage collection threshold, the memory quota, the
+ * execution budget, and the user data.
+ *
+ * @param context The Context object to reset.
+ */
+void gta_execution_context_reset(GTA_Execution_Context * context);
+
+/**
+ * Get an execution context for a program from the pool of the calling
+ * thread, or create a new one if the pool holds no context for the program.
+ *
+ * Each thread has its own pool, so no locking is needed.  A context which is
+ * acquired must either be returned with gta_execution_context_pool_release()
+ * or destroyed with gta_execution_context_destroy().
+ *
+ * Pooled contexts keep their configuration (see
+ * gta_execution_context_reset()), so a host which uses a different output
+ * sink or user data for each execution must set them after acquiring the
+ * context.
+ *
+ * @see gta_execution_context_pool_release()
+ *
+ * @param program The program associated with the execution.
+ * @return The execution context or NULL on failure.
+ */
+GTA_NO_DISCARD GTA_Execution_Context * gta_execution_context_pool_acquire(GTA_Program * program);
+
+/**
+ * Reset an execution context and return it to the pool of the calling
+ * thread.
+ *
+ * If the pool is full, then the context is destroyed instead.  The context
+ * must have been created with gta_execution_context_create() or
+ * gta_execution_context_pool_acquire().
+ *
+ * @see gta_execution_context_pool_acquire()
+ *
+ * @param context The execution context.
+ */
+void gta_execution_context_pool_release(GTA_Execution_Context * context);
+
+/**
+ * Destroy the pooled execution contexts of the calling thread.
+ *
+ * Pooled contexts refer to their program, so every thread which may hold a
+ * pooled context for a program must call this function before the program
+ * is destroyed.  A thread should also call it before it exits, or the pooled
+ * contexts will be leaked.
+ *
+ * @param program Only destroy the contexts of this program, or NULL to
+ *   destroy all of them.
+ */
+void gta_execution_context_pool_clear(GTA_Program * program);
+
+/**
+ * Limit the work that each execution of the program may perform.
+ *
+ * The budget is counted in safepoints: each loop iteration and each function
+ * call passes one.  If a program passes more safepoints than `steps`, or is
+ * still running once `timeout` nanoseconds have passed since it started,
+ * then it is aborted and its result is
+ * gta_computed_value_error_execution_budget_exceeded or
+ * gta_computed_value_error_execution_deadline_exceeded, respectively.  Any
+ * output produced before that point is kept.
+ *
+ * The clock is only read once every GTA_EXECUTION_CONTEXT_BUDGET_SLICE
+ * safepoints, so the deadline may be overrun by the time that it takes to
+ * pass that many safepoints (or to complete a single long-running library
+ * call).
+ *
+ * The budget is part of the configuration of the context, so it applies to
+ * every execution until it is changed.
+ *
+ * @param context The execution context.
+ * @param steps The number of safepoints, or
+ *   GTA_EXECUTION_CONTEXT_BUDGET_UNLIMITED.
+ * @param timeout The number of nanoseconds, or 0 for no deadline.
+ */
+void gta_execution_context_set_budget(GTA_Execution_Context * context, uint64_t steps, uint64_t timeout);
+
+/**
+ * Start the execution budget of a new execution of the program.
+ *
+ * This is called by gta_program_execute().
+ *
+ * @param context The execution context.
+ */
+void gta_execution_context_budget_start(GTA_Execution_Context * context);
+
+/**
+ * Check the execution budget once `budget_countdown` has run out.
+ *
+ * If the budget allows, then `budget_countdown` is refilled, and the
+ * safepoint which made the call is counted against it.
+ *
+ * @param context The execution context.
+ * @return NULL if execution may continue, or the error with which the
+ *   execution must be aborted.
+ */
+GTA_Computed_Value * GTA_CALL gta_execution_context_budget_check(GTA_Execution_Context * context);
+
+/**
+ * Make the next safepoint call gta_execution_context_budget_check().
+ *
+ * The remainder of `budget_countdown` is returned to the budget, so no
+ * safepoints are lost.
+ *
+ * @param context The execution context.
+ */
+void gta_execution_context_budget_interrupt(GTA_Execution_Context * context);
+
+/**
+ * Append a string to the output of the execution context.
+ *
+ * If an output sink has been set, then the string is rendered and written to
+ * the sink's buffer, which is passed to the sink whenever it is full.
+ * Otherwise, the string is stored as a separate chunk, so that appending is
+ * amortized O(1) regardless of how much output has already been produced.
+ *
+ * The context adopts the string, even on failure.
+ *
+ * @param context The execution context.
+ * @param string The string to append.
+ * @return NULL on success, otherwise the error:
+ *   gta_computed_value_error_output_sink_failed if the output sink reported a
+ *   failure, or gta_computed_value_error_out_of_memory.
+ */
+GTA_Computed_Value * gta_execution_context_output_append(GTA_Execution_Context * context, GTA_Unicode_String * string);
+
+/**
+ * Send the rendered output to a host-provided function as it is produced.
+ *
+ * Rendered output is accumulated in a buffer of `buffer_size` bytes, and is
+ * passed to the sink whenever the buffer is full, and when the program
+ * finishes executing.  Strings which are larger than the buffer are passed
+ * to the sink directly.  A buffer size of 0 passes every printed string to
+ * the sink as soon as it is produced.
+ *
+ * Any output that is already buffered for a previous sink is flushed to that
+ * sink first.  Output which was already collected in `output` is left as-is.
+ * Output still in the buffer when the context is destroyed is discarded.
+ *
+ * @param context The execution context.
+ * @param sink The sink function, or NULL to collect the output in the
+ *   context again.
+ * @param sink_data A user-defined pointer to pass to the sink.
+ * @param buffer_size The size of the output buffer in bytes.
+ * @return True on success, false on failure.
+ */
+bool gta_execution_context_set_output_sink(GTA_Execution_Context * context, GTA_Execution_Context_Output_Sink sink, void * sink_data, size_t buffer_size);
+
+/**
+ * Send the rendered output to a file descriptor as it is produced.
+ *
+ * @see gta_execution_context_set_output_sink()
+ *
+ * The output is written with write(), bypassing stdio.  If the host also
+ * writes to the same file descriptor through a FILE stream, then it must flush
+ * that stream before execution, or use gta_execution_context_set_output_file()
+ * instead.
+ *
+ * @param context The execution context.
+ * @param fd The file descriptor.  It is not closed by the context.
+ * @param buffer_size The size of the output buffer in bytes.
+ * @return True on success, false on failure.
+ */
+bool gta_execution_context_set_output_fd(GTA_Execution_Context * context, int fd, size_t buffer_size);
+
+/**
+ * Send the rendered output to a stdio stream as it is produced.
+ *
+ * The output is written with fwrite(), so it stays in order with anything
+ * else the host writes to the stream.  The stream is not flushed or closed by
+ * the context.  This is the sink used by GTA_PROGRAM_FLAG_PRINT_TO_STDOUT.
+ *
+ * @see gta_execution_context_set_output_sink()
+ *
+ * @param context The execution context.
+ * @param file The stream.
+ * @param buffer_size The size of the output buffer in bytes.
+ * @return True on success, false on failure.
+ */
+bool gta_execution_context_set_output_file(GTA_Execution_Context * context, FILE * file, size_t buffer_size);
+
+/**
+ * Pass any buffered output to the output sink.
+ *
+ * This is called automatically when the program finishes executing.
+ *
+ * @param context The execution context.
+ * @return True on success (or if there is no output sink), false if the sink
+ *   reported a failure.
+ */
+bool gta_execution_context_flush_output(GTA_Execution_Context * context);
+
+/**
+ * Get the output of the execution context as a single string.
+ *
+ * The output chunks are combined on the first call after any new output has
+ * been appended.  The returned string is owned by the context, and remains
+ * valid until more output is appended or the context is destroyed.
+ *
+ * Use gta_unicode_string_render() to get the rendered bytes.
+ *
+ * Output which was sent to an output sink is not included.
+ *
+ * @param context The execution context.
+ * @return The output string, or NULL on failure.
+ */
+GTA_Unicode_String * gta_execution_context_get_output(GTA_Execution_Context * context);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -2,6 +2,32 @@
  * @file
  *
  * Header file for the garbage collector functionality.
+ *
+ * Every computed value that is created within an execution context is
+ * registered with that context, so that it can be freed when the context is
+ * destroyed.  In addition, a mark-and-sweep collector frees values which are
+ * no longer reachable while the program is still running.
+ *
+ * The roots of the collection are:
+ *   - The bytecode interpreter stack (`context->stack`).
+ *   - The native stack used by JIT-compiled code (from the stack pointer at
+ *     the time of the collection up to `context->gc_stack_base`).
+ *   - `context->result`.
+ *
+ * Stacks are scanned conservatively: any stack word which has the same value
+ * as the address of a registered computed value keeps that value alive.
+ * Values which are reachable from a live array, map, iterator, or bound
+ * native function are also kept alive.
+ *
+ * Collections only happen at safe points (loop back-edges and function
+ * calls), where every live value is guaranteed to be on one of the stacks.
+ * They are never triggered from within a computed value operation, so
+ * library code may hold on to unrooted values for the duration of a call.
+ *
+ * The sizes of the registered values are also used to enforce an optional
+ * memory quota.  Registration never fails because of the quota: instead, it
+ * forces a collection at the next safe point, and the execution is aborted
+ * there if the live values still exceed the quota.
  */
 
 #ifndef G_TANG_GARBAGECOLLECTOR_H
@@ -21,9 +47,121 @@ extern "C" {
  */
 typedef GTA_VectorX GTA_Garbage_Collector_Allocations_List;
 
+/**
+ * The default number of bytes that may be allocated before a garbage
+ * collection is attempted.
+ *
+ * After each collection, the next collection is scheduled once the number of
+ * newly allocated bytes reaches the larger of this threshold and the number
+ * of bytes that survived the collection.
+ */
+#define GTA_GARBAGE_COLLECTOR_DEFAULT_THRESHOLD (1024 * 1024)
+
+/**
+ * Determine whether or not a garbage collection should be performed.
+ *
+ * @param context The execution context.
+ * @return True if enough memory has been allocated to warrant a collection.
+ */
+#define GTA_GARBAGE_COLLECTOR_SHOULD_COLLECT(context) ((context)->gc_bytes_since_collection >= (context)->gc_next_collection)
+
+/**
+ * Register a newly created computed value with the execution context.
+ *
+ * The value will be freed either by a garbage collection (if it is no longer
+ * reachable) or when the execution context is destroyed.
+ *
+ * @param context The execution context.
+ * @param value The computed value to register.
+ * @param size The approximate number of bytes owned by the value.
+ * @return True on success, false on failure.
+ */
+bool gta_garbage_collector_register(GTA_Execution_Context * context, GTA_Computed_Value * value, size_t size);
+
+/**
+ * Perform a mark-and-sweep garbage collection.
+ *
+ * This must only be called at a safe point, i.e., when every live value is
+ * reachable from one of the roots described in this file.
+ *
+ * @param context The execution context.
+ * @param stack_pointer The current native stack pointer, if called from
+ *   JIT-compiled code, or NULL otherwise.
+ * @return True on success, false if the collection could not be performed
+ *   (e.g., because memory for the bookkeeping could not be allocated).  No
+ *   values are freed on failure.
+ */
+bool gta_garbage_collector_collect(GTA_Execution_Context * context, void * stack_pointer);
+
+/**
+ * Perform a garbage collection if enough memory has been allocated since the
+ * last one.
+ *
+ * This is the function that is called from the safe points in JIT-compiled
+ * code once the inline threshold check has failed.
+ *
+ * @see gta_garbage_collector_collect()
+ *
+ * @param context The execution context.
+ * @param stack_pointer The current native stack pointer.
+ */
+void GTA_CALL gta_garbage_collector_safepoint(GTA_Execution_Context * context, void * stack_pointer);
+
+/**
+ * Set the minimum number of bytes that may be allocated between garbage
+ * collections.
+ *
+ * @param context The execution context.
+ * @param threshold The number of bytes.  SIZE_MAX disables the collector.
+ */
+void gta_garbage_collector_set_threshold(GTA_Execution_Context * context, size_t threshold);
+
+/**
+ * Limit the memory that the computed values of an execution may hold.
+ *
+ * If the live values exceed the quota, and a garbage collection does not
+ * bring them back under it, then the execution is aborted and its result is
+ * gta_computed_value_error_memory_quota_exceeded.  The quota is only checked
+ * at safe points, so it may be overrun by the values which are allocated
+ * between two of them.
+ *
+ * The quota is enforced on the sizes passed at registration, which are only
+ * an estimate of the memory that an execution holds:
+ * - Later growth of an array or a map is not counted.
+ * - Copies of an array or a map share its storage until they are written to
+ *   (see gta_computed_value_deep_copy()).  Each copy counts only its own
+ *   size, so shared storage is counted once, by the value which created it,
+ *   and not at all once that value has been collected.  Neither is the
+ *   storage that a copy allocates when it is first written to.
+ *
+ * The quota is part of the configuration of the context, so it applies to
+ * every execution until it is changed.
+ *
+ * @param context The execution context.
+ * @param quota The number of bytes.  SIZE_MAX removes the quota.
+ */
+void gta_garbage_collector_set_quota(GTA_Execution_Context * context, size_t quota);
+
+/**
+ * Get the approximate number of bytes held by the live computed values of an
+ * execution context.
+ *
+ * @param context The execution context.
+ * @return The number of bytes.
+ */
+size_t gta_garbage_collector_get_bytes_live(const GTA_Execution_Context * context);
+
+/**
+ * Get the largest number of bytes that the computed values of an execution
+ * context have held since the context was created or last reset.
+ *
+ * @param context The execution context.
+ * @return The number of bytes.
+ */
+size_t gta_garbage_collector_get_bytes_peak(const GTA_Execution_Context * context);
 
 #ifdef __cplusplus
 }
 #endif // __cplusplus
 
-#endif // G_TANG_GARBAGECOLLECTOR_H
\ No newline at end of file
+#endif // G_TANG_GARBAGECOLLECTOR_H
@@ -0,0 +1,88 @@
+/**
+ * @file
+ *
+ * Header file for the inline caches used by attribute lookups.
+ *
+ * Every `object.attribute` expression in a program is a call site.  Without a
+ * cache, each execution of the call site must look up the attribute callback
+ * in the two-dimensional `program->attributes` hash (first by the type of the
+ * object, then by the attribute name).  Instead, the bytecode and the JIT code
+ * for each call site hold a pointer to an inline cache which remembers the
+ * callback for the last few types that have been seen at that site, so that
+ * the common case is a single pointer compare.
+ *
+ * Each cache holds up to GTA_INLINE_CACHE_SIZE types.  Entries are written
+ * once and never modified, so a cache may be filled by any number of threads
+ * executing the same program at the same time.  Once a cache is full, the
+ * lookup falls back to the hash.
+ *
+ * Only types which use gta_computed_value_generic_period() are cached.  Other
+ * types (such as libraries) resolve attributes themselves, and are always
+ * passed to gta_computed_value_period().
+ *
+ * The caches are owned by the program, and are cleared whenever an attribute
+ * of the program is changed by gta_program_set_type_attribute().
+ */
+
+#ifndef G_TANG_INLINECACHE_H
+#define G_TANG_INLINECACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <tang/macros.h>
+
+/**
+ * The number of types that an inline cache can hold.
+ */
+#define GTA_INLINE_CACHE_SIZE 4
+
+/**
+ * Create an inline cache for an attribute lookup.
+ *
+ * The cache is owned by the program, and will be destroyed when the program
+ * is destroyed.
+ *
+ * @param program The program that contains the call site.
+ * @param identifier_hash The hash of the attribute name.
+ * @return The new cache or NULL on failure.
+ */
+GTA_NO_DISCARD GTA_Inline_Cache * gta_inline_cache_create(GTA_Program * program, GTA_UInteger identifier_hash);
+
+/**
+ * Destroy an inline cache.
+ *
+ * This is called by the program which owns the cache.
+ *
+ * @param self The cache to destroy.
+ */
+void gta_inline_cache_destroy(GTA_Inline_Cache * self);
+
+/**
+ * Remove all entries from an inline cache.
+ *
+ * This must not be called while the program is being executed.
+ *
+ * @param self The cache to clear.
+ */
+void gta_inline_cache_clear(GTA_Inline_Cache * self);
+
+/**
+ * Perform a period operation (e.g., `object.attribute`) using an inline cache.
+ *
+ * The result is the same as calling gta_computed_value_period() with the
+ * attribute hash of the cache.
+ *
+ * @param self The object whose attribute is requested.
+ * @param cache The inline cache of the call site.
+ * @param context The execution context.
+ * @return The value of the attribute, or an error.
+ */
+GTA_NO_DISCARD GTA_Computed_Value * GTA_CALL gta_inline_cache_period(GTA_Computed_Value * self, GTA_Inline_Cache * cache, GTA_Execution_Context * context);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // G_TANG_INLINECACHE_H
@@ -9,8 +9,17 @@
 extern "C" {
 #endif // __cplusplus
 
+#include <stddef.h>
 #include <tang/macros.h>
 
+/**
+ * The default number of invocations after which a tiered program is compiled
+ * to binary.
+ *
+ * @see GTA_PROGRAM_FLAG_TIERED
+ */
+#define GTA_LANGUAGE_DEFAULT_JIT_THRESHOLD 64
+
 /**
  * This structure holds the metadata pertaining to a language.
  *
@@ -24,6 +33,21 @@ struct GTA_Language {
    * The general libraries available to the language.
    */
   GTA_Library * library;
+  /**
+   * The executable memory which holds the JIT compiled code of the programs
+   * of the language.
+   */
+  GTA_Code_Arena * code_arena;
+  /**
+   * The number of executions of a tiered program (or calls of one of its
+   * functions) after which the program is compiled to binary.
+   *
+   * This may be changed at any time, and affects programs which are still
+   * warming up.
+   *
+   * @see GTA_PROGRAM_FLAG_TIERED
+   */
+  size_t jit_threshold;
 };
 
 /**
@@ -36,6 +60,8 @@ GTA_NO_DISCARD GTA_Language * gta_language_create(void);
 /**
  * Destroy the given language.
  *
+ * All of the programs of the language must have been destroyed first.
+ *
  * @param language The language to destroy.
  */
 void gta_language_destroy(GTA_Language * language);
@@ -29,6 +29,8 @@ extern "C" {
  * @see GTA_PROGRAM_FLAG_DUPLICATE_CODE
  * @see GTA_PROGRAM_FLAG_DISABLE_BYTECODE
  * @see GTA_PROGRAM_FLAG_DISABLE_BINARY
+ * @see GTA_PROGRAM_FLAG_TIERED
+ * @see GTA_PROGRAM_FLAG_DISABLE_SIMPLIFY
  */
 typedef uint32_t GTA_Program_Flags;
 
@@ -88,7 +90,10 @@ typedef uint32_t GTA_Program_Flags;
 /**
  * Print the output directly to stdout.
  *
- * The output buffer will not be populated.
+ * The execution context will send the output to the stdout stream as an
+ * output sink, so the output buffer will not be populated.
+ *
+ * @see gta_execution_context_set_output_sink()
  *
  * @see GTA_Program_Flags
  * @see gta_program_create()
@@ -103,6 +108,51 @@ typedef uint32_t GTA_Program_Flags;
  */
 #define GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT 64
 
+/**
+ * Start the program in the bytecode interpreter, and only compile it to
+ * binary once it is hot.
+ *
+ * The program is compiled to bytecode when it is created.  The number of
+ * times that the program is executed, and that each of its functions is
+ * called by the interpreter, is counted.  Once either count reaches the
+ * `jit_threshold` of the language, the program is compiled to binary the next
+ * time that it is executed, and all later executions use the binary.
+ *
+ * Programs that are never hot are never compiled to binary, which saves the
+ * compilation time and the executable memory.
+ *
+ * This flag has no effect if either GTA_PROGRAM_FLAG_DISABLE_BYTECODE or
+ * GTA_PROGRAM_FLAG_DISABLE_BINARY is set.
+ *
+ * @see GTA_Program_Flags
+ * @see gta_program_create()
+ */
+#define GTA_PROGRAM_FLAG_TIERED 128
+
+/**
+ * Do not simplify the AST before it is compiled.
+ *
+ * By default, constant expressions are folded and the values of variables
+ * which are known at compile time are propagated (see gta_tang_simplify()).
+ * This flag compiles the code exactly as it was written.
+ *
+ * @see GTA_Program_Flags
+ * @see gta_program_create()
+ */
+#define GTA_PROGRAM_FLAG_DISABLE_SIMPLIFY 256
+
+/**
+ * The execution tiers of a program.
+ *
+ * @see GTA_PROGRAM_FLAG_TIERED
+ */
+typedef enum GTA_Program_Tier {
+  GTA_PROGRAM_TIER_FINAL,     ///< The program will not change tiers.
+  GTA_PROGRAM_TIER_WARMING,   ///< Interpreted, counting invocations.
+  GTA_PROGRAM_TIER_HOT,       ///< To be compiled on the next execution.
+  GTA_PROGRAM_TIER_COMPILING, ///< Being compiled to binary.
+} GTA_Program_Tier;
+
 /**
  * Holds the metadata for a program.
  */
@@ -116,21 +166,44 @@ struct GTA_Program {
    */
   GTA_Library * library;
   /**
-   * The code that the program was created from.
+   * The code that the program was created from, or NULL if the program was
+   * loaded from a bytecode image.
    */
   const char * code;
   /**
-   * The AST for the program, if parsing was successful.
+   * The AST for the program, if parsing was successful.  Programs loaded from
+   * a bytecode image have no AST.
    */
   GTA_Ast_Node * ast;
   /**
    * The bytecode for the program, if it was generated.
+   *
+   * If the program was loaded from a bundle, then the vector does not own its
+   * data, which is part of the mapped bundle file and is read-only.
    */
   GTA_VectorX * bytecode;
+  /**
+   * The objects that the bytecode refers to, indexed by the operands of the
+   * LOAD instruction (a computed value) and the PERIOD instruction (an inline
+   * cache), so that the bytecode itself does not hold any pointers.
+   *
+   * The objects are owned by the program (as singletons or inline caches),
+   * not by the vector.  The vector is only appended to while the bytecode is
+   * being compiled.
+   */
+  GTA_VectorX * constants;
   /**
    * The binary for the program, if it was generated.
+   *
+   * The binary is stored in the code arena of the language.  For a tiered
+   * program, the binary is published (atomically) once it is complete, and
+   * may appear while other threads are executing the bytecode.
    */
-  void * binary;
+  GTA_ATOMIC(void *) binary;
+  /**
+   * The length of the binary in bytes.
+   */
+  size_t binary_length;
   /**
    * The flags for the program.
    */
@@ -164,6 +237,33 @@ struct GTA_Program {
    * the attribute value request.
    */
   GTA_HashX * attributes;
+  /**
+   * The inline caches of the attribute lookups in the compiled code.
+   *
+   * Each entry is a pointer to a GTA_Inline_Cache, which is owned by the
+   * program.
+   */
+  GTA_VectorX * inline_caches;
+  /**
+   * The execution tier of the program.
+   *
+   * This is accessed atomically.
+   */
+  GTA_ATOMIC(GTA_Program_Tier) tier;
+  /**
+   * The number of times that the program has been executed while warming up.
+   *
+   * This is accessed atomically.
+   */
+  GTA_ATOMIC(size_t) invocations;
+  /**
+   * The bundle whose mapped file holds the bytecode and string literals of the
+   * program, or NULL if the program owns them.
+   *
+   * The program holds a reference to the bundle, so that the file remains
+   * mapped for as long as the program exists.
+   */
+  GTA_Bundle * bundle;
 };
 
 /**
@@ -177,6 +277,8 @@ struct GTA_Program {
  * | TANG_DEBUG |  | If set, then the program will be created with the debug flag enabled. |
  * | TANG_DISABLE_BYTECODE |  | If set, then programs will not be compiled to bytecode. |
  * | TANG_DISABLE_BINARY |  | If set, then programs will not be compiled to binary. |
+ * | TANG_TIERED |  | If set, then programs will only be compiled to binary once they are hot. |
+ * | TANG_DISABLE_SIMPLIFY |  | If set, then the AST will not be simplified before it is compiled. |
  *
  * @param language The language with which the program should be executed.
  * @param code The code to create the program from.
@@ -229,6 +331,116 @@ GTA_NO_DISCARD GTA_Program * gta_program_create_with_flags(GTA_Language * langua
  */
 bool gta_program_create_in_place_with_flags(GTA_Program * program, GTA_Language * language, const char * code, GTA_Program_Flags flags);
 
+/**
+ * Create a new program from a bytecode image.
+ *
+ * The program is not parsed, analyzed, or compiled.  It will only have
+ * bytecode (no AST and no binary), so it is always executed by the virtual
+ * machine.  Environment variables are not consulted.
+ *
+ * @see gta_program_save()
+ * @see gta_bytecode_image_create()
+ *
+ * @param language The language with which the program should be executed.
+ * @param data The bytecode image.  It is not referenced after the program has
+ *   been created.
+ * @param length The length of the image in bytes.
+ * @param flags The flags to create the program with.  The
+ *   GTA_PROGRAM_FLAG_IS_TEMPLATE flag is taken from the image.
+ * @return The new program or null if the image is not valid or if the program
+ *   could not be created.
+ */
+GTA_NO_DISCARD GTA_Program * gta_program_create_from_image(GTA_Language * language, const void * data, size_t length, GTA_Program_Flags flags);
+
+/**
+ * Create a new program from a bytecode image in the memory location provided.
+ *
+ * For more details, see gta_program_create_from_image().
+ *
+ * A program created in place must only be destroyed with
+ * gta_program_destroy_in_place().
+ *
+ * @see gta_program_destroy_in_place()
+ *
+ * @param program The memory location to create the program in.
+ * @param language The language with which the program should be executed.
+ * @param data The bytecode image.
+ * @param length The length of the image in bytes.
+ * @param flags The flags to create the program with.
+ * @return True if the program was created successfully, false otherwise.
+ */
+bool gta_program_create_in_place_from_image(GTA_Program * program, GTA_Language * language, const void * data, size_t length, GTA_Program_Flags flags);
+
+/**
+ * Create a new program from a bytecode image inside of a mapped bundle file.
+ *
+ * Unlike gta_program_create_from_image(), the bytecode and the string
+ * literals are used in place rather than copied, whenever the platform
+ * allows it.  The program holds a reference to the bundle until it is
+ * destroyed.
+ *
+ * @see gta_bundle_load_program()
+ *
+ * @param language The language with which the program should be executed.
+ * @param bundle The bundle which holds the image.
+ * @param data The bytecode image, which is part of the bundle.
+ * @param length The length of the image in bytes.
+ * @param flags The flags to create the program with.
+ * @return The new program or null if the image is not valid or if the program
+ *   could not be created.
+ */
+GTA_NO_DISCARD GTA_Program * gta_program_create_from_bundle_image(GTA_Language * language, GTA_Bundle * bundle, const void * data, size_t length, GTA_Program_Flags flags);
+
+/**
+ * Create a new program from a bytecode image inside of a mapped bundle file,
+ * in the memory location provided.
+ *
+ * For more details, see gta_program_create_from_bundle_image().
+ *
+ * A program created in place must only be destroyed with
+ * gta_program_destroy_in_place().
+ *
+ * @see gta_program_destroy_in_place()
+ *
+ * @param program The memory location to create the program in.
+ * @param language The language with which the program should be executed.
+ * @param bundle The bundle which holds the image.
+ * @param data The bytecode image, which is part of the bundle.
+ * @param length The length of the image in bytes.
+ * @param flags The flags to create the program with.
+ * @return True if the program was created successfully, false otherwise.
+ */
+bool gta_program_create_in_place_from_bundle_image(GTA_Program * program, GTA_Language * language, GTA_Bundle * bundle, const void * data, size_t length, GTA_Program_Flags flags);
+
+/**
+ * Load a program from a bytecode image file.
+ *
+ * @see gta_program_create_from_image()
+ *
+ * @param language The language with which the program should be executed.
+ * @param path The path of the file, which was written by gta_program_save().
+ * @param flags The flags to create the program with.
+ * @return The new program or null if the file could not be read or is not a
+ *   valid image.
+ */
+GTA_NO_DISCARD GTA_Program * gta_program_load(GTA_Language * language, const char * path, GTA_Program_Flags flags);
+
+/**
+ * Save the bytecode of a program to a file, so that it can be loaded later
+ * with gta_program_load().
+ *
+ * Only programs which have bytecode can be saved, so the program should be
+ * created with the GTA_PROGRAM_FLAG_DISABLE_BINARY flag.
+ *
+ * @see gta_bytecode_image_create()
+ *
+ * @param program The program to save.
+ * @param path The path of the file to write.
+ * @return True on success, false if the program has no bytecode or the file
+ *   could not be written.
+ */
+bool gta_program_save(GTA_Program * program, const char * path);
+
 /**
  * Destroy the given program.
  *
@@ -255,11 +467,28 @@ void gta_program_destroy_in_place(GTA_Program * program);
  * Otherwise, if the program was compiled to bytecode then the bytecode will be
  * executed.  If the program has neither, then the function will return false.
  *
+ * A tiered program which has become hot is compiled to binary before it is
+ * executed.
+ *
  * @param context The initialized context with which to execute the program.
  * @return True if the program executed successfully, false otherwise.
  */
 bool gta_program_execute(GTA_Execution_Context * context);
 
+/**
+ * Mark a tiered program as hot, so that it will be compiled to binary the next
+ * time that it is executed.
+ *
+ * This is called by the bytecode interpreter when a function of the program
+ * has been called often enough.  It has no effect if the program is not
+ * warming up.
+ *
+ * @see GTA_PROGRAM_FLAG_TIERED
+ *
+ * @param program The program.
+ */
+void gta_program_mark_hot(GTA_Program * program);
+
 /**
  * Execute the given program with the given context using the bytecode.
  *
@@ -347,6 +576,9 @@ GTA_Computed_Value_Attribute_Callback gta_program_get_type_attribute(GTA_Program
 /**
  * Set an attribute function for a given type and identifier.
  *
+ * The inline caches of the program are cleared, so this must not be called
+ * while the program is being executed.
+ *
  * @param program The program to set the attribute function for.
  * @param type_vtable The vtable of the type.
  * @param identifier_hash The hash of the attribute name.
@@ -0,0 +1,126 @@
+/**
+ * @file
+ *
+ * Header file for the register cache of the x86_64 JIT.
+ *
+ * This is not a register allocator: temporaries stay on the machine stack,
+ * and every variable keeps its slot in memory, addressed from the frame
+ * pointer (r12).  The cache only chooses the (at most two) variables of a
+ * frame which are used most often, with uses inside of loops counting for
+ * more, and keeps a copy of each of them in one of the callee-saved registers
+ * which the JIT does not otherwise use.  Reads of those variables are then
+ * served from the register.
+ *
+ * The cache is write-through: writes go to both the register and the slot,
+ * so the slot always holds the current value.  As a result, nothing needs to
+ * be spilled before a call into the runtime: the garbage collector finds the
+ * values in the slots when it scans the stack, and the runtime functions
+ * preserve the registers.  JIT functions, however, use the same registers
+ * for their own variables, and they may also assign to the globals (which
+ * are the variables of the program's frame), so the registers are reloaded
+ * from the slots after every function call.
+ *
+ * A variable's slot is live from the start of the frame (where it is
+ * initialized) to the end of the frame (any loop may read it again), so the
+ * variables of a frame compete for the registers by weight alone.
+ */
+
+#ifndef G_TANG_REGISTERCACHE_H
+#define G_TANG_REGISTERCACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <cutil/vector.h>
+#include <tang/macros.h>
+#include <tang/program/binary.h>
+
+/**
+ * The number of registers which may cache variables.
+ */
+#define GTA_REGISTER_CACHE_SIZE 2
+
+/**
+ * The weight which is added to a use of a variable for each loop that
+ * encloses it.  A use outside of any loop has a weight of 1.
+ *
+ * Variables whose total weight is not greater than this are never cached,
+ * because the cost of loading the registers would outweigh the savings.
+ */
+#define GTA_REGISTER_CACHE_LOOP_WEIGHT 8
+
+/**
+ * The variables of a stack frame which are cached in registers.
+ */
+typedef struct GTA_Register_Cache {
+  /**
+   * The scope of the frame.
+   */
+  GTA_Variable_Scope * scope;
+  /**
+   * Whether or not the frame is the program's frame, in which global
+   * variables share the slots of the local variables.
+   */
+  bool includes_globals;
+  /**
+   * The number of variables which are held in registers.
+   */
+  size_t count;
+  /**
+   * The offset of each variable's slot from the frame pointer (r12).
+   */
+  int32_t offsets[GTA_REGISTER_CACHE_SIZE];
+  /**
+   * The register which holds each variable.
+   */
+  GTA_Register registers[GTA_REGISTER_CACHE_SIZE];
+} GTA_Register_Cache;
+
+/**
+ * Choose the variables of a stack frame to be cached in registers.
+ *
+ * @param self The cache to fill.
+ * @param program The program being compiled.
+ * @param scope The scope of the frame (the program's scope or a function's
+ *   scope).
+ * @param body The code of the frame.
+ * @return True on success, false if memory could not be allocated.
+ */
+bool gta_register_cache_choose(GTA_Register_Cache * self, GTA_Program * program, GTA_Variable_Scope * scope, GTA_Ast_Node * body);
+
+/**
+ * Clear a cache, so that no variables are held in registers.
+ *
+ * @param self The cache to clear.
+ */
+void gta_register_cache_clear(GTA_Register_Cache * self);
+
+/**
+ * Get the register which holds a variable.
+ *
+ * @param self The cache.
+ * @param is_global Whether the slot is addressed from the globals pointer
+ *   (r13) rather than the frame pointer (r12).
+ * @param offset The offset of the variable's slot.
+ * @return The register, or GTA_REG_NONE if the variable is not held in a
+ *   register.
+ */
+GTA_Register gta_register_cache_find(const GTA_Register_Cache * self, bool is_global, int32_t offset);
+
+/**
+ * Load the registers of a cache from the slots of their variables.
+ *
+ * @param self The cache.
+ * @param vector The vector in which to store the instructions.
+ * @return True on success, false on failure.
+ */
+bool gta_register_cache_load__x86_64(const GTA_Register_Cache * self, GCU_Vector8 * vector);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // G_TANG_REGISTERCACHE_H
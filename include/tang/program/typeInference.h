@@ -0,0 +1,56 @@
+/**
+ * @file
+ *
+ * Header file for the inference of the types of variables.
+ *
+ * The analysis of the AST (see gta_ast_node_analyze()) only knows the types of
+ * literals and of the operations on them, because a variable may hold any
+ * type.  The inference refines this for the variables of a stack frame which
+ * are proven to only ever hold integers, such as loop counters, so that the
+ * compiler may emit the integer-specialized bytecode for them.
+ *
+ * A variable of a frame is proven to be an integer when:
+ * - Its first use in the frame is an assignment (either a statement of the
+ *   body of the frame, or the initialization of a `for` loop which contains
+ *   every use of the variable), so that it is never read before it is
+ *   assigned.
+ * - Every assignment to it is of an integer expression: an integer, a variable
+ *   which is also proven to be an integer, or the sum, difference, product,
+ *   or negation of such expressions.
+ * - It is not assigned in any other way: it is not the variable of a ranged
+ *   `for` loop, a library, or (in the program's frame) declared as a global
+ *   by any function.
+ *
+ * The uses of such a variable are given the possible type
+ * GTA_AST_POSSIBLE_TYPE_INTEGER, and the possible types of the binary
+ * operations which use them are inferred again.  A proven integer may still be
+ * boxed (see GTA_VM_IMMEDIATE_INTEGER_FITS()), so the integer-specialized
+ * bytecode must still check for immediates.
+ */
+
+#ifndef G_TANG_TYPEINFERENCE_H
+#define G_TANG_TYPEINFERENCE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stdbool.h>
+#include <tang/macros.h>
+
+/**
+ * Infer the variables of each stack frame of a program which only ever hold
+ * integers.
+ *
+ * The AST of the program must already have been analyzed.
+ *
+ * @param program The program.
+ * @return True on success, false if memory could not be allocated.
+ */
+bool gta_type_inference_infer_integers(GTA_Program * program);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // G_TANG_TYPEINFERENCE_H
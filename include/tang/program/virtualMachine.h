@@ -16,6 +16,82 @@ extern "C" {
 #include <tang/computedValue/computedValue.h>
 #include <tang/program/program.h>
 
+/**
+ * Macros for working with immediate (unboxed) integers on the VM stack.
+ *
+ * The bytecode interpreter stores most values on its stack as pointers to
+ * GTA_Computed_Value objects.  Computed values are always allocated with at
+ * least pointer alignment, so the lowest bit of such a pointer is always 0.
+ * The interpreter takes advantage of this by storing integers that fit into
+ * the remaining bits directly in the stack slot, with the lowest bit set to 1.
+ * This avoids a heap allocation (and a garbage collection entry) for every
+ * integer literal and for most integer arithmetic.
+ *
+ * An immediate integer must be boxed into a GTA_Computed_Value_Integer
+ * whenever it escapes the interpreter (e.g., it is stored in an array or map,
+ * is passed to a native function, or becomes the result of the program).
+ *
+ * Booleans and null are already represented by singletons, so they do not
+ * need a tagged representation.  Floats are unboxed as well (see below).
+ *
+ * @{
+ */
+#define GTA_VM_IS_IMMEDIATE_INTEGER(X) ((bool)(GTA_TYPEX_UI(X) & 1))
+#define GTA_VM_IMMEDIATE_INTEGER_FITS(X) ((X) == (((GTA_Integer)((GTA_UInteger)(X) << 1)) >> 1))
+#define GTA_VM_MAKE_IMMEDIATE_INTEGER(X) GTA_TYPEX_MAKE_UI(((GTA_UInteger)(X) << 1) | 1)
+#define GTA_VM_IMMEDIATE_INTEGER_VALUE(X) (GTA_TYPEX_I(X) >> 1)
+/**
+ * @}
+ */
+
+/**
+ * Macros for working with immediate (unboxed) floats on the VM stack.
+ *
+ * An immediate float has its lowest two bits set to `10`, so it can be told
+ * apart from both a pointer (`00`) and an immediate integer (`x1`).  To make
+ * room for the tag, the bits of the float are rotated left by one (so that
+ * the sign becomes the lowest bit), and then GTA_VM_FLOAT_OFFSET is
+ * subtracted, which rebases the exponent so that its top two bits are zero
+ * and can be shifted out.  Zero (of either sign) is stored as-is.
+ *
+ * This is exact for every float whose magnitude is zero or between 2^-255 and
+ * 2^256 (2^-31 and 2^32 on 32-bit platforms), which covers the floats that
+ * templates normally compute with.  Any other float (infinity, NaN, or a very
+ * large or small magnitude) is boxed into a GTA_Computed_Value_Float, in the
+ * same way as an integer that does not fit into an immediate.
+ *
+ * @{
+ */
+#if GTA_32_BIT
+#define GTA_VM_FLOAT_EXPONENT_SHIFT 24
+#define GTA_VM_FLOAT_EXPONENT_OFFSET 95
+#else
+#define GTA_VM_FLOAT_EXPONENT_SHIFT 53
+#define GTA_VM_FLOAT_EXPONENT_OFFSET 767
+#endif
+#define GTA_VM_FLOAT_OFFSET ((GTA_UInteger)GTA_VM_FLOAT_EXPONENT_OFFSET << GTA_VM_FLOAT_EXPONENT_SHIFT)
+#define GTA_VM_FLOAT_ROTATE_LEFT(U) (((U) << 1) | ((U) >> (sizeof(GTA_UInteger) * 8 - 1)))
+#define GTA_VM_FLOAT_ROTATE_RIGHT(U) (((U) >> 1) | ((U) << (sizeof(GTA_UInteger) * 8 - 1)))
+#define GTA_VM_FLOAT_ROTATED(X) GTA_VM_FLOAT_ROTATE_LEFT(GTA_TYPEX_UI(GTA_TYPEX_MAKE_F(X)))
+#define GTA_VM_IS_IMMEDIATE(X) ((bool)(GTA_TYPEX_UI(X) & 3))
+#define GTA_VM_IS_IMMEDIATE_FLOAT(X) ((GTA_TYPEX_UI(X) & 3) == 2)
+#define GTA_VM_IMMEDIATE_FLOAT_FITS_ROTATED(R) (((R) <= 1) || ((R) - GTA_VM_FLOAT_OFFSET - ((GTA_UInteger)1 << GTA_VM_FLOAT_EXPONENT_SHIFT) < ((GTA_UInteger)1 << (sizeof(GTA_UInteger) * 8 - 2)) - ((GTA_UInteger)1 << GTA_VM_FLOAT_EXPONENT_SHIFT)))
+#define GTA_VM_IMMEDIATE_FLOAT_FITS(X) GTA_VM_IMMEDIATE_FLOAT_FITS_ROTATED(GTA_VM_FLOAT_ROTATED(X))
+#define GTA_VM_MAKE_IMMEDIATE_FLOAT_ROTATED(R) GTA_TYPEX_MAKE_UI(((((R) <= 1) ? (R) : (R) - GTA_VM_FLOAT_OFFSET) << 2) | 2)
+#define GTA_VM_MAKE_IMMEDIATE_FLOAT(X) GTA_VM_MAKE_IMMEDIATE_FLOAT_ROTATED(GTA_VM_FLOAT_ROTATED(X))
+#define GTA_VM_IMMEDIATE_FLOAT_VALUE(X) GTA_TYPEX_F(GTA_TYPEX_MAKE_UI(GTA_VM_FLOAT_ROTATE_RIGHT(((GTA_TYPEX_UI(X) >> 2) <= 1) ? (GTA_TYPEX_UI(X) >> 2) : (GTA_TYPEX_UI(X) >> 2) + GTA_VM_FLOAT_OFFSET)))
+/**
+ * @}
+ */
+
+/**
+ * Execute the bytecode of the program associated with the context.
+ *
+ * The result of the execution is stored in `context->result`.
+ *
+ * @param context The execution context.
+ * @return True on success, false on failure.
+ */
 bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context);
 
 #ifdef __cplusplus
@@ -24,6 +24,7 @@
 #ifndef G_TANG_UNICODESTRING_H
 #define G_TANG_UNICODESTRING_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <cutil/vector.h>
 #include <tang/libver.h>
@@ -72,15 +73,27 @@ extern "C" {
  * encoded correctly, even if it has been concatenated with other strings.  The
  * concatenation and substring functions will ensure that the type of the
  * string is maintained correctly as the string is manipulated.
+ *
+ * Most strings are only ever concatenated and rendered, neither of which
+ * needs to know where the graphemes are.  The grapheme index is therefore
+ * built lazily, the first time that it is needed, by
+ * gta_unicode_string_index_graphemes().  Until then, `grapheme_offsets` is
+ * NULL and `grapheme_length` is 0.  Building the index modifies the string,
+ * even through a const pointer, but it may be done from multiple threads at
+ * once: `grapheme_offsets` is published atomically, after `grapheme_length`.
  */
 struct GTA_Unicode_String {
   const char * buffer;             ///< The string buffer.
   size_t grapheme_length;          ///< Length of the string in graphemes.
+                                   ///<   Only valid once the grapheme index
+                                   ///<   has been built.
   size_t byte_length;              ///< Length of the string in bytes.  Does
                                    ///<   not include the null terminator.
-  GCU_Vector32 * grapheme_offsets; ///< Mapping of grapheme to the index where
+  GTA_ATOMIC(GCU_Vector32 *) grapheme_offsets;
+                                   ///< Mapping of grapheme to the index where
                                    ///<   the grapheme starts.  Will contain
-                                   ///<   grapheme_length + 1 entries.
+                                   ///<   grapheme_length + 1 entries.  NULL
+                                   ///<   until the grapheme index is built.
   GCU_Vector64 * string_type;      ///< Tracks the type of string in parts, so
                                    ///<   that the string can be encoded
                                    ///<   correctly, even if it has been
@@ -88,7 +101,10 @@ struct GTA_Unicode_String {
                                    ///<   The type is the upper 32 bits of the
                                    ///<   64-bit integer, and the offset is the
                                    ///<   lower 32 bits.  The offset is the
-                                   ///<   grapheme offset.
+                                   ///<   byte offset.
+  bool is_borrowed;                ///< Whether or not the buffer is owned by
+                                   ///<   someone else, in which case it is
+                                   ///<   not freed with the string.
 };
 
 /**
@@ -150,12 +166,70 @@ GTA_NO_DISCARD GTA_Unicode_String * gta_unicode_string_create(const char * sourc
  */
 GTA_NO_DISCARD GTA_Unicode_String * gta_unicode_string_create_and_adopt(const char * source, size_t length, GTA_String_Type type);
 
+/**
+ * Construct a new Unicode String object which uses the source string buffer
+ * without copying or adopting it.
+ *
+ * @param source The source string.  It must be null terminated, and must
+ *   remain valid and unchanged until the string is destroyed.
+ * @param length The length of the source string in bytes (not including the
+ *   null terminator).
+ * @param type The type of string being created.
+ * @return A pointer to the Unicode String object, or NULL if there was an error.
+ */
+GTA_NO_DISCARD GTA_Unicode_String * gta_unicode_string_create_borrowed(const char * source, size_t length, GTA_String_Type type);
+
 /**
  * Destroy a Unicode String object.
  * @param string The string to destroy.
  */
 void gta_unicode_string_destroy(GTA_Unicode_String * string);
 
+/**
+ * Build the grapheme index of a Unicode String, if it has not already been
+ * built.
+ *
+ * `grapheme_length` and `grapheme_offsets` are only valid after this function
+ * has returned true.
+ *
+ * @param string The string to index.
+ * @return True on success, false if the index could not be built (e.g., if
+ *   memory could not be allocated, or the string is not valid UTF-8).
+ */
+GTA_NO_DISCARD bool gta_unicode_string_index_graphemes(const GTA_Unicode_String * string);
+
+/**
+ * Get the length of a Unicode String in graphemes, building the grapheme index
+ * if needed.
+ *
+ * @param string The string.
+ * @return The number of graphemes in the string, or SIZE_MAX if the grapheme
+ *   index could not be built.
+ */
+GTA_NO_DISCARD size_t gta_unicode_string_get_grapheme_length(const GTA_Unicode_String * string);
+
+/**
+ * Determine whether or not the buffer of a Unicode String is valid UTF-8.
+ *
+ * This does not allocate, so it can be used to find out why
+ * gta_unicode_string_index_graphemes() failed.
+ *
+ * @param string The string.
+ * @return True if the string is valid UTF-8, false otherwise.
+ */
+GTA_NO_DISCARD bool gta_unicode_string_is_valid_utf8(const GTA_Unicode_String * string);
+
+/**
+ * Copy a Unicode String, including the types of its parts.
+ *
+ * The grapheme index is not copied, so the copy will build its own index if
+ * and when it is needed.
+ *
+ * @param string The string to copy.
+ * @return A pointer to the new string, or NULL if there was an error.
+ */
+GTA_NO_DISCARD GTA_Unicode_String * gta_unicode_string_copy(const GTA_Unicode_String * string);
+
 /**
  * Concatenate two Unicode Strings.
  *
@@ -167,9 +241,26 @@ void gta_unicode_string_destroy(GTA_Unicode_String * string);
  */
 GTA_NO_DISCARD GTA_Unicode_String * gta_unicode_string_concat(const GTA_Unicode_String * string1, const GTA_Unicode_String * string2);
 
+/**
+ * Concatenate a list of Unicode Strings.
+ *
+ * This is equivalent to repeatedly calling gta_unicode_string_concat(), but
+ * each input string is only copied once.
+ *
+ * The caller is responsible for handling the memory of the input strings.
+ *
+ * @param strings The strings to concatenate, in order.
+ * @param count The number of strings.
+ * @return A pointer to the new string, or NULL if there was an error.
+ */
+GTA_NO_DISCARD GTA_Unicode_String * gta_unicode_string_join(const GTA_Unicode_String * const * strings, size_t count);
+
 /**
  * Get the substring of a Unicode String.
  *
+ * The grapheme index of the input string will be built if it does not
+ * already exist.
+ *
  * The caller is responsible for handling the memory of the input string.
  *
  * @param string The string.
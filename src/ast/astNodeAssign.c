@@ -112,6 +112,11 @@ GTA_Ast_Node * gta_ast_node_assign_simplify(GTA_Ast_Node * self, GTA_Ast_Simplif
   // If the LHS is an identifier, then we need to add it to the variable map.
   if (GTA_AST_IS_IDENTIFIER(assign->lhs)) {
     GTA_Ast_Node_Identifier * identifier = (GTA_Ast_Node_Identifier *) assign->lhs;
+    if (identifier->is_shared) {
+      // The value may be changed by a function call, so it is not tracked.
+      gcu_hash64_remove(variable_map, gcu_string_hash_64(identifier->identifier, strlen(identifier->identifier)));
+      return 0;
+    }
     // Walk down the right hand side until we find a non-assign node.
     GTA_Ast_Node * rhs = assign->rhs;
     while (GTA_AST_IS_ASSIGN(rhs)) {
@@ -246,11 +251,19 @@ static bool __compile_binary_lhs_is_identifier__x86_64(GTA_Ast_Node * lhs, GTA_C
   // variable stacks.  We will need to move the pointer back to the beginning
   // of the memory address for whichever variable we're trying to access.
   int32_t index = ((int32_t)GTA_TYPEX_UI(val.value) + 1) * -8;
+  GTA_Register reg = (look_in_global || (identifier->scope == context->register_cache.scope))
+    ? gta_register_cache_find(&context->register_cache, look_in_global, index)
+    : GTA_REG_NONE;
 
   return true
   // Adopt the value.
     && gta_binary_adopt__x86_64(context, GTA_REG_RAX, GTA_REG_RDX, GTA_REG_R8, GTA_REG_R9)
 
+  // If the variable is held in a register, then update the register as well.
+  // The slot remains the authoritative copy.
+  //   mov reg, rax
+    && ((reg == GTA_REG_NONE) || gta_mov_reg_reg__x86_64(v, reg, GTA_REG_RAX))
+
   // Store the value in the appropriate location.
   // RAX contains the final value of the RHS.
   // Copy the value from the indexed position (GTA_TYPEX_UI(val.value)) to RAX.
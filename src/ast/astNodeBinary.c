@@ -6,8 +6,13 @@
 #include <tang/ast/astNodeBinary.h>
 #include <tang/ast/astNodeInteger.h>
 #include <tang/ast/astNodeFloat.h>
+#include <tang/ast/astNodeIdentifier.h>
 #include <tang/ast/astNodeBoolean.h>
 #include <tang/ast/astNodeString.h>
+#include <tang/computedValue/computedValueBoolean.h>
+#include <tang/computedValue/computedValueError.h>
+#include <tang/computedValue/computedValueFloat.h>
+#include <tang/computedValue/computedValueInteger.h>
 #include <tang/program/binary.h>
 #include <tang/unicodeString.h>
 
@@ -55,8 +60,13 @@ void gta_ast_node_binary_destroy(GTA_Ast_Node * self) {
   assert(GTA_AST_IS_BINARY(self));
   GTA_Ast_Node_Binary * binary = (GTA_Ast_Node_Binary *) self;
 
-  gta_ast_node_destroy(binary->lhs);
-  gta_ast_node_destroy(binary->rhs);
+  // The operands may have been moved out of the node during simplification.
+  if (binary->lhs) {
+    gta_ast_node_destroy(binary->lhs);
+  }
+  if (binary->rhs) {
+    gta_ast_node_destroy(binary->rhs);
+  }
 
   gcu_free(self);
 }
@@ -134,11 +144,97 @@ void gta_ast_node_binary_print(GTA_Ast_Node * self, const char * indent) {
 }
 
 
+/**
+ * Determine the truthiness of a primitive node, as it would be determined at
+ * runtime.
+ *
+ * @param node The node.
+ * @param is_true Set to the truthiness of the node.
+ * @return True if the node is a primitive, false otherwise.
+ */
+static bool primitive_is_true(GTA_Ast_Node * node, bool * is_true) {
+  if (GTA_AST_IS_BOOLEAN(node)) {
+    *is_true = ((GTA_Ast_Node_Boolean *) node)->value;
+  }
+  else if (GTA_AST_IS_INTEGER(node)) {
+    *is_true = ((GTA_Ast_Node_Integer *) node)->value;
+  }
+  else if (GTA_AST_IS_FLOAT(node)) {
+    *is_true = ((GTA_Ast_Node_Float *) node)->value;
+  }
+  else if (GTA_AST_IS_STRING(node)) {
+    *is_true = ((GTA_Ast_Node_String *) node)->string->byte_length > 0;
+  }
+  else {
+    return false;
+  }
+  return true;
+}
+
+
+/**
+ * Simplify a short-circuiting AND or OR operation.
+ *
+ * The RHS is not always evaluated, so any assignments in it are treated like
+ * those in the branches of an "if" statement.  The result of the operation is
+ * one of the operands (not necessarily a boolean), so once the truthiness of
+ * the LHS is known, the operation is replaced by whichever operand would be
+ * the result.
+ *
+ * @param binary The AND or OR node.
+ * @param variable_map The variable map.
+ * @return The simplified node, or NULL if the node was not simplified.
+ */
+static GTA_Ast_Node * simplify_short_circuit(GTA_Ast_Node_Binary * binary, GTA_Ast_Simplify_Variable_Map * variable_map) {
+  GTA_Ast_Node * simplified_lhs = gta_ast_node_simplify(binary->lhs, variable_map);
+  if (simplified_lhs) {
+    gta_ast_node_destroy(binary->lhs);
+    binary->lhs = simplified_lhs;
+  }
+
+  GTA_Ast_Simplify_Variable_Map * rhs_variable_map = gcu_hash64_clone(variable_map);
+  if (!rhs_variable_map) {
+    // The RHS cannot be checked for assignments, so nothing that follows may
+    // rely on the variable map.
+    gta_ast_simplify_variable_map_invalidate(variable_map);
+    return 0;
+  }
+  GTA_Ast_Node * simplified_rhs = gta_ast_node_simplify(binary->rhs, rhs_variable_map);
+  if (simplified_rhs) {
+    gta_ast_node_destroy(binary->rhs);
+    binary->rhs = simplified_rhs;
+  }
+  gta_ast_simplify_variable_map_synchronize(variable_map, rhs_variable_map);
+  gcu_hash64_destroy(rhs_variable_map);
+
+  bool lhs_is_true;
+  if (!primitive_is_true(binary->lhs, &lhs_is_true)) {
+    return 0;
+  }
+  // AND: A false LHS is the result, otherwise the RHS is the result.
+  // OR: A true LHS is the result, otherwise the RHS is the result.
+  GTA_Ast_Node * result;
+  if (lhs_is_true == (binary->operator_type == GTA_BINARY_TYPE_OR)) {
+    result = binary->lhs;
+    binary->lhs = 0;
+  }
+  else {
+    result = binary->rhs;
+    binary->rhs = 0;
+  }
+  return result;
+}
+
+
 GTA_Ast_Node * gta_ast_node_binary_simplify(GTA_Ast_Node * self, GTA_Ast_Simplify_Variable_Map * variable_map) {
   assert(self);
   assert(GTA_AST_IS_BINARY(self));
   GTA_Ast_Node_Binary * binary = (GTA_Ast_Node_Binary *) self;
 
+  if ((binary->operator_type == GTA_BINARY_TYPE_AND) || (binary->operator_type == GTA_BINARY_TYPE_OR)) {
+    return simplify_short_circuit(binary, variable_map);
+  }
+
   GTA_Ast_Node * simplified_lhs = gta_ast_node_simplify(binary->lhs, variable_map);
   if (simplified_lhs) {
     gta_ast_node_destroy(binary->lhs);
@@ -151,6 +247,10 @@ GTA_Ast_Node * gta_ast_node_binary_simplify(GTA_Ast_Node * self, GTA_Ast_Simplif
     binary->rhs = simplified_rhs;
   }
 
+  // Only the operations which the runtime implements for these types are
+  // folded, so that the result is the same as if it had been computed at
+  // runtime.
+
   if (GTA_AST_IS_INTEGER(binary->lhs) && GTA_AST_IS_INTEGER(binary->rhs)) {
     GTA_Ast_Node_Integer * lhs = (GTA_Ast_Node_Integer *) binary->lhs;
     GTA_Ast_Node_Integer * rhs = (GTA_Ast_Node_Integer *) binary->rhs;
@@ -185,10 +285,8 @@ GTA_Ast_Node * gta_ast_node_binary_simplify(GTA_Ast_Node * self, GTA_Ast_Simplif
         return (GTA_Ast_Node *)gta_ast_node_boolean_create(lhs->value == rhs->value, self->location);
       case GTA_BINARY_TYPE_NOT_EQUAL:
         return (GTA_Ast_Node *)gta_ast_node_boolean_create(lhs->value != rhs->value, self->location);
-      case GTA_BINARY_TYPE_AND:
-        return (GTA_Ast_Node *)gta_ast_node_boolean_create(lhs->value && rhs->value, self->location);
-      case GTA_BINARY_TYPE_OR:
-        return (GTA_Ast_Node *)gta_ast_node_boolean_create(lhs->value || rhs->value, self->location);
+      default:
+        break;
     }
   }
   else if (GTA_AST_IS_NUMERIC(binary->lhs) && GTA_AST_IS_NUMERIC(binary->rhs)) {
@@ -227,51 +325,6 @@ GTA_Ast_Node * gta_ast_node_binary_simplify(GTA_Ast_Node * self, GTA_Ast_Simplif
         return (GTA_Ast_Node *)gta_ast_node_boolean_create(lhs == rhs, self->location);
       case GTA_BINARY_TYPE_NOT_EQUAL:
         return (GTA_Ast_Node *)gta_ast_node_boolean_create(lhs != rhs, self->location);
-      case GTA_BINARY_TYPE_AND:
-        return (GTA_Ast_Node *)gta_ast_node_boolean_create(lhs && rhs, self->location);
-      case GTA_BINARY_TYPE_OR:
-        return (GTA_Ast_Node *)gta_ast_node_boolean_create(lhs || rhs, self->location);
-    }
-  }
-  else if (GTA_AST_IS_STRING(binary->lhs) && GTA_AST_IS_STRING(binary->rhs)) {
-    GTA_Ast_Node_String * lhs = (GTA_Ast_Node_String *) binary->lhs;
-    GTA_Ast_Node_String * rhs = (GTA_Ast_Node_String *) binary->rhs;
-    switch (binary->operator_type) {
-      case GTA_BINARY_TYPE_ADD: {
-        GTA_Unicode_String * new_string = gta_unicode_string_concat(lhs->string, rhs->string);
-        if (!new_string) {
-          return 0;
-        }
-        return (GTA_Ast_Node *)gta_ast_node_string_create(new_string, self->location);
-      }
-      case GTA_BINARY_TYPE_EQUAL:
-        return (GTA_Ast_Node *)gta_ast_node_boolean_create(!strcmp(lhs->string->buffer, rhs->string->buffer), self->location);
-      case GTA_BINARY_TYPE_NOT_EQUAL:
-        return (GTA_Ast_Node *)gta_ast_node_boolean_create(strcmp(lhs->string->buffer, rhs->string->buffer), self->location);
-      default:
-        break;
-    }
-  }
-  else if (GTA_AST_IS_PRIMITIVE(binary->lhs) && GTA_AST_IS_PRIMITIVE(binary->rhs)) {
-    bool lhs = GTA_AST_IS_BOOLEAN(binary->lhs)
-      ? ((GTA_Ast_Node_Boolean *) binary->lhs)->value
-      : (GTA_AST_IS_INTEGER(binary->lhs)
-        ? ((GTA_Ast_Node_Integer *) binary->lhs)->value
-        : (GTA_AST_IS_FLOAT(binary->lhs)
-          ? ((GTA_Ast_Node_Float *) binary->lhs)->value
-          : ((GTA_Ast_Node_String *) binary->lhs)->string->grapheme_length));
-    bool rhs = GTA_AST_IS_BOOLEAN(binary->rhs)
-      ? ((GTA_Ast_Node_Boolean *) binary->rhs)->value
-      : (GTA_AST_IS_INTEGER(binary->rhs)
-        ? ((GTA_Ast_Node_Integer *) binary->rhs)->value
-        : (GTA_AST_IS_FLOAT(binary->rhs)
-          ? ((GTA_Ast_Node_Float *) binary->rhs)->value
-          : ((GTA_Ast_Node_String *) binary->rhs)->string->grapheme_length));
-    switch (binary->operator_type) {
-      case GTA_BINARY_TYPE_AND:
-        return (GTA_Ast_Node *)gta_ast_node_boolean_create(lhs && rhs, self->location);
-      case GTA_BINARY_TYPE_OR:
-        return (GTA_Ast_Node *)gta_ast_node_boolean_create(lhs || rhs, self->location);
       default:
         break;
     }
@@ -292,13 +345,62 @@ void gta_ast_node_binary_walk(GTA_Ast_Node * self, GTA_Ast_Node_Walk_Callback ca
 }
 
 
+GTA_Ast_Possible_Type gta_ast_node_binary_infer_possible_type(GTA_Ast_Node_Binary * self) {
+  assert(self);
+  GTA_Ast_Possible_Type lhs = self->lhs->possible_type;
+  GTA_Ast_Possible_Type rhs = self->rhs->possible_type;
+  if (!lhs || !rhs) {
+    return GTA_AST_POSSIBLE_TYPE_UNKNOWN;
+  }
+
+  bool integers = (lhs == GTA_AST_POSSIBLE_TYPE_INTEGER) && (rhs == GTA_AST_POSSIBLE_TYPE_INTEGER);
+  bool numbers = !(lhs & ~(GTA_AST_POSSIBLE_TYPE_INTEGER | GTA_AST_POSSIBLE_TYPE_FLOAT))
+    && !(rhs & ~(GTA_AST_POSSIBLE_TYPE_INTEGER | GTA_AST_POSSIBLE_TYPE_FLOAT));
+  switch (self->operator_type) {
+    case GTA_BINARY_TYPE_ADD:
+    case GTA_BINARY_TYPE_SUBTRACT:
+    case GTA_BINARY_TYPE_MULTIPLY:
+      return integers
+        ? GTA_AST_POSSIBLE_TYPE_INTEGER
+        : GTA_AST_POSSIBLE_TYPE_UNKNOWN;
+    case GTA_BINARY_TYPE_DIVIDE:
+    case GTA_BINARY_TYPE_MODULO:
+      // Division by zero produces an error.
+      return integers
+        ? GTA_AST_POSSIBLE_TYPE_INTEGER | GTA_AST_POSSIBLE_TYPE_ERROR
+        : GTA_AST_POSSIBLE_TYPE_UNKNOWN;
+    case GTA_BINARY_TYPE_LESS_THAN:
+    case GTA_BINARY_TYPE_LESS_THAN_EQUAL:
+    case GTA_BINARY_TYPE_GREATER_THAN:
+    case GTA_BINARY_TYPE_GREATER_THAN_EQUAL:
+    case GTA_BINARY_TYPE_EQUAL:
+    case GTA_BINARY_TYPE_NOT_EQUAL:
+      return numbers
+        ? GTA_AST_POSSIBLE_TYPE_BOOLEAN
+        : GTA_AST_POSSIBLE_TYPE_UNKNOWN;
+    case GTA_BINARY_TYPE_AND:
+    case GTA_BINARY_TYPE_OR:
+      // The result is one of the operands.
+      return lhs | rhs;
+    default:
+      return GTA_AST_POSSIBLE_TYPE_UNKNOWN;
+  }
+}
+
+
 GTA_Ast_Node * gta_ast_node_binary_analyze(GTA_Ast_Node * self, GTA_Program * program, GTA_Variable_Scope * scope) {
   assert(self);
   assert(GTA_AST_IS_BINARY(self));
   GTA_Ast_Node_Binary * binary = (GTA_Ast_Node_Binary *) self;
 
   GTA_Ast_Node * result = gta_ast_node_analyze(binary->lhs, program, scope);
-  return !result ? gta_ast_node_analyze(binary->rhs, program, scope) : result;
+  if (!result) {
+    result = gta_ast_node_analyze(binary->rhs, program, scope);
+  }
+  if (!result) {
+    self->possible_type = gta_ast_node_binary_infer_possible_type(binary);
+  }
+  return result;
 }
 
 
@@ -318,7 +420,9 @@ bool gta_ast_node_binary_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_C
       && ((lhs_was_false = gta_compiler_context_get_label(context)) >= 0)
       && gta_ast_node_compile_to_bytecode(binary_node->lhs, context)
       && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-      && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_JMPF))
+      && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_AST_POSSIBLE_TYPE_IS_BOOLEAN(binary_node->lhs->possible_type)
+        ? GTA_BYTECODE_JMPF_BOOLEAN
+        : GTA_BYTECODE_JMPF))
       && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(0))
       && gta_compiler_context_add_label_jump(context, lhs_was_false, context->program->bytecode->count - 1)
       && gta_ast_node_compile_to_bytecode(binary_node->rhs, context)
@@ -343,9 +447,15 @@ bool gta_ast_node_binary_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_C
     && gta_ast_node_compile_to_bytecode(binary_node->lhs, context)
     && gta_ast_node_compile_to_bytecode(binary_node->rhs, context)
     && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count);
+  // Both operands are proven to be integers (see
+  // gta_type_inference_infer_integers()).
+  bool integers = (binary_node->lhs->possible_type == GTA_AST_POSSIBLE_TYPE_INTEGER)
+    && (binary_node->rhs->possible_type == GTA_AST_POSSIBLE_TYPE_INTEGER);
   switch (binary_node->operator_type) {
     case GTA_BINARY_TYPE_ADD:
-      error_free = error_free && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_ADD));
+      error_free = error_free && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(integers
+        ? GTA_BYTECODE_ADD_INT_INT
+        : GTA_BYTECODE_ADD));
       break;
     case GTA_BINARY_TYPE_SUBTRACT:
       error_free = error_free && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_SUBTRACT));
@@ -360,7 +470,9 @@ bool gta_ast_node_binary_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_C
       error_free = error_free && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_MODULO));
       break;
     case GTA_BINARY_TYPE_LESS_THAN:
-      error_free = error_free && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_LESS_THAN));
+      error_free = error_free && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(integers
+        ? GTA_BYTECODE_LESS_THAN_INT_INT
+        : GTA_BYTECODE_LESS_THAN));
       break;
     case GTA_BINARY_TYPE_LESS_THAN_EQUAL:
       error_free = error_free && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_LESS_THAN_EQUAL));
@@ -384,6 +496,537 @@ bool gta_ast_node_binary_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_C
 }
 
 
+static bool compile_generic_binary_to_binary__x86_64(GTA_Ast_Node_Binary * self, bool is_fallback, GTA_Compiler_Context * context);
+
+
+/**
+ * Compile an operand of a generic binary operation.
+ *
+ * When the operation is the fallback for an unboxed expression (see
+ * compile_unboxed_binary_to_binary__x86_64()), any nested arithmetic is also
+ * compiled generically, rather than trying the unboxed code a second time.
+ *
+ * @param operand The operand.
+ * @param is_fallback Whether the operation is the fallback for an unboxed
+ *   expression.
+ * @param context The compiler context.
+ * @return True on success, false on failure.
+ */
+static bool compile_operand_to_binary__x86_64(GTA_Ast_Node * operand, bool is_fallback, GTA_Compiler_Context * context) {
+  if (is_fallback && GTA_AST_IS_BINARY(operand) && (((GTA_Ast_Node_Binary *) operand)->operator_type < GTA_BINARY_TYPE_AND)) {
+    return compile_generic_binary_to_binary__x86_64((GTA_Ast_Node_Binary *) operand, true, context);
+  }
+  return gta_ast_node_compile_to_binary__x86_64(operand, context);
+}
+
+
+/**
+ * Compile an arithmetic or comparison operation as a call to the generic
+ * gta_computed_value_* function, which works for values of any type.
+ *
+ * @param self The binary node.
+ * @param is_fallback Whether the operation is the fallback for an unboxed
+ *   expression.
+ * @param context The compiler context.
+ * @return True on success, false on failure.
+ */
+static bool compile_generic_binary_to_binary__x86_64(GTA_Ast_Node_Binary * self, bool is_fallback, GTA_Compiler_Context * context) {
+  GCU_Vector8 * v = context->binary_vector;
+
+  // Determine the function to call.
+  GTA_Integer func = 0;
+  switch(self->operator_type) {
+    case GTA_BINARY_TYPE_ADD:
+      func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_add);
+      break;
+    case GTA_BINARY_TYPE_SUBTRACT:
+      func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_subtract);
+      break;
+    case GTA_BINARY_TYPE_MULTIPLY:
+      func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_multiply);
+      break;
+    case GTA_BINARY_TYPE_DIVIDE:
+      func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_divide);
+      break;
+    case GTA_BINARY_TYPE_MODULO:
+      func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_modulo);
+      break;
+    case GTA_BINARY_TYPE_LESS_THAN:
+      func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_less_than);
+      break;
+    case GTA_BINARY_TYPE_LESS_THAN_EQUAL:
+      func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_less_than_equal);
+      break;
+    case GTA_BINARY_TYPE_GREATER_THAN:
+      func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_greater_than);
+      break;
+    case GTA_BINARY_TYPE_GREATER_THAN_EQUAL:
+      func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_greater_than_equal);
+      break;
+    case GTA_BINARY_TYPE_EQUAL:
+      func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_equal);
+      break;
+    case GTA_BINARY_TYPE_NOT_EQUAL:
+      func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_not_equal);
+      break;
+    default:
+      return false;
+  }
+
+  return true
+  // Compile the LHS expression.  The result will be in rax.
+    && compile_operand_to_binary__x86_64(self->lhs, is_fallback, context)
+  // "Push" the result of the LHS expression.
+  //   add rsp, -16
+  //   mov [rsp + GTA_SHADOW_SIZE__X86_64], rax
+    && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, -16)
+    && gta_mov_ind_reg__x86_64(v, GTA_REG_RSP, GTA_REG_NONE, 0, GTA_SHADOW_SIZE__X86_64, GTA_REG_RAX)
+  // Compile the RHS expression.  The result will be in rax.
+    && compile_operand_to_binary__x86_64(self->rhs, is_fallback, context)
+
+  // Prepare registers for: func(result_from_lhs, result_from_rhs, true, is_assignment, context)
+  // "Pop" the result of the LHS expression.
+  // NOTE: We will not change RSP, because if compiling for Windows, it will
+  // need it.  RSP will be cleaned up later in this function.
+  //   mov GTA_X86_64_R1, [rsp + GTA_SHADOW_SIZE__X86_64] ; result from lhs
+    && gta_mov_reg_ind__x86_64(v, GTA_X86_64_R1, GTA_REG_RSP, GTA_REG_NONE, 0, GTA_SHADOW_SIZE__X86_64)
+  //   mov GTA_X86_64_R2, rax  ; result_from_rhs
+  //   mov GTA_X86_64_R3, 1    ; true
+  //   mov GTA_X86_64_R4, is_assignment ; is_assignment
+    && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R2, GTA_REG_RAX)
+    && gta_mov_reg_imm__x86_64(v, GTA_X86_64_R3, 1)
+    && gta_mov_reg_imm__x86_64(v, GTA_X86_64_R4, 0)
+#if defined(_WIN32) || defined(_WIN64)
+  // The Windows x64 calling convention ABI requires that the fifth argument
+  // be put on the stack, just above the shadow space.
+  //   mov [rsp + GTA_SHADOW_SIZE__X86_64], r15 ; context (the fifth argument)
+    && gta_mov_ind_reg__x86_64(v, GTA_REG_RSP, GTA_REG_NONE, 0, GTA_SHADOW_SIZE__X86_64, GTA_REG_R15)
+  //   call func
+    && gta_binary_call__x86_64(v, (uint64_t)func)
+  // Restore the stack after the function call.
+  //   add rsp, 16
+    && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, 16)
+#else
+  // Restore the stack since the extra space is not needed.
+  //   add rsp, 16
+    && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, 16)
+  //   mov r8, r15   ; context (the fifth argument)
+    && gta_mov_reg_reg__x86_64(v, GTA_REG_R8, GTA_REG_R15)
+  //   mov rax, func ; func
+    && gta_mov_reg_imm__x86_64(v, GTA_REG_RAX, (uint64_t)func)
+  // Call the function.
+    && gta_binary_call_reg__x86_64(v, GTA_REG_RAX)
+#endif
+  ;
+}
+
+
+/**
+ * The registers which hold unboxed integer intermediate values, indexed by
+ * their depth in the expression tree.
+ *
+ * They are all volatile in both the System V and the Windows calling
+ * conventions, so they may be used freely between calls.
+ */
+static const GTA_Register unboxed_integer_registers[] = {
+  GTA_X86_64_R1,
+  GTA_X86_64_R2,
+  GTA_X86_64_R3,
+  GTA_X86_64_R4,
+};
+
+/**
+ * The registers which hold unboxed float intermediate values, indexed by
+ * their depth in the expression tree.
+ */
+static const GTA_Register unboxed_float_registers[] = {
+  GTA_REG_XMM0,
+  GTA_REG_XMM1,
+  GTA_REG_XMM2,
+  GTA_REG_XMM3,
+};
+
+/**
+ * The maximum number of intermediate values that an unboxed expression tree
+ * may need at once.
+ */
+#define UNBOXED_REGISTER_COUNT (sizeof(unboxed_integer_registers) / sizeof(unboxed_integer_registers[0]))
+
+
+/**
+ * Determine whether or not a node may be a leaf of an unboxed expression tree.
+ *
+ * Leaves are numeric literals and reads of local or global variables.  None of
+ * them has side effects, so they may be evaluated a second time if a type
+ * guard fails.
+ *
+ * @param node The node.
+ * @return True if the node may be a leaf of an unboxed expression tree.
+ */
+static bool is_unboxed_leaf(GTA_Ast_Node * node) {
+  if (GTA_AST_IS_INTEGER(node) || GTA_AST_IS_FLOAT(node)) {
+    return true;
+  }
+  if (GTA_AST_IS_IDENTIFIER(node)) {
+    GTA_Ast_Node_Identifier * identifier = (GTA_Ast_Node_Identifier *) node;
+    return (identifier->type == GTA_AST_NODE_IDENTIFIER_TYPE_LOCAL)
+      || (identifier->type == GTA_AST_NODE_IDENTIFIER_TYPE_GLOBAL);
+  }
+  return false;
+}
+
+
+/**
+ * Count the registers that are needed to compute an arithmetic expression
+ * tree without boxing its intermediate values.
+ *
+ * The tree may only contain addition, subtraction, and multiplication, with
+ * leaves as described by is_unboxed_leaf().  A node whose operands are both
+ * integer literals is rejected, because it is a constant which should be
+ * folded instead (and folding it as a float could change its value).
+ *
+ * @param node The root of the tree.
+ * @param has_literal Set to true if the tree contains a numeric literal.
+ * @param has_float Set to true if the tree contains a float literal.
+ * @return The number of registers needed, or 0 if the tree cannot be computed
+ *   unboxed.
+ */
+static size_t unboxed_register_count(GTA_Ast_Node * node, bool * has_literal, bool * has_float) {
+  if (is_unboxed_leaf(node)) {
+    if (GTA_AST_IS_FLOAT(node)) {
+      *has_float = true;
+    }
+    if (!GTA_AST_IS_IDENTIFIER(node)) {
+      *has_literal = true;
+    }
+    return 1;
+  }
+  if (!GTA_AST_IS_BINARY(node)) {
+    return 0;
+  }
+  GTA_Ast_Node_Binary * binary = (GTA_Ast_Node_Binary *) node;
+  if ((binary->operator_type != GTA_BINARY_TYPE_ADD)
+    && (binary->operator_type != GTA_BINARY_TYPE_SUBTRACT)
+    && (binary->operator_type != GTA_BINARY_TYPE_MULTIPLY)) {
+    return 0;
+  }
+  if (GTA_AST_IS_INTEGER(binary->lhs) && GTA_AST_IS_INTEGER(binary->rhs)) {
+    return 0;
+  }
+  size_t lhs = unboxed_register_count(binary->lhs, has_literal, has_float);
+  size_t rhs = unboxed_register_count(binary->rhs, has_literal, has_float);
+  if (!lhs || !rhs) {
+    return 0;
+  }
+  // The LHS is held in a register while the RHS is computed.
+  return lhs > rhs ? lhs : rhs + 1;
+}
+
+
+/**
+ * Determine whether or not a binary operation should be compiled to native
+ * integer or float instructions.
+ *
+ * The operation must be an arithmetic or comparison operation whose operands
+ * are unboxed expression trees (see unboxed_register_count()).  As with the
+ * integer-specialized bytecode, at least one of the values must be known to
+ * be a number.  Variables are only known at runtime, so they are guarded, and
+ * the whole expression falls back to the generic operations if a guard fails.
+ *
+ * @param self The binary node.
+ * @param is_float Set to true if the operation should use float instructions.
+ * @return True if the operation should be compiled unboxed.
+ */
+static bool use_unboxed_binary(GTA_Ast_Node_Binary * self, bool * is_float) {
+  if (self->operator_type >= GTA_BINARY_TYPE_AND
+    || self->operator_type == GTA_BINARY_TYPE_DIVIDE
+    || self->operator_type == GTA_BINARY_TYPE_MODULO) {
+    return false;
+  }
+  bool has_literal = false;
+  *is_float = false;
+  size_t count;
+  if (self->operator_type >= GTA_BINARY_TYPE_LESS_THAN) {
+    // The operands of a comparison are computed just like those of the
+    // arithmetic operations.
+    size_t lhs = unboxed_register_count(self->lhs, &has_literal, is_float);
+    size_t rhs = unboxed_register_count(self->rhs, &has_literal, is_float);
+    count = (lhs && rhs)
+      ? (lhs > rhs ? lhs : rhs + 1)
+      : 0;
+  }
+  else {
+    count = unboxed_register_count((GTA_Ast_Node *)self, &has_literal, is_float);
+  }
+  return count && (count <= UNBOXED_REGISTER_COUNT) && has_literal;
+}
+
+
+/**
+ * Compile an unboxed expression tree so that its value is left in the
+ * register for `depth`.
+ *
+ * The registers for any greater depth may be overwritten, as may RAX and the
+ * scratch registers.
+ *
+ * @param node The root of the tree.
+ * @param is_float Whether the tree is computed with float instructions.
+ * @param depth The depth of the tree, which selects its result register.
+ * @param label_guard_failed The label to jump to if a variable does not hold
+ *   a value of the expected type.
+ * @param context The compiler context.
+ * @return True on success, false on failure.
+ */
+static bool compile_unboxed_to_binary__x86_64(GTA_Ast_Node * node, bool is_float, size_t depth, GTA_Integer label_guard_failed, GTA_Compiler_Context * context) {
+  assert(depth < UNBOXED_REGISTER_COUNT);
+  GCU_Vector8 * v = context->binary_vector;
+  GTA_Register dst = is_float
+    ? unboxed_float_registers[depth]
+    : unboxed_integer_registers[depth];
+
+  if (GTA_AST_IS_INTEGER(node)) {
+    GTA_Integer value = ((GTA_Ast_Node_Integer *) node)->value;
+    if (!is_float) {
+      //   mov dst, value
+      return gta_mov_reg_imm__x86_64(v, dst, value);
+    }
+    GTA_Float converted = (GTA_Float)value;
+    int64_t bits;
+    memcpy(&bits, &converted, sizeof(bits));
+    //   mov GTA_X86_64_Scratch1, bits
+    //   movq dst, GTA_X86_64_Scratch1
+    return true
+      && gta_mov_reg_imm__x86_64(v, GTA_X86_64_Scratch1, bits)
+      && gta_movq_reg_reg__x86_64(v, dst, GTA_X86_64_Scratch1);
+  }
+
+  if (GTA_AST_IS_FLOAT(node)) {
+    assert(is_float);
+    int64_t bits;
+    memcpy(&bits, &((GTA_Ast_Node_Float *) node)->value, sizeof(bits));
+    //   mov GTA_X86_64_Scratch1, bits
+    //   movq dst, GTA_X86_64_Scratch1
+    return true
+      && gta_mov_reg_imm__x86_64(v, GTA_X86_64_Scratch1, bits)
+      && gta_movq_reg_reg__x86_64(v, dst, GTA_X86_64_Scratch1);
+  }
+
+  if (GTA_AST_IS_IDENTIFIER(node)) {
+    GTA_Computed_Value_VTable * vtable = is_float
+      ? &gta_computed_value_float_vtable
+      : &gta_computed_value_integer_vtable;
+    int32_t value_offset = is_float
+      ? (int32_t)(size_t)&((GTA_Computed_Value_Float *)0)->value
+      : (int32_t)(size_t)&((GTA_Computed_Value_Integer *)0)->value;
+    int32_t vtable_offset = (int32_t)(size_t)&((GTA_Computed_Value *)0)->vtable;
+    return true
+    // Load the variable into rax.
+      && gta_ast_node_compile_to_binary__x86_64(node, context)
+    // Guard the type of the value.
+    //   mov GTA_X86_64_Scratch1, [rax + vtable_offset]
+    //   mov GTA_X86_64_Scratch2, vtable
+    //   cmp GTA_X86_64_Scratch1, GTA_X86_64_Scratch2
+    //   jne label_guard_failed
+      && gta_mov_reg_ind__x86_64(v, GTA_X86_64_Scratch1, GTA_REG_RAX, GTA_REG_NONE, 0, vtable_offset)
+      && gta_mov_reg_imm__x86_64(v, GTA_X86_64_Scratch2, (int64_t)vtable)
+      && gta_cmp_reg_reg__x86_64(v, GTA_X86_64_Scratch1, GTA_X86_64_Scratch2)
+      && gta_jcc__x86_64(v, GTA_CC_NE, 0xDEADBEEF)
+      && gta_compiler_context_add_label_jump(context, label_guard_failed, v->count - 4)
+    // Unbox the value.
+    //   mov dst, [rax + value_offset]
+    // or, for floats:
+    //   mov GTA_X86_64_Scratch1, [rax + value_offset]
+    //   movq dst, GTA_X86_64_Scratch1
+      && (is_float
+        ? (gta_mov_reg_ind__x86_64(v, GTA_X86_64_Scratch1, GTA_REG_RAX, GTA_REG_NONE, 0, value_offset)
+          && gta_movq_reg_reg__x86_64(v, dst, GTA_X86_64_Scratch1))
+        : gta_mov_reg_ind__x86_64(v, dst, GTA_REG_RAX, GTA_REG_NONE, 0, value_offset));
+  }
+
+  assert(GTA_AST_IS_BINARY(node));
+  GTA_Ast_Node_Binary * binary = (GTA_Ast_Node_Binary *) node;
+  GTA_Register src = is_float
+    ? unboxed_float_registers[depth + 1]
+    : unboxed_integer_registers[depth + 1];
+  if (!compile_unboxed_to_binary__x86_64(binary->lhs, is_float, depth, label_guard_failed, context)
+    || !compile_unboxed_to_binary__x86_64(binary->rhs, is_float, depth + 1, label_guard_failed, context)) {
+    return false;
+  }
+  // Integer overflow wraps, just as it does in the generic operations.
+  switch (binary->operator_type) {
+    case GTA_BINARY_TYPE_ADD:
+      //   add dst, src
+      return is_float
+        ? gta_addsd_reg_reg__x86_64(v, dst, src)
+        : gta_add_reg_reg__x86_64(v, dst, src);
+    case GTA_BINARY_TYPE_SUBTRACT:
+      //   sub dst, src
+      return is_float
+        ? gta_subsd_reg_reg__x86_64(v, dst, src)
+        : gta_sub_reg_reg__x86_64(v, dst, src);
+    case GTA_BINARY_TYPE_MULTIPLY:
+      //   imul dst, src
+      return is_float
+        ? gta_mulsd_reg_reg__x86_64(v, dst, src)
+        : gta_imul_reg_reg__x86_64(v, dst, src);
+    default:
+      return false;
+  }
+}
+
+
+/**
+ * Compile a comparison of two unboxed values.
+ *
+ * The LHS is in the register for depth 0 and the RHS is in the register for
+ * depth 1.  The boolean singleton for the result is left in RAX, so no value
+ * is allocated.
+ *
+ * @param operator_type The comparison.
+ * @param is_float Whether the values are floats.
+ * @param context The compiler context.
+ * @return True on success, false on failure.
+ */
+static bool compile_unboxed_comparison_to_binary__x86_64(GTA_Binary_Type operator_type, bool is_float, GTA_Compiler_Context * context) {
+  GCU_Vector8 * v = context->binary_vector;
+  GTA_Register lhs = is_float ? unboxed_float_registers[0] : unboxed_integer_registers[0];
+  GTA_Register rhs = is_float ? unboxed_float_registers[1] : unboxed_integer_registers[1];
+  GTA_Condition_Code condition;
+  bool swap = false;
+
+  // UCOMISD reports an unordered comparison (NaN) as "below" and "equal", so
+  // the float comparisons are arranged to only use conditions which are false
+  // when the comparison is unordered.
+  switch (operator_type) {
+    case GTA_BINARY_TYPE_LESS_THAN:
+      condition = is_float ? GTA_CC_A : GTA_CC_L;
+      swap = is_float;
+      break;
+    case GTA_BINARY_TYPE_LESS_THAN_EQUAL:
+      condition = is_float ? GTA_CC_AE : GTA_CC_LE;
+      swap = is_float;
+      break;
+    case GTA_BINARY_TYPE_GREATER_THAN:
+      condition = is_float ? GTA_CC_A : GTA_CC_G;
+      break;
+    case GTA_BINARY_TYPE_GREATER_THAN_EQUAL:
+      condition = is_float ? GTA_CC_AE : GTA_CC_GE;
+      break;
+    case GTA_BINARY_TYPE_EQUAL:
+      condition = GTA_CC_E;
+      break;
+    case GTA_BINARY_TYPE_NOT_EQUAL:
+      condition = GTA_CC_NE;
+      break;
+    default:
+      return false;
+  }
+
+  GTA_Computed_Value * if_true = gta_computed_value_boolean_true;
+  GTA_Computed_Value * if_false = gta_computed_value_boolean_false;
+  return true
+  //   cmp lhs, rhs
+  // or, for floats:
+  //   ucomisd lhs, rhs     ; (or rhs, lhs if swapped)
+    && (is_float
+      ? gta_ucomisd_reg_reg__x86_64(v, swap ? rhs : lhs, swap ? lhs : rhs)
+      : gta_cmp_reg_reg__x86_64(v, lhs, rhs))
+  //   mov rax, gta_computed_value_boolean_false
+  //   mov GTA_X86_64_Scratch1, gta_computed_value_boolean_true
+  //   cmovcc rax, GTA_X86_64_Scratch1
+    && gta_mov_reg_imm__x86_64(v, GTA_REG_RAX, (int64_t)if_false)
+    && gta_mov_reg_imm__x86_64(v, GTA_X86_64_Scratch1, (int64_t)if_true)
+    && gta_cmovcc_reg_reg__x86_64(v, condition, GTA_REG_RAX, GTA_X86_64_Scratch1)
+  // NaN is not equal to anything, including itself.
+  //   mov GTA_X86_64_Scratch2, (EQUAL ? false : true)
+  //   cmovp rax, GTA_X86_64_Scratch2
+    && (!is_float || ((operator_type != GTA_BINARY_TYPE_EQUAL) && (operator_type != GTA_BINARY_TYPE_NOT_EQUAL))
+      || (gta_mov_reg_imm__x86_64(v, GTA_X86_64_Scratch2, (int64_t)(operator_type == GTA_BINARY_TYPE_EQUAL ? if_false : if_true))
+        && gta_cmovcc_reg_reg__x86_64(v, GTA_CC_P, GTA_REG_RAX, GTA_X86_64_Scratch2)));
+}
+
+
+/**
+ * Compile a binary operation with unboxed values, followed by the generic
+ * operation as a fallback.
+ *
+ * Both operands are computed in registers.  Comparisons produce a boolean
+ * singleton, and arithmetic boxes its result once, when it leaves the
+ * expression.  If a variable does not hold a value of the expected type, the
+ * expression is computed again with the generic operations, which is safe
+ * because the leaves of the tree have no side effects.
+ *
+ * @param self The binary node.
+ * @param is_float Whether the operation uses float instructions.
+ * @param context The compiler context.
+ * @return True on success, false on failure.
+ */
+static bool compile_unboxed_binary_to_binary__x86_64(GTA_Ast_Node_Binary * self, bool is_float, GTA_Compiler_Context * context) {
+  GCU_Vector8 * v = context->binary_vector;
+  GTA_Integer label_guard_failed;
+  GTA_Integer label_done;
+  bool is_comparison = self->operator_type >= GTA_BINARY_TYPE_LESS_THAN;
+
+  if (((label_guard_failed = gta_compiler_context_get_label(context)) < 0)
+    || ((label_done = gta_compiler_context_get_label(context)) < 0)) {
+    return false;
+  }
+
+  if (is_comparison) {
+    if (!compile_unboxed_to_binary__x86_64(self->lhs, is_float, 0, label_guard_failed, context)
+      || !compile_unboxed_to_binary__x86_64(self->rhs, is_float, 1, label_guard_failed, context)
+      || !compile_unboxed_comparison_to_binary__x86_64(self->operator_type, is_float, context)) {
+      return false;
+    }
+  }
+  else {
+    // The result is in the first register, which (for integers) is also the
+    // first argument of the function call.
+    if (!compile_unboxed_to_binary__x86_64((GTA_Ast_Node *)self, is_float, 0, label_guard_failed, context)) {
+      return false;
+    }
+    bool boxed;
+    if (is_float) {
+      // gta_computed_value_float_create(xmm0, context)
+#if defined(_WIN32) || defined(_WIN64)
+      //   mov GTA_X86_64_R2, r15
+      boxed = gta_mov_reg_reg__x86_64(v, GTA_X86_64_R2, GTA_REG_R15)
+#else
+      //   mov GTA_X86_64_R1, r15
+      boxed = gta_mov_reg_reg__x86_64(v, GTA_X86_64_R1, GTA_REG_R15)
+#endif
+        && gta_binary_call__x86_64(v, (uint64_t)gta_computed_value_float_create);
+    }
+    else {
+      // gta_computed_value_integer_create(GTA_X86_64_R1, context)
+      //   mov GTA_X86_64_R2, r15
+      boxed = gta_mov_reg_reg__x86_64(v, GTA_X86_64_R2, GTA_REG_R15)
+        && gta_binary_call__x86_64(v, (uint64_t)gta_computed_value_integer_create);
+    }
+    if (!boxed
+    // If the allocation failed, then the result is an error.
+    //   mov GTA_X86_64_Scratch1, gta_computed_value_error_out_of_memory
+    //   test rax, rax
+    //   cmovz rax, GTA_X86_64_Scratch1
+      || !gta_mov_reg_imm__x86_64(v, GTA_X86_64_Scratch1, (int64_t)gta_computed_value_error_out_of_memory)
+      || !gta_test_reg_reg__x86_64(v, GTA_REG_RAX, GTA_REG_RAX)
+      || !gta_cmovcc_reg_reg__x86_64(v, GTA_CC_Z, GTA_REG_RAX, GTA_X86_64_Scratch1)) {
+      return false;
+    }
+  }
+
+  return true
+  //   jmp done
+    && gta_jmp__x86_64(v, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, label_done, v->count - 4)
+  // guard_failed:
+    && gta_compiler_context_set_label(context, label_guard_failed, v->count)
+    && compile_generic_binary_to_binary__x86_64(self, true, context)
+  // done:
+    && gta_compiler_context_set_label(context, label_done, v->count);
+}
+
+
 bool gta_ast_node_binary_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_Compiler_Context * context) {
   assert(self);
   assert(GTA_AST_IS_BINARY(self));
@@ -434,91 +1077,10 @@ bool gta_ast_node_binary_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_Comp
   }
 
   if (binary_node->operator_type < GTA_BINARY_TYPE_AND) {
-    // Determine the function to call.
-    GTA_Integer func = 0;
-    switch(binary_node->operator_type) {
-      case GTA_BINARY_TYPE_ADD:
-        func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_add);
-        break;
-      case GTA_BINARY_TYPE_SUBTRACT:
-        func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_subtract);
-        break;
-      case GTA_BINARY_TYPE_MULTIPLY:
-        func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_multiply);
-        break;
-      case GTA_BINARY_TYPE_DIVIDE:
-        func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_divide);
-        break;
-      case GTA_BINARY_TYPE_MODULO:
-        func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_modulo);
-        break;
-      case GTA_BINARY_TYPE_LESS_THAN:
-        func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_less_than);
-        break;
-      case GTA_BINARY_TYPE_LESS_THAN_EQUAL:
-        func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_less_than_equal);
-        break;
-      case GTA_BINARY_TYPE_GREATER_THAN:
-        func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_greater_than);
-        break;
-      case GTA_BINARY_TYPE_GREATER_THAN_EQUAL:
-        func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_greater_than_equal);
-        break;
-      case GTA_BINARY_TYPE_EQUAL:
-        func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_equal);
-        break;
-      case GTA_BINARY_TYPE_NOT_EQUAL:
-        func = GTA_JIT_FUNCTION_CONVERTER(gta_computed_value_not_equal);
-        break;
-      default:
-        return false;
-    }
-
-    return true
-    // Compile the LHS expression.  The result will be in rax.
-      && gta_ast_node_compile_to_binary__x86_64(binary_node->lhs, context)
-    // "Push" the result of the LHS expression.
-    //   add rsp, -16
-    //   mov [rsp + GTA_SHADOW_SIZE__X86_64], rax
-      && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, -16)
-      && gta_mov_ind_reg__x86_64(v, GTA_REG_RSP, GTA_REG_NONE, 0, GTA_SHADOW_SIZE__X86_64, GTA_REG_RAX)
-    // Compile the RHS expression.  The result will be in rax.
-      && gta_ast_node_compile_to_binary__x86_64(binary_node->rhs, context)
-
-    // Prepare registers for: func(result_from_lhs, result_from_rhs, true, is_assignment, context)
-    // "Pop" the result of the LHS expression.
-    // NOTE: We will not change RSP, because if compiling for Windows, it will
-    // need it.  RSP will be cleaned up later in this function.
-    //   mov GTA_X86_64_R1, [rsp + GTA_SHADOW_SIZE__X86_64] ; result from lhs
-      && gta_mov_reg_ind__x86_64(v, GTA_X86_64_R1, GTA_REG_RSP, GTA_REG_NONE, 0, GTA_SHADOW_SIZE__X86_64)
-    //   mov GTA_X86_64_R2, rax  ; result_from_rhs
-    //   mov GTA_X86_64_R3, 1    ; true
-    //   mov GTA_X86_64_R4, is_assignment ; is_assignment
-      && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R2, GTA_REG_RAX)
-      && gta_mov_reg_imm__x86_64(v, GTA_X86_64_R3, 1)
-      && gta_mov_reg_imm__x86_64(v, GTA_X86_64_R4, 0)
-#if defined(_WIN32) || defined(_WIN64)
-    // The Windows x64 calling convention ABI requires that the fifth argument
-    // be put on the stack, just above the shadow space.
-    //   mov [rsp + GTA_SHADOW_SIZE__X86_64], r15 ; context (the fifth argument)
-      && gta_mov_ind_reg__x86_64(v, GTA_REG_RSP, GTA_REG_NONE, 0, GTA_SHADOW_SIZE__X86_64, GTA_REG_R15)
-    //   call func
-      && gta_binary_call__x86_64(v, (uint64_t)func)
-    // Restore the stack after the function call.
-    //   add rsp, 16
-      && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, 16)
-#else
-    // Restore the stack since the extra space is not needed.
-    //   add rsp, 16
-      && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, 16)
-    //   mov r8, r15   ; context (the fifth argument)
-      && gta_mov_reg_reg__x86_64(v, GTA_REG_R8, GTA_REG_R15)
-    //   mov rax, func ; func
-      && gta_mov_reg_imm__x86_64(v, GTA_REG_RAX, (uint64_t)func)
-    // Call the function.
-      && gta_binary_call_reg__x86_64(v, GTA_REG_RAX)
-#endif
-    ;
+    bool is_float;
+    return use_unboxed_binary(binary_node, &is_float)
+      ? compile_unboxed_binary_to_binary__x86_64(binary_node, is_float, context)
+      : compile_generic_binary_to_binary__x86_64(binary_node, false, context);
   }
   return false;
 }
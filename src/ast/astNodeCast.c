@@ -309,16 +309,7 @@ bool gta_ast_node_cast_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_Con
     && gta_ast_node_compile_to_bytecode(cast->expression, context)
     && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
     && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_CAST))
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_P(
-      cast->type == GTA_CAST_TYPE_INTEGER
-        ? &gta_computed_value_integer_vtable
-        : cast->type == GTA_CAST_TYPE_FLOAT
-          ? &gta_computed_value_float_vtable
-          : cast->type == GTA_CAST_TYPE_BOOLEAN
-            ? &gta_computed_value_boolean_vtable
-            : cast->type == GTA_CAST_TYPE_STRING
-              ? &gta_computed_value_string_vtable
-              : &gta_computed_value_null_vtable));
+    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(cast->type));
 }
 
 
@@ -275,6 +275,9 @@ bool gta_ast_node_do_while_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_Co
     && ((context->continue_label = gta_compiler_context_get_label(context)) >= 0)
   // block_start:            ; Start of the while loop
     && gta_compiler_context_set_label(context, block_start, v->count)
+  // Perform a garbage collection, if one is due, and count the safepoint
+  // against the execution budget.
+    && gta_binary_safepoint__x86_64(context)
   // Compile the code block.
     && gta_ast_node_compile_to_binary__x86_64(do_while_node->block, context)
   // Continue:
@@ -7,6 +7,7 @@
 #include <tang/computedValue/computedValueFloat.h>
 #include <tang/program/binary.h>
 #include <tang/program/bytecode.h>
+#include <tang/program/virtualMachine.h>
 
 GTA_Ast_Node_VTable gta_ast_node_float_vtable = {
   .name = "Float",
@@ -75,6 +76,19 @@ bool gta_ast_node_float_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_Co
   assert(GTA_AST_IS_FLOAT(self));
   GTA_Ast_Node_Float * float_node = (GTA_Ast_Node_Float *) self;
 
+  assert(context);
+  assert(context->program);
+  assert(context->program->bytecode);
+  assert(context->bytecode_offsets);
+
+  // Most floats are pushed as immediates, which allows the VM to use its
+  // float fast paths without allocating.
+  if (GTA_VM_IMMEDIATE_FLOAT_FITS(float_node->value)) {
+    return GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
+      && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_FLOAT))
+      && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_F(float_node->value));
+  }
+
   GTA_Computed_Value * singleton = gta_program_get_singleton(context->program, &gta_computed_value_float_vtable, float_node->value);
   if (!singleton) {
     singleton = (GTA_Computed_Value *)gta_computed_value_float_create(float_node->value, NULL);
@@ -87,14 +101,15 @@ bool gta_ast_node_float_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_Co
     }
   }
 
-  assert(context);
-  assert(context->program);
-  assert(context->program->bytecode);
-  assert(context->bytecode_offsets);
+  GTA_Integer constant = gta_compiler_context_add_constant(context, singleton);
+  if (constant < 0) {
+    return false;
+  }
+
   return true
     && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
     && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_LOAD))
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_P(singleton))
+    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(constant))
   ;
 }
 
@@ -290,7 +290,9 @@ bool gta_ast_node_for_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_Cont
         && gta_ast_node_compile_to_bytecode(for_node->condition, context)
       // JMPF block_end
         && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-        && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_JMPF))
+        && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_AST_POSSIBLE_TYPE_IS_BOOLEAN(for_node->condition->possible_type)
+          ? GTA_BYTECODE_JMPF_BOOLEAN
+          : GTA_BYTECODE_JMPF))
         && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(0))
         && gta_compiler_context_add_label_jump(context, block_end, context->program->bytecode->count - 1)
       )
@@ -376,6 +378,9 @@ bool gta_ast_node_for_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_Compile
       : true)
   // condition_start:
     && gta_compiler_context_set_label(context, condition_start, context->binary_vector->count)
+  // Perform a garbage collection, if one is due, and count the safepoint
+  // against the execution budget.
+    && gta_binary_safepoint__x86_64(context)
   // Compile the condition.
     && (has_condition
       ? (true
@@ -391,6 +391,7 @@ bool gta_ast_node_function_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_Co
   GTA_Integer old_continue_label = context->continue_label;
   GTA_Integer old_break_label = context->break_label;
   GTA_Integer old_return_label = context->return_label;
+  GTA_Register_Cache old_register_cache = context->register_cache;
 
   // Stack offsets.
   size_t count_of_locals_excluding_parameters = GTA_HASHX_COUNT(function->scope->variable_positions)
@@ -423,7 +424,7 @@ bool gta_ast_node_function_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_Co
   // Record the function's binary offset.
   // This will be translated into an actual pointer after the program is fully
   // compiled.
-    && (function->runtime_function->pointer = v->count)
+    && (function->runtime_function->binary = v->count)
   // Reserve the stack space for the function's local variables as well as
   // shadow space.
   //   add rsp, -total_stack_adjustment)
@@ -448,6 +449,14 @@ bool gta_ast_node_function_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_Co
   }
 
   return error_free
+  // Perform a garbage collection, if one is due, and count the safepoint
+  // against the execution budget.
+    && gta_binary_safepoint__x86_64(context)
+  // Choose the variables to hold in registers, and load them.  The caller's
+  // registers are not preserved, because the caller reloads them after the
+  // call.
+    && gta_register_cache_choose(&context->register_cache, context->program, function->scope, function->block)
+    && gta_register_cache_load__x86_64(&context->register_cache, v)
   // Compile the function body.
     && gta_ast_node_compile_to_binary__x86_64(function->block, context)
 
@@ -480,9 +489,10 @@ bool gta_ast_node_function_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_Co
   //   after_function:
     && gta_compiler_context_set_label(context, after_function, v->count)
 
-  // Restore the old jump labels.
+  // Restore the old jump labels and register cache.
     && ((context->continue_label = old_continue_label) >= 0)
     && ((context->break_label = old_break_label) >= 0)
     && ((context->return_label = old_return_label) >= 0)
+    && ((context->register_cache = old_register_cache), true)
   ;
 }
@@ -203,7 +203,7 @@ bool gta_ast_node_function_call_compile_to_binary__x86_64(GTA_Ast_Node * self, G
   // Offsets
   int32_t vtable_offset = (int32_t)(size_t)(&((GTA_Computed_Value *)0)->vtable);
   int32_t num_arguments_offset = (int32_t)(size_t)(&((GTA_Computed_Value_Function *)0)->num_arguments);
-  int32_t pointer_offset = (int32_t)(size_t)(&((GTA_Computed_Value_Function *)0)->pointer);
+  int32_t binary_offset = (int32_t)(size_t)(&((GTA_Computed_Value_Function *)0)->binary);
   int32_t bound_object = (int32_t)(size_t)(&((GTA_Computed_Value_Function_Native *)0)->bound_object);
   int32_t callback = (int32_t)(size_t)(&((GTA_Computed_Value_Function_Native *)0)->callback);
   bool * is_temporary_offset = &((GTA_Computed_Value *)0)->is_temporary;
@@ -337,10 +337,10 @@ bool gta_ast_node_function_call_compile_to_binary__x86_64(GTA_Ast_Node * self, G
 
   // Load the function pointer, call it, then clean up.
   // Note: The stack is already aligned.
-  //   mov rax, [rax + pointer_offset]
+  //   mov rax, [rax + binary_offset]
   //   call rax
   //   jmp cleanup
-    && gta_mov_reg_ind__x86_64(v, GTA_REG_RAX, GTA_REG_RAX, GTA_REG_NONE, 0, pointer_offset)
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_RAX, GTA_REG_RAX, GTA_REG_NONE, 0, binary_offset)
     && gta_call_reg__x86_64(v, GTA_REG_RAX)
     && gta_jmp__x86_64(v, 0xDEADBEEF)
     && gta_compiler_context_add_label_jump(context, cleanup, v->count - 4)
@@ -368,5 +368,10 @@ bool gta_ast_node_function_call_compile_to_binary__x86_64(GTA_Ast_Node * self, G
   //  add rsp, total_stack_adjustment
     && gta_mov_reg_ind__x86_64(v, GTA_REG_R12, GTA_REG_RSP, GTA_REG_NONE, 0, r12_offset)
     && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, total_stack_adjustment)
+
+  // The called function may have used the registers for its own variables,
+  // or assigned to a global variable, so reload any variables which are
+  // held in registers.
+    && gta_register_cache_load__x86_64(&context->register_cache, v)
   ;
 }
@@ -53,6 +53,7 @@ GTA_Ast_Node_Identifier * gta_ast_node_identifier_create(const char * identifier
     .mangled_name_hash = 0,
     .type = GTA_AST_NODE_IDENTIFIER_TYPE_NONE,
     .scope = 0,
+    .is_shared = false,
   };
   return self;
 }
@@ -89,6 +90,10 @@ GTA_Ast_Node * gta_ast_node_identifier_simplify(GTA_Ast_Node * self, GTA_Ast_Sim
   assert(GTA_AST_IS_IDENTIFIER(self));
   GTA_Ast_Node_Identifier * identifier = (GTA_Ast_Node_Identifier *) self;
 
+  if (identifier->is_shared) {
+    return 0;
+  }
+
   GCU_Hash64_Value val = gcu_hash64_get(variable_map, identifier->hash);
   if (val.exists) {
     GTA_Ast_Node * node = (GTA_Ast_Node *)val.value.p;
@@ -280,6 +285,13 @@ bool gta_ast_node_identifier_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_
     // the memory address for whichever variable we're trying to access.
     int32_t index = ((int32_t)GTA_TYPEX_UI(val.value) + 1) * -8;
 
+    // If the variable is held in a register, then copy it from there.
+    //   mov rax, reg
+    GTA_Register reg = gta_register_cache_find(&context->register_cache, true, index);
+    if (reg != GTA_REG_NONE) {
+      return gta_mov_reg_reg__x86_64(context->binary_vector, GTA_REG_RAX, reg);
+    }
+
     // Copy the value from the global position (GTA_TYPEX_UI(val.value)) to RAX.
     //   mov rax, [r13 + index]
     return true
@@ -299,6 +311,15 @@ bool gta_ast_node_identifier_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_
     // the memory address for whichever variable we're trying to access.
     int32_t index = ((int32_t)GTA_TYPEX_UI(val.value) + 1) * -8;
 
+    // If the variable is held in a register, then copy it from there.
+    //   mov rax, reg
+    GTA_Register reg = (identifier->scope == context->register_cache.scope)
+      ? gta_register_cache_find(&context->register_cache, false, index)
+      : GTA_REG_NONE;
+    if (reg != GTA_REG_NONE) {
+      return gta_mov_reg_reg__x86_64(context->binary_vector, GTA_REG_RAX, reg);
+    }
+
     // Copy the value from the local position (GTA_TYPEX_UI(val.value)) to RAX.
     //   mov rax, [r12 + index]
     return true
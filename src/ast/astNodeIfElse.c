@@ -213,7 +213,9 @@ bool gta_ast_node_if_else_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_
     && gta_ast_node_compile_to_bytecode(if_else->condition, context)
   // JMPF else_block         ; value is not popped
     && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_JMPF))
+    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_AST_POSSIBLE_TYPE_IS_BOOLEAN(if_else->condition->possible_type)
+      ? GTA_BYTECODE_JMPF_BOOLEAN
+      : GTA_BYTECODE_JMPF))
     && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(0))
     && gta_compiler_context_add_label_jump(context, else_block, context->program->bytecode->count - 1)
   // POP
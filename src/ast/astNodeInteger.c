@@ -6,6 +6,7 @@
 #include <tang/ast/astNodeInteger.h>
 #include <tang/computedValue/computedValueInteger.h>
 #include <tang/program/binary.h>
+#include <tang/program/virtualMachine.h>
 
 GTA_Ast_Node_VTable gta_ast_node_integer_vtable = {
   .name = "Integer",
@@ -74,6 +75,19 @@ bool gta_ast_node_integer_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_
   assert(GTA_AST_IS_INTEGER(self));
   GTA_Ast_Node_Integer * integer = (GTA_Ast_Node_Integer *) self;
 
+  assert(context);
+  assert(context->program);
+  assert(context->program->bytecode);
+  assert(context->bytecode_offsets);
+
+  // Small integers are pushed as immediates, which allows the VM to use its
+  // integer fast paths and the optimizer to fuse them into superinstructions.
+  if (GTA_VM_IMMEDIATE_INTEGER_FITS(integer->value)) {
+    return GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
+      && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_INTEGER))
+      && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_I(integer->value));
+  }
+
   GTA_Computed_Value * singleton = gta_program_get_singleton(context->program, &gta_computed_value_integer_vtable, integer->value);
   if (!singleton) {
     singleton = (GTA_Computed_Value *)gta_computed_value_integer_create(integer->value, NULL);
@@ -86,13 +100,14 @@ bool gta_ast_node_integer_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_
     }
   }
 
-  assert(context);
-  assert(context->program);
-  assert(context->program->bytecode);
-  assert(context->bytecode_offsets);
+  GTA_Integer constant = gta_compiler_context_add_constant(context, singleton);
+  if (constant < 0) {
+    return false;
+  }
+
   return GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
     && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_LOAD))
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_P(singleton));
+    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(constant));
 }
 
 
@@ -6,6 +6,7 @@
 #include <cutil/string.h>
 #include <tang/ast/astNodePeriod.h>
 #include <tang/program/binary.h>
+#include <tang/program/inlineCache.h>
 
 GTA_Ast_Node_VTable gta_ast_node_period_vtable = {
   .name = "Period",
@@ -119,13 +120,18 @@ bool gta_ast_node_period_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_C
   assert(self);
   assert(GTA_AST_IS_PERIOD(self));
   GTA_Ast_Node_Period * period = (GTA_Ast_Node_Period *) self;
+  GTA_UInteger attribute_hash = GTA_STRING_HASH(period->rhs, strlen(period->rhs));
+  GTA_Inline_Cache * cache = gta_inline_cache_create(context->program, attribute_hash);
+  GTA_Integer constant = cache
+    ? gta_compiler_context_add_constant(context, cache)
+    : -1;
 
-  return true
+  return (constant >= 0)
     && gta_ast_node_compile_to_bytecode(period->lhs, context)
     && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
     && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_PERIOD))
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_STRING_HASH(period->rhs, strlen(period->rhs))))
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_P((void *)period->rhs))
+    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(attribute_hash))
+    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(constant))
   ;
 }
 
@@ -139,20 +145,22 @@ bool gta_ast_node_period_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_Comp
   assert(context->binary_vector);
   GCU_Vector8 * v = context->binary_vector;
   GTA_UInteger attribute_hash = GTA_STRING_HASH(period->rhs, strlen(period->rhs));
+  GTA_Inline_Cache * cache = gta_inline_cache_create(context->program, attribute_hash);
 
-  return true
+  return cache
   // Compile the LHS
     && gta_ast_node_compile_to_binary__x86_64(period->lhs, context)
-  // The result is in RAX.  Call the period function.
+  // The result is in RAX.  Call the period function through the inline cache
+  // of this call site.
   //   mov GTA_X86_64_R1, rax
-  //   mov GTA_X86_64_R2, attribute_hash
+  //   mov GTA_X86_64_R2, cache
   //   mov GTA_X86_64_R3, r15             ; context
-  //   mov rax, gta_computed_value_period
+  //   mov rax, gta_inline_cache_period
   //   call rax
     && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R1, GTA_REG_RAX)
-    && gta_mov_reg_imm__x86_64(v, GTA_X86_64_R2, attribute_hash)
+    && gta_mov_reg_imm__x86_64(v, GTA_X86_64_R2, (int64_t)cache)
     && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R3, GTA_REG_R15)
-    && gta_mov_reg_imm__x86_64(v, GTA_REG_RAX, (int64_t)gta_computed_value_period)
+    && gta_mov_reg_imm__x86_64(v, GTA_REG_RAX, (int64_t)gta_inline_cache_period)
     && gta_binary_call_reg__x86_64(v, GTA_REG_RAX)
   ;
 }
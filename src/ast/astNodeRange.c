@@ -0,0 +1,171 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <cutil/memory.h>
+#include <tang/ast/astNodeRange.h>
+#include <tang/computedValue/computedValueRange.h>
+#include <tang/program/binary.h>
+
+GTA_Ast_Node_VTable gta_ast_node_range_vtable = {
+  .name = "Range",
+  .compile_to_bytecode = gta_ast_node_range_compile_to_bytecode,
+  .compile_to_binary__x86_64 = gta_ast_node_range_compile_to_binary__x86_64,
+  .compile_to_binary__arm_64 = 0,
+  .compile_to_binary__x86_32 = 0,
+  .compile_to_binary__arm_32 = 0,
+  .destroy = gta_ast_node_range_destroy,
+  .print = gta_ast_node_range_print,
+  .simplify = gta_ast_node_range_simplify,
+  .analyze = gta_ast_node_range_analyze,
+  .walk = gta_ast_node_range_walk,
+};
+
+
+GTA_Ast_Node_Range * gta_ast_node_range_create(GTA_Ast_Node * start, GTA_Ast_Node * end, GTA_PARSER_LTYPE location) {
+  assert(start);
+  assert(end);
+
+  GTA_Ast_Node_Range * self = gcu_malloc(sizeof(GTA_Ast_Node_Range));
+  if (!self) {
+    return 0;
+  }
+
+  *self = (GTA_Ast_Node_Range) {
+    .base = {
+      .vtable = &gta_ast_node_range_vtable,
+      .location = location,
+      .possible_type = GTA_AST_POSSIBLE_TYPE_UNKNOWN,
+      .is_singleton = false,
+    },
+    .start = start,
+    .end = end,
+  };
+  return self;
+}
+
+
+void gta_ast_node_range_destroy(GTA_Ast_Node * self) {
+  assert(self);
+  assert(GTA_AST_IS_RANGE(self));
+  GTA_Ast_Node_Range * range = (GTA_Ast_Node_Range *)self;
+
+  gta_ast_node_destroy(range->start);
+  gta_ast_node_destroy(range->end);
+  gcu_free(self);
+}
+
+
+void gta_ast_node_range_print(GTA_Ast_Node * self, const char * indent) {
+  assert(self);
+  assert(GTA_AST_IS_RANGE(self));
+  GTA_Ast_Node_Range * range = (GTA_Ast_Node_Range *)self;
+
+  assert(indent);
+  size_t indent_len = strlen(indent);
+  char * new_indent = gcu_malloc(indent_len + 5);
+  if (!new_indent) {
+    return;
+  }
+  memcpy(new_indent, indent, indent_len + 1);
+  memcpy(new_indent + indent_len, "    ", 5);
+
+  assert(self->vtable);
+  assert(self->vtable->name);
+  printf("%s%s:\n", indent, self->vtable->name);
+
+  printf("%s  Start:\n", indent);
+  gta_ast_node_print(range->start, new_indent);
+
+  printf("%s  End:\n", indent);
+  gta_ast_node_print(range->end, new_indent);
+  gcu_free(new_indent);
+}
+
+
+GTA_Ast_Node * gta_ast_node_range_simplify(GTA_Ast_Node * self, GTA_Ast_Simplify_Variable_Map * variable_map) {
+  assert(self);
+  assert(GTA_AST_IS_RANGE(self));
+  GTA_Ast_Node_Range * range = (GTA_Ast_Node_Range *)self;
+
+  GTA_Ast_Node * simplified_start = gta_ast_node_simplify(range->start, variable_map);
+  if (simplified_start) {
+    gta_ast_node_destroy(range->start);
+    range->start = simplified_start;
+  }
+
+  GTA_Ast_Node * simplified_end = gta_ast_node_simplify(range->end, variable_map);
+  if (simplified_end) {
+    gta_ast_node_destroy(range->end);
+    range->end = simplified_end;
+  }
+  return 0;
+}
+
+
+void gta_ast_node_range_walk(GTA_Ast_Node * self, GTA_Ast_Node_Walk_Callback callback, void * data, void * return_value) {
+  assert(self);
+  assert(GTA_AST_IS_RANGE(self));
+  GTA_Ast_Node_Range * range = (GTA_Ast_Node_Range *)self;
+
+  callback(self, data, return_value);
+
+  gta_ast_node_walk(range->start, callback, data, return_value);
+  gta_ast_node_walk(range->end, callback, data, return_value);
+}
+
+
+GTA_Ast_Node * gta_ast_node_range_analyze(GTA_Ast_Node * self, GTA_Program * program, GTA_Variable_Scope * scope) {
+  assert(self);
+  assert(GTA_AST_IS_RANGE(self));
+  GTA_Ast_Node_Range * range = (GTA_Ast_Node_Range *)self;
+
+  GTA_Ast_Node * error = gta_ast_node_analyze(range->start, program, scope);
+  return error
+    ? error
+    : gta_ast_node_analyze(range->end, program, scope);
+}
+
+
+bool gta_ast_node_range_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_Context * context) {
+  assert(self);
+  assert(GTA_AST_IS_RANGE(self));
+  GTA_Ast_Node_Range * range = (GTA_Ast_Node_Range *)self;
+
+  assert(context);
+  assert(context->program);
+  assert(context->program->bytecode);
+  assert(context->bytecode_offsets);
+  return true
+    && gta_ast_node_compile_to_bytecode(range->start, context)
+    && gta_ast_node_compile_to_bytecode(range->end, context)
+    && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
+    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_RANGE));
+}
+
+
+bool gta_ast_node_range_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_Compiler_Context * context) {
+  assert(self);
+  assert(GTA_AST_IS_RANGE(self));
+  GTA_Ast_Node_Range * range = (GTA_Ast_Node_Range *)self;
+
+  assert(context);
+  assert(context->binary_vector);
+  GCU_Vector8 * v = context->binary_vector;
+
+  return true
+  // Compile the start and push the result.
+  //   push rax
+    && gta_ast_node_compile_to_binary__x86_64(range->start, context)
+    && gta_push_reg__x86_64(v, GTA_REG_RAX)
+  // Compile the end.
+    && gta_ast_node_compile_to_binary__x86_64(range->end, context)
+  // Call the range function.
+  // gta_computed_value_range_create_from_values(start, end, context)
+  //   mov GTA_X86_64_R2, rax
+  //   pop GTA_X86_64_R1
+  //   mov GTA_X86_64_R3, r15
+    && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R2, GTA_REG_RAX)
+    && gta_pop_reg__x86_64(v, GTA_X86_64_R1)
+    && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R3, GTA_REG_R15)
+    && gta_binary_call__x86_64(v, (uint64_t)gta_computed_value_range_create_from_values);
+}
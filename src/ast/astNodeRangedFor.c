@@ -9,7 +9,11 @@
 #include <tang/ast/astNodeBinary.h>
 #include <tang/ast/astNodeIdentifier.h>
 #include <tang/ast/astNodeRangedFor.h>
+#include <tang/computedValue/computedValueArray.h>
+#include <tang/computedValue/computedValueError.h>
+#include <tang/computedValue/computedValueInteger.h>
 #include <tang/computedValue/computedValueIterator.h>
+#include <tang/computedValue/computedValueRange.h>
 #include <tang/program/binary.h>
 #include <tang/program/variable.h>
 
@@ -55,6 +59,17 @@ GTA_Ast_Node_Ranged_For * gta_ast_node_ranged_for_create(const char * identifier
   if (!iterator_node) {
     goto ITERATOR_IDENTIFIER_CREATE_FAILED;
   }
+  // Create a unique name for the index variable.
+  char * index_name = gcu_malloc(32);
+  if (!index_name) {
+    goto INDEX_NAME_CREATE_FAILED;
+  }
+  snprintf(index_name, 31, "index::%p", (void *)self);
+  // Create an identifier node for the index variable.
+  GTA_Ast_Node * index_node = (GTA_Ast_Node *)gta_ast_node_identifier_create(index_name, location);
+  if (!index_node) {
+    goto INDEX_IDENTIFIER_CREATE_FAILED;
+  }
 
   // All allocations are successful, so initialize the ranged-for node.
   *self = (GTA_Ast_Node_Ranged_For) {
@@ -67,11 +82,18 @@ GTA_Ast_Node_Ranged_For * gta_ast_node_ranged_for_create(const char * identifier
     .identifier = identifier_node,
     .expression = expression,
     .iterator = iterator_node,
+    .index = index_node,
     .block = block,
   };
   return self;
 
   // Failure cleanup.
+INDEX_IDENTIFIER_CREATE_FAILED:
+  gcu_free(index_name);
+INDEX_NAME_CREATE_FAILED:
+  // The iterator node owns its name, so the name is not freed separately.
+  gta_ast_node_destroy(iterator_node);
+  goto ITERATOR_NAME_CREATE_FAILED;
 ITERATOR_IDENTIFIER_CREATE_FAILED:
   gcu_free(iterator_name);
 ITERATOR_NAME_CREATE_FAILED:
@@ -91,6 +113,7 @@ void gta_ast_node_ranged_for_destroy(GTA_Ast_Node * self) {
   gta_ast_node_destroy(ranged_for->identifier);
   gta_ast_node_destroy(ranged_for->expression);
   gta_ast_node_destroy(ranged_for->iterator);
+  gta_ast_node_destroy(ranged_for->index);
   gta_ast_node_destroy(ranged_for->block);
   gcu_free(self);
 }
@@ -222,6 +245,7 @@ void gta_ast_node_ranged_for_walk(GTA_Ast_Node * self, GTA_Ast_Node_Walk_Callbac
   gta_ast_node_walk(ranged_for->identifier, callback, data, return_value);
   gta_ast_node_walk(ranged_for->expression, callback, data, return_value);
   gta_ast_node_walk(ranged_for->iterator, callback, data, return_value);
+  gta_ast_node_walk(ranged_for->index, callback, data, return_value);
   gta_ast_node_walk(ranged_for->block, callback, data, return_value);
 }
 
@@ -231,8 +255,8 @@ GTA_Ast_Node * gta_ast_node_ranged_for_analyze(GTA_Ast_Node * self, GTA_Program
   assert(GTA_AST_IS_RANGED_FOR(self));
   GTA_Ast_Node_Ranged_For * ranged_for = (GTA_Ast_Node_Ranged_For *) self;
 
-  GTA_Ast_Node * items[] = {ranged_for->identifier, ranged_for->expression, ranged_for->iterator, ranged_for->block};
-  for (size_t i = 0; i < 4; ++i) {
+  GTA_Ast_Node * items[] = {ranged_for->identifier, ranged_for->expression, ranged_for->iterator, ranged_for->index, ranged_for->block};
+  for (size_t i = 0; i < 5; ++i) {
     GTA_Ast_Node * error = gta_ast_node_analyze(items[i], program, scope);
     if (error) {
       return error;
@@ -260,6 +284,14 @@ bool gta_ast_node_ranged_for_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compil
     return false;
   }
 
+  // Find where the index is stored.  It will always be local.
+  GTA_Ast_Node_Identifier * index = (GTA_Ast_Node_Identifier *)ranged_for->index;
+  GTA_HashX_Value index_stack_location = GTA_HASHX_GET(index->scope->variable_positions, index->mangled_name_hash);
+  if (!index_stack_location.exists) {
+    printf("Error: Identifier %s not found in local positions.\n", index->mangled_name);
+    return false;
+  }
+
   // Find where the ranged-for variable is stored.  It may not be local.
   GTA_Ast_Node_Identifier * identifier = (GTA_Ast_Node_Identifier *)ranged_for->identifier;
   GTA_HashX_Value identifier_stack_location = GTA_HASHX_GET(identifier->scope->variable_positions, identifier->mangled_name_hash);
@@ -275,54 +307,39 @@ bool gta_ast_node_ranged_for_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compil
 
   // Jump labels.
   GTA_Integer get_next_iterator_value;
-  GTA_Integer end_of_loop;
   GTA_Integer original_break_label = context->break_label;
   GTA_Integer original_continue_label = context->continue_label;
 
   // Compile the expression.
   return true
   // Create jump labels.
+  // The end of the loop is the break label, because both leave a single
+  // value on the stack: the reason that the iteration stopped, or null.
     && ((get_next_iterator_value = gta_compiler_context_get_label(context)) >= 0)
-    && ((end_of_loop = gta_compiler_context_get_label(context)) >= 0)
     && ((context->continue_label = gta_compiler_context_get_label(context)) >= 0)
     && ((context->break_label = gta_compiler_context_get_label(context)) >= 0)
 
   // Compile the iterator expression.
     && gta_ast_node_compile_to_bytecode(ranged_for->expression, context)
-  // ITERATOR ; pushes the iterator, pushes true if the iterator is valid,
-  //            otherwise false.
+  // ITERATOR_LOCAL (fp + iterator offset) (fp + index offset)
+  //   ; pops the collection, stores it (if it is an array) or its iterator in
+  //   ; the iterator variable, and resets the index.
     && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_ITERATOR))
-  // JMPF end_of_loop ; jump to the end of the loop if the iterator is invalid.
-  //                    'false' and iterator error will be on stack.
-    && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_JMPF))
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(0))
-    && gta_compiler_context_add_label_jump(context, end_of_loop, context->program->bytecode->count - 1)
-  // POP ; pop the iterator T/F value.
-    && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_POP))
-  // Iterator is on top of the stack.
-  // POKE_LOCAL (fp + iterator offset) ; store the iterator in the local variable.
-    && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_POKE_LOCAL))
+    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_ITERATOR_LOCAL))
     && GTA_VECTORX_APPEND(context->program->bytecode, iterator_stack_location.value)
+    && GTA_VECTORX_APPEND(context->program->bytecode, index_stack_location.value)
 
-  // The iterator is on the top of the stack.
   // get_next_iterator_value:
-  //   ITERATOR_NEXT
-  //   JMPF end_of_loop ; jump to the end of the loop if the iterator is
-  //                     ; invalid.  'false' and iterator error left on stack.
+  //   ITERATOR_NEXT_LOCAL (fp + iterator offset) (fp + index offset) break_label
+  //     ; pushes the next value, or pushes the iterator end (or error) and
+  //     ; jumps to the end of the loop.
     && gta_compiler_context_set_label(context, get_next_iterator_value, context->program->bytecode->count)
     && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_ITERATOR_NEXT))
-    && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_JMPF))
+    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_ITERATOR_NEXT_LOCAL))
+    && GTA_VECTORX_APPEND(context->program->bytecode, iterator_stack_location.value)
+    && GTA_VECTORX_APPEND(context->program->bytecode, index_stack_location.value)
     && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(0))
-    && gta_compiler_context_add_label_jump(context, end_of_loop, context->program->bytecode->count - 1)
-  //   POP ; pop the iterator T/F value.  Iterator current value left on stack.
-    && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_POP))
+    && gta_compiler_context_add_label_jump(context, context->break_label, context->program->bytecode->count - 1)
 
   // Assign the current iterator value to the iterator identifier variable.
   //   ADOPT
@@ -342,24 +359,14 @@ bool gta_ast_node_ranged_for_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compil
     && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
     && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_POP))
 
-  // Load the iterator value.
   // continue_label:
-  //   PEEK_LOCAL (fp + iterator offset)
   //   JMP get_next_iterator_value
     && gta_compiler_context_set_label(context, context->continue_label, context->program->bytecode->count)
     && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_PEEK_LOCAL))
-    && GTA_VECTORX_APPEND(context->program->bytecode, iterator_stack_location.value)
-    && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
     && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_JMP))
     && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(0))
     && gta_compiler_context_add_label_jump(context, get_next_iterator_value, context->program->bytecode->count - 1)
 
-  // end_of_loop:
-  //   POP                   ; pop the iterator T/F value.
-    && gta_compiler_context_set_label(context, end_of_loop, context->program->bytecode->count)
-    && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_POP))
   // context->break_label:
     && gta_compiler_context_set_label(context, context->break_label, context->program->bytecode->count)
   // Restore the original break and continue labels.
@@ -379,6 +386,11 @@ bool gta_ast_node_ranged_for_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_
 
   // Offsets.
   void * vtable_offset = &((GTA_Computed_Value *)0)->vtable;
+  GTA_VectorX * * elements_offset = &((GTA_Computed_Value_Array *)0)->elements;
+  GTA_TypeX_Union * * data_offset = &((GTA_VectorX *)0)->data;
+  size_t * count_offset = &((GTA_VectorX *)0)->count;
+  GTA_Integer * start_offset = &((GTA_Computed_Value_Range *)0)->start;
+  GTA_Integer * end_offset = &((GTA_Computed_Value_Range *)0)->end;
 
   // Find where the iterator is stored.  It will always be local.
   GTA_Ast_Node_Identifier * iterator = (GTA_Ast_Node_Identifier *)ranged_for->iterator;
@@ -389,6 +401,15 @@ bool gta_ast_node_ranged_for_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_
   }
   int32_t iterator_stack_location_offset = ((int32_t)GTA_TYPEX_UI(iterator_stack_location.value) + 1) * -8;
 
+  // Find where the index is stored.  It will always be local.
+  GTA_Ast_Node_Identifier * index = (GTA_Ast_Node_Identifier *)ranged_for->index;
+  GTA_HashX_Value index_stack_location = GTA_HASHX_GET(index->scope->variable_positions, index->mangled_name_hash);
+  if (!index_stack_location.exists) {
+    printf("Error: Identifier %s not found in local positions.\n", index->mangled_name);
+    return false;
+  }
+  int32_t index_stack_location_offset = ((int32_t)GTA_TYPEX_UI(index_stack_location.value) + 1) * -8;
+
   // Find where the ranged-for variable is stored.  It may not be local.
   GTA_Ast_Node_Identifier * identifier = (GTA_Ast_Node_Identifier *)ranged_for->identifier;
   GTA_HashX_Value identifier_stack_location = GTA_HASHX_GET(identifier->scope->variable_positions, identifier->mangled_name_hash);
@@ -402,9 +423,16 @@ bool gta_ast_node_ranged_for_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_
     }
   }
   int32_t identifier_stack_location_offset = ((int32_t)GTA_TYPEX_UI(identifier_stack_location.value) + 1) * -8;
+  GTA_Register identifier_register = (!identifier_is_local || (identifier->scope == context->register_cache.scope))
+    ? gta_register_cache_find(&context->register_cache, !identifier_is_local, identifier_stack_location_offset)
+    : GTA_REG_NONE;
 
   // Jump labels.
   GTA_Integer top_of_loop;
+  GTA_Integer not_an_array;
+  GTA_Integer next_from_iterator;
+  GTA_Integer have_value;
+  GTA_Integer end_of_array;
   GTA_Integer get_next_iterator_value;
   GTA_Integer end_of_loop;
   GTA_Integer original_break_label = context->break_label;
@@ -413,35 +441,71 @@ bool gta_ast_node_ranged_for_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_
   // This is long and messy.  Example code and psudocode is below.
   // for (a:<expression>) {<block>}
   //   1. Evaluate the expression.
-  //   2. Get the iterator.
-  //   3. If the iterator fails, jump to the end of the loop.
-  //   4. Save the iterator.
-  //   5. Call the iterator next.
-  //   6. If the iterator next fails, jump to the end of the loop.
-  //   7. Adopt the iterator value.
-  //   8. Assign the iterator value to the ranged-for variable.
-  //   9. Execute the block.
-  //   10. Load the iterator.
-  //   11. Jump to 5.
+  //   2. Save the collection and reset the index.  If the collection is an
+  //      array or a range, then it is read directly, so skip to 5.
+  //   3. Get the iterator, and save it.
+  //   4. If the iterator fails, jump to the end of the loop.
+  //   5. Load the collection.  If it is not an array, skip to 7.
+  //   6. Read the element at the index and advance the index, then skip to 9.
+  //      If the index is past the end of the array, jump to the end of the
+  //      loop.
+  //   7. If the collection is not a range, skip to 8.  Otherwise, create the
+  //      integer at the index and advance the index, then skip to 9.  If the
+  //      index is past the end of the range, jump to the end of the loop.
+  //   8. Call the iterator next.  If it fails, jump to the end of the loop.
+  //   9. Adopt the value.
+  //   10. Assign the value to the ranged-for variable.
+  //   11. Execute the block.
+  //   12. Jump to 5.
 
   // Compile the expression.
   return true
   // Create jump labels.
     && ((top_of_loop = gta_compiler_context_get_label(context)) >= 0)
+    && ((not_an_array = gta_compiler_context_get_label(context)) >= 0)
+    && ((next_from_iterator = gta_compiler_context_get_label(context)) >= 0)
+    && ((have_value = gta_compiler_context_get_label(context)) >= 0)
+    && ((end_of_array = gta_compiler_context_get_label(context)) >= 0)
     && ((context->continue_label = get_next_iterator_value = gta_compiler_context_get_label(context)) >= 0)
     && ((context->break_label = end_of_loop = gta_compiler_context_get_label(context)) >= 0)
 
   // 1. Compile the iterator expression.  Result in RAX.
     && gta_ast_node_compile_to_binary__x86_64(ranged_for->expression, context)
 
-  // 2. gta_computed_value_iterator_get(RAX, context). Result in RAX.
+  // 2. Save the collection and reset the index.
+  //   mov [r12 + iterator_stack_location_offset], rax
+  //   mov rcx, 0
+  //   mov [r12 + index_stack_location_offset], rcx
+    && gta_mov_ind_reg__x86_64(v, GTA_REG_R12, GTA_REG_NONE, 0, iterator_stack_location_offset, GTA_REG_RAX)
+    && gta_mov_reg_imm__x86_64(v, GTA_REG_RCX, 0)
+    && gta_mov_ind_reg__x86_64(v, GTA_REG_R12, GTA_REG_NONE, 0, index_stack_location_offset, GTA_REG_RCX)
+  //   mov rcx, [rax + vtable_offset]
+  //   mov rdx, &gta_computed_value_array_vtable
+  //   cmp rcx, rdx
+  //   je top_of_loop
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_RCX, GTA_REG_RAX, GTA_REG_NONE, 0, (GTA_Integer)vtable_offset)
+    && gta_mov_reg_imm__x86_64(v, GTA_REG_RDX, (int64_t)&gta_computed_value_array_vtable)
+    && gta_cmp_reg_reg__x86_64(v, GTA_REG_RCX, GTA_REG_RDX)
+    && gta_jcc__x86_64(v, GTA_CC_E, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, top_of_loop, v->count - 4)
+  //   mov rdx, &gta_computed_value_range_vtable
+  //   cmp rcx, rdx
+  //   je top_of_loop
+    && gta_mov_reg_imm__x86_64(v, GTA_REG_RDX, (int64_t)&gta_computed_value_range_vtable)
+    && gta_cmp_reg_reg__x86_64(v, GTA_REG_RCX, GTA_REG_RDX)
+    && gta_jcc__x86_64(v, GTA_CC_E, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, top_of_loop, v->count - 4)
+
+  // 3. gta_computed_value_iterator_get(RAX, context). Result in RAX.
   //   mov GTA_X86_64_R1, rax
   //   mov GTA_X86_64_R2, context
+  //   mov [r12 + iterator_stack_location_offset], rax
     && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R1, GTA_REG_RAX)
     && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R2, GTA_REG_R15)
     && gta_binary_call__x86_64(v, (uint64_t)&gta_computed_value_iterator_get)
+    && gta_mov_ind_reg__x86_64(v, GTA_REG_R12, GTA_REG_NONE, 0, iterator_stack_location_offset, GTA_REG_RAX)
 
-  // 3. If the iterator fails, jump to the end of the loop.
+  // 4. If the iterator fails, jump to the end of the loop.
   //   mov GTA_X86_64_R1, [rax + vtable_offset]
   //   mov GTA_X86_64_R2, &gta_computed_value_iterator_vtable
   //   cmp GTA_X86_64_R1, GTA_X86_64_R2
@@ -452,21 +516,109 @@ bool gta_ast_node_ranged_for_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_
     && gta_jcc__x86_64(v, GTA_CC_NE, 0xDEADBEEF)
     && gta_compiler_context_add_label_jump(context, end_of_loop, v->count - 4)
 
-  // 4. Save the iterator.
-  //   mov [r12 + iterator_stack_location_offset], rax
-    && gta_mov_ind_reg__x86_64(v, GTA_REG_R12, GTA_REG_NONE, 0, iterator_stack_location_offset, GTA_REG_RAX)
+  // 5. Load the collection.
+  // top_of_loop:
+  //   mov rax, [r12 + iterator_stack_location_offset]
+  //   mov rcx, [rax + vtable_offset]
+  //   mov rdx, &gta_computed_value_array_vtable
+  //   cmp rcx, rdx
+  //   jne not_an_array
+    && gta_compiler_context_set_label(context, top_of_loop, v->count)
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_RAX, GTA_REG_R12, GTA_REG_NONE, 0, iterator_stack_location_offset)
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_RCX, GTA_REG_RAX, GTA_REG_NONE, 0, (GTA_Integer)vtable_offset)
+    && gta_mov_reg_imm__x86_64(v, GTA_REG_RDX, (int64_t)&gta_computed_value_array_vtable)
+    && gta_cmp_reg_reg__x86_64(v, GTA_REG_RCX, GTA_REG_RDX)
+    && gta_jcc__x86_64(v, GTA_CC_NE, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, not_an_array, v->count - 4)
+
+  // 6. Read the element at the index.  The elements are loaded afresh each
+  //    time, because the block may change the array.
+  //   mov rdx, [rax + elements_offset]
+  //   mov rcx, [r12 + index_stack_location_offset]
+  //   mov r8, [rdx + count_offset]
+  //   cmp rcx, r8
+  //   jae end_of_array
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_RDX, GTA_REG_RAX, GTA_REG_NONE, 0, (GTA_Integer)elements_offset)
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_RCX, GTA_REG_R12, GTA_REG_NONE, 0, index_stack_location_offset)
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_R8, GTA_REG_RDX, GTA_REG_NONE, 0, (GTA_Integer)count_offset)
+    && gta_cmp_reg_reg__x86_64(v, GTA_REG_RCX, GTA_REG_R8)
+    && gta_jcc__x86_64(v, GTA_CC_AE, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, end_of_array, v->count - 4)
+  //   mov r8, [rdx + data_offset]
+  //   mov rax, [r8 + rcx * 8]
+  //   add rcx, 1
+  //   mov [r12 + index_stack_location_offset], rcx
+  //   jmp have_value
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_R8, GTA_REG_RDX, GTA_REG_NONE, 0, (GTA_Integer)data_offset)
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_RAX, GTA_REG_R8, GTA_REG_RCX, 8, 0)
+    && gta_add_reg_imm__x86_64(v, GTA_REG_RCX, 1)
+    && gta_mov_ind_reg__x86_64(v, GTA_REG_R12, GTA_REG_NONE, 0, index_stack_location_offset, GTA_REG_RCX)
+    && gta_jmp__x86_64(v, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, have_value, v->count - 4)
+
+  // 7. Create the integer at the index of the range.  The index counts up
+  //    from 0, and the length of the range is compared unsigned, so neither
+  //    can overflow.
+  // not_an_array:
+  //   mov rdx, &gta_computed_value_range_vtable
+  //   cmp rcx, rdx
+  //   jne next_from_iterator
+    && gta_compiler_context_set_label(context, not_an_array, v->count)
+    && gta_mov_reg_imm__x86_64(v, GTA_REG_RDX, (int64_t)&gta_computed_value_range_vtable)
+    && gta_cmp_reg_reg__x86_64(v, GTA_REG_RCX, GTA_REG_RDX)
+    && gta_jcc__x86_64(v, GTA_CC_NE, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, next_from_iterator, v->count - 4)
+  //   mov rcx, [r12 + index_stack_location_offset]
+  //   mov rdx, [rax + start_offset]
+  //   mov r8, [rax + end_offset]
+  //   cmp rdx, r8
+  //   jge end_of_array
+  //   sub r8, rdx
+  //   cmp rcx, r8
+  //   jae end_of_array
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_RCX, GTA_REG_R12, GTA_REG_NONE, 0, index_stack_location_offset)
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_RDX, GTA_REG_RAX, GTA_REG_NONE, 0, (GTA_Integer)start_offset)
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_R8, GTA_REG_RAX, GTA_REG_NONE, 0, (GTA_Integer)end_offset)
+    && gta_cmp_reg_reg__x86_64(v, GTA_REG_RDX, GTA_REG_R8)
+    && gta_jcc__x86_64(v, GTA_CC_GE, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, end_of_array, v->count - 4)
+    && gta_sub_reg_reg__x86_64(v, GTA_REG_R8, GTA_REG_RDX)
+    && gta_cmp_reg_reg__x86_64(v, GTA_REG_RCX, GTA_REG_R8)
+    && gta_jcc__x86_64(v, GTA_CC_AE, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, end_of_array, v->count - 4)
+  //   add rdx, rcx
+  //   add rcx, 1
+  //   mov [r12 + index_stack_location_offset], rcx
+    && gta_add_reg_reg__x86_64(v, GTA_REG_RDX, GTA_REG_RCX)
+    && gta_add_reg_imm__x86_64(v, GTA_REG_RCX, 1)
+    && gta_mov_ind_reg__x86_64(v, GTA_REG_R12, GTA_REG_NONE, 0, index_stack_location_offset, GTA_REG_RCX)
+  // gta_computed_value_integer_create(rdx, context). Result in RAX.
+  //   mov GTA_X86_64_R1, rdx
+  //   mov GTA_X86_64_R2, r15
+    && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R1, GTA_REG_RDX)
+    && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R2, GTA_REG_R15)
+    && gta_binary_call__x86_64(v, (uint64_t)&gta_computed_value_integer_create)
+  // If the integer could not be created, then the value is an error.
+  //   mov GTA_X86_64_Scratch1, gta_computed_value_error_out_of_memory
+  //   test rax, rax
+  //   cmovz rax, GTA_X86_64_Scratch1
+  //   jmp have_value
+    && gta_mov_reg_imm__x86_64(v, GTA_X86_64_Scratch1, (int64_t)gta_computed_value_error_out_of_memory)
+    && gta_test_reg_reg__x86_64(v, GTA_REG_RAX, GTA_REG_RAX)
+    && gta_cmovcc_reg_reg__x86_64(v, GTA_CC_Z, GTA_REG_RAX, GTA_X86_64_Scratch1)
+    && gta_jmp__x86_64(v, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, have_value, v->count - 4)
 
-  // 5. Call the iterator next.
+  // 8. Call the iterator next.
   // gta_computed_value_iterator_iterator_next(RAX, context). Result in RAX.
+  // next_from_iterator:
   //   mov GTA_X86_64_R1, rax
-  // top_of_loop:
   //   mov GTA_X86_64_R2, context
+    && gta_compiler_context_set_label(context, next_from_iterator, v->count)
     && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R1, GTA_REG_RAX)
-    && gta_compiler_context_set_label(context, top_of_loop, v->count)
     && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R2, GTA_REG_R15)
     && gta_binary_call__x86_64(v, (uint64_t)&gta_computed_value_iterator_iterator_next)
-
-  // 6. If the iterator next fails, jump to the end of the loop.
+  // If the iterator next fails, jump to the end of the loop.
   //  mov GTA_X86_64_R1, gta_computed_value_error_iterator_end
   //  cmp rax, GTA_X86_64_R1
   //  je end_of_loop
@@ -475,27 +627,36 @@ bool gta_ast_node_ranged_for_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_
     && gta_jcc__x86_64(v, GTA_CC_E, 0xDEADBEEF)
     && gta_compiler_context_add_label_jump(context, end_of_loop, v->count - 4)
 
-  // 7. Adopt the value.
+  // 9. Adopt the value.
+  // have_value:
+    && gta_compiler_context_set_label(context, have_value, v->count)
     && gta_binary_adopt__x86_64(context, GTA_REG_RAX, GTA_REG_RDX, GTA_REG_R8, GTA_REG_R9)
 
-  // 8. Assign the iterator value to the ranged-for variable.
+  // 10. Assign the iterator value to the ranged-for variable.
   //   mov [REG(12 or 13) + identifier_stack_location_offset], rax
     && gta_mov_ind_reg__x86_64(v, identifier_is_local ? GTA_REG_R12 : GTA_REG_R13, GTA_REG_NONE, 0, identifier_stack_location_offset, GTA_REG_RAX)
+  // If the variable is held in a register, then update the register as well.
+  //   mov identifier_register, rax
+    && ((identifier_register == GTA_REG_NONE) || gta_mov_reg_reg__x86_64(v, identifier_register, GTA_REG_RAX))
 
-  // 9. Execute the block.
+  // 11. Execute the block.
     && gta_ast_node_compile_to_binary__x86_64(ranged_for->block, context)
 
-  // 10. Load the iterator.
+  // 12. Jump to 5.
   // get_next_iterator_value:
-  //   mov GTA_X86_64_R1, [r12 + iterator_stack_location_offset]
-    && gta_compiler_context_set_label(context, get_next_iterator_value, v->count)
-    && gta_mov_reg_ind__x86_64(v, GTA_X86_64_R1, GTA_REG_R12, GTA_REG_NONE, 0, iterator_stack_location_offset)
-
-  // 11. Jump to 5.
+  //   <safepoint>
   //   jmp top_of_loop
+    && gta_compiler_context_set_label(context, get_next_iterator_value, v->count)
+    && gta_binary_safepoint__x86_64(context)
     && gta_jmp__x86_64(v, 0xDEADBEEF)
     && gta_compiler_context_add_label_jump(context, top_of_loop, v->count - 4)
 
+  // The array or range has been exhausted.
+  // end_of_array:
+  //   mov rax, gta_computed_value_error_iterator_end
+    && gta_compiler_context_set_label(context, end_of_array, v->count)
+    && gta_mov_reg_imm__x86_64(v, GTA_REG_RAX, (int64_t)gta_computed_value_error_iterator_end)
+
   // end_of_loop:
     && gta_compiler_context_set_label(context, end_of_loop, v->count)
   // Restore the original break and continue labels.
@@ -101,9 +101,14 @@ bool gta_ast_node_string_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_C
   assert(context->program);
   assert(context->program->bytecode);
   assert(context->bytecode_offsets);
+  GTA_Integer constant = gta_compiler_context_add_constant(context, singleton);
+  if (constant < 0) {
+    return false;
+  }
+
   return GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
     && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_LOAD))
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_P(singleton));
+    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(constant));
 }
 
 
@@ -142,7 +142,16 @@ GTA_Ast_Node * gta_ast_node_unary_analyze(GTA_Ast_Node * self, GTA_Program * pro
   assert(GTA_AST_IS_UNARY(self));
   GTA_Ast_Node_Unary * unary = (GTA_Ast_Node_Unary *) self;
 
-  return gta_ast_node_analyze(unary->expression, program, scope);
+  GTA_Ast_Node * result = gta_ast_node_analyze(unary->expression, program, scope);
+  if (!result) {
+    // A logical not always produces a boolean.
+    self->possible_type = unary->operator_type == GTA_UNARY_TYPE_NOT
+      ? GTA_AST_POSSIBLE_TYPE_BOOLEAN
+      : unary->expression->possible_type == GTA_AST_POSSIBLE_TYPE_INTEGER
+        ? GTA_AST_POSSIBLE_TYPE_INTEGER
+        : GTA_AST_POSSIBLE_TYPE_UNKNOWN;
+  }
+  return result;
 }
 
 
@@ -223,7 +223,9 @@ bool gta_ast_node_while_compile_to_bytecode(GTA_Ast_Node * self, GTA_Compiler_Co
     && gta_ast_node_compile_to_bytecode(while_node->condition, context)
   // JMPF block_end          ; Value is not popped
     && GTA_BYTECODE_APPEND(context->bytecode_offsets, context->program->bytecode->count)
-    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_JMPF))
+    && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(GTA_AST_POSSIBLE_TYPE_IS_BOOLEAN(while_node->condition->possible_type)
+      ? GTA_BYTECODE_JMPF_BOOLEAN
+      : GTA_BYTECODE_JMPF))
     && GTA_VECTORX_APPEND(context->program->bytecode, GTA_TYPEX_MAKE_UI(0))
     && gta_compiler_context_add_label_jump(context, block_end, context->program->bytecode->count - 1)
   // POP                     ; Pop the condition value
@@ -273,6 +275,9 @@ bool gta_ast_node_while_compile_to_binary__x86_64(GTA_Ast_Node * self, GTA_Compi
     && ((context->break_label = block_end = gta_compiler_context_get_label(context)) >= 0)
   // condition_start:        ; Start of the while loop
     && gta_compiler_context_set_label(context, condition_start, v->count)
+  // Perform a garbage collection, if one is due, and count the safepoint
+  // against the execution budget.
+    && gta_binary_safepoint__x86_64(context)
   // Compile the condition.
     && gta_ast_node_compile_to_binary__x86_64(while_node->condition, context)
   // ; The condition result is in RAX.
@@ -1,5 +1,6 @@
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
@@ -9,7 +10,9 @@
 #include <tang/computedValue/computedValueError.h>
 #include <tang/computedValue/computedValueInteger.h>
 #include <tang/computedValue/computedValueIterator.h>
+#include <tang/computedValue/computedValueMap.h>
 #include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
 
 
 /**
@@ -70,6 +73,147 @@ GTA_INIT_FUNCTION(setup) {
 }
 
 
+/**
+ * Whether or not a value is a container which may be modified in place.
+ *
+ * @param value The value.
+ * @return True if the value is an array or a map.
+ */
+static bool is_container(GTA_Computed_Value * value) {
+  return GTA_COMPUTED_VALUE_IS_ARRAY(value) || GTA_COMPUTED_VALUE_IS_MAP(value);
+}
+
+
+/**
+ * Copy elements from one array into another.
+ *
+ * Containers are copied (which is cheap, because the copies share their
+ * contents), so that the target does not share them with the source.  All
+ * other values are immutable, so they are shared.
+ *
+ * @param target The elements to write.
+ * @param source The elements to copy.
+ * @param count The number of elements to copy.
+ * @param context The execution context in which to create the copies.
+ * @return True on success, false on failure.
+ */
+static bool copy_elements(GTA_TypeX_Union * target, const GTA_TypeX_Union * source, size_t count, GTA_Execution_Context * context) {
+  for (size_t i = 0; i < count; ++i) {
+    GTA_Computed_Value * element = GTA_TYPEX_P(source[i]);
+    if (is_container(element)) {
+      element = gta_computed_value_deep_copy(element, context);
+      if (!element || GTA_COMPUTED_VALUE_IS_ERROR(element)) {
+        return false;
+      }
+      element->is_temporary = false;
+    }
+    target[i] = GTA_TYPEX_MAKE_P(element);
+  }
+  return true;
+}
+
+
+/**
+ * Release an array's reference to its elements vector, destroying the vector
+ * if no other array shares it.
+ *
+ * @param self The array.
+ */
+static void release_elements(GTA_Computed_Value_Array * self) {
+  if (self->shared_count && (atomic_fetch_sub_explicit(self->shared_count, 1, memory_order_acq_rel) != 1)) {
+    // Another array still uses the vector.
+    return;
+  }
+  if (self->shared_count) {
+    gcu_free(self->shared_count);
+  }
+  GTA_VECTORX_DESTROY(self->elements);
+}
+
+
+/**
+ * Make sure that an array does not share its elements vector with any other
+ * array, so that the vector may be written to.
+ *
+ * @param self The array.
+ * @return True on success, false on failure.
+ */
+static bool own_elements(GTA_Computed_Value_Array * self) {
+  if (!self->shared_count) {
+    return true;
+  }
+  if (atomic_load_explicit(self->shared_count, memory_order_acquire) == 1) {
+    // The other arrays have all been destroyed, so the vector is no longer
+    // shared.
+    gcu_free(self->shared_count);
+    self->shared_count = NULL;
+    return true;
+  }
+
+  GTA_VectorX * elements = GTA_VECTORX_CREATE(self->elements->count);
+  if (!elements) {
+    return false;
+  }
+  if (!copy_elements(elements->data, self->elements->data, self->elements->count, self->base.context)) {
+    GTA_VECTORX_DESTROY(elements);
+    return false;
+  }
+  elements->count = self->elements->count;
+
+  release_elements(self);
+  self->elements = elements;
+  self->shared_count = NULL;
+  return true;
+}
+
+
+/**
+ * Create a copy of an array which shares its elements vector.
+ *
+ * @param self The array to copy.
+ * @param context The execution context of the array.
+ * @return The copy or an error on failure.
+ */
+static GTA_Computed_Value * share_elements(GTA_Computed_Value_Array * self, GTA_Execution_Context * context) {
+  GTA_Computed_Value_Array * copy = gcu_malloc(sizeof(GTA_Computed_Value_Array));
+  if (!copy) {
+    return gta_computed_value_error_out_of_memory;
+  }
+  if (!self->shared_count) {
+    if (!(self->shared_count = gcu_malloc(sizeof(*self->shared_count)))) {
+      gcu_free(copy);
+      return gta_computed_value_error_out_of_memory;
+    }
+    atomic_init(self->shared_count, 1);
+  }
+  atomic_fetch_add_explicit(self->shared_count, 1, memory_order_relaxed);
+
+  *copy = (GTA_Computed_Value_Array) {
+    .base = {
+      .vtable = &gta_computed_value_array_vtable,
+      .context = context,
+      .is_true = false,
+      .is_error = false,
+      .is_temporary = true,
+      .requires_deep_copy = false,
+      .is_singleton = false,
+      .is_a_reference = false,
+    },
+    .elements = self->elements,
+    .shared_count = self->shared_count,
+  };
+
+  // Only the array itself is new memory.  The shared vector stays counted
+  // once, by the array which created it (see
+  // gta_garbage_collector_set_quota()).
+  if (!gta_garbage_collector_register(context, (GTA_Computed_Value *)copy, sizeof(GTA_Computed_Value_Array))) {
+    gta_computed_value_array_destroy(&copy->base);
+    return gta_computed_value_error_out_of_memory;
+  }
+  return (GTA_Computed_Value *)copy;
+}
+
+
 GTA_Computed_Value * GTA_CALL gta_computed_value_array_create(size_t size, GTA_Execution_Context * context) {
   assert(context);
 
@@ -82,8 +226,8 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_array_create(size_t size, GTA_E
     return gta_computed_value_error_out_of_memory;
   }
   if (context) {
-    // Attempt to add the pointer to the context's garbage collection list.
-    if (!GTA_VECTORX_APPEND(context->garbage_collection, GTA_TYPEX_MAKE_P(self))) {
+    // Register the value with the garbage collector.
+    if (!gta_garbage_collector_register(context, (GTA_Computed_Value *)self, sizeof(GTA_Computed_Value_Array) + size * sizeof(GTA_TypeX_Union))) {
       gta_computed_value_array_destroy_in_place(&self->base);
       return gta_computed_value_error_out_of_memory;
     }
@@ -105,6 +249,7 @@ bool GTA_CALL gta_computed_value_array_create_in_place(GTA_Computed_Value_Array
       .is_a_reference = false,
     },
     .elements = GTA_VECTORX_CREATE(size),
+    .shared_count = NULL,
   };
   return self->elements != NULL;
 }
@@ -120,7 +265,7 @@ void GTA_CALL gta_computed_value_array_destroy(GTA_Computed_Value * self) {
 void GTA_CALL gta_computed_value_array_destroy_in_place(GTA_Computed_Value * self) {
   assert(self);
   assert(GTA_COMPUTED_VALUE_IS_ARRAY(self));
-  GTA_VECTORX_DESTROY(((GTA_Computed_Value_Array *) self)->elements);
+  release_elements((GTA_Computed_Value_Array *) self);
 }
 
 
@@ -128,6 +273,14 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_array_deep_copy(GTA_Computed_Va
   assert(value);
   assert(GTA_COMPUTED_VALUE_IS_ARRAY(value));
   GTA_Computed_Value_Array * self = (GTA_Computed_Value_Array *)value;
+
+  // Within a context, the copy shares the elements until one of the arrays
+  // is written to.  The elements of an array in another context belong to
+  // that context's garbage collector, so they must be copied.
+  if (context && (value->context == context)) {
+    return share_elements(self, context);
+  }
+
   GTA_Computed_Value_Array * copy = (GTA_Computed_Value_Array *)gta_computed_value_array_create(self->elements->count, context);
   if (!copy) {
     return gta_computed_value_error_out_of_memory;
@@ -244,6 +397,10 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_array_index_assign(GTA_Computed
     return gta_computed_value_error_invalid_index;
   }
 
+  if (!own_elements(array)) {
+    return gta_computed_value_error_out_of_memory;
+  }
+
   // Expand the array if the index is beyond the current bounds.
   if (normalized_index >= (GTA_Integer)array->elements->count) {
     size_t new_size = normalized_index + 1;
@@ -295,8 +452,10 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_array_add(GTA_Computed_Value *
   }
 
   // Copy the elements from the two arrays into the new array.
-  memcpy(result->elements->data, lhs->elements->data, sizeof(GTA_TypeX_Union) * lhs->elements->count);
-  memcpy(result->elements->data + lhs->elements->count, rhs->elements->data, sizeof(GTA_TypeX_Union) * rhs->elements->count);
+  if (!copy_elements(result->elements->data, lhs->elements->data, lhs->elements->count, context)
+    || !copy_elements(result->elements->data + lhs->elements->count, rhs->elements->data, rhs->elements->count, context)) {
+    return gta_computed_value_error_out_of_memory;
+  }
 
   // Update the count of the new array.
   result->elements->count = lhs->elements->count + rhs->elements->count;
@@ -427,7 +586,7 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_array_not_equal(GTA_Computed_Va
 
 GTA_Computed_Value * GTA_CALL gta_computed_value_array_append(GTA_Computed_Value_Array * self, GTA_Computed_Value * value, GTA_MAYBE_UNUSED(GTA_Execution_Context * context)) {
   assert(self);
-  if (!GTA_VECTORX_APPEND(self->elements, GTA_TYPEX_MAKE_P(value))) {
+  if (!own_elements(self) || !GTA_VECTORX_APPEND(self->elements, GTA_TYPEX_MAKE_P(value))) {
     return gta_computed_value_error_out_of_memory;
   }
   value->is_temporary = false;
@@ -456,7 +615,16 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_array_index(GTA_Computed_Value
     return gta_computed_value_null;
   }
 
-  return GTA_TYPEX_P(array->elements->data[normalized_index]);
+  GTA_Computed_Value * element = GTA_TYPEX_P(array->elements->data[normalized_index]);
+  if (array->shared_count && is_container(element)) {
+    // The caller may write to the element, which the other arrays must not
+    // see.
+    if (!own_elements(array)) {
+      return gta_computed_value_error_out_of_memory;
+    }
+    element = GTA_TYPEX_P(array->elements->data[normalized_index]);
+  }
+  return element;
 }
 
 
@@ -186,6 +186,66 @@ static GTA_Computed_Value_Error gta_computed_value_error_global_rng_seed_not_cha
 };
 
 
+static GTA_Computed_Value_Error gta_computed_value_error_execution_budget_exceeded_singleton = {
+  .base = {
+    .vtable = &gta_computed_value_error_vtable,
+    .context = 0,
+    .is_true = false,
+    .is_error = true,
+    .is_temporary = false,
+    .requires_deep_copy = false,
+    .is_singleton = true,
+    .is_a_reference = false,
+  },
+  .message = "Execution Budget Exceeded",
+};
+
+
+static GTA_Computed_Value_Error gta_computed_value_error_execution_deadline_exceeded_singleton = {
+  .base = {
+    .vtable = &gta_computed_value_error_vtable,
+    .context = 0,
+    .is_true = false,
+    .is_error = true,
+    .is_temporary = false,
+    .requires_deep_copy = false,
+    .is_singleton = true,
+    .is_a_reference = false,
+  },
+  .message = "Execution Deadline Exceeded",
+};
+
+
+static GTA_Computed_Value_Error gta_computed_value_error_memory_quota_exceeded_singleton = {
+  .base = {
+    .vtable = &gta_computed_value_error_vtable,
+    .context = 0,
+    .is_true = false,
+    .is_error = true,
+    .is_temporary = false,
+    .requires_deep_copy = false,
+    .is_singleton = true,
+    .is_a_reference = false,
+  },
+  .message = "Memory Quota Exceeded",
+};
+
+
+static GTA_Computed_Value_Error gta_computed_value_error_output_sink_failed_singleton = {
+  .base = {
+    .vtable = &gta_computed_value_error_vtable,
+    .context = 0,
+    .is_true = false,
+    .is_error = true,
+    .is_temporary = false,
+    .requires_deep_copy = false,
+    .is_singleton = true,
+    .is_a_reference = false,
+  },
+  .message = "Output Sink Failed",
+};
+
+
 GTA_Computed_Value * gta_computed_value_error_not_implemented = (GTA_Computed_Value *)&gta_computed_value_error_not_implemented_singleton;
 GTA_Computed_Value * gta_computed_value_error_out_of_memory = (GTA_Computed_Value *)&gta_computed_value_error_out_of_memory_singleton;
 GTA_Computed_Value * gta_computed_value_error_invalid_bytecode = (GTA_Computed_Value *)&gta_computed_value_error_invalid_bytecode_singleton;
@@ -196,6 +256,10 @@ GTA_Computed_Value * gta_computed_value_error_invalid_index = (GTA_Computed_Valu
 GTA_Computed_Value * gta_computed_value_error_invalid_function_call = (GTA_Computed_Value *)&gta_computed_value_error_invalid_function_call_singleton;
 GTA_Computed_Value * gta_computed_value_error_argument_count_mismatch = (GTA_Computed_Value *)&gta_computed_value_error_argument_count_mismatch_singleton;
 GTA_Computed_Value * gta_computed_value_error_global_rng_seed_not_changeable = (GTA_Computed_Value *)&gta_computed_value_error_global_rng_seed_not_changeable_singleton;
+GTA_Computed_Value * gta_computed_value_error_execution_budget_exceeded = (GTA_Computed_Value *)&gta_computed_value_error_execution_budget_exceeded_singleton;
+GTA_Computed_Value * gta_computed_value_error_execution_deadline_exceeded = (GTA_Computed_Value *)&gta_computed_value_error_execution_deadline_exceeded_singleton;
+GTA_Computed_Value * gta_computed_value_error_memory_quota_exceeded = (GTA_Computed_Value *)&gta_computed_value_error_memory_quota_exceeded_singleton;
+GTA_Computed_Value * gta_computed_value_error_output_sink_failed = (GTA_Computed_Value *)&gta_computed_value_error_output_sink_failed_singleton;
 
 
 char * GTA_CALL gta_computed_value_error_to_string(GTA_Computed_Value * self) {
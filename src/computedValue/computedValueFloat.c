@@ -10,6 +10,7 @@
 #include <tang/computedValue/computedValueInteger.h>
 #include <tang/computedValue/computedValueString.h>
 #include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
 
 GTA_Computed_Value_VTable gta_computed_value_float_vtable = {
   .name = "Float",
@@ -49,8 +50,8 @@ GTA_Computed_Value_Float * GTA_CALL gta_computed_value_float_create(GTA_Float va
     return NULL;
   }
   if(context) {
-    // Attempt to add the pointer to the context's garbage collection list.
-    if (!GTA_VECTORX_APPEND(context->garbage_collection, GTA_TYPEX_MAKE_P(self))) {
+    // Register the value with the garbage collector.
+    if (!gta_garbage_collector_register(context, (GTA_Computed_Value *)self, sizeof(GTA_Computed_Value_Float))) {
       gcu_free(self);
       return NULL;
     }
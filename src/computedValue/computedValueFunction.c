@@ -6,6 +6,7 @@
 #include <tang/computedValue/computedValueError.h>
 #include <tang/computedValue/computedValueFunction.h>
 #include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
 
 GTA_Computed_Value_VTable gta_computed_value_function_vtable = {
   .name = "Function",
@@ -49,8 +50,8 @@ GTA_Computed_Value_Function * GTA_CALL gta_computed_value_function_create(size_t
     return NULL;
   }
   if (context) {
-    // Attempt to add the pointer to the context's garbage collection list.
-    if (!GTA_VECTORX_APPEND(context->garbage_collection, GTA_TYPEX_MAKE_P(self))) {
+    // Register the value with the garbage collector.
+    if (!gta_garbage_collector_register(context, (GTA_Computed_Value *)self, sizeof(GTA_Computed_Value_Function))) {
       gta_computed_value_function_destroy((GTA_Computed_Value *)self);
       return NULL;
     }
@@ -74,6 +75,8 @@ bool GTA_CALL gta_computed_value_function_create_in_place(GTA_Computed_Value_Fun
     },
     .num_arguments = num_arguments,
     .pointer = pointer,
+    .binary = 0,
+    .invocations = 0,
   };
   return true;
 }
@@ -6,6 +6,7 @@
 #include <tang/computedValue/computedValueError.h>
 #include <tang/computedValue/computedValueFunctionNative.h>
 #include <tang/program/compilerContext.h>
+#include <tang/program/garbageCollector.h>
 
 /**
  * The vtable for the GTA_Computed_Value_Function_Native class.
@@ -52,8 +53,8 @@ GTA_Computed_Value_Function_Native * GTA_CALL gta_computed_value_function_native
     return NULL;
   }
   if (context) {
-    // Attempt to add the pointer to the context's garbage collection list.
-    if (!GTA_VECTORX_APPEND(context->garbage_collection, GTA_TYPEX_MAKE_P(self))) {
+    // Register the value with the garbage collector.
+    if (!gta_garbage_collector_register(context, (GTA_Computed_Value *)self, sizeof(GTA_Computed_Value_Function_Native))) {
       gta_computed_value_function_native_destroy((GTA_Computed_Value *)self);
       return (GTA_Computed_Value_Function_Native *)gta_computed_value_error_out_of_memory;
     }
@@ -6,6 +6,7 @@
 #include <tang/computedValue/computedValueError.h>
 #include <tang/computedValue/computedValueIterator.h>
 #include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
 
 GTA_Computed_Value_VTable gta_computed_value_iterator_vtable = {
   .name = "Iterator",
@@ -66,8 +67,8 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_iterator_create(GTA_Computed_Va
     return NULL;
   }
   if (context) {
-    // Attempt to add the pointer to the context's garbage collection list.
-    if (!GTA_VECTORX_APPEND(context->garbage_collection, GTA_TYPEX_MAKE_P(self))) {
+    // Register the value with the garbage collector.
+    if (!gta_garbage_collector_register(context, (GTA_Computed_Value *)self, sizeof(GTA_Computed_Value_Iterator))) {
       gta_computed_value_iterator_destroy_in_place(&self->base);
       return gta_computed_value_error_out_of_memory;
     }
@@ -6,6 +6,7 @@
 #include <tang/computedValue/computedValueError.h>
 #include <tang/computedValue/computedValueLibrary.h>
 #include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
 
 GTA_Computed_Value_VTable gta_computed_value_library_vtable = {
   .name = "Library",
@@ -49,8 +50,8 @@ GTA_Computed_Value_Library * GTA_CALL gta_computed_value_library_create(const ch
     return NULL;
   }
   if (context) {
-    // Attempt to add the pointer to the context's garbage collection list.
-    if (!GTA_VECTORX_APPEND(context->garbage_collection, GTA_TYPEX_MAKE_P(self))) {
+    // Register the value with the garbage collector.
+    if (!gta_garbage_collector_register(context, (GTA_Computed_Value *)self, sizeof(GTA_Computed_Value_Library))) {
       gta_computed_value_library_destroy((GTA_Computed_Value *)self);
       return NULL;
     }
@@ -1,21 +1,25 @@
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <stdio.h>
 #include <cutil/hash.h>
 #include <cutil/memory.h>
+#include <tang/computedValue/computedValueArray.h>
 #include <tang/computedValue/computedValueError.h>
+#include <tang/computedValue/computedValueIterator.h>
 #include <tang/computedValue/computedValueMap.h>
 #include <tang/computedValue/computedValueString.h>
 #include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
 
 
 GTA_Computed_Value_VTable gta_computed_value_map_vtable = {
-  .name = "Iterator",
+  .name = "Map",
   .destroy = gta_computed_value_map_destroy,
   .destroy_in_place = gta_computed_value_map_destroy_in_place,
   .deep_copy = gta_computed_value_map_deep_copy,
-  .to_string = gta_computed_value_null_to_string,
+  .to_string = gta_computed_value_map_to_string,
   .print = gta_computed_value_generic_print_from_to_string,
   .assign_index = gta_computed_value_map_assign_index,
   .add = gta_computed_value_add_not_supported,
@@ -33,7 +37,7 @@ GTA_Computed_Value_VTable gta_computed_value_map_vtable = {
   .period = gta_computed_value_generic_period,
   .index = gta_computed_value_map_index,
   .slice = gta_computed_value_slice_not_supported,
-  .iterator_get = gta_computed_value_iterator_get_not_supported,
+  .iterator_get = gta_computed_value_map_iterator_get,
   .iterator_next = gta_computed_value_iterator_next_not_supported,
   .cast = gta_computed_value_cast_not_supported,
   .call = gta_computed_value_call_not_supported,
@@ -75,6 +79,237 @@ static GTA_Computed_Value_Error gta_computed_value_error_map_key_not_string_sing
 
 GTA_Computed_Value * gta_computed_value_error_map_key_not_string = (GTA_Computed_Value *)&gta_computed_value_error_map_key_not_string_singleton;
 
+
+/**
+ * The smallest number of slots in a table.
+ */
+#define MINIMUM_SLOTS 8
+
+
+/**
+ * Get the number of bytes used by a table.
+ *
+ * @param capacity The number of entries that the table can hold.
+ * @param slot_count The number of slots in the table.
+ * @return The number of bytes.
+ */
+static size_t table_bytes(size_t capacity, size_t slot_count) {
+  return sizeof(GTA_Computed_Value_Map_Table)
+    + (capacity * sizeof(GTA_Computed_Value_Map_Entry))
+    + (slot_count * sizeof(uint32_t));
+}
+
+
+/**
+ * Create an empty table.
+ *
+ * The table is kept at most three quarters full, so that probing always
+ * reaches an empty slot quickly.
+ *
+ * @param size The number of entries that the table must be able to hold.
+ * @return The new table or NULL on failure.
+ */
+static GTA_Computed_Value_Map_Table * table_create(size_t size) {
+  size_t slot_count = MINIMUM_SLOTS;
+  while ((slot_count - (slot_count / 4)) < size) {
+    // The position of an entry (plus one) must fit in a slot.
+    if (slot_count > (UINT32_MAX / 2)) {
+      return NULL;
+    }
+    slot_count *= 2;
+  }
+  size_t capacity = slot_count - (slot_count / 4);
+
+  GTA_Computed_Value_Map_Table * table = gcu_malloc(table_bytes(capacity, slot_count));
+  if (!table) {
+    return NULL;
+  }
+  *table = (GTA_Computed_Value_Map_Table) {
+    .references = 1,
+    .count = 0,
+    .capacity = capacity,
+    .slot_mask = slot_count - 1,
+    .entries = (GTA_Computed_Value_Map_Entry *)(table + 1),
+    .slots = NULL,
+  };
+  table->slots = (uint32_t *)(table->entries + capacity);
+  memset(table->slots, 0, slot_count * sizeof(uint32_t));
+  return table;
+}
+
+
+/**
+ * Get the slot at which the probing for a hash begins.
+ *
+ * @param table The table.
+ * @param hash The hash of the key.
+ * @return The position of the slot.
+ */
+static size_t table_first_slot(const GTA_Computed_Value_Map_Table * table, uint64_t hash) {
+  // Fold the high bits in, since only the low bits select the slot.
+  return (size_t)(hash ^ (hash >> 32)) & table->slot_mask;
+}
+
+
+/**
+ * Find the slot of a key.
+ *
+ * @param table The table.
+ * @param buffer The bytes of the key.
+ * @param length The number of bytes in the key.
+ * @param hash The hash of the key.
+ * @return The position of the slot which refers to the key's entry, or of the
+ *   empty slot at which the key would be inserted.
+ */
+static size_t table_find(const GTA_Computed_Value_Map_Table * table, const char * buffer, size_t length, uint64_t hash) {
+  size_t slot = table_first_slot(table, hash);
+  while (table->slots[slot]) {
+    const GTA_Computed_Value_Map_Entry * entry = &table->entries[table->slots[slot] - 1];
+    if (entry->hash == hash) {
+      // Equal hashes do not guarantee equal keys.
+      const GTA_Unicode_String * key = ((GTA_Computed_Value_String *)entry->key)->value;
+      if ((key->byte_length == length) && !memcmp(key->buffer, buffer, length)) {
+        return slot;
+      }
+    }
+    slot = (slot + 1) & table->slot_mask;
+  }
+  return slot;
+}
+
+
+/**
+ * Create a larger copy of a table.
+ *
+ * The entries (and their order) are unchanged, but the slots are rebuilt.
+ *
+ * @param table The table to copy.
+ * @return The new table or NULL on failure.
+ */
+static GTA_Computed_Value_Map_Table * table_grow(const GTA_Computed_Value_Map_Table * table) {
+  GTA_Computed_Value_Map_Table * grown = table_create(table->capacity * 2);
+  if (!grown) {
+    return NULL;
+  }
+  memcpy(grown->entries, table->entries, table->count * sizeof(GTA_Computed_Value_Map_Entry));
+  grown->count = table->count;
+  for (size_t i = 0; i < grown->count; ++i) {
+    // The keys are already known to be distinct, so only an empty slot is
+    // needed.
+    size_t slot = table_first_slot(grown, grown->entries[i].hash);
+    while (grown->slots[slot]) {
+      slot = (slot + 1) & grown->slot_mask;
+    }
+    grown->slots[slot] = (uint32_t)(i + 1);
+  }
+  return grown;
+}
+
+
+/**
+ * Release a map's reference to its table, destroying the table if no other
+ * map shares it.
+ *
+ * @param self The map.
+ */
+static void release_table(GTA_Computed_Value_Map * self) {
+  if (self->table && (atomic_fetch_sub_explicit(&self->table->references, 1, memory_order_acq_rel) == 1)) {
+    gcu_free(self->table);
+  }
+  self->table = NULL;
+}
+
+
+/**
+ * Make sure that a map does not share its table with any other map, so that
+ * the table may be written to.
+ *
+ * The keys are strings, which are immutable, so they are shared.  Arrays and
+ * maps are copied (which is cheap, because the copies share their contents).
+ *
+ * @param self The map.
+ * @return True on success, false on failure.
+ */
+static bool own_table(GTA_Computed_Value_Map * self) {
+  GTA_Computed_Value_Map_Table * table = self->table;
+  if (atomic_load_explicit(&table->references, memory_order_acquire) == 1) {
+    return true;
+  }
+
+  // The copy has the same layout, so the slots are still valid.
+  size_t slot_count = table->slot_mask + 1;
+  GTA_Computed_Value_Map_Table * copy = gcu_malloc(table_bytes(table->capacity, slot_count));
+  if (!copy) {
+    return false;
+  }
+  *copy = (GTA_Computed_Value_Map_Table) {
+    .references = 1,
+    .count = table->count,
+    .capacity = table->capacity,
+    .slot_mask = table->slot_mask,
+    .entries = (GTA_Computed_Value_Map_Entry *)(copy + 1),
+    .slots = NULL,
+  };
+  copy->slots = (uint32_t *)(copy->entries + copy->capacity);
+  memcpy(copy->entries, table->entries, table->count * sizeof(GTA_Computed_Value_Map_Entry));
+  memcpy(copy->slots, table->slots, slot_count * sizeof(uint32_t));
+
+  for (size_t i = 0; i < copy->count; ++i) {
+    GTA_Computed_Value * value = copy->entries[i].value;
+    if (GTA_COMPUTED_VALUE_IS_ARRAY(value) || GTA_COMPUTED_VALUE_IS_MAP(value)) {
+      value = gta_computed_value_deep_copy(value, self->base.context);
+      if (!value || GTA_COMPUTED_VALUE_IS_ERROR(value)) {
+        gcu_free(copy);
+        return false;
+      }
+      value->is_temporary = false;
+      copy->entries[i].value = value;
+    }
+  }
+
+  release_table(self);
+  self->table = copy;
+  return true;
+}
+
+
+/**
+ * Create a copy of a map which shares its table.
+ *
+ * @param self The map to copy.
+ * @param context The execution context of the map.
+ * @return The copy or an error on failure.
+ */
+static GTA_Computed_Value * share_table(GTA_Computed_Value_Map * self, GTA_Execution_Context * context) {
+  GTA_Computed_Value_Map * copy = gcu_malloc(sizeof(GTA_Computed_Value_Map));
+  if (!copy) {
+    return gta_computed_value_error_out_of_memory;
+  }
+  atomic_fetch_add_explicit(&self->table->references, 1, memory_order_relaxed);
+
+  *copy = (GTA_Computed_Value_Map) {
+    .base = {
+      .vtable = &gta_computed_value_map_vtable,
+      .context = context,
+      .is_true = false,
+      .is_error = false,
+      .is_temporary = false,
+      .requires_deep_copy = false,
+      .is_singleton = false,
+      .is_a_reference = false,
+    },
+    .table = self->table,
+  };
+
+  // Only the map itself is new memory.  The shared table stays counted once,
+  // by the map which created it (see gta_garbage_collector_set_quota()).
+  if (!gta_garbage_collector_register(context, (GTA_Computed_Value *)copy, sizeof(GTA_Computed_Value_Map))) {
+    gta_computed_value_map_destroy(&copy->base);
+    return gta_computed_value_error_out_of_memory;
+  }
+  return (GTA_Computed_Value *)copy;
+}
+
 GTA_Computed_Value * GTA_CALL gta_computed_value_map_create(size_t size, GTA_Execution_Context * context) {
   GTA_Computed_Value_Map * self = gcu_malloc(sizeof(GTA_Computed_Value_Map));
   if (!self) {
@@ -85,9 +320,10 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_map_create(size_t size, GTA_Exe
     return NULL;
   }
   if (context) {
-    // Attempt to add the pointer to the context's garbage collection list.
-    if (!GTA_VECTORX_APPEND(context->garbage_collection, GTA_TYPEX_MAKE_P(self))) {
-      gta_computed_value_map_destroy_in_place(&self->base);
+    // Register the value with the garbage collector.
+    size_t bytes = sizeof(GTA_Computed_Value_Map) + table_bytes(self->table->capacity, self->table->slot_mask + 1);
+    if (!gta_garbage_collector_register(context, (GTA_Computed_Value *)self, bytes)) {
+      gta_computed_value_map_destroy(&self->base);
       return gta_computed_value_error_out_of_memory;
     }
   }
@@ -98,13 +334,9 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_map_create(size_t size, GTA_Exe
 bool GTA_CALL gta_computed_value_map_create_in_place(GTA_Computed_Value_Map * self, size_t size, GTA_Execution_Context * context) {
   assert (self);
 
-  GTA_HashX * key_hash = GTA_HASHX_CREATE(size);
-  if (!key_hash) {
-    goto KEY_HASH_CREATE_FAILED;
-  }
-  GTA_HashX * value_hash = GTA_HASHX_CREATE(size);
-  if (!value_hash) {
-    goto VALUE_HASH_CREATE_FAILED;
+  GTA_Computed_Value_Map_Table * table = table_create(size);
+  if (!table) {
+    return false;
   }
 
   *self = (GTA_Computed_Value_Map){
@@ -118,15 +350,9 @@ bool GTA_CALL gta_computed_value_map_create_in_place(GTA_Computed_Value_Map * se
       .is_singleton = false,
       .is_a_reference = false,
     },
-    .key_hash = key_hash,
-    .value_hash = value_hash,
+    .table = table,
   };
   return true;
-
-VALUE_HASH_CREATE_FAILED:
-  GTA_HASHX_DESTROY(key_hash);
-KEY_HASH_CREATE_FAILED:
-  return false;
 }
 
 
@@ -140,52 +366,41 @@ void GTA_CALL gta_computed_value_map_destroy(GTA_Computed_Value * self) {
 void GTA_CALL gta_computed_value_map_destroy_in_place(GTA_Computed_Value * self) {
   assert(self);
   assert(GTA_COMPUTED_VALUE_IS_MAP(self));
-  GTA_Computed_Value_Map * map = (GTA_Computed_Value_Map *)self;
-
-  GTA_HASHX_DESTROY(map->key_hash);
-  GTA_HASHX_DESTROY(map->value_hash);
+  release_table((GTA_Computed_Value_Map *)self);
 }
 
 
 GTA_Computed_Value * GTA_CALL gta_computed_value_map_deep_copy(GTA_Computed_Value * value, GTA_Execution_Context * context) {
+  assert(value);
+  assert(GTA_COMPUTED_VALUE_IS_MAP(value));
   GTA_Computed_Value_Map * map = (GTA_Computed_Value_Map *)value;
 
+  // Within a context, the copy shares the table until one of the maps is
+  // written to.  The contents of a map in another context belong to that
+  // context's garbage collector, so they must be copied.
+  if (context && (value->context == context)) {
+    return share_table(map, context);
+  }
+
   // Create a new map into which values can be copied.
-  GTA_Computed_Value_Map * map_copy = (GTA_Computed_Value_Map *)gta_computed_value_map_create(map->key_hash->entries, context);
+  GTA_Computed_Value_Map * map_copy = (GTA_Computed_Value_Map *)gta_computed_value_map_create(map->table->count, context);
   if (!map_copy || !GTA_COMPUTED_VALUE_IS_MAP(map_copy)) {
     return gta_computed_value_error_out_of_memory;
   }
 
-  // Copy the keys and values from the original map to the new map.
-  GTA_HashX_Iterator key_iterator = GTA_HASHX_ITERATOR_GET(map->key_hash);
-  GTA_HashX_Iterator value_iterator = GTA_HASHX_ITERATOR_GET(map->value_hash);
-
-  while (key_iterator.exists && value_iterator.exists) {
-    GTA_Computed_Value * key_copy = gta_computed_value_deep_copy((GTA_Computed_Value *)GTA_TYPEX_P(key_iterator.value), context);
-    GTA_Computed_Value * value_copy = gta_computed_value_deep_copy((GTA_Computed_Value *)GTA_TYPEX_P(value_iterator.value), context);
+  // Note: As with arrays, the copy and the copies of its contents are tracked
+  // by the garbage collector of the context, so nothing is explicitly
+  // destroyed if an error occurs.
 
+  // Copy the entries in order, so that the copy iterates in the same order.
+  for (size_t i = 0; i < map->table->count; ++i) {
+    GTA_Computed_Value * key_copy = gta_computed_value_deep_copy(map->table->entries[i].key, context);
+    GTA_Computed_Value * value_copy = gta_computed_value_deep_copy(map->table->entries[i].value, context);
     if (!key_copy
       || !value_copy
-      || !GTA_HASHX_SET(map_copy->key_hash, key_iterator.hash, GTA_TYPEX_MAKE_P(key_copy))
-      || !GTA_HASHX_SET(map_copy->value_hash, value_iterator.hash, GTA_TYPEX_MAKE_P(value_copy))) {
-      gta_computed_value_map_destroy((GTA_Computed_Value *)map_copy);
+      || (gta_computed_value_map_set_key_val(map_copy, key_copy, value_copy) != value_copy)) {
       return gta_computed_value_error_out_of_memory;
     }
-
-    // Make sure that the key and value objects are not marked temporary.
-    key_copy->is_temporary = false;
-    value_copy->is_temporary = false;
-
-    // Advance the iterators.
-    key_iterator = GTA_HASHX_ITERATOR_NEXT(key_iterator);
-    value_iterator = GTA_HASHX_ITERATOR_NEXT(value_iterator);
-  }
-
-  // Sanity check: make sure that the hash tables have the same number of entries.
-  if ((map->key_hash->entries != map_copy->key_hash->entries)
-    || (map->value_hash->entries != map_copy->value_hash->entries)) {
-    gta_computed_value_map_destroy((GTA_Computed_Value *)map_copy);
-    return gta_computed_value_error_out_of_memory;
   }
 
   return (GTA_Computed_Value *)map_copy;
@@ -209,12 +424,90 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_map_index(GTA_Computed_Value *
   }
   GTA_Computed_Value_String * key = (GTA_Computed_Value_String *)index;
 
-  GTA_Integer key_hash = gcu_string_hash_64(key->value->buffer, key->value->byte_length);
-  GTA_HashX_Value result = GTA_HASHX_GET(map->value_hash, key_hash);
-  if (!result.exists) {
+  size_t slot = table_find(map->table, key->value->buffer, key->value->byte_length, gta_computed_value_string_hash(key));
+  if (!map->table->slots[slot]) {
     return gta_computed_value_null;
   }
-  return (GTA_Computed_Value *)GTA_TYPEX_P(result.value);
+  size_t position = map->table->slots[slot] - 1;
+  GTA_Computed_Value * value = map->table->entries[position].value;
+  if (GTA_COMPUTED_VALUE_IS_ARRAY(value) || GTA_COMPUTED_VALUE_IS_MAP(value)) {
+    // The caller may write to the value, which the other maps must not see.
+    // A table of its own keeps the entries in the same positions.
+    if (!own_table(map)) {
+      return gta_computed_value_error_out_of_memory;
+    }
+    value = map->table->entries[position].value;
+  }
+  return value;
+}
+
+
+/**
+ * Helper function used as the 'advance' iterator operation.
+ *
+ * Each value is a [key, value] array.  The array from the previous step is
+ * refilled in place unless something else has taken a copy of it, so that
+ * iterating over a map does not allocate an array for every entry.  The map
+ * is read afresh on every step, so writes to it during the loop are safe.
+ *
+ * @param self The iterator.
+ */
+static void GTA_CALL __advance(GTA_Computed_Value_Iterator * self) {
+  assert(self);
+  assert(GTA_COMPUTED_VALUE_IS_ITERATOR(self));
+  GTA_Computed_Value_Map * map = (GTA_Computed_Value_Map *)self->collection;
+
+  if (self->index >= (GTA_Integer)map->table->count) {
+    self->value = gta_computed_value_error_iterator_end;
+    return;
+  }
+  GTA_Computed_Value_Map_Entry * entry = &map->table->entries[self->index];
+
+  // Arrays and maps are given to the loop as copies (which share their
+  // contents), so that writes through the pair do not change the map.
+  GTA_Computed_Value * value = entry->value;
+  if (GTA_COMPUTED_VALUE_IS_ARRAY(value) || GTA_COMPUTED_VALUE_IS_MAP(value)) {
+    value = gta_computed_value_deep_copy(value, self->base.context);
+    if (!value || GTA_COMPUTED_VALUE_IS_ERROR(value)) {
+      self->value = gta_computed_value_error_out_of_memory;
+      return;
+    }
+    value->is_temporary = false;
+  }
+
+  GTA_Computed_Value_Array * pair = (GTA_Computed_Value_Array *)self->value;
+  if (!self->index
+    || !GTA_COMPUTED_VALUE_IS_ARRAY(pair)
+    || (pair->shared_count && (atomic_load_explicit(pair->shared_count, memory_order_acquire) > 1))
+    || (pair->elements->count != 2)) {
+    pair = (GTA_Computed_Value_Array *)gta_computed_value_array_create(2, self->base.context);
+    if (!pair || !GTA_COMPUTED_VALUE_IS_ARRAY(pair)) {
+      self->value = gta_computed_value_error_out_of_memory;
+      return;
+    }
+    pair->elements->count = 2;
+  }
+  pair->elements->data[0] = GTA_TYPEX_MAKE_P(entry->key);
+  pair->elements->data[1] = GTA_TYPEX_MAKE_P(value);
+
+  // The loop variable adopts the pair without copying it.
+  pair->base.is_temporary = true;
+  self->value = (GTA_Computed_Value *)pair;
+}
+
+
+GTA_Computed_Value * GTA_CALL gta_computed_value_map_iterator_get(GTA_Computed_Value * self, GTA_Execution_Context * context) {
+  assert(self);
+  assert(GTA_COMPUTED_VALUE_IS_MAP(self));
+  GTA_Computed_Value * iterator = gta_computed_value_iterator_create(self, context);
+
+  if (!iterator || GTA_COMPUTED_VALUE_IS_ERROR(iterator)) {
+    return iterator ? iterator : gta_computed_value_error_out_of_memory;
+  }
+
+  ((GTA_Computed_Value_Iterator *)iterator)->advance = __advance;
+
+  return iterator;
 }
 
 
@@ -232,7 +525,9 @@ static bool GTA_CALL expand_and_concat(char * * buffer, size_t * len, const char
     return false;
   }
   strcpy(new_buffer + *len, string);
-  return new_buffer;
+  *buffer = new_buffer;
+  *len += string_length;
+  return true;
 }
 
 
@@ -248,33 +543,34 @@ char * GTA_CALL gta_computed_value_map_to_string(GTA_Computed_Value * self) {
   buffer[0] = '{';
   buffer[1] = '}';
   buffer[2] = '\0';
-  size_t len = 0;
-  if (map->key_hash->entries == 0) {
+  if (map->table->count == 0) {
     return buffer;
   }
   buffer[1] = '\n';
-  
-  GTA_HashX_Iterator key_iterator = GTA_HASHX_ITERATOR_GET(map->key_hash);
-  GTA_HashX_Iterator value_iterator = GTA_HASHX_ITERATOR_GET(map->value_hash);
-  while (key_iterator.exists && value_iterator.exists) {
-    char * key_str = gta_computed_value_to_string((GTA_Computed_Value *)GTA_TYPEX_P(key_iterator.value));
+  buffer[2] = '\0';
+  size_t len = 2;
+
+  for (size_t i = 0; i < map->table->count; ++i) {
+    char * key_str = gta_computed_value_to_string(map->table->entries[i].key);
     if (!key_str) {
       gcu_free(buffer);
       return NULL;
     }
 
-    char * value_str = gta_computed_value_to_string((GTA_Computed_Value *)GTA_TYPEX_P(value_iterator.value));
+    char * value_str = gta_computed_value_to_string(map->table->entries[i].value);
     if (!value_str) {
       gcu_free(key_str);
       gcu_free(buffer);
       return NULL;
     }
 
+    // String values are quoted, just like the keys.
+    bool is_string = GTA_COMPUTED_VALUE_IS_STRING(map->table->entries[i].value);
     if (!expand_and_concat(&buffer, &len, "  \"")
       || !expand_and_concat(&buffer, &len, key_str)
-      || !expand_and_concat(&buffer, &len, "\": ")
+      || !expand_and_concat(&buffer, &len, is_string ? "\": \"" : "\": ")
       || !expand_and_concat(&buffer, &len, value_str)
-      || !expand_and_concat(&buffer, &len, ",\n")) {
+      || !expand_and_concat(&buffer, &len, is_string ? "\",\n" : ",\n")) {
       gcu_free(key_str);
       gcu_free(value_str);
       gcu_free(buffer);
@@ -283,8 +579,6 @@ char * GTA_CALL gta_computed_value_map_to_string(GTA_Computed_Value * self) {
 
     gcu_free(key_str);
     gcu_free(value_str);
-    key_iterator = GTA_HASHX_ITERATOR_NEXT(key_iterator);
-    value_iterator = GTA_HASHX_ITERATOR_NEXT(value_iterator);
   }
 
   if (!expand_and_concat(&buffer, &len, "}")) {
@@ -299,12 +593,13 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_map_get_from_cstring(GTA_Comput
   assert(self);
   assert(key);
 
-  GTA_HashX_Value result = GTA_HASHX_GET(self->value_hash, gcu_string_hash_64(key, strlen(key)));
-  if (!result.exists) {
+  size_t length = strlen(key);
+  size_t slot = table_find(self->table, key, length, gcu_string_hash_64(key, length));
+  if (!self->table->slots[slot]) {
     return gta_computed_value_error_map_key_not_found;
   }
 
-  return (GTA_Computed_Value *)GTA_TYPEX_P(result.value);
+  return self->table->entries[self->table->slots[slot] - 1].value;
 }
 
 
@@ -313,14 +608,36 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_map_set_key_val(GTA_Computed_Va
     return gta_computed_value_error_map_key_not_string;
   }
 
-  // Compute the hash of the key.
+  if (!own_table(self)) {
+    return gta_computed_value_error_out_of_memory;
+  }
+
+  // Find the key.
   GTA_Computed_Value_String * key_string = (GTA_Computed_Value_String *)key;
-  GTA_Integer key_hash = gcu_string_hash_64(key_string->value->buffer, key_string->value->byte_length);
+  uint64_t hash = gta_computed_value_string_hash(key_string);
+  size_t slot = table_find(self->table, key_string->value->buffer, key_string->value->byte_length, hash);
 
-  // Insert the key and value into the hash tables.
-  if (!GTA_HASHX_SET(self->key_hash, key_hash, GTA_TYPEX_MAKE_P(key))
-    || !GTA_HASHX_SET(self->value_hash, key_hash, GTA_TYPEX_MAKE_P(value))) {
-    return gta_computed_value_error_out_of_memory;
+  if (self->table->slots[slot]) {
+    // The key is already present, so only the value is replaced.  The entry
+    // keeps its position in the iteration order.
+    self->table->entries[self->table->slots[slot] - 1].value = value;
+  }
+  else {
+    if (self->table->count == self->table->capacity) {
+      GTA_Computed_Value_Map_Table * grown = table_grow(self->table);
+      if (!grown) {
+        return gta_computed_value_error_out_of_memory;
+      }
+      gcu_free(self->table);
+      self->table = grown;
+      slot = table_find(self->table, key_string->value->buffer, key_string->value->byte_length, hash);
+    }
+    self->table->entries[self->table->count] = (GTA_Computed_Value_Map_Entry) {
+      .key = key,
+      .value = value,
+      .hash = hash,
+    };
+    self->table->slots[slot] = (uint32_t)++self->table->count;
   }
 
   // Claim ownership of the key and value.
@@ -13,6 +13,7 @@
 #include <tang/computedValue/computedValueFunctionNative.h>
 #include <tang/computedValue/computedValueRNG.h>
 #include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -197,8 +198,8 @@ GTA_Computed_Value_RNG * GTA_CALL gta_computed_value_rng_create_seeded(GTA_UInte
     return 0;
   }
   if (context) {
-    // Attempt to add the pointer to the context's garbage collection list.
-    if (!GTA_VECTORX_APPEND(context->garbage_collection, GTA_TYPEX_MAKE_P(self))) {
+    // Register the value with the garbage collector.
+    if (!gta_garbage_collector_register(context, (GTA_Computed_Value *)self, sizeof(GTA_Computed_Value_RNG))) {
       gcu_free(self);
       return NULL;
     }
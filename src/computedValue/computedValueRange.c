@@ -0,0 +1,178 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <cutil/memory.h>
+#include <tang/computedValue/computedValueError.h>
+#include <tang/computedValue/computedValueInteger.h>
+#include <tang/computedValue/computedValueIterator.h>
+#include <tang/computedValue/computedValueRange.h>
+#include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
+
+GTA_Computed_Value_VTable gta_computed_value_range_vtable = {
+  .name = "Range",
+  .destroy = gta_computed_value_range_destroy,
+  .destroy_in_place = gta_computed_value_range_destroy_in_place,
+  .deep_copy = gta_computed_value_range_deep_copy,
+  .to_string = gta_computed_value_range_to_string,
+  .print = gta_computed_value_generic_print_from_to_string,
+  .assign_index = gta_computed_value_assign_index_not_supported,
+  .add = gta_computed_value_add_not_supported,
+  .subtract = gta_computed_value_subtract_not_supported,
+  .multiply = gta_computed_value_multiply_not_supported,
+  .divide = gta_computed_value_divide_not_supported,
+  .modulo = gta_computed_value_modulo_not_supported,
+  .negative = gta_computed_value_negative_not_supported,
+  .less_than = gta_computed_value_less_than_not_supported,
+  .less_than_equal = gta_computed_value_less_than_equal_not_supported,
+  .greater_than = gta_computed_value_greater_than_not_supported,
+  .greater_than_equal = gta_computed_value_greater_than_equal_not_supported,
+  .equal = gta_computed_value_equal_not_supported,
+  .not_equal = gta_computed_value_not_equal_not_supported,
+  .period = gta_computed_value_generic_period,
+  .index = gta_computed_value_index_not_supported,
+  .slice = gta_computed_value_slice_not_supported,
+  .iterator_get = gta_computed_value_range_iterator_get,
+  .iterator_next = gta_computed_value_iterator_next_not_supported,
+  .cast = gta_computed_value_cast_not_supported,
+  .call = gta_computed_value_call_not_supported,
+  .attributes = NULL,
+  .attributes_count = 0,
+};
+
+
+static GTA_Computed_Value_Error gta_computed_value_error_range_bounds_not_integer_singleton = {
+  .base = {
+    .vtable = &gta_computed_value_error_vtable,
+    .context = 0,
+    .is_true = false,
+    .is_error = true,
+    .is_temporary = false,
+    .requires_deep_copy = false,
+    .is_singleton = true,
+    .is_a_reference = false,
+  },
+  .message = "Range Bounds Not Integer",
+};
+
+GTA_Computed_Value * gta_computed_value_error_range_bounds_not_integer = (GTA_Computed_Value *)&gta_computed_value_error_range_bounds_not_integer_singleton;
+
+
+GTA_Computed_Value_Range * GTA_CALL gta_computed_value_range_create(GTA_Integer start, GTA_Integer end, GTA_Execution_Context * context) {
+  GTA_Computed_Value_Range * self = gcu_malloc(sizeof(GTA_Computed_Value_Range));
+  if (!self) {
+    return 0;
+  }
+  if (context) {
+    // Register the value with the garbage collector.
+    if (!gta_garbage_collector_register(context, (GTA_Computed_Value *)self, sizeof(GTA_Computed_Value_Range))) {
+      gcu_free(self);
+      return NULL;
+    }
+  }
+  gta_computed_value_range_create_in_place(self, start, end, context);
+  return self;
+}
+
+
+bool GTA_CALL gta_computed_value_range_create_in_place(GTA_Computed_Value_Range * self, GTA_Integer start, GTA_Integer end, GTA_Execution_Context * context) {
+  assert(self);
+  *self = (GTA_Computed_Value_Range) {
+    .base = {
+      .vtable = &gta_computed_value_range_vtable,
+      .context = context,
+      .is_true = end > start,
+      .is_error = false,
+      .is_temporary = true,
+      .requires_deep_copy = false,
+      .is_singleton = false,
+      .is_a_reference = false,
+    },
+    .start = start,
+    .end = end,
+  };
+  return true;
+}
+
+
+GTA_Computed_Value * GTA_CALL gta_computed_value_range_create_from_values(GTA_Computed_Value * start, GTA_Computed_Value * end, GTA_Execution_Context * context) {
+  assert(start);
+  assert(end);
+  if (!GTA_COMPUTED_VALUE_IS_INTEGER(start) || !GTA_COMPUTED_VALUE_IS_INTEGER(end)) {
+    return gta_computed_value_error_range_bounds_not_integer;
+  }
+  GTA_Computed_Value * range = (GTA_Computed_Value *)gta_computed_value_range_create(((GTA_Computed_Value_Integer *)start)->value, ((GTA_Computed_Value_Integer *)end)->value, context);
+  return range
+    ? range
+    : gta_computed_value_error_out_of_memory;
+}
+
+
+void GTA_CALL gta_computed_value_range_destroy(GTA_Computed_Value * self) {
+  assert(self);
+  gcu_free(self);
+}
+
+
+void GTA_CALL gta_computed_value_range_destroy_in_place(GTA_MAYBE_UNUSED(GTA_Computed_Value * self)) {}
+
+
+GTA_Computed_Value * GTA_CALL gta_computed_value_range_deep_copy(GTA_Computed_Value * value, GTA_Execution_Context * context) {
+  assert(value);
+  assert(GTA_COMPUTED_VALUE_IS_RANGE(value));
+  GTA_Computed_Value_Range * range = (GTA_Computed_Value_Range *)value;
+  return (GTA_Computed_Value *)gta_computed_value_range_create(range->start, range->end, context);
+}
+
+
+char * GTA_CALL gta_computed_value_range_to_string(GTA_Computed_Value * self) {
+  assert(self);
+  assert(GTA_COMPUTED_VALUE_IS_RANGE(self));
+  GTA_Computed_Value_Range * range = (GTA_Computed_Value_Range *)self;
+
+  char * str = (char *)gcu_malloc(64);
+  if (!str) {
+    return 0;
+  }
+  sprintf(str, "%zd..%zd", range->start, range->end);
+  return str;
+}
+
+
+/**
+ * Advance the iterator to the next integer of the range.
+ *
+ * @param self The iterator.
+ */
+static void GTA_CALL __advance(GTA_Computed_Value_Iterator * self) {
+  assert(self);
+  assert(GTA_COMPUTED_VALUE_IS_ITERATOR(self));
+  GTA_Computed_Value_Range * range = (GTA_Computed_Value_Range *)self->collection;
+
+  // The index counts up from 0, and the length of the range is computed
+  // unsigned, so neither can overflow.
+  if ((range->end <= range->start)
+    || ((GTA_UInteger)self->index >= (GTA_UInteger)range->end - (GTA_UInteger)range->start)) {
+    self->value = gta_computed_value_error_iterator_end;
+    return;
+  }
+  GTA_Computed_Value * value = (GTA_Computed_Value *)gta_computed_value_integer_create(range->start + self->index, self->base.context);
+  self->value = value
+    ? value
+    : gta_computed_value_error_out_of_memory;
+}
+
+
+GTA_Computed_Value * GTA_CALL gta_computed_value_range_iterator_get(GTA_Computed_Value * self, GTA_Execution_Context * context) {
+  assert(self);
+  assert(GTA_COMPUTED_VALUE_IS_RANGE(self));
+  GTA_Computed_Value * iterator = gta_computed_value_iterator_create(self, context);
+
+  if (!iterator || GTA_COMPUTED_VALUE_IS_ERROR(iterator)) {
+    return iterator ? iterator : gta_computed_value_error_out_of_memory;
+  }
+
+  ((GTA_Computed_Value_Iterator *)iterator)->advance = __advance;
+
+  return iterator;
+}
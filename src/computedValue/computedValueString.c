@@ -1,15 +1,19 @@
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <string.h>
+#include <cutil/hash.h>
 #include <cutil/memory.h>
 #include <tang/computedValue/computedValue.h>
 #include <tang/computedValue/computedValueBoolean.h>
 #include <tang/computedValue/computedValueError.h>
 #include <tang/computedValue/computedValueFloat.h>
 #include <tang/computedValue/computedValueInteger.h>
+#include <tang/computedValue/computedValueIterator.h>
 #include <tang/computedValue/computedValueString.h>
 #include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
 
 
 /**
@@ -147,7 +151,7 @@ GTA_Computed_Value_VTable gta_computed_value_string_vtable = {
   .period = gta_computed_value_generic_period,
   .index = gta_computed_value_string_index,
   .slice = gta_computed_value_string_slice,
-  .iterator_get = gta_computed_value_iterator_get_not_implemented,
+  .iterator_get = gta_computed_value_string_iterator_get,
   .iterator_next = gta_computed_value_iterator_next_not_implemented,
   .cast = gta_computed_value_string_cast,
   .call = gta_computed_value_call_not_supported,
@@ -215,10 +219,43 @@ GTA_Computed_Value_String gta_computed_value_string_empty_singleton = {
   },
   .value = &gta_unicode_string_empty_singleton,
   .is_owned = false,
+  .is_hashed = false,
+  .hash = 0,
 };
 
 GTA_Computed_Value * gta_computed_value_string_empty = (GTA_Computed_Value *)&gta_computed_value_string_empty_singleton;
 
+
+static GTA_Computed_Value_Error gta_computed_value_error_string_invalid_utf8_singleton = {
+  .base = {
+    .vtable = &gta_computed_value_error_vtable,
+    .context = 0,
+    .is_true = false,
+    .is_error = true,
+    .is_temporary = false,
+    .requires_deep_copy = false,
+    .is_singleton = true,
+    .is_a_reference = false,
+  },
+  .message = "Invalid UTF-8 String",
+};
+
+GTA_Computed_Value * gta_computed_value_error_string_invalid_utf8 = (GTA_Computed_Value *)&gta_computed_value_error_string_invalid_utf8_singleton;
+
+
+/**
+ * Get the error to report when the grapheme index of a string could not be
+ * built.
+ *
+ * @param string The string.
+ * @return The error value.
+ */
+static GTA_Computed_Value * grapheme_index_error(const GTA_Unicode_String * string) {
+  return gta_unicode_string_is_valid_utf8(string)
+    ? gta_computed_value_error_out_of_memory
+    : gta_computed_value_error_string_invalid_utf8;
+}
+
 /*
  * End of the empty string singleton code.
  */
@@ -230,8 +267,8 @@ GTA_Computed_Value_String * GTA_CALL gta_computed_value_string_create(GTA_Unicod
     return 0;
   }
   if (context) {
-    // Attempt to add the pointer to the context's garbage collection list.
-    if (!GTA_VECTORX_APPEND(context->garbage_collection, GTA_TYPEX_MAKE_P(self))) {
+    // Register the value with the garbage collector.
+    if (!gta_garbage_collector_register(context, (GTA_Computed_Value *)self, sizeof(GTA_Computed_Value_String) + (adopt && value ? value->byte_length : 0))) {
       gcu_free(self);
       return NULL;
     }
@@ -257,6 +294,8 @@ bool GTA_CALL gta_computed_value_string_create_in_place(GTA_Computed_Value_Strin
     },
     .value = value,
     .is_owned = adopt,
+    .is_hashed = false,
+    .hash = 0,
   };
   return true;
 }
@@ -289,11 +328,17 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_string_deep_copy(GTA_Computed_V
   GTA_Computed_Value_String * string = (GTA_Computed_Value_String *) value;
 
   assert(string->value);
-  GTA_Unicode_String * unicodeString = gta_unicode_string_substring(string->value, 0, string->value->grapheme_length);
+  GTA_Unicode_String * unicodeString = gta_unicode_string_copy(string->value);
   if (!unicodeString) {
     return 0;
   }
-  return (GTA_Computed_Value *)gta_computed_value_string_create(unicodeString, true, context);
+  GTA_Computed_Value_String * copy = gta_computed_value_string_create(unicodeString, true, context);
+  if (copy && atomic_load_explicit(&string->is_hashed, memory_order_acquire)) {
+    // The copy has the same contents, so it has the same hash.
+    copy->hash = string->hash;
+    atomic_store_explicit(&copy->is_hashed, true, memory_order_relaxed);
+  }
+  return (GTA_Computed_Value *)copy;
 }
 
 
@@ -320,7 +365,7 @@ GTA_Unicode_String * GTA_CALL gta_computed_value_string_print(GTA_Computed_Value
   GTA_Computed_Value_String * string = (GTA_Computed_Value_String *)self;
 
   assert(string->value);
-  return gta_unicode_string_substring(string->value, 0, string->value->grapheme_length);
+  return gta_unicode_string_copy(string->value);
 }
 
 
@@ -359,6 +404,9 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_string_index(GTA_Computed_Value
   GTA_Computed_Value_Integer * integer = (GTA_Computed_Value_Integer *)index;
 
   assert(string->value);
+  if (!gta_unicode_string_index_graphemes(string->value)) {
+    return grapheme_index_error(string->value);
+  }
   GTA_Integer normalized_index = integer->value >= 0
     ? integer->value
     : (GTA_Integer)string->value->grapheme_length + integer->value;
@@ -382,6 +430,63 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_string_index(GTA_Computed_Value
 }
 
 
+/**
+ * Helper function used as the 'advance' iterator operation.
+ *
+ * Each value is one grapheme of the string, found through the grapheme index
+ * (which is built when the iterator is created).
+ *
+ * @param self The iterator.
+ */
+static void GTA_CALL __advance(GTA_Computed_Value_Iterator * self) {
+  assert(self);
+  assert(GTA_COMPUTED_VALUE_IS_ITERATOR(self));
+  GTA_Unicode_String * string = ((GTA_Computed_Value_String *)self->collection)->value;
+
+  if (self->index >= (GTA_Integer)string->grapheme_length) {
+    self->value = gta_computed_value_error_iterator_end;
+    return;
+  }
+
+  GTA_Unicode_String * grapheme = gta_unicode_string_substring(string, self->index, 1);
+  if (!grapheme) {
+    self->value = gta_computed_value_error_out_of_memory;
+    return;
+  }
+  GTA_Computed_Value * value = (GTA_Computed_Value *)gta_computed_value_string_create(grapheme, true, self->base.context);
+  if (!value) {
+    gta_unicode_string_destroy(grapheme);
+    self->value = gta_computed_value_error_out_of_memory;
+    return;
+  }
+
+  // The grapheme is new, so the loop variable adopts it without copying it.
+  value->is_temporary = true;
+  self->value = value;
+}
+
+
+GTA_Computed_Value * GTA_CALL gta_computed_value_string_iterator_get(GTA_Computed_Value * self, GTA_Execution_Context * context) {
+  assert(self);
+  assert(GTA_COMPUTED_VALUE_IS_STRING(self));
+  GTA_Computed_Value_String * string = (GTA_Computed_Value_String *)self;
+
+  assert(string->value);
+  if (!gta_unicode_string_index_graphemes(string->value)) {
+    return grapheme_index_error(string->value);
+  }
+
+  GTA_Computed_Value * iterator = gta_computed_value_iterator_create(self, context);
+  if (!iterator || GTA_COMPUTED_VALUE_IS_ERROR(iterator)) {
+    return iterator ? iterator : gta_computed_value_error_out_of_memory;
+  }
+
+  ((GTA_Computed_Value_Iterator *)iterator)->advance = __advance;
+
+  return iterator;
+}
+
+
 // Helper function to correct start and end values of a slice.
 static GTA_Integer correct_bounds(GTA_Integer value, GTA_Integer boundary, GTA_Integer step) {
   GTA_Integer interval = (boundary - value) / step;
@@ -396,6 +501,9 @@ GTA_Computed_Value * GTA_CALL gta_computed_value_string_slice(GTA_Computed_Value
   GTA_Computed_Value_String * string = (GTA_Computed_Value_String *) self;
 
   assert(string->value);
+  if (!gta_unicode_string_index_graphemes(string->value)) {
+    return grapheme_index_error(string->value);
+  }
   GTA_Integer grapheme_length = (GTA_Integer)string->value->grapheme_length;
 
   // First, validate the step value.  If null, it will default to 1.
@@ -525,7 +633,11 @@ GTA_Computed_Value * GTA_CALL string_length(GTA_Computed_Value * self, GTA_Execu
   assert(self);
   assert(GTA_COMPUTED_VALUE_IS_STRING(self));
   GTA_Computed_Value_String * string = (GTA_Computed_Value_String *)self;
-  return (GTA_Computed_Value *)gta_computed_value_integer_create(string->value->grapheme_length, context);
+  size_t grapheme_length = gta_unicode_string_get_grapheme_length(string->value);
+  if (grapheme_length == SIZE_MAX) {
+    return grapheme_index_error(string->value);
+  }
+  return (GTA_Computed_Value *)gta_computed_value_integer_create(grapheme_length, context);
 }
 
 
@@ -616,3 +728,17 @@ static GTA_Computed_Value * GTA_CALL string_percent(GTA_Computed_Value * self, G
 static GTA_Computed_Value * GTA_CALL string_javascript(GTA_Computed_Value * self, GTA_Execution_Context * context) {
   return string_change_type(self, context, GTA_UNICODE_STRING_TYPE_JAVASCRIPT);
 }
+
+
+uint64_t GTA_CALL gta_computed_value_string_hash(GTA_Computed_Value_String * self) {
+  assert(self);
+  assert(self->value);
+  if (atomic_load_explicit(&self->is_hashed, memory_order_acquire)) {
+    return self->hash;
+  }
+  // Every thread computes the same hash, so a race to store it is harmless.
+  uint64_t hash = gcu_string_hash_64(self->value->buffer, self->value->byte_length);
+  self->hash = hash;
+  atomic_store_explicit(&self->is_hashed, true, memory_order_release);
+  return hash;
+}
@@ -5,6 +5,8 @@
 #include <stdio.h>
 #include <tang/program/binary.h>
 #include <tang/program/compilerContext.h>
+#include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
 #include <tang/computedValue/computedValue.h>
 
 #define VECTOR_GROWTH_FACTOR ((double)1.5)
@@ -148,6 +150,128 @@ bool gta_binary_adopt__x86_64(GTA_Compiler_Context * context, GTA_Register targe
 }
 
 
+bool gta_binary_safepoint__x86_64(GTA_Compiler_Context * context) {
+  assert(context);
+  assert(context->binary_vector);
+  GCU_Vector8 * v = context->binary_vector;
+
+  size_t * bytes_since_collection_offset = &((GTA_Execution_Context *)0)->gc_bytes_since_collection;
+  size_t * next_collection_offset = &((GTA_Execution_Context *)0)->gc_next_collection;
+  int64_t * budget_countdown_offset = &((GTA_Execution_Context *)0)->budget_countdown;
+
+  GTA_Integer label_skip;
+  GTA_Integer label_within_budget;
+
+  return true
+  // Create the jump labels.
+    && ((label_skip = gta_compiler_context_get_label(context)) >= 0)
+    && ((label_within_budget = gta_compiler_context_get_label(context)) >= 0)
+  /////////////////////////////////////////////////////////////////////////////
+  // if (bytes_since_collection < next_collection) jump to skip
+  /////////////////////////////////////////////////////////////////////////////
+  //   mov scratch1, [r15 + bytes_since_collection_offset]
+  //   mov scratch2, [r15 + next_collection_offset]
+  //   cmp scratch1, scratch2
+  //   jb skip
+    && gta_mov_reg_ind__x86_64(v, GTA_X86_64_Scratch1, GTA_REG_R15, GTA_REG_NONE, 0, (int32_t)(size_t)bytes_since_collection_offset)
+    && gta_mov_reg_ind__x86_64(v, GTA_X86_64_Scratch2, GTA_REG_R15, GTA_REG_NONE, 0, (int32_t)(size_t)next_collection_offset)
+    && gta_cmp_reg_reg__x86_64(v, GTA_X86_64_Scratch1, GTA_X86_64_Scratch2)
+    && gta_jcc__x86_64(v, GTA_CC_B, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, label_skip, v->count - 4)
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Collect, preserving RAX on the stack (where it will also be seen as a
+  // root).  The stack remains 16-byte aligned.
+  /////////////////////////////////////////////////////////////////////////////
+  //   add rsp, -16
+  //   mov [rsp + GTA_SHADOW_SIZE__X86_64], rax
+  //   mov R1, r15
+  //   mov R2, rsp
+  //   call gta_garbage_collector_safepoint
+  //   mov rax, [rsp + GTA_SHADOW_SIZE__X86_64]
+  //   add rsp, 16
+    && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, -16)
+    && gta_mov_ind_reg__x86_64(v, GTA_REG_RSP, GTA_REG_NONE, 0, GTA_SHADOW_SIZE__X86_64, GTA_REG_RAX)
+    && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R1, GTA_REG_R15)
+    && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R2, GTA_REG_RSP)
+    && gta_binary_call__x86_64(v, (uint64_t)gta_garbage_collector_safepoint)
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_RAX, GTA_REG_RSP, GTA_REG_NONE, 0, GTA_SHADOW_SIZE__X86_64)
+    && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, 16)
+
+  // skip:
+    && gta_compiler_context_set_label(context, label_skip, v->count)
+
+  /////////////////////////////////////////////////////////////////////////////
+  // if (--budget_countdown >= 0) jump to within_budget
+  /////////////////////////////////////////////////////////////////////////////
+  //   mov scratch1, [r15 + budget_countdown_offset]
+  //   add scratch1, -1
+  //   mov [r15 + budget_countdown_offset], scratch1
+  //   jns within_budget
+    && gta_mov_reg_ind__x86_64(v, GTA_X86_64_Scratch1, GTA_REG_R15, GTA_REG_NONE, 0, (int32_t)(size_t)budget_countdown_offset)
+    && gta_add_reg_imm__x86_64(v, GTA_X86_64_Scratch1, -1)
+    && gta_mov_ind_reg__x86_64(v, GTA_REG_R15, GTA_REG_NONE, 0, (int32_t)(size_t)budget_countdown_offset, GTA_X86_64_Scratch1)
+    && gta_jcc__x86_64(v, GTA_CC_NS, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, label_within_budget, v->count - 4)
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Check the budget, preserving RAX on the stack.  If the budget has run
+  // out, then abort with the error (the stack is discarded).
+  /////////////////////////////////////////////////////////////////////////////
+  //   add rsp, -16
+  //   mov [rsp + GTA_SHADOW_SIZE__X86_64], rax
+  //   mov R1, r15
+  //   call gta_execution_context_budget_check
+  //   test rax, rax
+  //   jnz abort
+  //   mov rax, [rsp + GTA_SHADOW_SIZE__X86_64]
+  //   add rsp, 16
+    && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, -16)
+    && gta_mov_ind_reg__x86_64(v, GTA_REG_RSP, GTA_REG_NONE, 0, GTA_SHADOW_SIZE__X86_64, GTA_REG_RAX)
+    && gta_mov_reg_reg__x86_64(v, GTA_X86_64_R1, GTA_REG_R15)
+    && gta_binary_call__x86_64(v, (uint64_t)gta_execution_context_budget_check)
+    && gta_test_reg_reg__x86_64(v, GTA_REG_RAX, GTA_REG_RAX)
+    && gta_jcc__x86_64(v, GTA_CC_NZ, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, context->abort_label, v->count - 4)
+    && gta_mov_reg_ind__x86_64(v, GTA_REG_RAX, GTA_REG_RSP, GTA_REG_NONE, 0, GTA_SHADOW_SIZE__X86_64)
+    && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, 16)
+
+  // within_budget:
+    && gta_compiler_context_set_label(context, label_within_budget, v->count)
+  ;
+}
+
+
+/**
+ * Helper function to encode an SSE instruction of the form `OP xmm, xmm`.
+ *
+ * @param vector The vector in which to store the instruction.
+ * @param prefix The mandatory prefix of the instruction (e.g., 0xF2).
+ * @param opcode The second byte of the opcode (the first byte is 0x0F).
+ * @param dst The register encoded in the `reg` field of the ModRM byte.
+ * @param src The register encoded in the `r/m` field of the ModRM byte.
+ * @return True on success, false on failure.
+ */
+static bool sse_reg_reg(GCU_Vector8 * vector, uint8_t prefix, uint8_t opcode, GTA_Register dst, GTA_Register src) {
+  assert(vector);
+
+  if (!REG_IS_XMM(dst) || !REG_IS_XMM(src) || !gta_binary_optimistic_increase(vector, X86_64_GROW_SIZE)) {
+    return false;
+  }
+  uint8_t src_code = gta_binary_get_register_code__x86_64(src);
+  uint8_t dst_code = gta_binary_get_register_code__x86_64(dst);
+  vector->data[vector->count++] = GCU_TYPE8_UI8(prefix);
+  if ((src_code | dst_code) & 0x08) {
+    // REX prefix
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0x40 | ((dst_code & 0x08) >> 1) | ((src_code & 0x08) >> 3));
+  }
+  vector->data[vector->count++] = GCU_TYPE8_UI8(0x0F);
+  vector->data[vector->count++] = GCU_TYPE8_UI8(opcode);
+  vector->data[vector->count++] = GCU_TYPE8_UI8(0xC0 + ((dst_code & 0x07) << 3) + (src_code & 0x07));
+  return true;
+}
+
+
 bool gta_add_reg_imm__x86_64(GCU_Vector8 * vector, GTA_Register dst, int32_t immediate) {
   // https://www.felixcloutier.com/x86/add
   assert(vector);
@@ -247,6 +371,38 @@ bool gta_add_reg_imm__x86_64(GCU_Vector8 * vector, GTA_Register dst, int32_t imm
 }
 
 
+bool gta_add_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src) {
+  // https://www.felixcloutier.com/x86/add
+  assert(vector);
+
+  if (!REG_IS_INTEGER(dst) || !REG_IS_INTEGER(src) || !gta_binary_optimistic_increase(vector, X86_64_GROW_SIZE)) {
+    return false;
+  }
+  uint8_t src_code = gta_binary_get_register_code__x86_64(src);
+  uint8_t dst_code = gta_binary_get_register_code__x86_64(dst);
+  if (REG_IS_64BIT(src) && REG_IS_64BIT(dst)) {
+    // REX prefix
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0x48 | ((src_code & 0x08) >> 1) | ((dst_code & 0x08) >> 3));
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0x01);
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0xC0 + ((src_code & 0x07) << 3) + (dst_code & 0x07));
+    return true;
+  }
+  if (REG_IS_32BIT(src) && REG_IS_32BIT(dst)) {
+    // 32-bit register
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0x01);
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0xC0 + ((src_code & 0x07) << 3) + (dst_code & 0x07));
+    return true;
+  }
+  return false;
+}
+
+
+bool gta_addsd_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src) {
+  // https://www.felixcloutier.com/x86/addsd
+  return sse_reg_reg(vector, 0xF2, 0x58, dst, src);
+}
+
+
 bool gta_and_reg_imm__x86_64(GCU_Vector8 * vector, GTA_Register dst, int32_t immediate) {
   // https://www.felixcloutier.com/x86/and
   assert(vector);
@@ -640,6 +796,34 @@ bool gta_cmp_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register op1, GTA_Registe
 }
 
 
+bool gta_imul_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src) {
+  // https://www.felixcloutier.com/x86/imul
+  assert(vector);
+
+  if (!REG_IS_INTEGER(dst) || !REG_IS_INTEGER(src) || !gta_binary_optimistic_increase(vector, X86_64_GROW_SIZE)) {
+    return false;
+  }
+  uint8_t src_code = gta_binary_get_register_code__x86_64(src);
+  uint8_t dst_code = gta_binary_get_register_code__x86_64(dst);
+  if (REG_IS_64BIT(src) && REG_IS_64BIT(dst)) {
+    // REX prefix
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0x48 | ((dst_code & 0x08) >> 1) | ((src_code & 0x08) >> 3));
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0x0F);
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0xAF);
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0xC0 + ((dst_code & 0x07) << 3) + (src_code & 0x07));
+    return true;
+  }
+  if (REG_IS_32BIT(src) && REG_IS_32BIT(dst)) {
+    // 32-bit register
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0x0F);
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0xAF);
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0xC0 + ((dst_code & 0x07) << 3) + (src_code & 0x07));
+    return true;
+  }
+  return false;
+}
+
+
 bool gta_jmp__x86_64(GCU_Vector8 * vector, int32_t offset) {
   // https://www.felixcloutier.com/x86/jmp
   assert(vector);
@@ -1284,7 +1468,7 @@ bool gta_movq_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Regist
     vector->data[vector->count++] = GCU_TYPE8_UI8(0x48 | ((src_code & 0x08) >> 3) | ((dst_code & 0x08) >> 1));
     vector->data[vector->count++] = GCU_TYPE8_UI8(0x0F);
     vector->data[vector->count++] = GCU_TYPE8_UI8(0x6E);
-    vector->data[vector->count++] = GCU_TYPE8_UI8(0xC0 | ((src_code & 0x07) << 3) | (dst_code & 0x07));
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0xC0 | ((dst_code & 0x07) << 3) | (src_code & 0x07));
     return true;
   }
   else if (REG_IS_XMM(src) && REG_IS_64BIT(dst) && REG_IS_INTEGER(dst)) {
@@ -1300,6 +1484,12 @@ bool gta_movq_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Regist
 }
 
 
+bool gta_mulsd_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src) {
+  // https://www.felixcloutier.com/x86/mulsd
+  return sse_reg_reg(vector, 0xF2, 0x59, dst, src);
+}
+
+
 bool gta_nop__x86_64(GCU_Vector8 * vector) {
   // https://www.felixcloutier.com/x86/nop
   assert(vector);
@@ -1398,6 +1588,38 @@ bool gta_ret__x86_64(GCU_Vector8 * vector) {
 }
 
 
+bool gta_sub_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src) {
+  // https://www.felixcloutier.com/x86/sub
+  assert(vector);
+
+  if (!REG_IS_INTEGER(dst) || !REG_IS_INTEGER(src) || !gta_binary_optimistic_increase(vector, X86_64_GROW_SIZE)) {
+    return false;
+  }
+  uint8_t src_code = gta_binary_get_register_code__x86_64(src);
+  uint8_t dst_code = gta_binary_get_register_code__x86_64(dst);
+  if (REG_IS_64BIT(src) && REG_IS_64BIT(dst)) {
+    // REX prefix
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0x48 | ((src_code & 0x08) >> 1) | ((dst_code & 0x08) >> 3));
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0x29);
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0xC0 + ((src_code & 0x07) << 3) + (dst_code & 0x07));
+    return true;
+  }
+  if (REG_IS_32BIT(src) && REG_IS_32BIT(dst)) {
+    // 32-bit register
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0x29);
+    vector->data[vector->count++] = GCU_TYPE8_UI8(0xC0 + ((src_code & 0x07) << 3) + (dst_code & 0x07));
+    return true;
+  }
+  return false;
+}
+
+
+bool gta_subsd_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src) {
+  // https://www.felixcloutier.com/x86/subsd
+  return sse_reg_reg(vector, 0xF2, 0x5C, dst, src);
+}
+
+
 bool gta_test_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register op1, GTA_Register op2) {
   // https://www.felixcloutier.com/x86/test
   assert(vector);
@@ -1437,6 +1659,12 @@ bool gta_test_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register op1, GTA_Regist
 }
 
 
+bool gta_ucomisd_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register op1, GTA_Register op2) {
+  // https://www.felixcloutier.com/x86/ucomisd
+  return sse_reg_reg(vector, 0x66, 0x2E, op1, op2);
+}
+
+
 bool gta_xor_reg_reg__x86_64(GCU_Vector8 * vector, GTA_Register dst, GTA_Register src) {
   // https://www.felixcloutier.com/x86/xor
   assert(vector);
@@ -0,0 +1,531 @@
+// Include the correct header file for the platform.
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cutil/memory.h>
+#include <tang/program/bundle.h>
+#include <tang/program/bytecodeImage.h>
+
+/**
+ * The word used to detect a bundle which was created on a machine with a
+ * different byte order.
+ */
+#define BYTE_ORDER_MARKER UINT64_C(0x0102030405060708)
+
+/**
+ * The positions of the words in the bundle header.
+ * @{
+ */
+#define HEADER_MAGIC 0
+#define HEADER_VERSION 1
+#define HEADER_BYTE_ORDER 2
+#define HEADER_INTEGER_SIZE 3
+#define HEADER_COUNT 4
+#define HEADER_WORDS 5
+/** @} */
+
+/**
+ * The positions of the words in an index entry.
+ * @{
+ */
+#define ENTRY_HASH 0
+#define ENTRY_NAME_OFFSET 1
+#define ENTRY_NAME_LENGTH 2
+#define ENTRY_IMAGE_OFFSET 3
+#define ENTRY_IMAGE_LENGTH 4
+#define ENTRY_WORDS 5
+/** @} */
+
+/**
+ * Round a number of bytes up to a whole number of words.
+ *
+ * @param X The number of bytes.
+ * @return The number of bytes, rounded up.
+ */
+#define PADDED_LENGTH(X) (((X) + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1))
+
+/**
+ * A program that has been added to a bundle builder.
+ */
+typedef struct Bundle_Builder_Entry {
+  /**
+   * The name of the program.  It is owned by the builder.
+   */
+  char * name;
+  /**
+   * The length of the name in bytes.
+   */
+  size_t name_length;
+  /**
+   * The hash of the name.
+   */
+  GTA_UInteger hash;
+  /**
+   * The bytecode image of the program.  It is owned by the builder.
+   */
+  GCU_Vector64 * image;
+} Bundle_Builder_Entry;
+
+/**
+ * Collects programs so that they can be written to a bundle file.
+ */
+struct GTA_Bundle_Builder {
+  /**
+   * The programs that have been added.
+   */
+  Bundle_Builder_Entry * entries;
+  /**
+   * The number of programs that have been added.
+   */
+  size_t count;
+  /**
+   * The number of entries that have been allocated.
+   */
+  size_t capacity;
+};
+
+/**
+ * A bundle file which has been mapped into memory.
+ */
+struct GTA_Bundle {
+  /**
+   * The mapped file.
+   */
+  const unsigned char * data;
+  /**
+   * The length of the file in bytes.
+   */
+  size_t length;
+  /**
+   * The number of programs in the bundle.
+   */
+  size_t count;
+  /**
+   * The index of the bundle, which is part of the mapped file.
+   */
+  const uint64_t * index;
+  /**
+   * The number of references to the bundle: one for the creator, and one for
+   * each program which was loaded from it and still exists.
+   */
+  atomic_size_t references;
+};
+
+
+GTA_Bundle_Builder * gta_bundle_builder_create(void) {
+  GTA_Bundle_Builder * self = gcu_malloc(sizeof(GTA_Bundle_Builder));
+  if (!self) {
+    return 0;
+  }
+  *self = (GTA_Bundle_Builder) {
+    .entries = 0,
+    .count = 0,
+    .capacity = 0,
+  };
+  return self;
+}
+
+
+void gta_bundle_builder_destroy(GTA_Bundle_Builder * self) {
+  assert(self);
+  for (size_t i = 0; i < self->count; ++i) {
+    gcu_free(self->entries[i].name);
+    gcu_vector64_destroy(self->entries[i].image);
+  }
+  if (self->entries) {
+    gcu_free(self->entries);
+  }
+  gcu_free(self);
+}
+
+
+/**
+ * Add an entry to a bundle builder, adopting the image.
+ *
+ * @param self The builder.
+ * @param name The name of the program.
+ * @param image The image of the program.  It is adopted only on success.
+ * @return True on success, false if the name is already in use or memory
+ *   could not be allocated.
+ */
+static bool builder_add_entry(GTA_Bundle_Builder * self, const char * name, GCU_Vector64 * image) {
+  size_t name_length = strlen(name);
+  GTA_UInteger hash = GTA_STRING_HASH(name, name_length);
+  for (size_t i = 0; i < self->count; ++i) {
+    if ((self->entries[i].hash == hash) && (self->entries[i].name_length == name_length) && !memcmp(self->entries[i].name, name, name_length)) {
+      return false;
+    }
+  }
+
+  if (self->count == self->capacity) {
+    size_t capacity = self->capacity ? self->capacity * 2 : 32;
+    Bundle_Builder_Entry * entries = gcu_realloc(self->entries, capacity * sizeof(Bundle_Builder_Entry));
+    if (!entries) {
+      return false;
+    }
+    self->entries = entries;
+    self->capacity = capacity;
+  }
+
+  char * name_copy = gcu_malloc(name_length + 1);
+  if (!name_copy) {
+    return false;
+  }
+  memcpy(name_copy, name, name_length + 1);
+  self->entries[self->count++] = (Bundle_Builder_Entry) {
+    .name = name_copy,
+    .name_length = name_length,
+    .hash = hash,
+    .image = image,
+  };
+  return true;
+}
+
+
+bool gta_bundle_builder_add(GTA_Bundle_Builder * self, const char * name, GTA_Program * program) {
+  assert(self);
+  assert(name);
+  assert(program);
+
+  GCU_Vector64 * image = gta_bytecode_image_create(program);
+  if (!image) {
+    return false;
+  }
+  if (!builder_add_entry(self, name, image)) {
+    gcu_vector64_destroy(image);
+    return false;
+  }
+  return true;
+}
+
+
+bool gta_bundle_builder_add_image(GTA_Bundle_Builder * self, const char * name, const void * data, size_t length) {
+  assert(self);
+  assert(name);
+  assert(data || !length);
+
+  if (length % sizeof(uint64_t)) {
+    return false;
+  }
+  GCU_Vector64 * image = gcu_vector64_create(length / sizeof(uint64_t));
+  if (!image) {
+    return false;
+  }
+  for (size_t i = 0; i < length; i += sizeof(uint64_t)) {
+    GCU_Type64_Union word;
+    memcpy(&word.ui64, (const unsigned char *)data + i, sizeof(uint64_t));
+    if (!gcu_vector64_append(image, word)) {
+      gcu_vector64_destroy(image);
+      return false;
+    }
+  }
+  if (!builder_add_entry(self, name, image)) {
+    gcu_vector64_destroy(image);
+    return false;
+  }
+  return true;
+}
+
+
+/**
+ * Compare two bundle builder entries by the hash of their names.
+ *
+ * @param a The first entry.
+ * @param b The second entry.
+ * @return The result of the comparison, as required by qsort().
+ */
+static int compare_entries(const void * a, const void * b) {
+  GTA_UInteger hash_a = ((const Bundle_Builder_Entry *)a)->hash;
+  GTA_UInteger hash_b = ((const Bundle_Builder_Entry *)b)->hash;
+  return (hash_a > hash_b) - (hash_a < hash_b);
+}
+
+
+/**
+ * Write bytes to a file, padded with zeros to a whole number of words.
+ *
+ * @param file The file to write to.
+ * @param bytes The bytes to write.
+ * @param length The number of bytes.
+ * @return True on success, false otherwise.
+ */
+static bool write_padded(FILE * file, const void * bytes, size_t length) {
+  static const unsigned char zeros[sizeof(uint64_t)] = {0};
+  size_t padding = PADDED_LENGTH(length) - length;
+  return (fwrite(bytes, 1, length, file) == length)
+    && (fwrite(zeros, 1, padding, file) == padding);
+}
+
+
+bool gta_bundle_builder_save(GTA_Bundle_Builder * self, const char * path) {
+  assert(self);
+  assert(path);
+
+  if (self->count) {
+    qsort(self->entries, self->count, sizeof(Bundle_Builder_Entry), compare_entries);
+  }
+
+  // Build the header and the index.
+  GCU_Vector64 * index = gcu_vector64_create(HEADER_WORDS + (self->count * ENTRY_WORDS));
+  if (!index) {
+    return false;
+  }
+  bool success = true
+    && gcu_vector64_append(index, GCU_TYPE64_UI64(GTA_BUNDLE_MAGIC))
+    && gcu_vector64_append(index, GCU_TYPE64_UI64(GTA_BUNDLE_VERSION))
+    && gcu_vector64_append(index, GCU_TYPE64_UI64(BYTE_ORDER_MARKER))
+    && gcu_vector64_append(index, GCU_TYPE64_UI64(sizeof(GTA_UInteger)))
+    && gcu_vector64_append(index, GCU_TYPE64_UI64(self->count));
+  uint64_t offset = (HEADER_WORDS + (self->count * ENTRY_WORDS)) * sizeof(uint64_t);
+  for (size_t i = 0; success && (i < self->count); ++i) {
+    Bundle_Builder_Entry * entry = &self->entries[i];
+    uint64_t image_length = entry->image->count * sizeof(uint64_t);
+    success = true
+      && gcu_vector64_append(index, GCU_TYPE64_UI64(entry->hash))
+      && gcu_vector64_append(index, GCU_TYPE64_UI64(offset))
+      && gcu_vector64_append(index, GCU_TYPE64_UI64(entry->name_length))
+      && gcu_vector64_append(index, GCU_TYPE64_UI64(offset + PADDED_LENGTH(entry->name_length)))
+      && gcu_vector64_append(index, GCU_TYPE64_UI64(image_length));
+    offset += PADDED_LENGTH(entry->name_length) + image_length;
+  }
+
+  // Write the file.
+  FILE * file = success ? fopen(path, "wb") : 0;
+  if (file) {
+    success = write_padded(file, index->data, index->count * sizeof(uint64_t));
+    for (size_t i = 0; success && (i < self->count); ++i) {
+      success = true
+        && write_padded(file, self->entries[i].name, self->entries[i].name_length)
+        && write_padded(file, self->entries[i].image->data, self->entries[i].image->count * sizeof(uint64_t));
+    }
+    success &= !fclose(file);
+  }
+  else {
+    success = false;
+  }
+  gcu_vector64_destroy(index);
+  return success;
+}
+
+
+/**
+ * Unmap a bundle file.
+ *
+ * @param data The mapped file.
+ * @param length The length of the file in bytes.
+ */
+static void unmap_file(const unsigned char * data, GTA_MAYBE_UNUSED(size_t length)) {
+#ifdef _WIN32
+  UnmapViewOfFile(data);
+#else
+  munmap((void *)data, length);
+#endif // _WIN32
+}
+
+
+/**
+ * Map a file into memory, read-only.
+ *
+ * @param path The path of the file.
+ * @param length Set to the length of the file in bytes on success.
+ * @return The mapped file, or NULL on failure (including if the file is
+ *   empty).
+ */
+static const unsigned char * map_file(const char * path, size_t * length) {
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+  if (file == INVALID_HANDLE_VALUE) {
+    return 0;
+  }
+  const unsigned char * data = 0;
+  LARGE_INTEGER size;
+  if (GetFileSizeEx(file, &size) && (size.QuadPart > 0) && ((unsigned long long)size.QuadPart <= SIZE_MAX)) {
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    if (mapping) {
+      // The view keeps the mapping alive after the handle is closed.
+      data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      *length = (size_t)size.QuadPart;
+      CloseHandle(mapping);
+    }
+  }
+  CloseHandle(file);
+  return data;
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  const unsigned char * data = 0;
+  struct stat status;
+  if (!fstat(fd, &status) && (status.st_size > 0) && ((unsigned long long)status.st_size <= SIZE_MAX)) {
+    // The mapping remains valid after the file descriptor is closed.
+    void * mapping = mmap(0, (size_t)status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping != MAP_FAILED) {
+      data = mapping;
+      *length = (size_t)status.st_size;
+    }
+  }
+  close(fd);
+  return data;
+#endif // _WIN32
+}
+
+
+GTA_Bundle * gta_bundle_create(const char * path) {
+  assert(path);
+
+  size_t length = 0;
+  const unsigned char * data = map_file(path, &length);
+  if (!data) {
+    return 0;
+  }
+
+  // Verify the header.  The mapping is page aligned, so the words of the
+  // header and the index can be read directly.
+  const uint64_t * header = (const uint64_t *)data;
+  size_t words = length / sizeof(uint64_t);
+  if ((words < HEADER_WORDS)
+    || (header[HEADER_MAGIC] != GTA_BUNDLE_MAGIC)
+    || (header[HEADER_VERSION] != GTA_BUNDLE_VERSION)
+    || (header[HEADER_BYTE_ORDER] != BYTE_ORDER_MARKER)
+    || (header[HEADER_INTEGER_SIZE] != sizeof(GTA_UInteger))
+    || (header[HEADER_COUNT] > (words - HEADER_WORDS) / ENTRY_WORDS)) {
+    goto INVALID_BUNDLE;
+  }
+  size_t count = (size_t)header[HEADER_COUNT];
+  const uint64_t * index = header + HEADER_WORDS;
+
+  // Verify that every entry is within the file, and that the index is sorted.
+  for (size_t i = 0; i < count; ++i) {
+    const uint64_t * entry = index + (i * ENTRY_WORDS);
+    if ((entry[ENTRY_NAME_OFFSET] > length)
+      || (entry[ENTRY_NAME_LENGTH] > length - entry[ENTRY_NAME_OFFSET])
+      || (entry[ENTRY_IMAGE_OFFSET] > length)
+      || (entry[ENTRY_IMAGE_LENGTH] > length - entry[ENTRY_IMAGE_OFFSET])
+      || (i && (entry[ENTRY_HASH] < (entry - ENTRY_WORDS)[ENTRY_HASH]))) {
+      goto INVALID_BUNDLE;
+    }
+  }
+
+  GTA_Bundle * self = gcu_malloc(sizeof(GTA_Bundle));
+  if (!self) {
+    goto INVALID_BUNDLE;
+  }
+  *self = (GTA_Bundle) {
+    .data = data,
+    .length = length,
+    .count = count,
+    .index = index,
+  };
+  atomic_init(&self->references, 1);
+  return self;
+
+INVALID_BUNDLE:
+  unmap_file(data, length);
+  return 0;
+}
+
+
+void gta_bundle_destroy(GTA_Bundle * self) {
+  gta_bundle_release(self);
+}
+
+
+GTA_Bundle * gta_bundle_retain(GTA_Bundle * self) {
+  assert(self);
+  atomic_fetch_add_explicit(&self->references, 1, memory_order_relaxed);
+  return self;
+}
+
+
+void gta_bundle_release(GTA_Bundle * self) {
+  assert(self);
+  // The last reference must see every use of the mapping by the others.
+  if (atomic_fetch_sub_explicit(&self->references, 1, memory_order_acq_rel) == 1) {
+    unmap_file(self->data, self->length);
+    gcu_free(self);
+  }
+}
+
+
+size_t gta_bundle_count(GTA_Bundle * self) {
+  assert(self);
+  return self->count;
+}
+
+
+const char * gta_bundle_get_name(GTA_Bundle * self, size_t index, size_t * length) {
+  assert(self);
+  assert(index < self->count);
+  assert(length);
+  const uint64_t * entry = self->index + (index * ENTRY_WORDS);
+  *length = (size_t)entry[ENTRY_NAME_LENGTH];
+  return (const char *)self->data + entry[ENTRY_NAME_OFFSET];
+}
+
+
+/**
+ * Find the index entry of a program.
+ *
+ * @param self The bundle.
+ * @param name The name of the program.
+ * @return The index entry, or NULL if the bundle does not contain the program.
+ */
+static const uint64_t * find_entry(GTA_Bundle * self, const char * name) {
+  size_t name_length = strlen(name);
+  GTA_UInteger hash = GTA_STRING_HASH(name, name_length);
+
+  // Find the first entry with the hash.
+  size_t low = 0;
+  size_t high = self->count;
+  while (low < high) {
+    size_t middle = low + ((high - low) / 2);
+    if (self->index[(middle * ENTRY_WORDS) + ENTRY_HASH] < hash) {
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
+  }
+
+  // Different names may have the same hash.
+  for (; low < self->count; ++low) {
+    const uint64_t * entry = self->index + (low * ENTRY_WORDS);
+    if (entry[ENTRY_HASH] != hash) {
+      break;
+    }
+    if ((entry[ENTRY_NAME_LENGTH] == name_length) && !memcmp(self->data + entry[ENTRY_NAME_OFFSET], name, name_length)) {
+      return entry;
+    }
+  }
+  return 0;
+}
+
+
+bool gta_bundle_contains(GTA_Bundle * self, const char * name) {
+  assert(self);
+  assert(name);
+  return find_entry(self, name);
+}
+
+
+GTA_Program * gta_bundle_load_program(GTA_Bundle * self, GTA_Language * language, const char * name, GTA_Program_Flags flags) {
+  assert(self);
+  assert(name);
+
+  const uint64_t * entry = find_entry(self, name);
+  return entry
+    ? gta_program_create_from_bundle_image(language, self, self->data + entry[ENTRY_IMAGE_OFFSET], (size_t)entry[ENTRY_IMAGE_LENGTH], flags)
+    : 0;
+}
@@ -4,7 +4,87 @@
 #include <cutil/vector.h>
 #include <cutil/memory.h>
 #include <tang/program/bytecode.h>
-#include <tang/computedValue/computedValue.h>
+#include <tang/computedValue/computedValueAll.h>
+
+GTA_Computed_Value_VTable * const gta_bytecode_cast_types[GTA_BYTECODE_CAST_TYPE_COUNT] = {
+  &gta_computed_value_integer_vtable,
+  &gta_computed_value_float_vtable,
+  &gta_computed_value_boolean_vtable,
+  &gta_computed_value_string_vtable,
+};
+
+size_t gta_bytecode_instruction_size(GTA_UInteger opcode) {
+  switch (opcode) {
+    case GTA_BYTECODE_RETURN:
+    case GTA_BYTECODE_NOP:
+    case GTA_BYTECODE_NULL:
+    case GTA_BYTECODE_SET_NOT_TEMP:
+    case GTA_BYTECODE_ADOPT:
+    case GTA_BYTECODE_POP:
+    case GTA_BYTECODE_PUSH_BP:
+    case GTA_BYTECODE_PUSH_PC:
+    case GTA_BYTECODE_POP_BP:
+    case GTA_BYTECODE_POP_PC:
+    case GTA_BYTECODE_MARK_FP:
+    case GTA_BYTECODE_PUSH_FP:
+    case GTA_BYTECODE_POP_FP:
+    case GTA_BYTECODE_NEGATIVE:
+    case GTA_BYTECODE_NOT:
+    case GTA_BYTECODE_ADD:
+    case GTA_BYTECODE_SUBTRACT:
+    case GTA_BYTECODE_MULTIPLY:
+    case GTA_BYTECODE_DIVIDE:
+    case GTA_BYTECODE_MODULO:
+    case GTA_BYTECODE_LESS_THAN:
+    case GTA_BYTECODE_LESS_THAN_EQUAL:
+    case GTA_BYTECODE_GREATER_THAN:
+    case GTA_BYTECODE_GREATER_THAN_EQUAL:
+    case GTA_BYTECODE_EQUAL:
+    case GTA_BYTECODE_NOT_EQUAL:
+    case GTA_BYTECODE_AND:
+    case GTA_BYTECODE_OR:
+    case GTA_BYTECODE_PRINT:
+    case GTA_BYTECODE_INDEX:
+    case GTA_BYTECODE_SLICE:
+    case GTA_BYTECODE_ASSIGN_INDEX:
+    case GTA_BYTECODE_ITERATOR:
+    case GTA_BYTECODE_ITERATOR_NEXT:
+    case GTA_BYTECODE_ADD_INT_INT:
+    case GTA_BYTECODE_LESS_THAN_INT_INT:
+    case GTA_BYTECODE_RANGE:
+      return 1;
+    case GTA_BYTECODE_BOOLEAN:
+    case GTA_BYTECODE_FLOAT:
+    case GTA_BYTECODE_INTEGER:
+    case GTA_BYTECODE_STRING:
+    case GTA_BYTECODE_ARRAY:
+    case GTA_BYTECODE_MAP:
+    case GTA_BYTECODE_CAST:
+    case GTA_BYTECODE_PEEK_GLOBAL:
+    case GTA_BYTECODE_POKE_GLOBAL:
+    case GTA_BYTECODE_PEEK_LOCAL:
+    case GTA_BYTECODE_POKE_LOCAL:
+    case GTA_BYTECODE_LOAD:
+    case GTA_BYTECODE_LOAD_LIBRARY:
+    case GTA_BYTECODE_JMP:
+    case GTA_BYTECODE_JMPF:
+    case GTA_BYTECODE_JMPT:
+    case GTA_BYTECODE_CALL:
+    case GTA_BYTECODE_JMPF_BOOLEAN:
+      return 2;
+    case GTA_BYTECODE_INC_LOCAL_IMM:
+    case GTA_BYTECODE_ITERATOR_LOCAL:
+    case GTA_BYTECODE_PERIOD:
+      return 3;
+    case GTA_BYTECODE_ITERATOR_NEXT_LOCAL:
+      return 4;
+    case GTA_BYTECODE_CMP_LOCAL_IMM_JMPF:
+      return 5;
+    default:
+      return 0;
+  }
+}
+
 
 void gta_bytecode_print(GTA_VectorX * bytecode) {
   assert(bytecode);
@@ -52,7 +132,7 @@ void gta_bytecode_print(GTA_VectorX * bytecode) {
         current += 2;
         break;
       case GTA_BYTECODE_CAST:
-        printf("%4zu CAST\t%p\n", current - start, GTA_TYPEX_P(*(current + 1)));
+        printf("%4zu CAST\t%zu\n", current - start, GTA_TYPEX_UI(*(current + 1)));
         current += 2;
         break;
       case GTA_BYTECODE_SET_NOT_TEMP:
@@ -95,14 +175,10 @@ void gta_bytecode_print(GTA_VectorX * bytecode) {
         printf("%4zu POP_FP\n", current - start);
         ++current;
         break;
-      case GTA_BYTECODE_LOAD: {
-        GTA_Computed_Value * value = GTA_TYPEX_P(*(current + 1));
-        char * output = gta_computed_value_to_string(value);
-        printf("%4zu LOAD\t%zu\t%s\n", current - start, GTA_TYPEX_UI(*(current + 1)), output);
-        gcu_free(output);
+      case GTA_BYTECODE_LOAD:
+        printf("%4zu LOAD\t%zu\n", current - start, GTA_TYPEX_UI(*(current + 1)));
         current += 2;
         break;
-      }
       case GTA_BYTECODE_LOAD_LIBRARY:
         printf("%4zu LOAD_LIBRARY\t%zu\n", current - start, GTA_TYPEX_UI(*(current + 1)));
         current += 2;
@@ -188,7 +264,7 @@ void gta_bytecode_print(GTA_VectorX * bytecode) {
         ++current;
         break;
       case GTA_BYTECODE_PERIOD:
-        printf("%4zu PERIOD\t%p (%s)\n", current - start, GTA_TYPEX_P(*(current + 1)), (char *)GTA_TYPEX_P(*(current + 2)));
+        printf("%4zu PERIOD\t%zu\t%zu\n", current - start, GTA_TYPEX_UI(*(current + 1)), GTA_TYPEX_UI(*(current + 2)));
         current += 3;
         break;
       case GTA_BYTECODE_SLICE:
@@ -211,6 +287,46 @@ void gta_bytecode_print(GTA_VectorX * bytecode) {
         printf("%4zu CALL\t%zu\n", current - start, GTA_TYPEX_UI(*(current + 1)));
         current += 2;
         break;
+      case GTA_BYTECODE_ADD_INT_INT:
+        printf("%4zu ADD_INT_INT\n", current - start);
+        ++current;
+        break;
+      case GTA_BYTECODE_LESS_THAN_INT_INT:
+        printf("%4zu LESS_THAN_INT_INT\n", current - start);
+        ++current;
+        break;
+      case GTA_BYTECODE_JMPF_BOOLEAN:
+        printf("%4zu JMPF_BOOLEAN\t%zd\n", current - start, GTA_TYPEX_I(*(current + 1)));
+        current += 2;
+        break;
+      case GTA_BYTECODE_INC_LOCAL_IMM:
+        printf("%4zu INC_LOCAL_IMM\t%zu\t%zd\n", current - start, GTA_TYPEX_UI(*(current + 1)), GTA_TYPEX_I(*(current + 2)));
+        current += 3;
+        break;
+      case GTA_BYTECODE_CMP_LOCAL_IMM_JMPF:
+        printf("%4zu CMP_LOCAL_IMM_JMPF\t%zu\t%s\t%zd\t%zd\n", current - start, GTA_TYPEX_UI(*(current + 1)),
+          GTA_TYPEX_UI(*(current + 2)) == GTA_BYTECODE_LESS_THAN ? "<"
+          : GTA_TYPEX_UI(*(current + 2)) == GTA_BYTECODE_LESS_THAN_EQUAL ? "<="
+          : GTA_TYPEX_UI(*(current + 2)) == GTA_BYTECODE_GREATER_THAN ? ">"
+          : GTA_TYPEX_UI(*(current + 2)) == GTA_BYTECODE_GREATER_THAN_EQUAL ? ">="
+          : GTA_TYPEX_UI(*(current + 2)) == GTA_BYTECODE_EQUAL ? "=="
+          : GTA_TYPEX_UI(*(current + 2)) == GTA_BYTECODE_NOT_EQUAL ? "!="
+          : "?",
+          GTA_TYPEX_I(*(current + 3)), GTA_TYPEX_I(*(current + 4)));
+        current += 5;
+        break;
+      case GTA_BYTECODE_ITERATOR_LOCAL:
+        printf("%4zu ITERATOR_LOCAL\t%zu\t%zu\n", current - start, GTA_TYPEX_UI(*(current + 1)), GTA_TYPEX_UI(*(current + 2)));
+        current += 3;
+        break;
+      case GTA_BYTECODE_ITERATOR_NEXT_LOCAL:
+        printf("%4zu ITERATOR_NEXT_LOCAL\t%zu\t%zu\t%zd\n", current - start, GTA_TYPEX_UI(*(current + 1)), GTA_TYPEX_UI(*(current + 2)), GTA_TYPEX_I(*(current + 3)));
+        current += 4;
+        break;
+      case GTA_BYTECODE_RANGE:
+        printf("%4zu RANGE\n", current - start);
+        ++current;
+        break;
       default:
         printf("%4zu Unknown\n", current - start);
         ++current;
@@ -0,0 +1,687 @@
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <cutil/memory.h>
+#include <tang/computedValue/computedValueAll.h>
+#include <tang/program/bytecode.h>
+#include <tang/program/bytecodeImage.h>
+#include <tang/program/inlineCache.h>
+#include <tang/program/program.h>
+#include <tang/unicodeString.h>
+
+/**
+ * The word used to detect an image which was created on a machine with a
+ * different byte order.
+ */
+#define BYTE_ORDER_MARKER UINT64_C(0x0102030405060708)
+
+/**
+ * The positions of the words in the image header.
+ * @{
+ */
+#define HEADER_MAGIC 0
+#define HEADER_VERSION 1
+#define HEADER_BYTE_ORDER 2
+#define HEADER_INTEGER_SIZE 3
+#define HEADER_FLOAT_SIZE 4
+#define HEADER_FLAGS 5
+#define HEADER_CONSTANT_COUNT 6
+#define HEADER_BYTECODE_COUNT 7
+#define HEADER_WORDS 8
+/** @} */
+
+/**
+ * The kinds of entries in the constant pool.
+ * @{
+ */
+#define CONSTANT_UNUSED 0
+#define CONSTANT_INTEGER 1
+#define CONSTANT_FLOAT 2
+#define CONSTANT_STRING 3
+#define CONSTANT_FUNCTION 4
+#define CONSTANT_INLINE_CACHE 5
+/** @} */
+
+/**
+ * The state of an image while it is being loaded.
+ */
+typedef struct Image_Reader {
+  /**
+   * The image.
+   */
+  const unsigned char * data;
+  /**
+   * The length of the image in bytes.
+   */
+  size_t length;
+  /**
+   * The position of the next unread byte.
+   */
+  size_t position;
+} Image_Reader;
+
+
+/**
+ * Append a word to an image.
+ *
+ * @param image The image.
+ * @param word The word to append.
+ * @return True on success, false otherwise.
+ */
+static bool append_word(GCU_Vector64 * image, uint64_t word) {
+  return gcu_vector64_append(image, GCU_TYPE64_UI64(word));
+}
+
+
+/**
+ * Append a byte string to an image.
+ *
+ * The length is written first, followed by the bytes, padded with zeros to a
+ * whole number of words.  At least one zero byte is always written after the
+ * bytes, so that the string can be used in place as a null terminated string.
+ *
+ * @param image The image.
+ * @param bytes The bytes to append.
+ * @param length The number of bytes.
+ * @return True on success, false otherwise.
+ */
+static bool append_bytes(GCU_Vector64 * image, const char * bytes, size_t length) {
+  if (!append_word(image, length)) {
+    return false;
+  }
+  for (size_t i = 0; i <= length; i += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, bytes + i, length - i < sizeof(uint64_t) ? length - i : sizeof(uint64_t));
+    if (!append_word(image, word)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/**
+ * Append a constant to an image.
+ *
+ * @param image The image.
+ * @param kind The kind of the constant.
+ * @param constant The constant.
+ * @param hash The attribute hash, if the constant is an inline cache.
+ * @return True on success, false otherwise.
+ */
+static bool append_constant(GCU_Vector64 * image, unsigned char kind, void * constant, uint64_t hash) {
+  if (!append_word(image, kind)) {
+    return false;
+  }
+  switch (kind) {
+    case CONSTANT_INTEGER:
+      return append_word(image, (uint64_t)(int64_t)((GTA_Computed_Value_Integer *)constant)->value);
+    case CONSTANT_FLOAT: {
+      uint64_t bits = 0;
+      memcpy(&bits, &((GTA_Computed_Value_Float *)constant)->value, sizeof(GTA_Float));
+      return append_word(image, bits);
+    }
+    case CONSTANT_STRING: {
+      GTA_Unicode_String * string = ((GTA_Computed_Value_String *)constant)->value;
+      if (!append_word(image, string->string_type->count)) {
+        return false;
+      }
+      for (size_t i = 0; i < string->string_type->count; ++i) {
+        if (!append_word(image, string->string_type->data[i].ui64)) {
+          return false;
+        }
+      }
+      return append_bytes(image, string->buffer, string->byte_length);
+    }
+    case CONSTANT_FUNCTION: {
+      GTA_Computed_Value_Function * function = (GTA_Computed_Value_Function *)constant;
+      return append_word(image, function->num_arguments)
+        && append_word(image, function->pointer);
+    }
+    case CONSTANT_INLINE_CACHE:
+      return append_word(image, hash);
+  }
+  // An unused constant has no value.
+  return true;
+}
+
+
+/**
+ * Get the kind of constant that a LOAD instruction loads.
+ *
+ * @param value The value that is loaded.
+ * @return The kind of the constant, or CONSTANT_UNUSED if the value cannot be
+ *   stored in an image.
+ */
+static unsigned char load_kind(GTA_Computed_Value * value) {
+  return GTA_COMPUTED_VALUE_IS_FUNCTION(value)
+    ? CONSTANT_FUNCTION
+    : GTA_COMPUTED_VALUE_IS_INTEGER(value)
+      ? CONSTANT_INTEGER
+      : GTA_COMPUTED_VALUE_IS_FLOAT(value)
+        ? CONSTANT_FLOAT
+        : GTA_COMPUTED_VALUE_IS_STRING(value)
+          ? CONSTANT_STRING
+          // Only literals and functions are ever loaded by the compiler.
+          : CONSTANT_UNUSED;
+}
+
+
+GCU_Vector64 * gta_bytecode_image_create(GTA_Program * program) {
+  assert(program);
+  assert(program->constants);
+
+  if (!program->bytecode) {
+    return 0;
+  }
+  GTA_VectorX * bytecode = program->bytecode;
+  GTA_VectorX * constants = program->constants;
+  GCU_Vector64 * image = 0;
+
+  // The bytecode does not say what kind of object each constant is, but the
+  // instructions which use it do.
+  unsigned char * kinds = gcu_calloc(constants->count + 1, sizeof(unsigned char));
+  if (!kinds) {
+    return 0;
+  }
+  uint64_t * hashes = gcu_calloc(constants->count + 1, sizeof(uint64_t));
+  if (!hashes) {
+    goto HASHES_CREATE_FAILED;
+  }
+
+  size_t size;
+  for (size_t position = 0; position < bytecode->count; position += size) {
+    GTA_TypeX_Union * code = &bytecode->data[position];
+    GTA_UInteger opcode = GTA_TYPEX_UI(code[0]);
+    size = gta_bytecode_instruction_size(opcode);
+    if (!size || (position + size > bytecode->count)) {
+      goto CLASSIFY_FAILED;
+    }
+    unsigned char kind;
+    GTA_UInteger index;
+    switch (opcode) {
+      case GTA_BYTECODE_LOAD:
+        index = GTA_TYPEX_UI(code[1]);
+        if ((index >= constants->count) || !(kind = load_kind(GTA_TYPEX_P(constants->data[index])))) {
+          goto CLASSIFY_FAILED;
+        }
+        break;
+      case GTA_BYTECODE_PERIOD:
+        index = GTA_TYPEX_UI(code[2]);
+        if (index >= constants->count) {
+          goto CLASSIFY_FAILED;
+        }
+        kind = CONSTANT_INLINE_CACHE;
+        hashes[index] = GTA_TYPEX_UI(code[1]);
+        break;
+      case GTA_BYTECODE_STRING:
+        // The operand is a raw pointer whose length is not known.
+        goto CLASSIFY_FAILED;
+      default:
+        // All other operands are plain values.
+        continue;
+    }
+    if (kinds[index] && (kinds[index] != kind)) {
+      goto CLASSIFY_FAILED;
+    }
+    kinds[index] = kind;
+  }
+
+  // Assemble the image.  The bytecode is copied as is.
+  image = gcu_vector64_create(HEADER_WORDS + (2 * constants->count) + bytecode->count);
+  if (!image) {
+    goto CLASSIFY_FAILED;
+  }
+  bool success = true
+    && append_word(image, GTA_BYTECODE_IMAGE_MAGIC)
+    && append_word(image, GTA_BYTECODE_IMAGE_VERSION)
+    && append_word(image, BYTE_ORDER_MARKER)
+    && append_word(image, sizeof(GTA_UInteger))
+    && append_word(image, sizeof(GTA_Float))
+    && append_word(image, program->flags & GTA_PROGRAM_FLAG_IS_TEMPLATE)
+    && append_word(image, constants->count)
+    && append_word(image, bytecode->count);
+  for (size_t i = 0; success && (i < constants->count); ++i) {
+    success = append_constant(image, kinds[i], GTA_TYPEX_P(constants->data[i]), hashes[i]);
+  }
+  for (size_t i = 0; success && (i < bytecode->count); ++i) {
+    success = append_word(image, GTA_TYPEX_UI(bytecode->data[i]));
+  }
+  if (!success) {
+    gcu_vector64_destroy(image);
+    image = 0;
+  }
+
+  // Cleanup and exit.  On failure, image is NULL.
+CLASSIFY_FAILED:
+  gcu_free(hashes);
+HASHES_CREATE_FAILED:
+  gcu_free(kinds);
+  return image;
+}
+
+
+/**
+ * Read a block of words from an image.
+ *
+ * @param reader The image reader.
+ * @param words The number of words to read.
+ * @return A pointer to the first byte of the block, or NULL if the image is
+ *   too short.  The block may not be aligned.
+ */
+static const unsigned char * read_block(Image_Reader * reader, uint64_t words) {
+  if (words > (reader->length - reader->position) / sizeof(uint64_t)) {
+    return 0;
+  }
+  const unsigned char * block = reader->data + reader->position;
+  reader->position += (size_t)words * sizeof(uint64_t);
+  return block;
+}
+
+
+/**
+ * Read a word from an image.
+ *
+ * @param reader The image reader.
+ * @param word Set to the word on success.
+ * @return True on success, false if the image is too short.
+ */
+static bool read_word(Image_Reader * reader, uint64_t * word) {
+  const unsigned char * block = read_block(reader, 1);
+  if (!block) {
+    return false;
+  }
+  memcpy(word, block, sizeof(uint64_t));
+  return true;
+}
+
+
+/**
+ * Read a byte string from an image.
+ *
+ * @param reader The image reader.
+ * @param bytes Set to the first byte of the string on success.  The string is
+ *   null terminated.
+ * @param length Set to the number of bytes on success.
+ * @return True on success, false if the image is too short or the string is
+ *   not null terminated.
+ */
+static bool read_bytes(Image_Reader * reader, const char ** bytes, size_t * length) {
+  uint64_t byte_length;
+  if (!read_word(reader, &byte_length) || (byte_length >= reader->length)) {
+    return false;
+  }
+  const unsigned char * block = read_block(reader, (byte_length / sizeof(uint64_t)) + 1);
+  if (!block || block[byte_length]) {
+    return false;
+  }
+  *bytes = (const char *)block;
+  *length = (size_t)byte_length;
+  return true;
+}
+
+
+/**
+ * Read a string constant from an image.
+ *
+ * @param reader The image reader.
+ * @param in_place Whether or not the string may use the bytes of the image,
+ *   rather than a copy of them.
+ * @return The new string value, or NULL if the image is not valid or memory
+ *   could not be allocated.
+ */
+static GTA_Computed_Value * read_string_constant(Image_Reader * reader, bool in_place) {
+  uint64_t part_count;
+  if (!read_word(reader, &part_count) || !part_count) {
+    return 0;
+  }
+  const unsigned char * parts = read_block(reader, part_count);
+  const char * bytes;
+  size_t length;
+  if (!parts || !read_bytes(reader, &bytes, &length)) {
+    return 0;
+  }
+
+  // The parts must start at the beginning of the string, and be in order.
+  GCU_Type64_Union previous = {.ui64 = 0};
+  for (size_t i = 0; i < part_count; ++i) {
+    GCU_Type64_Union part;
+    memcpy(&part.ui64, parts + i * sizeof(uint64_t), sizeof(uint64_t));
+    if ((i == 0)
+      ? (GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(part) != 0)
+      : ((GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(part) <= GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(previous)) || (GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(part) >= length))) {
+      return 0;
+    }
+    previous = part;
+  }
+
+  GCU_Type64_Union first;
+  memcpy(&first.ui64, parts, sizeof(uint64_t));
+  GTA_String_Type type = (GTA_String_Type)GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(first);
+  GTA_Unicode_String * string = in_place
+    ? gta_unicode_string_create_borrowed(bytes, length, type)
+    : gta_unicode_string_create(bytes, length, type);
+  if (!string) {
+    return 0;
+  }
+  if (part_count > 1) {
+    if (!gcu_vector64_reserve(string->string_type, (size_t)part_count)) {
+      gta_unicode_string_destroy(string);
+      return 0;
+    }
+    memcpy(string->string_type->data, parts, (size_t)part_count * sizeof(uint64_t));
+    string->string_type->count = (size_t)part_count;
+  }
+
+  GTA_Computed_Value * value = (GTA_Computed_Value *)gta_computed_value_string_create(string, true, 0);
+  if (!value) {
+    gta_unicode_string_destroy(string);
+  }
+  return value;
+}
+
+
+/**
+ * Read a constant from an image.
+ *
+ * The constant is owned by the program, either as a singleton or as an
+ * inline cache.
+ *
+ * @param reader The image reader.
+ * @param program The program that is being loaded.
+ * @param index The index of the constant in the constant pool.
+ * @param in_place Whether or not a string may use the bytes of the image.
+ * @param kind Set to the kind of the constant on success.
+ * @param constant Set to the constant on success (NULL if it is unused).
+ * @return True on success, false if the image is not valid or memory could
+ *   not be allocated.
+ */
+static bool read_constant(Image_Reader * reader, GTA_Program * program, size_t index, bool in_place, unsigned char * kind, void * * constant) {
+  uint64_t type;
+  uint64_t word;
+  uint64_t pointer;
+  if (!read_word(reader, &type)) {
+    return false;
+  }
+
+  GTA_Computed_Value * value = 0;
+  switch (type) {
+    case CONSTANT_UNUSED:
+      *kind = CONSTANT_UNUSED;
+      *constant = 0;
+      return true;
+    case CONSTANT_INTEGER:
+      if (read_word(reader, &word)) {
+        value = (GTA_Computed_Value *)gta_computed_value_integer_create((GTA_Integer)(int64_t)word, 0);
+      }
+      break;
+    case CONSTANT_FLOAT:
+      if (read_word(reader, &word)) {
+        GTA_Float number;
+        memcpy(&number, &word, sizeof(GTA_Float));
+        value = (GTA_Computed_Value *)gta_computed_value_float_create(number, 0);
+      }
+      break;
+    case CONSTANT_STRING:
+      value = read_string_constant(reader, in_place);
+      break;
+    case CONSTANT_FUNCTION:
+      // The pointer is checked once the bytecode has been read.
+      if (read_word(reader, &word) && read_word(reader, &pointer) && (pointer < reader->length)) {
+        value = (GTA_Computed_Value *)gta_computed_value_function_create((size_t)word, (size_t)pointer, 0);
+      }
+      break;
+    case CONSTANT_INLINE_CACHE:
+      // The cache is owned by the program as soon as it is created.
+      *kind = CONSTANT_INLINE_CACHE;
+      return read_word(reader, &word)
+        && (*constant = gta_inline_cache_create(program, (GTA_UInteger)word));
+  }
+
+  if (!value) {
+    return false;
+  }
+  if (!gta_program_set_singleton(program, value->vtable, index, value)) {
+    gta_computed_value_destroy(value);
+    return false;
+  }
+  *kind = (unsigned char)type;
+  *constant = value;
+  return true;
+}
+
+
+/**
+ * Determine whether or not an opcode is a jump.
+ *
+ * The jump offset is always the last operand of the instruction.
+ *
+ * @param opcode The opcode.
+ * @return True if the opcode is a jump, false otherwise.
+ */
+static bool is_jump(GTA_UInteger opcode) {
+  return opcode == GTA_BYTECODE_JMP
+    || opcode == GTA_BYTECODE_JMPF
+    || opcode == GTA_BYTECODE_JMPT
+    || opcode == GTA_BYTECODE_JMPF_BOOLEAN
+    || opcode == GTA_BYTECODE_CMP_LOCAL_IMM_JMPF
+    || opcode == GTA_BYTECODE_ITERATOR_NEXT_LOCAL;
+}
+
+
+/**
+ * Create the bytecode vector of a program from the bytecode section of an
+ * image.
+ *
+ * If the image is used in place, then the vector and its words are a single
+ * allocation (which is freed with gcu_free()), and the words are those of the
+ * image itself whenever their size and alignment allow it.  Otherwise, the
+ * vector is an ordinary vector which owns a copy of the words.
+ *
+ * @param words The bytecode section of the image.  It may not be aligned.
+ * @param count The number of words in the bytecode section.
+ * @param in_place Whether or not the image may be used in place.
+ * @return The bytecode vector, or NULL if memory could not be allocated.
+ */
+static GTA_VectorX * create_bytecode(const unsigned char * words, size_t count, bool in_place) {
+  bool is_shared = in_place
+    && (sizeof(GTA_TypeX_Union) == sizeof(uint64_t))
+    && !((uintptr_t)words % _Alignof(GTA_TypeX_Union));
+
+  GTA_VectorX * bytecode = in_place
+    ? gcu_malloc(sizeof(GTA_VectorX) + (is_shared ? 0 : count * sizeof(GTA_TypeX_Union)))
+    : GTA_VECTORX_CREATE(count);
+  if (!bytecode) {
+    return 0;
+  }
+  if (in_place) {
+    *bytecode = (GTA_VectorX) {
+      .capacity = count,
+      .count = count,
+      .data = is_shared
+        ? (GTA_TypeX_Union *)(uintptr_t)words
+        : (GTA_TypeX_Union *)(bytecode + 1),
+    };
+    if (is_shared) {
+      return bytecode;
+    }
+  }
+
+  // Copy the words, which may be narrower than an image word.
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t word;
+    memcpy(&word, words + i * sizeof(uint64_t), sizeof(uint64_t));
+    bytecode->data[i] = GTA_TYPEX_MAKE_UI((GTA_UInteger)word);
+  }
+  bytecode->count = count;
+  return bytecode;
+}
+
+
+/**
+ * Load a bytecode image into a program.
+ *
+ * @see gta_bytecode_image_load()
+ * @see gta_bytecode_image_load_in_place()
+ *
+ * @param program The program to load the image into.
+ * @param data The image.
+ * @param length The length of the image in bytes.
+ * @param in_place Whether or not the program may keep using the image.
+ * @return True on success, false if the image is not valid or if memory could
+ *   not be allocated.
+ */
+static bool load(GTA_Program * program, const void * data, size_t length, bool in_place) {
+  assert(program);
+  assert(program->constants);
+  assert(!program->bytecode);
+  assert(data || !length);
+
+  Image_Reader reader = {
+    .data = data,
+    .length = length,
+    .position = 0,
+  };
+
+  // Verify that the image was made for this platform.
+  uint64_t header[HEADER_WORDS];
+  for (size_t i = 0; i < HEADER_WORDS; ++i) {
+    if (!read_word(&reader, &header[i])) {
+      return false;
+    }
+  }
+  if ((header[HEADER_MAGIC] != GTA_BYTECODE_IMAGE_MAGIC)
+    || (header[HEADER_VERSION] != GTA_BYTECODE_IMAGE_VERSION)
+    || (header[HEADER_BYTE_ORDER] != BYTE_ORDER_MARKER)
+    || (header[HEADER_INTEGER_SIZE] != sizeof(GTA_UInteger))
+    || (header[HEADER_FLOAT_SIZE] != sizeof(GTA_Float))) {
+    return false;
+  }
+
+  // Every constant and every instruction uses at least one word, so a count
+  // that is larger than the image must be corrupt.
+  size_t max_count = length / sizeof(uint64_t);
+  if ((header[HEADER_CONSTANT_COUNT] > max_count)
+    || (header[HEADER_BYTECODE_COUNT] > max_count)) {
+    return false;
+  }
+  size_t constant_count = (size_t)header[HEADER_CONSTANT_COUNT];
+  size_t count = (size_t)header[HEADER_BYTECODE_COUNT];
+  program->flags |= (GTA_Program_Flags)(header[HEADER_FLAGS] & GTA_PROGRAM_FLAG_IS_TEMPLATE);
+
+  unsigned char * kinds = gcu_calloc(constant_count + 1, sizeof(unsigned char));
+  if (!kinds) {
+    return false;
+  }
+  unsigned char * is_instruction = gcu_calloc(count + 1, sizeof(unsigned char));
+  if (!is_instruction) {
+    goto IS_INSTRUCTION_CREATE_FAILED;
+  }
+
+  // Read the constants, in order, so that the operands in the bytecode refer
+  // to the same constants as they did in the program that was saved.  The
+  // constants are owned by the program as soon as they are created.
+  for (size_t i = 0; i < constant_count; ++i) {
+    void * constant;
+    if (!read_constant(&reader, program, i, in_place, &kinds[i], &constant)
+      || !GTA_VECTORX_APPEND(program->constants, GTA_TYPEX_MAKE_P(constant))) {
+      goto LOAD_FAILED;
+    }
+  }
+
+  // The bytecode is the last section of the image.
+  const unsigned char * words = read_block(&reader, count);
+  if (!words || (reader.position != length)) {
+    goto LOAD_FAILED;
+  }
+  if (!(program->bytecode = create_bytecode(words, count, in_place))) {
+    goto LOAD_FAILED;
+  }
+  GTA_TypeX_Union * code = program->bytecode->data;
+
+  // Verify the instructions and the operands that refer to the constants.
+  size_t size;
+  for (size_t position = 0; position < count; position += size) {
+    GTA_UInteger opcode = GTA_TYPEX_UI(code[position]);
+    size = gta_bytecode_instruction_size(opcode);
+    if (!size || (position + size > count)) {
+      goto LOAD_FAILED;
+    }
+    is_instruction[position] = true;
+
+    GTA_UInteger operand;
+    switch (opcode) {
+      case GTA_BYTECODE_LOAD:
+        operand = GTA_TYPEX_UI(code[position + 1]);
+        if ((operand >= constant_count) || (kinds[operand] == CONSTANT_UNUSED) || (kinds[operand] == CONSTANT_INLINE_CACHE)) {
+          goto LOAD_FAILED;
+        }
+        break;
+      case GTA_BYTECODE_PERIOD:
+        operand = GTA_TYPEX_UI(code[position + 2]);
+        if ((operand >= constant_count) || (kinds[operand] != CONSTANT_INLINE_CACHE)) {
+          goto LOAD_FAILED;
+        }
+        break;
+      case GTA_BYTECODE_CAST:
+        if (GTA_TYPEX_UI(code[position + 1]) >= GTA_BYTECODE_CAST_TYPE_COUNT) {
+          goto LOAD_FAILED;
+        }
+        break;
+      case GTA_BYTECODE_STRING:
+        goto LOAD_FAILED;
+    }
+  }
+  is_instruction[count] = true;
+
+  // Every jump and every function must land on an instruction.
+  for (size_t position = 0; position < count; position += size) {
+    GTA_UInteger opcode = GTA_TYPEX_UI(code[position]);
+    size = gta_bytecode_instruction_size(opcode);
+    if (is_jump(opcode)) {
+      GTA_Integer target = (GTA_Integer)(position + size) + GTA_TYPEX_I(code[position + size - 1]);
+      if ((target < 0) || ((size_t)target > count) || !is_instruction[target]) {
+        goto LOAD_FAILED;
+      }
+    }
+  }
+  for (size_t i = 0; i < constant_count; ++i) {
+    if (kinds[i] == CONSTANT_FUNCTION) {
+      size_t pointer = ((GTA_Computed_Value_Function *)GTA_TYPEX_P(program->constants->data[i]))->pointer;
+      if ((pointer >= count) || !is_instruction[pointer]) {
+        goto LOAD_FAILED;
+      }
+    }
+  }
+
+  gcu_free(is_instruction);
+  gcu_free(kinds);
+  return true;
+
+  // Failure conditions.  Cleanup and exit.
+LOAD_FAILED:
+  if (program->bytecode) {
+    if (in_place) {
+      gcu_free(program->bytecode);
+    }
+    else {
+      GTA_VECTORX_DESTROY(program->bytecode);
+    }
+    program->bytecode = 0;
+  }
+  gcu_free(is_instruction);
+IS_INSTRUCTION_CREATE_FAILED:
+  gcu_free(kinds);
+  return false;
+}
+
+
+bool gta_bytecode_image_load(GTA_Program * program, const void * data, size_t length) {
+  return load(program, data, length, false);
+}
+
+
+bool gta_bytecode_image_load_in_place(GTA_Program * program, const void * data, size_t length) {
+  return load(program, data, length, true);
+}
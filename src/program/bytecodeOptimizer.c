@@ -0,0 +1,420 @@
+
+#include <assert.h>
+#include <stdint.h>
+#include <cutil/memory.h>
+#include <tang/ast/astNodeFunction.h>
+#include <tang/computedValue/computedValueFunction.h>
+#include <tang/program/bytecode.h>
+#include <tang/program/bytecodeOptimizer.h>
+#include <tang/program/compilerContext.h>
+#include <tang/program/program.h>
+#include <tang/program/virtualMachine.h>
+
+/**
+ * The maximum number of jumps that will be followed when threading a jump.
+ *
+ * This prevents an endless search when the jumps form a cycle.
+ */
+#define MAX_THREADED_JUMPS 16
+
+/**
+ * Flag marking the first word of an instruction.
+ */
+#define FLAG_INSTRUCTION 1
+
+/**
+ * Flag marking an instruction which is the destination of a jump or the entry
+ * point of a function.
+ */
+#define FLAG_TARGET 2
+
+/**
+ * Data used when walking the AST to find the function entry points.
+ */
+typedef struct Function_Walk_Data {
+  /**
+   * The instruction flags, indexed by bytecode position.
+   */
+  unsigned char * flags;
+  /**
+   * The new position of each instruction, indexed by its old position.
+   */
+  size_t * new_position;
+} Function_Walk_Data;
+
+
+/**
+ * Determine whether or not an opcode is a jump.
+ *
+ * The jump offset is always the last operand of the instruction.
+ *
+ * @param opcode The opcode.
+ * @return True if the opcode is a jump, false otherwise.
+ */
+static bool is_jump(GTA_UInteger opcode) {
+  return opcode == GTA_BYTECODE_JMP
+    || opcode == GTA_BYTECODE_JMPF
+    || opcode == GTA_BYTECODE_JMPT
+    || opcode == GTA_BYTECODE_JMPF_BOOLEAN
+    || opcode == GTA_BYTECODE_CMP_LOCAL_IMM_JMPF
+    || opcode == GTA_BYTECODE_ITERATOR_NEXT_LOCAL;
+}
+
+
+/**
+ * Determine whether or not an opcode jumps if the top of the stack is false.
+ *
+ * @param opcode The opcode.
+ * @return True if the opcode is JMPF or one of its specializations.
+ */
+static bool is_jump_if_false(GTA_UInteger opcode) {
+  return opcode == GTA_BYTECODE_JMPF
+    || opcode == GTA_BYTECODE_JMPF_BOOLEAN;
+}
+
+
+/**
+ * Determine whether or not an opcode is an addition.
+ *
+ * @param opcode The opcode.
+ * @return True if the opcode is ADD or one of its specializations.
+ */
+static bool is_add(GTA_UInteger opcode) {
+  return opcode == GTA_BYTECODE_ADD
+    || opcode == GTA_BYTECODE_ADD_INT_INT;
+}
+
+
+/**
+ * Get the generic comparison performed by an opcode.
+ *
+ * @param opcode The opcode.
+ * @return The generic comparison opcode, or GTA_BYTECODE_COUNT if the opcode
+ *   is not a comparison.
+ */
+static GTA_UInteger comparison(GTA_UInteger opcode) {
+  switch (opcode) {
+    case GTA_BYTECODE_LESS_THAN:
+    case GTA_BYTECODE_LESS_THAN_INT_INT:
+      return GTA_BYTECODE_LESS_THAN;
+    case GTA_BYTECODE_LESS_THAN_EQUAL:
+    case GTA_BYTECODE_GREATER_THAN:
+    case GTA_BYTECODE_GREATER_THAN_EQUAL:
+    case GTA_BYTECODE_EQUAL:
+    case GTA_BYTECODE_NOT_EQUAL:
+      return opcode;
+    default:
+      return GTA_BYTECODE_COUNT;
+  }
+}
+
+
+/**
+ * Get the destination of a jump instruction.
+ *
+ * @param bytecode The bytecode.
+ * @param position The position of the jump instruction.
+ * @return The position of the destination.
+ */
+static size_t jump_target(GTA_VectorX * bytecode, size_t position) {
+  size_t size = gta_bytecode_instruction_size(GTA_TYPEX_UI(bytecode->data[position]));
+  return (size_t)((GTA_Integer)(position + size) + GTA_TYPEX_I(bytecode->data[position + size - 1]));
+}
+
+
+/**
+ * Follow a chain of jumps to find the final destination of a jump.
+ *
+ * An unconditional jump can always be followed.  A conditional jump can also
+ * be followed through a conditional jump of the same kind (because the value
+ * being tested is unchanged), and jumps to the instruction after a
+ * conditional jump of the opposite kind.
+ *
+ * @param bytecode The bytecode.
+ * @param opcode The opcode of the jump being threaded.
+ * @param target The current destination of the jump.
+ * @return The final destination of the jump.
+ */
+static size_t thread_jump(GTA_VectorX * bytecode, GTA_UInteger opcode, size_t target) {
+  for (size_t i = 0; (i < MAX_THREADED_JUMPS) && (target < bytecode->count); ++i) {
+    GTA_UInteger destination = GTA_TYPEX_UI(bytecode->data[target]);
+    if ((destination == GTA_BYTECODE_JMP)
+      || (is_jump_if_false(opcode) && is_jump_if_false(destination))
+      || ((opcode == GTA_BYTECODE_JMPT) && (destination == GTA_BYTECODE_JMPT))) {
+      target = jump_target(bytecode, target);
+    }
+    else if ((is_jump_if_false(opcode) && (destination == GTA_BYTECODE_JMPT))
+      || ((opcode == GTA_BYTECODE_JMPT) && is_jump_if_false(destination))) {
+      target += gta_bytecode_instruction_size(destination);
+    }
+    else {
+      break;
+    }
+  }
+  return target;
+}
+
+
+/**
+ * Determine whether or not a SET_NOT_TEMP following an instruction has no
+ * observable effect.
+ *
+ * @param code The instruction.
+ * @return True if a following SET_NOT_TEMP may be removed.
+ */
+static bool pushes_non_temporary(GTA_TypeX_Union * code) {
+  switch (GTA_TYPEX_UI(code[0])) {
+    case GTA_BYTECODE_NULL:
+    case GTA_BYTECODE_BOOLEAN:
+    case GTA_BYTECODE_SET_NOT_TEMP:
+      // Singletons are never copied or adopted, so their flag is irrelevant.
+      // A value that has just been made not temporary needs nothing more.
+      return true;
+    case GTA_BYTECODE_INTEGER:
+      // Immediate integers are values, not objects.
+      return GTA_VM_IMMEDIATE_INTEGER_FITS(GTA_TYPEX_I(code[1]));
+    case GTA_BYTECODE_FLOAT:
+      // So are immediate floats.
+      return GTA_VM_IMMEDIATE_FLOAT_FITS(GTA_TYPEX_F(code[1]));
+    default:
+      return false;
+  }
+}
+
+
+/**
+ * Mark the entry point of a function as a jump target.
+ *
+ * @param self The AST node being visited.
+ * @param data The Function_Walk_Data.
+ * @param return_value Unused.
+ */
+static void mark_function_entry(GTA_Ast_Node * self, void * data, GTA_MAYBE_UNUSED(void * return_value)) {
+  assert(self);
+  if (GTA_AST_IS_FUNCTION(self)) {
+    GTA_Ast_Node_Function * function = (GTA_Ast_Node_Function *)self;
+    assert(function->runtime_function);
+    ((Function_Walk_Data *)data)->flags[function->runtime_function->pointer] |= FLAG_TARGET;
+  }
+}
+
+
+/**
+ * Update the entry point of a function to its position in the optimized
+ * bytecode.
+ *
+ * @param self The AST node being visited.
+ * @param data The Function_Walk_Data.
+ * @param return_value Unused.
+ */
+static void update_function_entry(GTA_Ast_Node * self, void * data, GTA_MAYBE_UNUSED(void * return_value)) {
+  assert(self);
+  if (GTA_AST_IS_FUNCTION(self)) {
+    GTA_Ast_Node_Function * function = (GTA_Ast_Node_Function *)self;
+    assert(function->runtime_function);
+    function->runtime_function->pointer = ((Function_Walk_Data *)data)->new_position[function->runtime_function->pointer];
+  }
+}
+
+
+bool gta_bytecode_optimizer_optimize(GTA_Compiler_Context * context) {
+  assert(context);
+  assert(context->program);
+  assert(context->program->bytecode);
+  assert(context->bytecode_offsets);
+
+  GTA_Program * program = context->program;
+  GTA_VectorX * bytecode = program->bytecode;
+  size_t count = bytecode->count;
+
+  unsigned char * flags = gcu_calloc(count + 1, sizeof(unsigned char));
+  if (!flags) {
+    return false;
+  }
+  size_t * new_position = gcu_malloc((count + 1) * sizeof(size_t));
+  if (!new_position) {
+    goto NEW_POSITION_CREATE_FAILED;
+  }
+  GTA_VectorX * optimized = GTA_VECTORX_CREATE(count);
+  if (!optimized) {
+    goto OPTIMIZED_CREATE_FAILED;
+  }
+  GTA_VectorX * offsets = GTA_VECTORX_CREATE(context->bytecode_offsets->count);
+  if (!offsets) {
+    goto OFFSETS_CREATE_FAILED;
+  }
+  // Pairs of (jump offset position in the optimized bytecode, old target).
+  GTA_VectorX * jumps = GTA_VECTORX_CREATE(32);
+  if (!jumps) {
+    goto JUMPS_CREATE_FAILED;
+  }
+
+  // Find the start of every instruction.  If the bytecode cannot be decoded,
+  // then leave it as it is.
+  size_t size;
+  for (size_t position = 0; position < count; position += size) {
+    size = gta_bytecode_instruction_size(GTA_TYPEX_UI(bytecode->data[position]));
+    if (!size || (position + size > count)) {
+      goto UNCHANGED;
+    }
+    flags[position] = FLAG_INSTRUCTION;
+  }
+  flags[count] = FLAG_INSTRUCTION;
+
+  // Verify that every jump lands on an instruction.
+  for (size_t position = 0; position < count; position += gta_bytecode_instruction_size(GTA_TYPEX_UI(bytecode->data[position]))) {
+    if (is_jump(GTA_TYPEX_UI(bytecode->data[position]))) {
+      size_t target = jump_target(bytecode, position);
+      if ((target > count) || !(flags[target] & FLAG_INSTRUCTION)) {
+        goto UNCHANGED;
+      }
+    }
+  }
+
+  // Thread jumps to jumps, and mark the final destinations.
+  flags[0] |= FLAG_TARGET;
+  for (size_t position = 0; position < count; position += size) {
+    GTA_UInteger opcode = GTA_TYPEX_UI(bytecode->data[position]);
+    size = gta_bytecode_instruction_size(opcode);
+    if (is_jump(opcode)) {
+      size_t target = thread_jump(bytecode, opcode, jump_target(bytecode, position));
+      bytecode->data[position + size - 1] = GTA_TYPEX_MAKE_I((GTA_Integer)target - (GTA_Integer)(position + size));
+      flags[target] |= FLAG_TARGET;
+    }
+  }
+  Function_Walk_Data walk_data = {
+    .flags = flags,
+    .new_position = new_position,
+  };
+  gta_ast_node_walk(program->ast, mark_function_entry, &walk_data, 0);
+
+  // Produce the optimized bytecode.
+  size_t previous = SIZE_MAX;
+  for (size_t position = 0; position < count; position += size) {
+    GTA_TypeX_Union * code = &bytecode->data[position];
+    GTA_UInteger opcode = GTA_TYPEX_UI(code[0]);
+    size = gta_bytecode_instruction_size(opcode);
+    new_position[position] = optimized->count;
+
+    // PEEK_LOCAL a, INTEGER k, ADD, POKE_LOCAL a, POP => INC_LOCAL_IMM a k
+    if ((opcode == GTA_BYTECODE_PEEK_LOCAL)
+      && (position + 8 <= count)
+      && (GTA_TYPEX_UI(code[2]) == GTA_BYTECODE_INTEGER)
+      && GTA_VM_IMMEDIATE_INTEGER_FITS(GTA_TYPEX_I(code[3]))
+      && is_add(GTA_TYPEX_UI(code[4]))
+      && (GTA_TYPEX_UI(code[5]) == GTA_BYTECODE_POKE_LOCAL)
+      && (GTA_TYPEX_UI(code[6]) == GTA_TYPEX_UI(code[1]))
+      && (GTA_TYPEX_UI(code[7]) == GTA_BYTECODE_POP)
+      && !((flags[position + 2] | flags[position + 4] | flags[position + 5] | flags[position + 7]) & FLAG_TARGET)) {
+      if (!(true
+        && GTA_BYTECODE_APPEND(offsets, optimized->count)
+        && GTA_VECTORX_APPEND(optimized, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_INC_LOCAL_IMM))
+        && GTA_VECTORX_APPEND(optimized, code[1])
+        && GTA_VECTORX_APPEND(optimized, code[3]))) {
+        goto OPTIMIZE_FAILED;
+      }
+      size = 8;
+    }
+
+    // PEEK_LOCAL a, INTEGER k, <comparison>, JMPF offset
+    //   => CMP_LOCAL_IMM_JMPF a <comparison> k offset
+    else if ((opcode == GTA_BYTECODE_PEEK_LOCAL)
+      && (position + 7 <= count)
+      && (GTA_TYPEX_UI(code[2]) == GTA_BYTECODE_INTEGER)
+      && GTA_VM_IMMEDIATE_INTEGER_FITS(GTA_TYPEX_I(code[3]))
+      && (comparison(GTA_TYPEX_UI(code[4])) != GTA_BYTECODE_COUNT)
+      && is_jump_if_false(GTA_TYPEX_UI(code[5]))
+      && !((flags[position + 2] | flags[position + 4] | flags[position + 5]) & FLAG_TARGET)) {
+      if (!(true
+        && GTA_BYTECODE_APPEND(offsets, optimized->count)
+        && GTA_VECTORX_APPEND(optimized, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_CMP_LOCAL_IMM_JMPF))
+        && GTA_VECTORX_APPEND(optimized, code[1])
+        && GTA_VECTORX_APPEND(optimized, GTA_TYPEX_MAKE_UI(comparison(GTA_TYPEX_UI(code[4]))))
+        && GTA_VECTORX_APPEND(optimized, code[3])
+        && GTA_VECTORX_APPEND(optimized, GTA_TYPEX_MAKE_I(0))
+        && GTA_BYTECODE_APPEND(jumps, optimized->count - 1)
+        && GTA_BYTECODE_APPEND(jumps, jump_target(bytecode, position + 5)))) {
+        goto OPTIMIZE_FAILED;
+      }
+      size = 7;
+    }
+
+    // A SET_NOT_TEMP which can only be reached from an instruction that
+    // pushes a non-temporary value is dropped.
+    else if ((opcode == GTA_BYTECODE_SET_NOT_TEMP)
+      && !(flags[position] & FLAG_TARGET)
+      && (previous != SIZE_MAX)
+      && pushes_non_temporary(&bytecode->data[previous])) {
+      // Nothing to emit.
+    }
+
+    // Any other instruction is copied as-is.
+    else {
+      if (!GTA_BYTECODE_APPEND(offsets, optimized->count)) {
+        goto OPTIMIZE_FAILED;
+      }
+      for (size_t i = 0; i < size; ++i) {
+        if (!GTA_VECTORX_APPEND(optimized, code[i])) {
+          goto OPTIMIZE_FAILED;
+        }
+      }
+      if (is_jump(opcode)
+        && !(true
+          && GTA_BYTECODE_APPEND(jumps, optimized->count - 1)
+          && GTA_BYTECODE_APPEND(jumps, jump_target(bytecode, position)))) {
+        goto OPTIMIZE_FAILED;
+      }
+    }
+
+    // Instructions inside of a fused sequence are never jump targets, but map
+    // them to the start of the sequence for completeness.
+    for (size_t i = 1; i < size; ++i) {
+      if (flags[position + i] & FLAG_INSTRUCTION) {
+        new_position[position + i] = new_position[position];
+      }
+    }
+    previous = position;
+  }
+  new_position[count] = optimized->count;
+
+  // Resolve the jumps.  Offsets are relative to the word after the offset.
+  for (size_t i = 0; i < jumps->count; i += 2) {
+    size_t position = GTA_TYPEX_UI(jumps->data[i]);
+    size_t target = new_position[GTA_TYPEX_UI(jumps->data[i + 1])];
+    optimized->data[position] = GTA_TYPEX_MAKE_I((GTA_Integer)target - (GTA_Integer)(position + 1));
+  }
+
+  // Nothing can fail from here on, so commit the changes.
+  gta_ast_node_walk(program->ast, update_function_entry, &walk_data, 0);
+  program->bytecode = optimized;
+  GTA_VECTORX_DESTROY(bytecode);
+  GTA_VECTORX_DESTROY(context->bytecode_offsets);
+  context->bytecode_offsets = offsets;
+
+  GTA_VECTORX_DESTROY(jumps);
+  gcu_free(new_position);
+  gcu_free(flags);
+  return true;
+
+  // The bytecode could not be decoded, so it is left unoptimized.
+UNCHANGED:
+  GTA_VECTORX_DESTROY(jumps);
+  GTA_VECTORX_DESTROY(offsets);
+  GTA_VECTORX_DESTROY(optimized);
+  gcu_free(new_position);
+  gcu_free(flags);
+  return true;
+
+  // Failure conditions.
+OPTIMIZE_FAILED:
+  GTA_VECTORX_DESTROY(jumps);
+JUMPS_CREATE_FAILED:
+  GTA_VECTORX_DESTROY(offsets);
+OFFSETS_CREATE_FAILED:
+  GTA_VECTORX_DESTROY(optimized);
+OPTIMIZED_CREATE_FAILED:
+  gcu_free(new_position);
+NEW_POSITION_CREATE_FAILED:
+  gcu_free(flags);
+  return false;
+}
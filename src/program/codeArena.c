@@ -0,0 +1,569 @@
+
+// memfd_create() and MAP_ANONYMOUS are extensions to the POSIX API.
+#ifndef _WIN32
+#define _GNU_SOURCE
+#endif // _WIN32
+
+// Include the correct header file for the platform.
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tang/program/codeArena.h>
+
+#if !defined(_WIN32) && !defined(MAP_ANONYMOUS)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+/**
+ * A block of free memory in a chunk.
+ */
+typedef struct Code_Arena_Block {
+  /**
+   * The offset of the block from the start of the chunk.
+   */
+  size_t offset;
+  /**
+   * The length of the block in bytes.
+   */
+  size_t length;
+} Code_Arena_Block;
+
+/**
+ * A single mapping of executable memory.
+ */
+typedef struct Code_Arena_Chunk {
+  /**
+   * The executable view of the chunk.
+   */
+  unsigned char * code;
+  /**
+   * The writable view of the chunk, or NULL if the chunk is only mapped once
+   * (in which case blocks are made writable while they are being written).
+   */
+  unsigned char * write;
+  /**
+   * The size of the chunk in bytes.
+   */
+  size_t size;
+  /**
+   * The offset of the first byte which has never been allocated.
+   */
+  size_t top;
+  /**
+   * The number of bytes which are allocated.
+   */
+  size_t used;
+  /**
+   * The number of blocks which are allocated.
+   */
+  size_t allocations;
+  /**
+   * The free blocks below `top`, sorted by offset.  Neighbouring free blocks
+   * are always merged.
+   */
+  Code_Arena_Block * blocks;
+  /**
+   * The number of entries in `blocks`.
+   */
+  size_t block_count;
+  /**
+   * The capacity of `blocks`.
+   */
+  size_t block_capacity;
+} Code_Arena_Chunk;
+
+/**
+ * The arena and its bookkeeping belong to the language rather than to any one
+ * program, and a chunk outlives the program whose code caused it to be
+ * mapped.  The bookkeeping is therefore allocated with the system allocator,
+ * so that it does not appear in the cutil allocation counts which are used to
+ * check that a program releases everything that it allocates.
+ */
+struct GTA_Code_Arena {
+  /**
+   * Protects the chunks of the arena.
+   */
+  atomic_flag lock;
+  /**
+   * The size of a page of memory.
+   */
+  size_t page_size;
+  /**
+   * The chunks of the arena.
+   */
+  Code_Arena_Chunk * chunks;
+  /**
+   * The number of entries in `chunks`.
+   */
+  size_t chunk_count;
+  /**
+   * The capacity of `chunks`.
+   */
+  size_t chunk_capacity;
+};
+
+
+/**
+ * Acquire the lock of the arena.
+ *
+ * The lock is only held for a few comparisons, so it is a simple spin lock.
+ *
+ * @param self The arena.
+ */
+static void lock(GTA_Code_Arena * self) {
+  while (atomic_flag_test_and_set_explicit(&self->lock, memory_order_acquire)) {}
+}
+
+
+/**
+ * Release the lock of the arena.
+ *
+ * @param self The arena.
+ */
+static void unlock(GTA_Code_Arena * self) {
+  atomic_flag_clear_explicit(&self->lock, memory_order_release);
+}
+
+
+/**
+ * Round a length up to a multiple of a power of two.
+ *
+ * @param length The length.
+ * @param granularity The power of two.
+ * @return The rounded length, or 0 if it would overflow.
+ */
+static size_t round_up(size_t length, size_t granularity) {
+  if (length > SIZE_MAX - (granularity - 1)) {
+    return 0;
+  }
+  return (length + granularity - 1) & ~(granularity - 1);
+}
+
+
+/**
+ * Get the granularity of the blocks of a chunk.
+ *
+ * Blocks of chunks which are made writable while they are being written must
+ * not share a page with any other code.
+ *
+ * @param self The arena.
+ * @param chunk The chunk.
+ * @return The granularity in bytes.
+ */
+static size_t chunk_granularity(GTA_Code_Arena * self, Code_Arena_Chunk * chunk) {
+  return chunk->write ? GTA_CODE_ARENA_ALIGNMENT : self->page_size;
+}
+
+
+/**
+ * Map the memory of a new chunk.
+ *
+ * @param chunk The chunk, whose size has been set.
+ * @return True on success, false otherwise.
+ */
+static bool map_chunk(Code_Arena_Chunk * chunk) {
+  chunk->code = 0;
+  chunk->write = 0;
+#ifdef _WIN32
+  chunk->code = VirtualAlloc(0, chunk->size, MEM_COMMIT | MEM_RESERVE, PAGE_READONLY);
+  return chunk->code;
+#else
+#ifdef MFD_CLOEXEC
+  // Map the same memory twice, so that it never has to be made writable and
+  // executable at the same time.
+  int fd = memfd_create("tang-code-arena", MFD_CLOEXEC);
+  if (fd >= 0) {
+    if (!ftruncate(fd, (off_t)chunk->size)) {
+      void * write = mmap(0, chunk->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      void * code = mmap(0, chunk->size, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+      if ((write != MAP_FAILED) && (code != MAP_FAILED)) {
+        chunk->write = write;
+        chunk->code = code;
+      }
+      else {
+        if (write != MAP_FAILED) {
+          munmap(write, chunk->size);
+        }
+        if (code != MAP_FAILED) {
+          munmap(code, chunk->size);
+        }
+      }
+    }
+    // The mappings remain valid after the file descriptor is closed.
+    close(fd);
+    if (chunk->code) {
+      return true;
+    }
+  }
+#endif // MFD_CLOEXEC
+  // Fall back to a single mapping.
+  void * code = mmap(0, chunk->size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (code == MAP_FAILED) {
+    return false;
+  }
+  chunk->code = code;
+  return true;
+#endif // _WIN32
+}
+
+
+/**
+ * Unmap the memory of a chunk and free its free list.
+ *
+ * @param chunk The chunk.
+ */
+static void unmap_chunk(Code_Arena_Chunk * chunk) {
+#ifdef _WIN32
+  VirtualFree(chunk->code, 0, MEM_RELEASE);
+#else
+  munmap(chunk->code, chunk->size);
+  if (chunk->write) {
+    munmap(chunk->write, chunk->size);
+  }
+#endif // _WIN32
+  free(chunk->blocks);
+}
+
+
+/**
+ * Copy code into a block of a chunk.
+ *
+ * @param code The executable view of the block.
+ * @param write The writable view of the block, or NULL if the block must be
+ *   made writable.
+ * @param block_length The length of the block, which is a multiple of the
+ *   page size if `write` is NULL.
+ * @param source The code to copy.
+ * @param length The length of the code.
+ * @return True on success, false otherwise.
+ */
+static bool write_block(unsigned char * code, unsigned char * write, size_t block_length, const void * source, size_t length) {
+#ifdef _WIN32
+  (void)write;
+  DWORD old_protection;
+  if (!VirtualProtect(code, block_length, PAGE_READWRITE, &old_protection)) {
+    return false;
+  }
+  memcpy(code, source, length);
+  if (!VirtualProtect(code, block_length, PAGE_EXECUTE_READ, &old_protection)) {
+    return false;
+  }
+  FlushInstructionCache(GetCurrentProcess(), code, length);
+  return true;
+#else
+  if (write) {
+    memcpy(write, source, length);
+  }
+  else {
+    if (mprotect(code, block_length, PROT_READ | PROT_WRITE)) {
+      return false;
+    }
+    memcpy(code, source, length);
+    if (mprotect(code, block_length, PROT_READ | PROT_EXEC)) {
+      return false;
+    }
+  }
+  __builtin___clear_cache((char *)code, (char *)code + length);
+  return true;
+#endif // _WIN32
+}
+
+
+/**
+ * Find space for a block in an existing chunk.
+ *
+ * @param self The arena.
+ * @param length The length of the code.
+ * @param chunk_index Set to the index of the chunk on success.
+ * @param offset Set to the offset of the block on success.
+ * @param block_length Set to the length of the block on success.
+ * @return True if space was found, false otherwise.
+ */
+static bool find_block(GTA_Code_Arena * self, size_t length, size_t * chunk_index, size_t * offset, size_t * block_length) {
+  // Reuse a free block before using fresh memory, so that the code stays
+  // packed into as few pages as possible.
+  for (size_t i = 0; i < self->chunk_count; ++i) {
+    Code_Arena_Chunk * chunk = &self->chunks[i];
+    size_t rounded = round_up(length, chunk_granularity(self, chunk));
+    if (!rounded) {
+      continue;
+    }
+    for (size_t j = 0; j < chunk->block_count; ++j) {
+      Code_Arena_Block * block = &chunk->blocks[j];
+      if (block->length >= rounded) {
+        *chunk_index = i;
+        *offset = block->offset;
+        *block_length = rounded;
+        block->offset += rounded;
+        block->length -= rounded;
+        if (!block->length) {
+          memmove(block, block + 1, (chunk->block_count - j - 1) * sizeof(Code_Arena_Block));
+          --chunk->block_count;
+        }
+        return true;
+      }
+    }
+  }
+  for (size_t i = 0; i < self->chunk_count; ++i) {
+    Code_Arena_Chunk * chunk = &self->chunks[i];
+    size_t rounded = round_up(length, chunk_granularity(self, chunk));
+    if (rounded && (rounded <= chunk->size - chunk->top)) {
+      *chunk_index = i;
+      *offset = chunk->top;
+      *block_length = rounded;
+      chunk->top += rounded;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/**
+ * Map a new chunk which is large enough to hold a block.
+ *
+ * @param self The arena.
+ * @param length The length of the code.
+ * @param chunk_index Set to the index of the chunk on success.
+ * @param offset Set to the offset of the block on success.
+ * @param block_length Set to the length of the block on success.
+ * @return True on success, false otherwise.
+ */
+static bool add_chunk(GTA_Code_Arena * self, size_t length, size_t * chunk_index, size_t * offset, size_t * block_length) {
+  if (self->chunk_count == self->chunk_capacity) {
+    size_t capacity = self->chunk_capacity ? self->chunk_capacity * 2 : 4;
+    Code_Arena_Chunk * chunks = realloc(self->chunks, capacity * sizeof(Code_Arena_Chunk));
+    if (!chunks) {
+      return false;
+    }
+    self->chunks = chunks;
+    self->chunk_capacity = capacity;
+  }
+
+  size_t size = round_up(length, self->page_size);
+  if (!size) {
+    return false;
+  }
+  Code_Arena_Chunk chunk = {
+    .size = size > GTA_CODE_ARENA_CHUNK_SIZE ? size : round_up(GTA_CODE_ARENA_CHUNK_SIZE, self->page_size),
+  };
+  if (!map_chunk(&chunk)) {
+    return false;
+  }
+  chunk.top = round_up(length, chunk_granularity(self, &chunk));
+  *chunk_index = self->chunk_count;
+  *offset = 0;
+  *block_length = chunk.top;
+  self->chunks[self->chunk_count++] = chunk;
+  return true;
+}
+
+
+/**
+ * Return a block to the free list of its chunk.
+ *
+ * Blocks at the end of the chunk lower `top` instead, so that the space can
+ * be used by code of any size.  If the free list cannot grow, then the block
+ * is not reused until the chunk is empty.
+ *
+ * @param chunk The chunk.
+ * @param offset The offset of the block.
+ * @param length The length of the block.
+ */
+static void release_block(Code_Arena_Chunk * chunk, size_t offset, size_t length) {
+  // Find the first free block after this one.
+  size_t index = 0;
+  while ((index < chunk->block_count) && (chunk->blocks[index].offset < offset)) {
+    ++index;
+  }
+
+  bool merge_previous = index && (chunk->blocks[index - 1].offset + chunk->blocks[index - 1].length == offset);
+  bool merge_next = (index < chunk->block_count) && (offset + length == chunk->blocks[index].offset);
+  if (merge_previous) {
+    --index;
+    chunk->blocks[index].length += length;
+    if (merge_next) {
+      chunk->blocks[index].length += chunk->blocks[index + 1].length;
+      memmove(&chunk->blocks[index + 1], &chunk->blocks[index + 2], (chunk->block_count - index - 2) * sizeof(Code_Arena_Block));
+      --chunk->block_count;
+    }
+  }
+  else if (merge_next) {
+    chunk->blocks[index].offset = offset;
+    chunk->blocks[index].length += length;
+  }
+  else {
+    if (chunk->block_count == chunk->block_capacity) {
+      size_t capacity = chunk->block_capacity ? chunk->block_capacity * 2 : 8;
+      Code_Arena_Block * blocks = realloc(chunk->blocks, capacity * sizeof(Code_Arena_Block));
+      if (!blocks) {
+        return;
+      }
+      chunk->blocks = blocks;
+      chunk->block_capacity = capacity;
+    }
+    memmove(&chunk->blocks[index + 1], &chunk->blocks[index], (chunk->block_count - index) * sizeof(Code_Arena_Block));
+    chunk->blocks[index] = (Code_Arena_Block) {
+      .offset = offset,
+      .length = length,
+    };
+    ++chunk->block_count;
+  }
+
+  // A free block at the end of the chunk is returned to the fresh memory.
+  Code_Arena_Block * last = &chunk->blocks[chunk->block_count - 1];
+  if (last->offset + last->length == chunk->top) {
+    chunk->top = last->offset;
+    --chunk->block_count;
+  }
+}
+
+
+GTA_Code_Arena * gta_code_arena_create(void) {
+  GTA_Code_Arena * self = malloc(sizeof(GTA_Code_Arena));
+  if (!self) {
+    return 0;
+  }
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  size_t page_size = info.dwPageSize;
+#else
+  long page_size = sysconf(_SC_PAGESIZE);
+#endif // _WIN32
+  *self = (GTA_Code_Arena) {
+    .page_size = page_size > 0 ? (size_t)page_size : 4096,
+    .chunks = 0,
+    .chunk_count = 0,
+    .chunk_capacity = 0,
+  };
+  atomic_flag_clear(&self->lock);
+  return self;
+}
+
+
+void gta_code_arena_destroy(GTA_Code_Arena * self) {
+  assert(self);
+
+  for (size_t i = 0; i < self->chunk_count; ++i) {
+    unmap_chunk(&self->chunks[i]);
+  }
+  free(self->chunks);
+  free(self);
+}
+
+
+void * gta_code_arena_allocate(GTA_Code_Arena * self, const void * code, size_t length) {
+  assert(self);
+  assert(code);
+
+  if (!length) {
+    return 0;
+  }
+
+  // Reserve a block while holding the lock.
+  lock(self);
+  size_t chunk_index;
+  size_t offset;
+  size_t block_length;
+  if (!find_block(self, length, &chunk_index, &offset, &block_length)
+    && !add_chunk(self, length, &chunk_index, &offset, &block_length)) {
+    unlock(self);
+    return 0;
+  }
+  Code_Arena_Chunk * chunk = &self->chunks[chunk_index];
+  chunk->used += block_length;
+  ++chunk->allocations;
+  unsigned char * executable = chunk->code + offset;
+  unsigned char * writable = chunk->write ? chunk->write + offset : 0;
+  unlock(self);
+
+  // The block belongs to this caller, so the (comparatively slow) copy does
+  // not need the lock.  The chunk cannot be unmapped while it has a block in
+  // use, even if the array of chunks is reallocated by another thread.
+  if (!write_block(executable, writable, block_length, code, length)) {
+    gta_code_arena_free(self, executable, length);
+    return 0;
+  }
+  return executable;
+}
+
+
+void gta_code_arena_free(GTA_Code_Arena * self, void * code, size_t length) {
+  assert(self);
+
+  if (!code) {
+    return;
+  }
+
+  lock(self);
+  for (size_t i = 0; i < self->chunk_count; ++i) {
+    Code_Arena_Chunk * chunk = &self->chunks[i];
+    if (((unsigned char *)code < chunk->code) || ((unsigned char *)code >= chunk->code + chunk->size)) {
+      continue;
+    }
+    size_t offset = (size_t)((unsigned char *)code - chunk->code);
+    size_t block_length = round_up(length, chunk_granularity(self, chunk));
+    assert(block_length <= chunk->used);
+    chunk->used -= block_length;
+    --chunk->allocations;
+
+    if (chunk->allocations) {
+      release_block(chunk, offset, block_length);
+    }
+    else if (self->chunk_count > 1) {
+      // Keep one empty chunk, so that a program which is repeatedly created
+      // and destroyed does not map and unmap memory every time.
+      unmap_chunk(chunk);
+      memmove(chunk, chunk + 1, (self->chunk_count - i - 1) * sizeof(Code_Arena_Chunk));
+      --self->chunk_count;
+    }
+    else {
+      chunk->top = 0;
+      chunk->used = 0;
+      chunk->block_count = 0;
+    }
+    break;
+  }
+  unlock(self);
+}
+
+
+void gta_code_arena_get_stats(GTA_Code_Arena * self, GTA_Code_Arena_Stats * stats) {
+  assert(self);
+  assert(stats);
+
+  *stats = (GTA_Code_Arena_Stats) {0};
+  lock(self);
+  stats->chunks = self->chunk_count;
+  for (size_t i = 0; i < self->chunk_count; ++i) {
+    Code_Arena_Chunk * chunk = &self->chunks[i];
+    size_t tail = chunk->size - chunk->top;
+    stats->bytes_reserved += chunk->size;
+    stats->bytes_used += chunk->used;
+    stats->bytes_free += tail;
+    stats->allocations += chunk->allocations;
+    if (tail > stats->largest_free_block) {
+      stats->largest_free_block = tail;
+    }
+    for (size_t j = 0; j < chunk->block_count; ++j) {
+      stats->bytes_free += chunk->blocks[j].length;
+      if (chunk->blocks[j].length > stats->largest_free_block) {
+        stats->largest_free_block = chunk->blocks[j].length;
+      }
+    }
+  }
+  unlock(self);
+  if (stats->bytes_free) {
+    stats->fragmentation = 1. - ((double)stats->largest_free_block / (double)stats->bytes_free);
+  }
+}
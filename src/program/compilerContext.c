@@ -21,6 +21,10 @@ bool gta_compiler_context_create_in_place(GTA_Compiler_Context * context, GTA_Pr
   if (!bytecode_offsets) {
     return false;
   }
+  GTA_HashX * constant_indices = GTA_HASHX_CREATE(32);
+  if (!constant_indices) {
+    goto CONSTANT_INDICES_CREATE_FAILED;
+  }
   GCU_Vector8 * binary_vector = gcu_vector8_create(1024);
   if (!binary_vector) {
     goto BINARY_VECTOR_CREATE_FAILED;
@@ -58,6 +62,7 @@ bool gta_compiler_context_create_in_place(GTA_Compiler_Context * context, GTA_Pr
     .binary_vector = binary_vector,
     .binary = 0,
     .bytecode_offsets = bytecode_offsets,
+    .constant_indices = constant_indices,
     .stack_depth = 0,
     .scope_stack = scope_stack,
     .globals = globals,
@@ -66,6 +71,8 @@ bool gta_compiler_context_create_in_place(GTA_Compiler_Context * context, GTA_Pr
     .break_label = 0,
     .continue_label = 0,
     .return_label = 0,
+    .abort_label = 0,
+    .register_cache = {0},
   };
 
   // Label creation will not fail because the label vector was created with
@@ -75,6 +82,7 @@ bool gta_compiler_context_create_in_place(GTA_Compiler_Context * context, GTA_Pr
   context->break_label = gta_compiler_context_get_label(context);
   context->continue_label = gta_compiler_context_get_label(context);
   context->return_label = gta_compiler_context_get_label(context);
+  context->abort_label = gta_compiler_context_get_label(context);
 
   return true;
 
@@ -90,6 +98,8 @@ SCOPE_HASH_CREATE_FAILED:
 SCOPE_STACK_VECTOR_CREATE_FAILED:
   gcu_vector8_destroy(binary_vector);
 BINARY_VECTOR_CREATE_FAILED:
+  GTA_HASHX_DESTROY(constant_indices);
+CONSTANT_INDICES_CREATE_FAILED:
   GTA_VECTORX_DESTROY(bytecode_offsets);
   return false;
 }
@@ -105,6 +115,7 @@ void gta_compiler_context_destroy(GTA_Compiler_Context * context) {
 void gta_compiler_context_destroy_in_place(GTA_Compiler_Context * context) {
   assert(context);
   GTA_VECTORX_DESTROY(context->bytecode_offsets);
+  GTA_HASHX_DESTROY(context->constant_indices);
   gcu_vector8_destroy(context->binary_vector);
 
   assert(context->scope_stack);
@@ -163,3 +174,26 @@ bool gta_compiler_context_set_label(GTA_Compiler_Context * context, GTA_Integer
   context->labels->data[label] = GTA_TYPEX_MAKE_UI(byte_offset);
   return true;
 }
+
+
+GTA_NO_DISCARD GTA_Integer gta_compiler_context_add_constant(GTA_Compiler_Context * context, void * object) {
+  assert(context);
+  assert(context->program);
+  assert(context->program->constants);
+  assert(object);
+
+  GTA_HashX_Value existing = GTA_HASHX_GET(context->constant_indices, (GTA_UInteger)object);
+  if (existing.exists) {
+    return GTA_TYPEX_UI(existing.value);
+  }
+  GTA_VectorX * constants = context->program->constants;
+  GTA_Integer index = constants->count;
+  if (!GTA_VECTORX_APPEND(constants, GTA_TYPEX_MAKE_P(object))) {
+    return -1;
+  }
+  if (!GTA_HASHX_SET(context->constant_indices, (GTA_UInteger)object, GTA_TYPEX_MAKE_UI(index))) {
+    --constants->count;
+    return -1;
+  }
+  return index;
+}
@@ -1,10 +1,28 @@
 
+// clock_gettime() and CLOCK_MONOTONIC are part of the POSIX API.
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L
+#endif // _WIN32
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif // _WIN32
+
 #include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <cutil/memory.h>
 #include <tang/computedValue/computedValue.h>
+#include <tang/computedValue/computedValueError.h>
 #include <tang/library/library.h>
 #include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
+#include <tang/program/program.h>
 
 GTA_Execution_Context * gta_execution_context_create(GTA_Program * program) {
   GTA_Execution_Context * context = gcu_malloc(sizeof(GTA_Execution_Context));
@@ -30,33 +48,68 @@ bool gta_execution_context_create_in_place(GTA_Execution_Context * context, GTA_
   if (!garbage_collection) {
     goto GARBAGE_COLLECTION_VECTOR_CREATE_FAILED;
   }
+  GTA_VectorX * garbage_collection_sizes = GTA_VECTORX_CREATE(32);
+  if (!garbage_collection_sizes) {
+    goto GARBAGE_COLLECTION_SIZES_VECTOR_CREATE_FAILED;
+  }
   GTA_Library * library = gta_library_create();
   if (!library) {
     goto LIBRARY_CREATE_FAILED;
   }
-  GTA_Unicode_String * output = gta_unicode_string_create("", 0, GTA_UNICODE_STRING_TYPE_TRUSTED);
+  GTA_VectorX * output = GTA_VECTORX_CREATE(32);
   if (!output) {
-    goto OUTPUT_STRING_CREATE_FAILED;
+    goto OUTPUT_VECTOR_CREATE_FAILED;
   }
 
   assert(context);
   *context = (GTA_Execution_Context) {
     .program = program,
     .output = output,
+    .output_byte_length = 0,
+    .output_sink = 0,
+    .output_sink_data = 0,
+    .output_sink_buffer = 0,
+    .output_sink_buffer_size = 0,
+    .output_sink_buffer_length = 0,
     .result = 0,
     .stack = stack,
     .pc_stack = 0,
     .garbage_collection = garbage_collection,
+    .garbage_collection_sizes = garbage_collection_sizes,
+    .gc_bytes_live = 0,
+    .gc_bytes_since_collection = 0,
+    .gc_next_collection = GTA_GARBAGE_COLLECTOR_DEFAULT_THRESHOLD,
+    .gc_threshold = GTA_GARBAGE_COLLECTOR_DEFAULT_THRESHOLD,
+    .gc_bytes_peak = 0,
+    .gc_quota = SIZE_MAX,
+    .gc_stack_base = 0,
+    .budget_countdown = INT64_MAX,
+    .budget_steps_remaining = GTA_EXECUTION_CONTEXT_BUDGET_UNLIMITED,
+    .budget_deadline = 0,
+    .budget_steps = GTA_EXECUTION_CONTEXT_BUDGET_UNLIMITED,
+    .budget_timeout = 0,
     .library = library,
     .user_data = 0,
     .fp = 0,
   };
+
+  // Printing to stdout is just a sink for the stdout stream.  It goes through
+  // stdio so that it stays in order with anything the host prints.
+  if (program && (program->flags & GTA_PROGRAM_FLAG_PRINT_TO_STDOUT)) {
+    if (!gta_execution_context_set_output_file(context, stdout, GTA_EXECUTION_CONTEXT_OUTPUT_SINK_DEFAULT_BUFFER_SIZE)) {
+      goto OUTPUT_SINK_CREATE_FAILED;
+    }
+  }
   return true;
 
   // Failure conditions.
-OUTPUT_STRING_CREATE_FAILED:
+OUTPUT_SINK_CREATE_FAILED:
+  GTA_VECTORX_DESTROY(output);
+OUTPUT_VECTOR_CREATE_FAILED:
   gta_library_destroy(library);
 LIBRARY_CREATE_FAILED:
+  GTA_VECTORX_DESTROY(garbage_collection_sizes);
+GARBAGE_COLLECTION_SIZES_VECTOR_CREATE_FAILED:
   GTA_VECTORX_DESTROY(garbage_collection);
 GARBAGE_COLLECTION_VECTOR_CREATE_FAILED:
   GTA_VECTORX_DESTROY(stack);
@@ -83,6 +136,393 @@ void gta_execution_context_destroy_in_place(GTA_Execution_Context * self) {
     gta_computed_value_destroy(GTA_TYPEX_P(self->garbage_collection->data[i]));
   }
   GTA_VECTORX_DESTROY(self->garbage_collection);
+  GTA_VECTORX_DESTROY(self->garbage_collection_sizes);
   gta_library_destroy(self->library);
-  gta_unicode_string_destroy(self->output);
+  for (size_t i = 0; i < self->output->count; ++i) {
+    gta_unicode_string_destroy(GTA_TYPEX_P(self->output->data[i]));
+  }
+  GTA_VECTORX_DESTROY(self->output);
+  if (self->output_sink_buffer) {
+    gcu_free(self->output_sink_buffer);
+  }
+}
+
+
+void gta_execution_context_reset(GTA_Execution_Context * self) {
+  assert(self);
+  assert(self->stack);
+  assert(self->garbage_collection);
+  assert(self->garbage_collection_sizes);
+  assert(self->output);
+
+  // Destroy everything that the previous execution created.
+  for (size_t i = 0; i < self->garbage_collection->count; ++i) {
+    gta_computed_value_destroy(GTA_TYPEX_P(self->garbage_collection->data[i]));
+  }
+  self->garbage_collection->count = 0;
+  self->garbage_collection_sizes->count = 0;
+  self->gc_bytes_live = 0;
+  self->gc_bytes_since_collection = 0;
+  self->gc_next_collection = self->gc_threshold;
+  self->gc_bytes_peak = 0;
+  self->gc_stack_base = 0;
+
+  for (size_t i = 0; i < self->output->count; ++i) {
+    gta_unicode_string_destroy(GTA_TYPEX_P(self->output->data[i]));
+  }
+  self->output->count = 0;
+  self->output_byte_length = 0;
+  // Output which is still buffered belongs to the previous execution, so it
+  // is passed to the sink rather than lost.  The buffer is emptied even if
+  // the sink fails.
+  (void)gta_execution_context_flush_output(self);
+
+  self->stack->count = 0;
+  if (self->pc_stack) {
+    self->pc_stack->count = 0;
+  }
+  self->result = 0;
+  self->fp = 0;
+}
+
+
+/**
+ * The idle execution contexts of a thread.
+ */
+typedef struct Execution_Context_Pool {
+  /**
+   * The idle contexts.
+   */
+  GTA_Execution_Context * contexts[GTA_EXECUTION_CONTEXT_POOL_SIZE];
+  /**
+   * The number of entries in `contexts`.
+   */
+  size_t count;
+} Execution_Context_Pool;
+
+/**
+ * The pool of the current thread.
+ */
+static GTA_THREAD_LOCAL Execution_Context_Pool pool;
+
+
+GTA_Execution_Context * gta_execution_context_pool_acquire(GTA_Program * program) {
+  // Prefer the most recently released context, whose memory is the most
+  // likely to still be in the cache.
+  for (size_t i = pool.count; i > 0; --i) {
+    GTA_Execution_Context * context = pool.contexts[i - 1];
+    if (context->program == program) {
+      pool.contexts[i - 1] = pool.contexts[--pool.count];
+      return context;
+    }
+  }
+  return gta_execution_context_create(program);
+}
+
+
+void gta_execution_context_pool_release(GTA_Execution_Context * context) {
+  assert(context);
+
+  if (pool.count == GTA_EXECUTION_CONTEXT_POOL_SIZE) {
+    gta_execution_context_destroy(context);
+    return;
+  }
+  gta_execution_context_reset(context);
+  pool.contexts[pool.count++] = context;
+}
+
+
+void gta_execution_context_pool_clear(GTA_Program * program) {
+  size_t kept = 0;
+  for (size_t i = 0; i < pool.count; ++i) {
+    if (!program || (pool.contexts[i]->program == program)) {
+      gta_execution_context_destroy(pool.contexts[i]);
+    }
+    else {
+      pool.contexts[kept++] = pool.contexts[i];
+    }
+  }
+  pool.count = kept;
+}
+
+
+/**
+ * Get the current time from a monotonic clock, so that the budget deadline is
+ * not affected by changes to the wall clock.
+ *
+ * Falls back to the wall clock when no monotonic clock is available.
+ *
+ * @return The current time, in nanoseconds from an arbitrary starting point.
+ */
+static uint64_t budget_now(void) {
+  struct timespec now;
+#if defined(CLOCK_MONOTONIC)
+  if (clock_gettime(CLOCK_MONOTONIC, &now)) {
+    return 0;
+  }
+#else
+  if (!timespec_get(&now, TIME_UTC)) {
+    return 0;
+  }
+#endif // CLOCK_MONOTONIC
+  return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+
+/**
+ * Give the next slice of the execution budget to `budget_countdown`.
+ *
+ * @param self The execution context.
+ */
+static void budget_refill(GTA_Execution_Context * self) {
+  if ((self->budget_steps_remaining == GTA_EXECUTION_CONTEXT_BUDGET_UNLIMITED) && !self->budget_deadline) {
+    // There is nothing to check, so the countdown will never run out.
+    self->budget_countdown = INT64_MAX;
+    return;
+  }
+  uint64_t slice = self->budget_steps_remaining < GTA_EXECUTION_CONTEXT_BUDGET_SLICE
+    ? self->budget_steps_remaining
+    : GTA_EXECUTION_CONTEXT_BUDGET_SLICE;
+  if (self->budget_steps_remaining != GTA_EXECUTION_CONTEXT_BUDGET_UNLIMITED) {
+    self->budget_steps_remaining -= slice;
+  }
+  self->budget_countdown = (int64_t)slice;
+}
+
+
+void gta_execution_context_set_budget(GTA_Execution_Context * self, uint64_t steps, uint64_t timeout) {
+  assert(self);
+  self->budget_steps = steps;
+  self->budget_timeout = timeout;
+}
+
+
+void gta_execution_context_budget_start(GTA_Execution_Context * self) {
+  assert(self);
+  self->budget_steps_remaining = self->budget_steps;
+  self->budget_deadline = self->budget_timeout
+    ? budget_now() + self->budget_timeout
+    : 0;
+  budget_refill(self);
+}
+
+
+GTA_Computed_Value * GTA_CALL gta_execution_context_budget_check(GTA_Execution_Context * self) {
+  assert(self);
+  // The countdown stays exhausted, so that every later safepoint fails too.
+  // The safepoint has already collected, so anything over the quota is
+  // still reachable.
+  if (self->gc_bytes_live > self->gc_quota) {
+    self->budget_countdown = -1;
+    return gta_computed_value_error_memory_quota_exceeded;
+  }
+  if (!self->budget_steps_remaining) {
+    self->budget_countdown = -1;
+    return gta_computed_value_error_execution_budget_exceeded;
+  }
+  if (self->budget_deadline && (budget_now() >= self->budget_deadline)) {
+    self->budget_countdown = -1;
+    return gta_computed_value_error_execution_deadline_exceeded;
+  }
+  budget_refill(self);
+  // Count the safepoint which made this call.
+  --self->budget_countdown;
+  return NULL;
+}
+
+
+void gta_execution_context_budget_interrupt(GTA_Execution_Context * self) {
+  assert(self);
+  if (self->budget_countdown > 0) {
+    if (self->budget_steps_remaining != GTA_EXECUTION_CONTEXT_BUDGET_UNLIMITED) {
+      self->budget_steps_remaining += (uint64_t)self->budget_countdown;
+    }
+    self->budget_countdown = 0;
+  }
+}
+
+
+/**
+ * Write rendered bytes to the output sink, through its buffer.
+ *
+ * @param self The execution context.
+ * @param buffer The rendered bytes.
+ * @param length The number of bytes.
+ * @return True on success, false if the sink reported a failure.
+ */
+static bool output_sink_write(GTA_Execution_Context * self, const char * buffer, size_t length) {
+  assert(self->output_sink);
+
+  if (!length) {
+    return true;
+  }
+  if (self->output_sink_buffer_length + length > self->output_sink_buffer_size) {
+    if (!gta_execution_context_flush_output(self)) {
+      return false;
+    }
+    // Anything that would not fit in the buffer bypasses it.
+    if (length >= self->output_sink_buffer_size) {
+      return self->output_sink(self->output_sink_data, buffer, length);
+    }
+  }
+  memcpy(self->output_sink_buffer + self->output_sink_buffer_length, buffer, length);
+  self->output_sink_buffer_length += length;
+  return true;
+}
+
+
+GTA_Computed_Value * gta_execution_context_output_append(GTA_Execution_Context * self, GTA_Unicode_String * string) {
+  assert(self);
+  assert(self->output);
+  assert(string);
+
+  // Empty strings do not need to be stored.
+  if (!string->byte_length) {
+    gta_unicode_string_destroy(string);
+    return NULL;
+  }
+  if (self->output_sink) {
+    // Trusted strings render as themselves, so they can be written as-is.
+    if ((string->string_type->count == 1) && (GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(string->string_type->data[0]) == GTA_UNICODE_STRING_TYPE_TRUSTED)) {
+      bool success = output_sink_write(self, string->buffer, string->byte_length);
+      gta_unicode_string_destroy(string);
+      return success ? NULL : gta_computed_value_error_output_sink_failed;
+    }
+    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(string);
+    gta_unicode_string_destroy(string);
+    if (!rendered.buffer) {
+      return gta_computed_value_error_out_of_memory;
+    }
+    bool success = output_sink_write(self, rendered.buffer, rendered.length);
+    gcu_free(rendered.buffer);
+    return success ? NULL : gta_computed_value_error_output_sink_failed;
+  }
+  if (!GTA_VECTORX_APPEND(self->output, GTA_TYPEX_MAKE_P(string))) {
+    gta_unicode_string_destroy(string);
+    return gta_computed_value_error_out_of_memory;
+  }
+  self->output_byte_length += string->byte_length;
+  return NULL;
+}
+
+
+GTA_Unicode_String * gta_execution_context_get_output(GTA_Execution_Context * self) {
+  assert(self);
+  assert(self->output);
+
+  if (self->output->count == 1) {
+    return GTA_TYPEX_P(self->output->data[0]);
+  }
+
+  // Either there is no output yet, or there are multiple chunks that must be
+  // combined.
+  GTA_Unicode_String * combined = gta_unicode_string_join((const GTA_Unicode_String * const *)self->output->data, self->output->count);
+  if (!combined) {
+    return NULL;
+  }
+  for (size_t i = 0; i < self->output->count; ++i) {
+    gta_unicode_string_destroy(GTA_TYPEX_P(self->output->data[i]));
+  }
+  self->output->count = 0;
+  if (!GTA_VECTORX_APPEND(self->output, GTA_TYPEX_MAKE_P(combined))) {
+    // Only possible if there was no output at all.
+    gta_unicode_string_destroy(combined);
+    return NULL;
+  }
+  return combined;
+}
+
+
+bool gta_execution_context_set_output_sink(GTA_Execution_Context * self, GTA_Execution_Context_Output_Sink sink, void * sink_data, size_t buffer_size) {
+  assert(self);
+
+  if (!gta_execution_context_flush_output(self)) {
+    return false;
+  }
+
+  char * buffer = NULL;
+  if (sink && buffer_size) {
+    buffer = gcu_malloc(buffer_size);
+    if (!buffer) {
+      return false;
+    }
+  }
+  if (self->output_sink_buffer) {
+    gcu_free(self->output_sink_buffer);
+  }
+  self->output_sink = sink;
+  self->output_sink_data = sink_data;
+  self->output_sink_buffer = buffer;
+  self->output_sink_buffer_size = buffer ? buffer_size : 0;
+  self->output_sink_buffer_length = 0;
+  return true;
+}
+
+
+/**
+ * Output sink which writes to a file descriptor.
+ *
+ * @param sink_data The file descriptor, cast to a pointer.
+ * @param buffer The rendered bytes.
+ * @param length The number of bytes.
+ * @return True on success, false on failure.
+ */
+static bool output_sink_fd(void * sink_data, const char * buffer, size_t length) {
+  int fd = (int)(intptr_t)sink_data;
+  while (length) {
+#ifdef _WIN32
+    int written = _write(fd, buffer, length > INT32_MAX ? INT32_MAX : (unsigned int)length);
+#else
+    ssize_t written = write(fd, buffer, length);
+#endif // _WIN32
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    buffer += written;
+    length -= (size_t)written;
+  }
+  return true;
+}
+
+
+bool gta_execution_context_set_output_fd(GTA_Execution_Context * self, int fd, size_t buffer_size) {
+  assert(self);
+  return gta_execution_context_set_output_sink(self, output_sink_fd, (void *)(intptr_t)fd, buffer_size);
+}
+
+
+/**
+ * Output sink which writes to a stdio stream.
+ *
+ * @param sink_data The FILE pointer.
+ * @param buffer The rendered bytes.
+ * @param length The number of bytes.
+ * @return True on success, false on failure.
+ */
+static bool output_sink_file(void * sink_data, const char * buffer, size_t length) {
+  return fwrite(buffer, 1, length, (FILE *)sink_data) == length;
+}
+
+
+bool gta_execution_context_set_output_file(GTA_Execution_Context * self, FILE * file, size_t buffer_size) {
+  assert(self);
+  assert(file);
+  return gta_execution_context_set_output_sink(self, output_sink_file, file, buffer_size);
+}
+
+
+bool gta_execution_context_flush_output(GTA_Execution_Context * self) {
+  assert(self);
+
+  if (!self->output_sink || !self->output_sink_buffer_length) {
+    return true;
+  }
+  // The buffered output is dropped even if the sink fails, so that it is not
+  // sent twice.
+  size_t length = self->output_sink_buffer_length;
+  self->output_sink_buffer_length = 0;
+  return self->output_sink(self->output_sink_data, self->output_sink_buffer, length);
 }
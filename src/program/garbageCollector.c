@@ -1,2 +1,245 @@
+
+#include <assert.h>
+#include <stdint.h>
+#include <cutil/hash.h>
+#include <cutil/memory.h>
+#include <tang/computedValue/computedValueAll.h>
+#include <tang/program/executionContext.h>
 #include <tang/program/garbageCollector.h>
 
+/**
+ * Mark a potential pointer to a computed value as reachable.
+ *
+ * If the word is the address of a registered computed value which has not yet
+ * been marked, then the value is marked and added to the worklist so that its
+ * children will be traced.  Any other word is ignored.
+ *
+ * @param index Mapping of registered value addresses to their position in the
+ *   garbage collection list.
+ * @param marked The mark bits, one per registered value.
+ * @param worklist The list of marked values whose children must be traced.
+ * @param word The potential pointer.
+ * @return True on success, false on memory allocation failure.
+ */
+static bool mark_word(GTA_HashX * index, bool * marked, GTA_VectorX * worklist, GTA_UInteger word) {
+  // Immediate integers and floats are tagged with the low two bits, and
+  // computed values are always aligned, so such words can never be a match.
+  if (!word || (word & 3)) {
+    return true;
+  }
+  GTA_HashX_Value position = GTA_HASHX_GET(index, word);
+  if (!position.exists || marked[GTA_TYPEX_UI(position.value)]) {
+    return true;
+  }
+  marked[GTA_TYPEX_UI(position.value)] = true;
+  return GTA_VECTORX_APPEND(worklist, GTA_TYPEX_MAKE_UI(word));
+}
+
+
+/**
+ * Mark all of the computed values directly referenced by a computed value.
+ *
+ * Only the built-in container types hold references to other computed values.
+ * Values of any other type (including host-defined types) are treated as
+ * leaves.
+ *
+ * @param index Mapping of registered value addresses to their position in the
+ *   garbage collection list.
+ * @param marked The mark bits, one per registered value.
+ * @param worklist The list of marked values whose children must be traced.
+ * @param value The computed value whose children should be marked.
+ * @return True on success, false on memory allocation failure.
+ */
+static bool mark_children(GTA_HashX * index, bool * marked, GTA_VectorX * worklist, GTA_Computed_Value * value) {
+  if (GTA_COMPUTED_VALUE_IS_ARRAY(value)) {
+    GTA_VectorX * elements = ((GTA_Computed_Value_Array *)value)->elements;
+    for (size_t i = 0; i < elements->count; ++i) {
+      if (!mark_word(index, marked, worklist, (GTA_UInteger)(uintptr_t)GTA_TYPEX_P(elements->data[i]))) {
+        return false;
+      }
+    }
+  }
+  else if (GTA_COMPUTED_VALUE_IS_MAP(value)) {
+    GTA_Computed_Value_Map * map = (GTA_Computed_Value_Map *)value;
+    for (size_t i = 0; i < map->table->count; ++i) {
+      if (!mark_word(index, marked, worklist, (GTA_UInteger)(uintptr_t)map->table->entries[i].key)
+        || !mark_word(index, marked, worklist, (GTA_UInteger)(uintptr_t)map->table->entries[i].value)) {
+        return false;
+      }
+    }
+  }
+  else if (GTA_COMPUTED_VALUE_IS_ITERATOR(value)) {
+    GTA_Computed_Value_Iterator * iterator = (GTA_Computed_Value_Iterator *)value;
+    return mark_word(index, marked, worklist, (GTA_UInteger)(uintptr_t)iterator->collection)
+      && mark_word(index, marked, worklist, (GTA_UInteger)(uintptr_t)iterator->value);
+  }
+  else if (GTA_COMPUTED_VALUE_IS_FUNCTION_NATIVE(value)) {
+    return mark_word(index, marked, worklist, (GTA_UInteger)(uintptr_t)((GTA_Computed_Value_Function_Native *)value)->bound_object);
+  }
+  return true;
+}
+
+
+bool gta_garbage_collector_register(GTA_Execution_Context * context, GTA_Computed_Value * value, size_t size) {
+  assert(context);
+  assert(context->garbage_collection);
+  assert(context->garbage_collection_sizes);
+  assert(value);
+
+  if (!GTA_VECTORX_APPEND(context->garbage_collection, GTA_TYPEX_MAKE_P(value))) {
+    return false;
+  }
+  if (!GTA_VECTORX_APPEND(context->garbage_collection_sizes, GTA_TYPEX_MAKE_UI(size))) {
+    // Keep the two vectors parallel.
+    --context->garbage_collection->count;
+    return false;
+  }
+  context->gc_bytes_live += size;
+  context->gc_bytes_since_collection += size;
+  if (context->gc_bytes_live > context->gc_bytes_peak) {
+    context->gc_bytes_peak = context->gc_bytes_live;
+  }
+  // A collection cannot happen here, so over the quota, force one at the
+  // next safepoint, which will then abort if it did not free enough.
+  if (context->gc_bytes_live > context->gc_quota) {
+    context->gc_next_collection = 0;
+    gta_execution_context_budget_interrupt(context);
+  }
+  return true;
+}
+
+
+bool gta_garbage_collector_collect(GTA_Execution_Context * context, void * stack_pointer) {
+  assert(context);
+  assert(context->garbage_collection);
+  assert(context->garbage_collection_sizes);
+  assert(context->garbage_collection->count == context->garbage_collection_sizes->count);
+
+  GTA_VectorX * values = context->garbage_collection;
+  GTA_VectorX * sizes = context->garbage_collection_sizes;
+  size_t count = values->count;
+
+  // Whether the collection succeeds or not, do not attempt another one until
+  // more memory has been allocated.
+  context->gc_bytes_since_collection = 0;
+
+  if (!count) {
+    return true;
+  }
+
+  // Build the lookup table used to identify pointers to registered values.
+  GTA_HashX * index = GTA_HASHX_CREATE(count);
+  if (!index) {
+    return false;
+  }
+  bool * marked = gcu_calloc(count, sizeof(bool));
+  if (!marked) {
+    goto MARKED_CREATE_FAILED;
+  }
+  GTA_VectorX * worklist = GTA_VECTORX_CREATE(32);
+  if (!worklist) {
+    goto WORKLIST_CREATE_FAILED;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (!GTA_HASHX_SET(index, (GTA_UInteger)(uintptr_t)GTA_TYPEX_P(values->data[i]), GTA_TYPEX_MAKE_UI(i))) {
+      goto MARK_FAILED;
+    }
+  }
+
+  // Mark the roots.
+  if (context->stack) {
+    for (size_t i = 0; i < context->stack->count; ++i) {
+      if (!mark_word(index, marked, worklist, GTA_TYPEX_UI(context->stack->data[i]))) {
+        goto MARK_FAILED;
+      }
+    }
+  }
+  if (!mark_word(index, marked, worklist, (GTA_UInteger)(uintptr_t)context->result)) {
+    goto MARK_FAILED;
+  }
+  if (stack_pointer && context->gc_stack_base) {
+    assert((uintptr_t)stack_pointer <= (uintptr_t)context->gc_stack_base);
+    uintptr_t start = ((uintptr_t)stack_pointer + sizeof(uintptr_t) - 1) & ~(uintptr_t)(sizeof(uintptr_t) - 1);
+    for (uintptr_t * word = (uintptr_t *)start; (uintptr_t)word < (uintptr_t)context->gc_stack_base; ++word) {
+      if (!mark_word(index, marked, worklist, (GTA_UInteger)*word)) {
+        goto MARK_FAILED;
+      }
+    }
+  }
+
+  // Trace the children of everything that has been marked.
+  while (worklist->count) {
+    GTA_Computed_Value * value = (GTA_Computed_Value *)(uintptr_t)GTA_TYPEX_UI(worklist->data[--worklist->count]);
+    if (!mark_children(index, marked, worklist, value)) {
+      goto MARK_FAILED;
+    }
+  }
+
+  // Sweep, compacting the (parallel) garbage collection lists in place.
+  size_t kept = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (marked[i]) {
+      values->data[kept] = values->data[i];
+      sizes->data[kept] = sizes->data[i];
+      ++kept;
+    }
+    else {
+      context->gc_bytes_live -= GTA_TYPEX_UI(sizes->data[i]);
+      gta_computed_value_destroy((GTA_Computed_Value *)GTA_TYPEX_P(values->data[i]));
+    }
+  }
+  values->count = kept;
+  sizes->count = kept;
+
+  // Schedule the next collection.
+  context->gc_next_collection = context->gc_threshold > context->gc_bytes_live
+    ? context->gc_threshold
+    : context->gc_bytes_live;
+
+  GTA_VECTORX_DESTROY(worklist);
+  gcu_free(marked);
+  GTA_HASHX_DESTROY(index);
+  return true;
+
+  // Failure conditions.
+MARK_FAILED:
+  GTA_VECTORX_DESTROY(worklist);
+WORKLIST_CREATE_FAILED:
+  gcu_free(marked);
+MARKED_CREATE_FAILED:
+  GTA_HASHX_DESTROY(index);
+  return false;
+}
+
+
+void GTA_CALL gta_garbage_collector_safepoint(GTA_Execution_Context * context, void * stack_pointer) {
+  assert(context);
+  gta_garbage_collector_collect(context, stack_pointer);
+}
+
+
+void gta_garbage_collector_set_threshold(GTA_Execution_Context * context, size_t threshold) {
+  assert(context);
+  context->gc_threshold = threshold;
+  context->gc_next_collection = threshold > context->gc_bytes_live
+    ? threshold
+    : context->gc_bytes_live;
+}
+
+
+void gta_garbage_collector_set_quota(GTA_Execution_Context * context, size_t quota) {
+  assert(context);
+  context->gc_quota = quota;
+}
+
+
+size_t gta_garbage_collector_get_bytes_live(const GTA_Execution_Context * context) {
+  assert(context);
+  return context->gc_bytes_live;
+}
+
+
+size_t gta_garbage_collector_get_bytes_peak(const GTA_Execution_Context * context) {
+  assert(context);
+  return context->gc_bytes_peak;
+}
@@ -0,0 +1,121 @@
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <cutil/memory.h>
+#include <tang/computedValue/computedValueError.h>
+#include <tang/program/inlineCache.h>
+#include <tang/program/program.h>
+
+/**
+ * A single entry of an inline cache.
+ */
+typedef struct GTA_Inline_Cache_Entry {
+  /**
+   * The type of the object, or NULL if the entry has not been filled.
+   *
+   * The vtable is published after the callback has been written, so a reader
+   * which sees the vtable is guaranteed to also see the callback.
+   */
+  _Atomic(GTA_Computed_Value_VTable *) vtable;
+  /**
+   * The attribute callback for the type.
+   */
+  GTA_Computed_Value_Attribute_Callback callback;
+} GTA_Inline_Cache_Entry;
+
+/**
+ * The inline cache of a single attribute lookup call site.
+ */
+struct GTA_Inline_Cache {
+  /**
+   * The types that have been seen at the call site, in the order that they
+   * were first seen.
+   */
+  GTA_Inline_Cache_Entry entries[GTA_INLINE_CACHE_SIZE];
+  /**
+   * The number of entries that have been claimed by a writer.
+   *
+   * This may exceed GTA_INLINE_CACHE_SIZE, in which case the cache is full.
+   */
+  atomic_size_t reserved;
+  /**
+   * The hash of the attribute name.
+   */
+  GTA_UInteger identifier_hash;
+};
+
+
+GTA_Inline_Cache * gta_inline_cache_create(GTA_Program * program, GTA_UInteger identifier_hash) {
+  assert(program);
+  assert(program->inline_caches);
+
+  GTA_Inline_Cache * self = gcu_malloc(sizeof(GTA_Inline_Cache));
+  if (!self) {
+    return 0;
+  }
+  self->identifier_hash = identifier_hash;
+  gta_inline_cache_clear(self);
+
+  if (!GTA_VECTORX_APPEND(program->inline_caches, GTA_TYPEX_MAKE_P(self))) {
+    gcu_free(self);
+    return 0;
+  }
+  return self;
+}
+
+
+void gta_inline_cache_destroy(GTA_Inline_Cache * self) {
+  assert(self);
+  gcu_free(self);
+}
+
+
+void gta_inline_cache_clear(GTA_Inline_Cache * self) {
+  assert(self);
+  for (size_t i = 0; i < GTA_INLINE_CACHE_SIZE; ++i) {
+    atomic_init(&self->entries[i].vtable, NULL);
+    self->entries[i].callback = NULL;
+  }
+  atomic_init(&self->reserved, 0);
+}
+
+
+GTA_Computed_Value * GTA_CALL gta_inline_cache_period(GTA_Computed_Value * self, GTA_Inline_Cache * cache, GTA_Execution_Context * context) {
+  assert(self);
+  assert(self->vtable);
+  assert(cache);
+  assert(context);
+  assert(context->program);
+
+  // Fast path: the type has already been seen at this call site.
+  for (size_t i = 0; i < GTA_INLINE_CACHE_SIZE; ++i) {
+    GTA_Computed_Value_VTable * vtable = atomic_load_explicit(&cache->entries[i].vtable, memory_order_acquire);
+    if (vtable == self->vtable) {
+      return cache->entries[i].callback(self, context);
+    }
+    if (!vtable) {
+      break;
+    }
+  }
+
+  // Types which resolve their own attributes are never cached.
+  if (self->vtable->period != gta_computed_value_generic_period) {
+    return gta_computed_value_period(self, cache->identifier_hash, context);
+  }
+
+  GTA_Computed_Value_Attribute_Callback callback = gta_program_get_type_attribute(context->program, self->vtable, cache->identifier_hash);
+  if (!callback) {
+    return gta_computed_value_error_not_implemented;
+  }
+
+  // Claim an entry, if there is one left.  If two threads see the same type
+  // at the same time, then it may be cached twice, which is harmless.
+  if (atomic_load_explicit(&cache->reserved, memory_order_relaxed) < GTA_INLINE_CACHE_SIZE) {
+    size_t slot = atomic_fetch_add_explicit(&cache->reserved, 1, memory_order_relaxed);
+    if (slot < GTA_INLINE_CACHE_SIZE) {
+      cache->entries[slot].callback = callback;
+      atomic_store_explicit(&cache->entries[slot].vtable, self->vtable, memory_order_release);
+    }
+  }
+  return callback(self, context);
+}
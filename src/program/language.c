@@ -5,6 +5,7 @@
 #include <tang/library/library.h>
 #include <tang/library/libraryMath.h>
 #include <tang/library/libraryRandom.h>
+#include <tang/program/codeArena.h>
 #include <tang/program/language.h>
 
 GTA_Language * gta_language_create(void) {
@@ -28,6 +29,12 @@ GTA_Language * gta_language_create(void) {
       goto ADD_LIBRARY_FAILED;
     }
   }
+
+  language->code_arena = gta_code_arena_create();
+  if (language->code_arena == NULL) {
+    goto ADD_LIBRARY_FAILED;
+  }
+  language->jit_threshold = GTA_LANGUAGE_DEFAULT_JIT_THRESHOLD;
   return language;
 
 ADD_LIBRARY_FAILED:
@@ -43,7 +50,9 @@ LANGUAGE_CREATE_FAILED:
 void gta_language_destroy(GTA_Language * language) {
   assert(language);
   assert(language->library);
+  assert(language->code_arena);
 
+  gta_code_arena_destroy(language->code_arena);
   gta_library_destroy(language->library);
   gcu_free(language);
 }
@@ -1,18 +1,8 @@
 
-// Include the correct header file for the platform.
-#ifdef _WIN32
-#include <windows.h>
-#else
-#include <sys/mman.h>
-#endif
-
 #include <assert.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
 
 #include <errno.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <stdio.h>
 #include <cutil/memory.h>
@@ -20,8 +10,14 @@
 #include <tang/computedValue/computedValueAll.h>
 #include <tang/program/compilerContext.h>
 #include <tang/program/executionContext.h>
+#include <tang/program/inlineCache.h>
 #include <tang/program/binary.h>
+#include <tang/program/bundle.h>
+#include <tang/program/bytecodeImage.h>
+#include <tang/program/bytecodeOptimizer.h>
+#include <tang/program/codeArena.h>
 #include <tang/program/program.h>
+#include <tang/program/typeInference.h>
 #include <tang/program/variable.h>
 #include <tang/program/virtualMachine.h>
 #include <tang/tangLanguage.h>
@@ -35,6 +31,14 @@
 static void computed_value_attribute_hash_cleanup(GTA_HashX * hash);
 
 
+/**
+ * Helper function to clean up the list of inline caches.
+ *
+ * @param vector The list to clean up.
+ */
+static void inline_cache_list_cleanup(GTA_VectorX * vector);
+
+
 /**
  * Helper function to clean up the type/value_hash -> singleton hash.
  *
@@ -115,9 +119,11 @@ static void gta_program_compile_bytecode(GTA_Program * program) {
     }
     else if (GTA_AST_IS_FUNCTION(value.value.p)) {
       GTA_Ast_Node_Function * function = value.value.p;
+      GTA_Integer constant = gta_compiler_context_add_constant(&context, function->runtime_function);
       error_free &= true
+        && (constant >= 0)
         && GTA_VECTORX_APPEND(bytecode, GTA_TYPEX_MAKE_UI(GTA_BYTECODE_LOAD))
-        && GTA_VECTORX_APPEND(bytecode, GTA_TYPEX_MAKE_P(function->runtime_function));
+        && GTA_VECTORX_APPEND(bytecode, GTA_TYPEX_MAKE_UI(constant));
     }
     else {
       // We don't know how to handle this type of global.
@@ -174,6 +180,12 @@ static void gta_program_compile_bytecode(GTA_Program * program) {
     }
   }
 
+  // Apply the peephole optimizations.  If this fails, then the unoptimized
+  // bytecode is still usable.
+  if (error_free) {
+    gta_bytecode_optimizer_optimize(&context);
+  }
+
   // Cleanup and exit.
   GTA_VECTORX_DESTROY(variables_order);
   gta_compiler_context_destroy_in_place(&context);
@@ -227,22 +239,22 @@ GTA_Program * gta_program_create_with_flags(GTA_Language * language, const char
 }
 
 
-bool gta_program_create_in_place_with_flags(GTA_Program * program, GTA_Language * language, const char * code, GTA_Program_Flags flags) {
+/**
+ * Initialize the data structures that every program needs, whether it is
+ * compiled from source code or loaded from a bytecode image.
+ *
+ * On success, the program must be destroyed with
+ * gta_program_destroy_in_place().
+ *
+ * @param program The memory location to create the program in.
+ * @param language The language with which the program should be executed.
+ * @param code The code that the program is created from, if any.
+ * @param flags The flags to create the program with.
+ * @return True on success, false otherwise.
+ */
+static bool gta_program_initialize(GTA_Program * program, GTA_Language * language, const char * code, GTA_Program_Flags flags) {
   assert(program);
 
-  // Override flags (if allowed).
-  if (!(flags & GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT)) {
-    if (getenv("TANG_DEBUG")) {
-      flags |= GTA_PROGRAM_FLAG_DEBUG;
-    }
-    if (getenv("TANG_DISABLE_BYTECODE")) {
-      flags |= GTA_PROGRAM_FLAG_DISABLE_BYTECODE;
-    }
-    if (getenv("TANG_DISABLE_BINARY")) {
-      flags |= GTA_PROGRAM_FLAG_DISABLE_BINARY;
-    }
-  }
-
   // Initialize the program data structure.
   *program = (GTA_Program) {
     .language = language,
@@ -250,11 +262,17 @@ bool gta_program_create_in_place_with_flags(GTA_Program * program, GTA_Language
     .code = code,
     .ast = 0,
     .bytecode = 0,
+    .constants = 0,
     .binary = 0,
+    .binary_length = 0,
     .flags = flags,
     .scope = 0,
     .singletons = 0,
     .attributes = 0,
+    .inline_caches = 0,
+    .tier = GTA_PROGRAM_TIER_FINAL,
+    .invocations = 0,
+    .bundle = 0,
   };
 
   // Create the library.
@@ -270,6 +288,19 @@ bool gta_program_create_in_place_with_flags(GTA_Program * program, GTA_Language
   }
   program->attributes->cleanup = computed_value_attribute_hash_cleanup;
 
+  // Create the inline cache list.
+  program->inline_caches = GTA_VECTORX_CREATE(32);
+  if (!program->inline_caches) {
+    goto INLINE_CACHES_CREATE_FAILURE;
+  }
+  program->inline_caches->cleanup = inline_cache_list_cleanup;
+
+  // Create the constant list.
+  program->constants = GTA_VECTORX_CREATE(32);
+  if (!program->constants) {
+    goto CONSTANTS_CREATE_FAILURE;
+  }
+
   GTA_Computed_Value_VTable * vtable[] = {
     &gta_computed_value_array_vtable,
     &gta_computed_value_boolean_vtable,
@@ -302,6 +333,52 @@ bool gta_program_create_in_place_with_flags(GTA_Program * program, GTA_Language
   }
   program->singletons->cleanup = computed_value_singleton_hash_cleanup_1;
 
+  return true;
+
+  // Cleanup on failure.
+SINGLETON_HASH_CREATE_FAILURE:
+ATTRIBUTE_HASH_POPULATE_FAILURE:
+  GTA_VECTORX_DESTROY(program->constants);
+  program->constants = 0;
+CONSTANTS_CREATE_FAILURE:
+  GTA_VECTORX_DESTROY(program->inline_caches);
+  program->inline_caches = 0;
+INLINE_CACHES_CREATE_FAILURE:
+  GTA_HASHX_DESTROY(program->attributes);
+ATTRIBUTE_HASH_CREATE_FAILURE:
+  gta_library_destroy(program->library);
+  program->library = 0;
+LIBRARY_CREATE_FAILURE:
+  return false;
+}
+
+
+bool gta_program_create_in_place_with_flags(GTA_Program * program, GTA_Language * language, const char * code, GTA_Program_Flags flags) {
+  assert(program);
+
+  // Override flags (if allowed).
+  if (!(flags & GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT)) {
+    if (getenv("TANG_DEBUG")) {
+      flags |= GTA_PROGRAM_FLAG_DEBUG;
+    }
+    if (getenv("TANG_DISABLE_BYTECODE")) {
+      flags |= GTA_PROGRAM_FLAG_DISABLE_BYTECODE;
+    }
+    if (getenv("TANG_DISABLE_BINARY")) {
+      flags |= GTA_PROGRAM_FLAG_DISABLE_BINARY;
+    }
+    if (getenv("TANG_TIERED")) {
+      flags |= GTA_PROGRAM_FLAG_TIERED;
+    }
+    if (getenv("TANG_DISABLE_SIMPLIFY")) {
+      flags |= GTA_PROGRAM_FLAG_DISABLE_SIMPLIFY;
+    }
+  }
+
+  if (!gta_program_initialize(program, language, code, flags)) {
+    return false;
+  }
+
   // Either parse the code into an AST or create a null AST.
   program->ast = program->flags & GTA_PROGRAM_FLAG_IS_TEMPLATE
     ? gta_tang_parse_template(code)
@@ -318,6 +395,10 @@ bool gta_program_create_in_place_with_flags(GTA_Program * program, GTA_Language
     // If the AST is a parse error, then the program is not valid.
     goto PARSE_FAILURE;
   }
+  else if (!(program->flags & GTA_PROGRAM_FLAG_DISABLE_SIMPLIFY)) {
+    // Fold constant expressions and propagate known values.
+    program->ast = gta_tang_simplify(program->ast);
+  }
   if (!program->ast) {
     // If there is no AST, then there is no program.
     goto COMPLETE_FAILURE;
@@ -340,12 +421,29 @@ bool gta_program_create_in_place_with_flags(GTA_Program * program, GTA_Language
     goto ANALYZE_FAILURE;
   }
 
-  // If the program can compile to binary, then there is no need to compile to
-  // bytecode.
-  if (!(flags & GTA_PROGRAM_FLAG_DISABLE_BINARY)) {
+  // Prove which variables only ever hold integers, so that the bytecode may
+  // use the integer-specialized opcodes for them.
+  if (!gta_type_inference_infer_integers(program)) {
+    goto ANALYZE_FAILURE;
+  }
+
+  // A tiered program starts out as bytecode, and is only compiled to binary
+  // once it is hot (see gta_program_execute()).
+  bool is_tiered = (flags & GTA_PROGRAM_FLAG_TIERED)
+    && !(flags & (GTA_PROGRAM_FLAG_DISABLE_BYTECODE | GTA_PROGRAM_FLAG_DISABLE_BINARY));
+  if (is_tiered) {
+    gta_program_compile_bytecode(program);
+    if (program->bytecode) {
+      program->tier = GTA_PROGRAM_TIER_WARMING;
+    }
+  }
+
+  // Otherwise, if the program can compile to binary, then there is no need to
+  // compile to bytecode.
+  if (!program->bytecode && !(flags & GTA_PROGRAM_FLAG_DISABLE_BINARY)) {
     gta_program_compile_binary(program);
   }
-  if (!program->binary && !(flags & GTA_PROGRAM_FLAG_DISABLE_BYTECODE)) {
+  if (!program->binary && !program->bytecode && !(flags & GTA_PROGRAM_FLAG_DISABLE_BYTECODE)) {
     gta_program_compile_bytecode(program);
   }
 
@@ -355,30 +453,128 @@ bool gta_program_create_in_place_with_flags(GTA_Program * program, GTA_Language
 
   return true;
 
-  // Cleanup on failure.
+  // Cleanup on failure.  The scope and the AST (which may be a parse error)
+  // are destroyed along with the rest of the program.
 COMPILE_FAILURE:
 ANALYZE_FAILURE:
-  gta_variable_scope_destroy(program->scope);
-  program->scope = 0;
 SCOPE_CREATION_FAILURE:
 SCOPE_NAME_CREATION_FAILURE:
 PARSE_FAILURE:
-  gta_ast_node_destroy(program->ast);
-  program->ast = 0;
 COMPLETE_FAILURE:
-  GTA_HASHX_DESTROY(program->singletons);
-  program->singletons = 0;
-SINGLETON_HASH_CREATE_FAILURE:
-ATTRIBUTE_HASH_POPULATE_FAILURE:
-  GTA_HASHX_DESTROY(program->attributes);
-ATTRIBUTE_HASH_CREATE_FAILURE:
-  gta_library_destroy(program->library);
-  program->library = 0;
-LIBRARY_CREATE_FAILURE:
+  gta_program_destroy_in_place(program);
   return false;
 }
 
 
+GTA_Program * gta_program_create_from_image(GTA_Language * language, const void * data, size_t length, GTA_Program_Flags flags) {
+  GTA_Program * program = gcu_malloc(sizeof(GTA_Program));
+  if (!program) {
+    return 0;
+  }
+
+  if (!gta_program_create_in_place_from_image(program, language, data, length, flags)) {
+    gcu_free(program);
+    return 0;
+  }
+  return program;
+}
+
+
+bool gta_program_create_in_place_from_image(GTA_Program * program, GTA_Language * language, const void * data, size_t length, GTA_Program_Flags flags) {
+  assert(program);
+
+  if (!gta_program_initialize(program, language, 0, flags)) {
+    return false;
+  }
+  if (!gta_bytecode_image_load(program, data, length)) {
+    gta_program_destroy_in_place(program);
+    return false;
+  }
+  return true;
+}
+
+
+GTA_Program * gta_program_create_from_bundle_image(GTA_Language * language, GTA_Bundle * bundle, const void * data, size_t length, GTA_Program_Flags flags) {
+  GTA_Program * program = gcu_malloc(sizeof(GTA_Program));
+  if (!program) {
+    return 0;
+  }
+
+  if (!gta_program_create_in_place_from_bundle_image(program, language, bundle, data, length, flags)) {
+    gcu_free(program);
+    return 0;
+  }
+  return program;
+}
+
+
+bool gta_program_create_in_place_from_bundle_image(GTA_Program * program, GTA_Language * language, GTA_Bundle * bundle, const void * data, size_t length, GTA_Program_Flags flags) {
+  assert(program);
+  assert(bundle);
+
+  if (!gta_program_initialize(program, language, 0, flags)) {
+    return false;
+  }
+  // The reference is taken first, so that the mapping outlives any borrowed
+  // string that is created while loading, even if the load fails.
+  program->bundle = gta_bundle_retain(bundle);
+  if (!gta_bytecode_image_load_in_place(program, data, length)) {
+    gta_program_destroy_in_place(program);
+    return false;
+  }
+  return true;
+}
+
+
+GTA_Program * gta_program_load(GTA_Language * language, const char * path, GTA_Program_Flags flags) {
+  assert(path);
+
+  FILE * file = fopen(path, "rb");
+  if (!file) {
+    return 0;
+  }
+  GTA_Program * program = 0;
+  if (fseek(file, 0, SEEK_END)) {
+    goto FILE_CLOSE;
+  }
+  long length = ftell(file);
+  if ((length < 0) || fseek(file, 0, SEEK_SET)) {
+    goto FILE_CLOSE;
+  }
+  char * buffer = gcu_malloc(length ? (size_t)length : 1);
+  if (!buffer) {
+    goto FILE_CLOSE;
+  }
+  if (fread(buffer, 1, (size_t)length, file) == (size_t)length) {
+    program = gta_program_create_from_image(language, buffer, (size_t)length, flags);
+  }
+  gcu_free(buffer);
+
+FILE_CLOSE:
+  fclose(file);
+  return program;
+}
+
+
+bool gta_program_save(GTA_Program * program, const char * path) {
+  assert(program);
+  assert(path);
+
+  GCU_Vector64 * image = gta_bytecode_image_create(program);
+  if (!image) {
+    return false;
+  }
+  bool success = false;
+  FILE * file = fopen(path, "wb");
+  if (file) {
+    success = fwrite(image->data, sizeof(GCU_Type64_Union), image->count, file) == image->count;
+    success &= !fclose(file);
+  }
+  gcu_vector64_destroy(image);
+  return success;
+}
+
+
 void gta_program_destroy(GTA_Program * self) {
   assert(self);
   gta_program_destroy_in_place(self);
@@ -408,27 +604,44 @@ void gta_program_destroy_in_place(GTA_Program * self) {
   assert(self->attributes);
   GTA_HASHX_DESTROY(self->attributes);
 
+  // Destroy the inline caches.
+  assert(self->inline_caches);
+  GTA_VECTORX_DESTROY(self->inline_caches);
+
   // Destroy the singletons.
   assert(self->singletons);
   GTA_HASHX_DESTROY(self->singletons);
   self->singletons = 0;
 
-  // Destroy the bytecode.
+  // Destroy the constant list.  The values were owned by the singletons.
+  assert(self->constants);
+  GTA_VECTORX_DESTROY(self->constants);
+  self->constants = 0;
+
+  // Destroy the bytecode.  The words of a program that was loaded from a
+  // bundle belong to the mapped file, so only the vector itself is freed.
   if (self->bytecode) {
-    GTA_VECTORX_DESTROY(self->bytecode);
+    if (self->bundle) {
+      gcu_free(self->bytecode);
+    }
+    else {
+      GTA_VECTORX_DESTROY(self->bytecode);
+    }
   }
   self->bytecode = 0;
 
-  // Destroy the binary.
+  // Release the bundle, now that nothing refers to its mapped file.
+  if (self->bundle) {
+    gta_bundle_release(self->bundle);
+  }
+  self->bundle = 0;
+
+  // Return the binary to the code arena.
   if (self->binary) {
-#ifdef _WIN32
-    VirtualFree(self->binary, 0, MEM_RELEASE);
-#else
-    size_t length = gcu_vector8_count(self->binary);
-    munmap(self->binary, length);
-#endif // _WIN32
+    gta_code_arena_free(self->language->code_arena, self->binary, self->binary_length);
   }
   self->binary = 0;
+  self->binary_length = 0;
 }
 
 
@@ -442,6 +655,14 @@ static void computed_value_attribute_hash_cleanup(GTA_HashX * hash) {
 }
 
 
+static void inline_cache_list_cleanup(GTA_VectorX * vector) {
+  assert(vector);
+  for (size_t i = 0; i < vector->count; ++i) {
+    gta_inline_cache_destroy(GTA_TYPEX_P(vector->data[i]));
+  }
+}
+
+
 GTA_Computed_Value_Attribute_Callback gta_program_get_type_attribute(GTA_Program * program, GTA_Computed_Value_VTable * type_vtable, GTA_UInteger identifier_hash) {
   assert(program);
   assert(program->attributes);
@@ -475,7 +696,17 @@ bool gta_program_set_type_attribute(GTA_Program * program, GTA_Computed_Value_VT
   else {
     attribute_hash = GTA_TYPEX_P(type_value.value);
   }
-  return GTA_HASHX_SET(attribute_hash, identifier_hash, GTA_TYPEX_MAKE_UI(GTA_JIT_FUNCTION_CONVERTER(callback)));
+  if (!GTA_HASHX_SET(attribute_hash, identifier_hash, GTA_TYPEX_MAKE_UI(GTA_JIT_FUNCTION_CONVERTER(callback)))) {
+    return false;
+  }
+
+  // The inline caches may hold the previous callback.
+  if (program->inline_caches) {
+    for (size_t i = 0; i < program->inline_caches->count; ++i) {
+      gta_inline_cache_clear(GTA_TYPEX_P(program->inline_caches->data[i]));
+    }
+  }
+  return true;
 }
 
 
@@ -539,11 +770,51 @@ bool gta_program_set_singleton(GTA_Program * program, GTA_Computed_Value_VTable
 }
 
 
+void gta_program_mark_hot(GTA_Program * program) {
+  assert(program);
+  GTA_Program_Tier expected = GTA_PROGRAM_TIER_WARMING;
+  atomic_compare_exchange_strong_explicit(&program->tier, &expected, GTA_PROGRAM_TIER_HOT, memory_order_relaxed, memory_order_relaxed);
+}
+
+
+/**
+ * Count an execution of a tiered program, and compile it to binary if it has
+ * become hot.
+ *
+ * Only one thread compiles the program.  Other threads continue to execute
+ * the bytecode until the binary is published.
+ *
+ * @param program The program.
+ */
+static void tier_up(GTA_Program * program) {
+  GTA_Program_Tier tier = atomic_load_explicit(&program->tier, memory_order_relaxed);
+  if ((tier == GTA_PROGRAM_TIER_WARMING)
+    && (atomic_fetch_add_explicit(&program->invocations, 1, memory_order_relaxed) + 1 < program->language->jit_threshold)) {
+    return;
+  }
+  if (((tier != GTA_PROGRAM_TIER_WARMING) && (tier != GTA_PROGRAM_TIER_HOT))
+    || !atomic_compare_exchange_strong_explicit(&program->tier, &tier, GTA_PROGRAM_TIER_COMPILING, memory_order_acquire, memory_order_relaxed)) {
+    return;
+  }
+
+  // If the compilation fails, then the program simply stays in the bytecode.
+  gta_program_compile_binary(program);
+  atomic_store_explicit(&program->tier, GTA_PROGRAM_TIER_FINAL, memory_order_release);
+}
+
+
 bool gta_program_execute(GTA_Execution_Context * context) {
   assert(context);
   assert(context->program);
 
-  if (context->program->binary) {
+  if (atomic_load_explicit(&context->program->tier, memory_order_relaxed) != GTA_PROGRAM_TIER_FINAL) {
+    tier_up(context->program);
+  }
+
+  gta_execution_context_budget_start(context);
+
+  // The binary of a tiered program is published atomically.
+  if (atomic_load_explicit(&context->program->binary, memory_order_acquire)) {
     return gta_program_execute_binary(context);
   } else if (context->program->bytecode) {
     return gta_program_execute_bytecode(context);
@@ -554,7 +825,9 @@ bool gta_program_execute(GTA_Execution_Context * context) {
 
 
 bool gta_program_execute_bytecode(GTA_Execution_Context * context) {
-  return gta_virtual_machine_execute_bytecode(context);
+  bool success = gta_virtual_machine_execute_bytecode(context);
+  // Pass any remaining output to the output sink, even if execution failed.
+  return gta_execution_context_flush_output(context) && success;
 }
 
 
@@ -569,7 +842,10 @@ bool gta_program_execute_binary(GTA_Execution_Context * context) {
   assert(context->program);
   if (context->program->binary) {
     context->result = (Function_Converter){.b = context->program->binary}.f(context);
-    return true;
+    // The native stack is no longer in use.
+    context->gc_stack_base = 0;
+    // Pass any remaining output to the output sink.
+    return gta_execution_context_flush_output(context);
   }
   return false;
 }
@@ -596,7 +872,7 @@ static void update_function_pointers(GTA_Ast_Node * self, void * data, GTA_MAYBE
   if (GTA_AST_IS_FUNCTION(self)) {
     GTA_Ast_Node_Function * function = (GTA_Ast_Node_Function *)self;
     assert(function->runtime_function);
-    function->runtime_function->pointer += (size_t)data;
+    function->runtime_function->binary += (size_t)data;
   }
 }
 
@@ -614,13 +890,12 @@ void gta_program_compile_binary__x86_64(GTA_Program * program) {
   //   (GTA_Binary_Execution_Context * context)
   // Setup will pre-populate registers with:
   //   r15 = context (rdi)
-  //   r14 = &context->result
   //   r13 = global stack pointer
   //   r12 = frame (variable) stack pointer
+  //   rbx, r14 = variables chosen by the register cache
   // Each execution will put the result in rax.  It is up to
   // the caller to move the result to the correct location.
   // Registers available for use:
-  //   rbx (must save before use and restore)
   //   r10, r11 (may be clobbered by function calls)
   //   rdi, rsi, rdx, rcx, r8, r9 (function arguments, may be clobbered by function calls)
   //   rax (return value, will be clobbered by function calls)
@@ -738,14 +1013,16 @@ void gta_program_compile_binary__x86_64(GTA_Program * program) {
   //   mov r15, GTA_X86_64_R1 ; Store context in r15.
     && gta_mov_reg_reg__x86_64(v, GTA_REG_R15, GTA_X86_64_R1)
 
-  //   lea r14, [r15 + offsetof(GTA_Binary_Execution_Context, result)]
-    && gta_lea_reg_ind__x86_64(v, GTA_REG_R14, GTA_REG_R15, GTA_REG_NONE, 0, (int32_t)(size_t)(&((GTA_Execution_Context *)0)->result))
-
   //   mov r13, rsp          ; Store the global stack pointer in r13.
   //   mov r12, rsp          ; Store the frame (local variable) stack pointer in r12.
     && gta_mov_reg_reg__x86_64(v, GTA_REG_R13, GTA_REG_RSP)
     && gta_mov_reg_reg__x86_64(v, GTA_REG_R12, GTA_REG_RSP)
 
+  // Record the base of the stack so that the garbage collector knows where
+  // to stop scanning for roots.
+  //   mov [r15 + offsetof(GTA_Execution_Context, gc_stack_base)], r13
+    && gta_mov_ind_reg__x86_64(v, GTA_REG_R15, GTA_REG_NONE, 0, (int32_t)(size_t)(&((GTA_Execution_Context *)0)->gc_stack_base), GTA_REG_R13)
+
   // Reserve space for the global variables and the shadow space.
   //   add rsp, -total_stack_adjustment
     && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, -total_stack_adjustment)
@@ -830,8 +1107,12 @@ void gta_program_compile_binary__x86_64(GTA_Program * program) {
   /////////////////////////////////////////////////////////////////////////////
 
 
-  // Actually compile the AST to binary.
+  // Actually compile the AST to binary.  Some variables may be held in
+  // registers (see registerCache.h), so load them now that the globals
+  // have been initialized.
   error_free &= true
+    && gta_register_cache_choose(&context->register_cache, program, program->scope, program->ast)
+    && gta_register_cache_load__x86_64(&context->register_cache, v)
     && gta_ast_node_compile_to_binary__x86_64(program->ast, context)
 
   // At this point, a return value will be in RAX from either the code block
@@ -877,6 +1158,21 @@ void gta_program_compile_binary__x86_64(GTA_Program * program) {
     && gta_mov_reg_imm__x86_64(v, GTA_REG_RAX, (uint64_t)gta_computed_value_null)
     && gta_jmp__x86_64(v, 0xDEADBEEF)
     && gta_compiler_context_add_label_jump(context, context->break_label, v->count - 4)
+
+  // Abort: A safepoint found that the execution budget has run out, and put
+  // the error in RAX.  The safepoint may be nested within any number of
+  // function calls, but their frames hold nothing that must be cleaned up
+  // (no native code calls back into the binary), so the stack pointer is
+  // reset to that of this frame, and the program returns as usual.  R13 and
+  // RBP hold the values of this frame at every safepoint.
+  //   mov rsp, r13
+  //   add rsp, -total_stack_adjustment
+  //   jmp break
+    && gta_compiler_context_set_label(context, context->abort_label, v->count)
+    && gta_mov_reg_reg__x86_64(v, GTA_REG_RSP, GTA_REG_R13)
+    && gta_add_reg_imm__x86_64(v, GTA_REG_RSP, -total_stack_adjustment)
+    && gta_jmp__x86_64(v, 0xDEADBEEF)
+    && gta_compiler_context_add_label_jump(context, context->break_label, v->count - 4)
   ;
 
   // The compilation is finished (aside from writing the jump targets).  If
@@ -905,59 +1201,33 @@ void gta_program_compile_binary__x86_64(GTA_Program * program) {
     }
   }
 
-  // Lastly, copy the binary into executable memory.
+  // Lastly, copy the binary into the executable memory of the language.
   size_t length = gcu_vector8_count(v);
-#ifdef _WIN32
-  program->binary = VirtualAlloc(0, length, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
-  if (program->binary) {
-    memcpy(program->binary, v->data, length);
+  void * binary = gta_code_arena_allocate(program->language->code_arena, v->data, length);
+  if (binary) {
     // dump the binary to stderr
     // printf("\nProgram code:\n%s\n", program->code);
-    // Write to a file named "output.bin" for debugging.
+    // fwrite(v->data, 1, length, stderr);
+    //Write to a file named "output.bin" for debugging.
     // FILE * file = fopen("output.bin", "wb");
     // if (file) {
     //   fwrite(v->data, 1, length, file);
     //   fclose(file);
     // }
   }
-#else
-#if !defined(MAP_ANONYMOUS) && !defined(MAP_ANON)
-  // neither MAP_ANONYMOUS nor MAP_ANON are defined
-  // so we must use a file descriptor
-  int fd = open("/dev/zero", O_RDWR);
-  program->binary = mmap(0, length, PROT_EXEC | PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
-  close(fd);
-#else
-#ifndef MAP_ANONYMOUS
-#define MAP_ANONYMOUS MAP_ANON
-#endif
-  program->binary = mmap(0, length, PROT_EXEC | PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-#endif // !defined(MAP_ANONYMOUS) && !defined(MAP_ANON)
-  if (program->binary != MAP_FAILED) {
-    memcpy(program->binary, v->data, length);
-    if (mprotect(program->binary, length, PROT_EXEC | PROT_READ) != 0) {
-      munmap(program->binary, length);
-      program->binary = 0;
-    }
-    else {
-      // dump the binary to stderr
-      // printf("\nProgram code:\n%s\n", program->code);
-      // fwrite(v->data, 1, length, stderr);
-      //Write to a file named "output.bin" for debugging.
-      // FILE * file = fopen("output.bin", "wb");
-      // if (file) {
-      //   fwrite(v->data, 1, length, file);
-      //   fclose(file);
-      // }
-    }
-  }
-#endif
 
   // At this point, we must update any function pointers to point to the acutal
   // address in the binary.  They currently represent the byte offset into the
   // code block.  We will do this by iterating through the AST and updating the
   // function pointers.
-  gta_ast_node_walk(program->ast, update_function_pointers, program->binary, 0);
+  gta_ast_node_walk(program->ast, update_function_pointers, binary, 0);
+
+  // Publish the binary only once it is complete, because a tiered program may
+  // be executing on other threads.
+  if (binary) {
+    program->binary_length = length;
+    atomic_store_explicit(&program->binary, binary, memory_order_release);
+  }
 
   goto CONTEXT_CLEANUP;
 
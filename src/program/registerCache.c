@@ -0,0 +1,235 @@
+
+#include <assert.h>
+#include <cutil/memory.h>
+#include <tang/ast/astNodeDoWhile.h>
+#include <tang/ast/astNodeFor.h>
+#include <tang/ast/astNodeIdentifier.h>
+#include <tang/ast/astNodeRangedFor.h>
+#include <tang/ast/astNodeWhile.h>
+#include <tang/program/registerCache.h>
+#include <tang/program/variable.h>
+
+/**
+ * The registers which may hold variables, in the order that they are given
+ * out.
+ *
+ * These are callee-saved, so the runtime functions do not disturb them.  The
+ * other callee-saved registers are taken: r12 is the frame pointer, r13 is the
+ * globals pointer, and r15 is the execution context.
+ */
+static const GTA_Register cache_registers[GTA_REGISTER_CACHE_SIZE] = {
+  GTA_REG_RBX,
+  GTA_REG_R14,
+};
+
+/**
+ * The state of the walk over the code of a frame.
+ */
+typedef struct Register_Cache_Walk {
+  /**
+   * The cache being filled.
+   */
+  GTA_Register_Cache * cache;
+  /**
+   * The weight of each slot of the frame, indexed by position.
+   */
+  size_t * weights;
+  /**
+   * Whether or not each slot of the frame has been ruled out (or already
+   * given a register), indexed by position.
+   */
+  bool * excluded;
+  /**
+   * The number of slots in the frame.
+   */
+  size_t slot_count;
+} Register_Cache_Walk;
+
+/**
+ * Find the slot of a variable in the frame whose cache is being filled.
+ *
+ * The lookups mirror those of gta_ast_node_identifier_compile_to_binary__x86_64().
+ *
+ * @param cache The cache being filled.
+ * @param identifier The identifier.
+ * @param position Set to the position of the slot.
+ * @return True if the identifier refers to a slot of the frame.
+ */
+static bool find_slot(GTA_Register_Cache * cache, GTA_Ast_Node_Identifier * identifier, size_t * position) {
+  // Identifiers in nested functions belong to other frames.
+  if (identifier->scope != cache->scope) {
+    return false;
+  }
+  GTA_HashX_Value val;
+  if (identifier->type == GTA_AST_NODE_IDENTIFIER_TYPE_LOCAL) {
+    val = GTA_HASHX_GET(identifier->scope->variable_positions, identifier->mangled_name_hash);
+  }
+  else if (cache->includes_globals
+    && ((identifier->type == GTA_AST_NODE_IDENTIFIER_TYPE_GLOBAL)
+      || (identifier->type == GTA_AST_NODE_IDENTIFIER_TYPE_LIBRARY))) {
+    val = GTA_HASHX_GET(cache->scope->variable_positions, identifier->hash);
+  }
+  else {
+    return false;
+  }
+  if (!val.exists) {
+    return false;
+  }
+  *position = GTA_TYPEX_UI(val.value);
+  return true;
+}
+
+/**
+ * Add a weight to the slot of an identifier.
+ *
+ * @param walk The state of the walk.
+ * @param node The node being visited.
+ * @param weight The weight to add.
+ */
+static void add_weight(Register_Cache_Walk * walk, GTA_Ast_Node * node, size_t weight) {
+  size_t position;
+  if (GTA_AST_IS_IDENTIFIER(node)
+    && find_slot(walk->cache, (GTA_Ast_Node_Identifier *)node, &position)
+    && (position < walk->slot_count)) {
+    walk->weights[position] += weight;
+  }
+}
+
+/**
+ * Walk callback which adds the loop weight to every use of a variable within
+ * a loop.
+ *
+ * @param self The node being visited.
+ * @param data The Register_Cache_Walk.
+ * @param return_value Unused.
+ */
+static void weigh_loop_use(GTA_Ast_Node * self, void * data, void * return_value) {
+  (void)return_value;
+  add_weight((Register_Cache_Walk *)data, self, GTA_REGISTER_CACHE_LOOP_WEIGHT);
+}
+
+/**
+ * Walk callback which weighs every use of a variable.
+ *
+ * A loop is weighed again by a nested walk, so that a use is weighed once
+ * for each loop that encloses it.
+ *
+ * @param self The node being visited.
+ * @param data The Register_Cache_Walk.
+ * @param return_value Unused.
+ */
+static void weigh_use(GTA_Ast_Node * self, void * data, void * return_value) {
+  Register_Cache_Walk * walk = (Register_Cache_Walk *)data;
+  add_weight(walk, self, 1);
+
+  if (GTA_AST_IS_RANGED_FOR(self)) {
+    // The iterator and the index are hidden variables which are only
+    // accessed directly through their slots.
+    GTA_Ast_Node_Ranged_For * ranged_for = (GTA_Ast_Node_Ranged_For *)self;
+    GTA_Ast_Node * hidden[] = {ranged_for->iterator, ranged_for->index};
+    for (size_t i = 0; i < 2; ++i) {
+      size_t position;
+      if (find_slot(walk->cache, (GTA_Ast_Node_Identifier *)hidden[i], &position) && (position < walk->slot_count)) {
+        walk->excluded[position] = true;
+      }
+    }
+  }
+
+  if (GTA_AST_IS_WHILE(self)
+    || GTA_AST_IS_DO_WHILE(self)
+    || GTA_AST_IS_FOR(self)
+    || GTA_AST_IS_RANGED_FOR(self)) {
+    gta_ast_node_walk(self, weigh_loop_use, data, return_value);
+  }
+}
+
+
+bool gta_register_cache_choose(GTA_Register_Cache * self, GTA_Program * program, GTA_Variable_Scope * scope, GTA_Ast_Node * body) {
+  assert(self);
+  assert(program);
+  assert(scope);
+  assert(scope->variable_positions);
+
+  gta_register_cache_clear(self);
+  self->scope = scope;
+  self->includes_globals = (scope == program->scope);
+
+  size_t slot_count = GTA_HASHX_COUNT(scope->variable_positions);
+  if (!slot_count || !body) {
+    return true;
+  }
+
+  Register_Cache_Walk walk = {
+    .cache = self,
+    .weights = gcu_calloc(slot_count, sizeof(size_t)),
+    .excluded = gcu_calloc(slot_count, sizeof(bool)),
+    .slot_count = slot_count,
+  };
+  if (!walk.weights || !walk.excluded) {
+    goto CLEANUP;
+  }
+
+  gta_ast_node_walk(body, weigh_use, &walk, 0);
+
+  // Every slot is live for the whole frame, so the slots with the greatest
+  // weights are given the registers.
+  while (self->count < GTA_REGISTER_CACHE_SIZE) {
+    size_t best = slot_count;
+    for (size_t i = 0; i < slot_count; ++i) {
+      if (!walk.excluded[i]
+        && (walk.weights[i] > GTA_REGISTER_CACHE_LOOP_WEIGHT)
+        && ((best == slot_count) || (walk.weights[i] > walk.weights[best]))) {
+        best = i;
+      }
+    }
+    if (best == slot_count) {
+      break;
+    }
+    walk.excluded[best] = true;
+    self->offsets[self->count] = ((int32_t)best + 1) * -8;
+    self->registers[self->count] = cache_registers[self->count];
+    ++self->count;
+  }
+
+  gcu_free(walk.weights);
+  gcu_free(walk.excluded);
+  return true;
+
+CLEANUP:
+  gcu_free(walk.weights);
+  gcu_free(walk.excluded);
+  gta_register_cache_clear(self);
+  return false;
+}
+
+
+void gta_register_cache_clear(GTA_Register_Cache * self) {
+  assert(self);
+  *self = (GTA_Register_Cache){0};
+}
+
+
+GTA_Register gta_register_cache_find(const GTA_Register_Cache * self, bool is_global, int32_t offset) {
+  assert(self);
+  if (is_global && !self->includes_globals) {
+    return GTA_REG_NONE;
+  }
+  for (size_t i = 0; i < self->count; ++i) {
+    if (self->offsets[i] == offset) {
+      return self->registers[i];
+    }
+  }
+  return GTA_REG_NONE;
+}
+
+
+bool gta_register_cache_load__x86_64(const GTA_Register_Cache * self, GCU_Vector8 * vector) {
+  assert(self);
+  assert(vector);
+  bool error_free = true;
+  for (size_t i = 0; error_free && (i < self->count); ++i) {
+    //   mov reg, [r12 + offset]
+    error_free &= gta_mov_reg_ind__x86_64(vector, self->registers[i], GTA_REG_R12, GTA_REG_NONE, 0, self->offsets[i]);
+  }
+  return error_free;
+}
@@ -0,0 +1,469 @@
+
+#include <assert.h>
+#include <cutil/memory.h>
+#include <tang/ast/astNodeAssign.h>
+#include <tang/ast/astNodeBinary.h>
+#include <tang/ast/astNodeBlock.h>
+#include <tang/ast/astNodeFor.h>
+#include <tang/ast/astNodeFunction.h>
+#include <tang/ast/astNodeIdentifier.h>
+#include <tang/ast/astNodeRangedFor.h>
+#include <tang/ast/astNodeUnary.h>
+#include <tang/program/program.h>
+#include <tang/program/typeInference.h>
+#include <tang/program/variable.h>
+
+/**
+ * What is known about a slot of a frame.
+ */
+typedef enum Type_Inference_State {
+  TYPE_INFERENCE_UNSEEN,   ///< The slot has not been used yet.
+  TYPE_INFERENCE_INTEGER,  ///< The slot is (so far) proven to be an integer.
+  TYPE_INFERENCE_EXCLUDED, ///< The slot may hold something else.
+} Type_Inference_State;
+
+/**
+ * The state of the inference over the code of a frame.
+ */
+typedef struct Type_Inference_Frame {
+  /**
+   * The scope of the frame.
+   */
+  GTA_Variable_Scope * scope;
+  /**
+   * Whether or not the frame is the program's frame, whose slots also hold
+   * the globals and the libraries.
+   */
+  bool includes_globals;
+  /**
+   * What is known about each slot of the frame, indexed by position.
+   */
+  Type_Inference_State * states;
+  /**
+   * The number of uses of each slot of the frame, indexed by position.
+   */
+  size_t * uses;
+  /**
+   * The number of slots in the frame.
+   */
+  size_t slot_count;
+  /**
+   * The top-level statement of the frame which is being walked.
+   */
+  GTA_Ast_Node * statement;
+  /**
+   * Whether or not a slot was excluded during the current pass.
+   */
+  bool changed;
+} Type_Inference_Frame;
+
+/**
+ * The state of a walk which counts the uses of one slot.
+ */
+typedef struct Type_Inference_Count {
+  /**
+   * The frame.
+   */
+  Type_Inference_Frame * frame;
+  /**
+   * The position of the slot.
+   */
+  size_t position;
+  /**
+   * The number of uses found.
+   */
+  size_t count;
+} Type_Inference_Count;
+
+/**
+ * Find the slot of a variable in the frame.
+ *
+ * The lookups mirror those of gta_ast_node_identifier_compile_to_bytecode().
+ *
+ * @param frame The frame.
+ * @param node The node, which may or may not be an identifier.
+ * @param position Set to the position of the slot.
+ * @return True if the node is an identifier which refers to a slot of the
+ *   frame.
+ */
+static bool find_slot(Type_Inference_Frame * frame, GTA_Ast_Node * node, size_t * position) {
+  if (!node || !GTA_AST_IS_IDENTIFIER(node)) {
+    return false;
+  }
+  GTA_Ast_Node_Identifier * identifier = (GTA_Ast_Node_Identifier *)node;
+
+  // Identifiers in nested functions belong to other frames.
+  if (identifier->scope != frame->scope) {
+    return false;
+  }
+  GTA_HashX_Value val;
+  if (identifier->type == GTA_AST_NODE_IDENTIFIER_TYPE_LOCAL) {
+    val = GTA_HASHX_GET(frame->scope->variable_positions, identifier->mangled_name_hash);
+  }
+  else if (frame->includes_globals
+    && ((identifier->type == GTA_AST_NODE_IDENTIFIER_TYPE_GLOBAL)
+      || (identifier->type == GTA_AST_NODE_IDENTIFIER_TYPE_LIBRARY))) {
+    val = GTA_HASHX_GET(frame->scope->variable_positions, identifier->hash);
+  }
+  else {
+    return false;
+  }
+  if (!val.exists || (GTA_TYPEX_UI(val.value) >= frame->slot_count)) {
+    return false;
+  }
+  *position = GTA_TYPEX_UI(val.value);
+  return true;
+}
+
+/**
+ * Walk callback which counts the uses of one slot.
+ *
+ * @param self The node being visited.
+ * @param data The Type_Inference_Count.
+ * @param return_value Unused.
+ */
+static void count_slot_use(GTA_Ast_Node * self, void * data, void * return_value) {
+  (void)return_value;
+  Type_Inference_Count * count = (Type_Inference_Count *)data;
+  size_t position;
+  if (find_slot(count->frame, self, &position) && (position == count->position)) {
+    ++count->count;
+  }
+}
+
+/**
+ * Count the uses of one slot within a node.
+ *
+ * @param frame The frame.
+ * @param node The node.
+ * @param position The position of the slot.
+ * @return The number of uses of the slot within the node.
+ */
+static size_t count_slot_uses(Type_Inference_Frame * frame, GTA_Ast_Node * node, size_t position) {
+  Type_Inference_Count count = {
+    .frame = frame,
+    .position = position,
+    .count = 0,
+  };
+  gta_ast_node_walk(node, count_slot_use, &count, 0);
+  return count.count;
+}
+
+/**
+ * Walk callback which counts the uses of every slot, and which excludes the
+ * slots that are assigned other than by an assignment.
+ *
+ * @param self The node being visited.
+ * @param data The Type_Inference_Frame.
+ * @param return_value Unused.
+ */
+static void count_use(GTA_Ast_Node * self, void * data, void * return_value) {
+  (void)return_value;
+  Type_Inference_Frame * frame = (Type_Inference_Frame *)data;
+  size_t position;
+
+  if (GTA_AST_IS_RANGED_FOR(self)) {
+    // The variable of the loop is assigned the elements of the collection.
+    if (find_slot(frame, ((GTA_Ast_Node_Ranged_For *)self)->identifier, &position)) {
+      frame->states[position] = TYPE_INFERENCE_EXCLUDED;
+    }
+    return;
+  }
+
+  if (!GTA_AST_IS_IDENTIFIER(self)) {
+    return;
+  }
+  GTA_Ast_Node_Identifier * identifier = (GTA_Ast_Node_Identifier *)self;
+
+  if (find_slot(frame, self, &position)) {
+    ++frame->uses[position];
+    if (identifier->type == GTA_AST_NODE_IDENTIFIER_TYPE_LIBRARY) {
+      frame->states[position] = TYPE_INFERENCE_EXCLUDED;
+    }
+    return;
+  }
+
+  // A global of a function (or a library) shares its slot with the variable
+  // of the program's frame which has the same name, and a function call may
+  // assign anything to it.
+  if (frame->includes_globals
+    && ((identifier->type == GTA_AST_NODE_IDENTIFIER_TYPE_GLOBAL)
+      || (identifier->type == GTA_AST_NODE_IDENTIFIER_TYPE_LIBRARY))) {
+    GTA_HashX_Value val = GTA_HASHX_GET(frame->scope->variable_positions, identifier->hash);
+    if (val.exists && (GTA_TYPEX_UI(val.value) < frame->slot_count)) {
+      frame->states[GTA_TYPEX_UI(val.value)] = TYPE_INFERENCE_EXCLUDED;
+    }
+  }
+}
+
+/**
+ * Make the variable of an assignment a candidate, if the assignment is the
+ * first use of the variable.
+ *
+ * @param frame The frame.
+ * @param node The node, which may or may not be an assignment.
+ */
+static void define(Type_Inference_Frame * frame, GTA_Ast_Node * node) {
+  if (!node || !GTA_AST_IS_ASSIGN(node)) {
+    return;
+  }
+  GTA_Ast_Node_Assign * assign = (GTA_Ast_Node_Assign *)node;
+  size_t position;
+  if (find_slot(frame, assign->lhs, &position)
+    && (frame->states[position] == TYPE_INFERENCE_UNSEEN)
+    && !count_slot_uses(frame, assign->rhs, position)) {
+    frame->states[position] = TYPE_INFERENCE_INTEGER;
+  }
+}
+
+/**
+ * Walk callback which finds the first use of every slot.
+ *
+ * A slot is a candidate if its first use is an assignment which is always
+ * executed before any other use of the slot: either a top-level statement of
+ * the frame, or the initialization of a `for` loop which contains every use
+ * of the slot.  Otherwise, the slot is excluded.
+ *
+ * @param self The node being visited.
+ * @param data The Type_Inference_Frame.
+ * @param return_value Unused.
+ */
+static void find_definition(GTA_Ast_Node * self, void * data, void * return_value) {
+  (void)return_value;
+  Type_Inference_Frame * frame = (Type_Inference_Frame *)data;
+  size_t position;
+
+  if (self == frame->statement) {
+    define(frame, self);
+  }
+  if (GTA_AST_IS_FOR(self)) {
+    GTA_Ast_Node_For * for_node = (GTA_Ast_Node_For *)self;
+    if (for_node->init
+      && GTA_AST_IS_ASSIGN(for_node->init)
+      && find_slot(frame, ((GTA_Ast_Node_Assign *)for_node->init)->lhs, &position)
+      && ((self == frame->statement)
+        || (count_slot_uses(frame, self, position) == frame->uses[position]))) {
+      define(frame, for_node->init);
+    }
+  }
+  else if (find_slot(frame, self, &position) && (frame->states[position] == TYPE_INFERENCE_UNSEEN)) {
+    frame->states[position] = TYPE_INFERENCE_EXCLUDED;
+  }
+}
+
+/**
+ * Whether or not an expression is proven to be an integer, given the
+ * candidates of the frame.
+ *
+ * @param frame The frame.
+ * @param node The expression.
+ * @return True if the expression is proven to be an integer.
+ */
+static bool is_integer(Type_Inference_Frame * frame, GTA_Ast_Node * node) {
+  if (node->possible_type == GTA_AST_POSSIBLE_TYPE_INTEGER) {
+    return true;
+  }
+  size_t position;
+  if (find_slot(frame, node, &position)) {
+    return frame->states[position] == TYPE_INFERENCE_INTEGER;
+  }
+  if (GTA_AST_IS_BINARY(node)) {
+    // Integer addition, subtraction, and multiplication always produce an
+    // integer (which may be boxed).
+    GTA_Ast_Node_Binary * binary = (GTA_Ast_Node_Binary *)node;
+    return ((binary->operator_type == GTA_BINARY_TYPE_ADD)
+        || (binary->operator_type == GTA_BINARY_TYPE_SUBTRACT)
+        || (binary->operator_type == GTA_BINARY_TYPE_MULTIPLY))
+      && is_integer(frame, binary->lhs)
+      && is_integer(frame, binary->rhs);
+  }
+  if (GTA_AST_IS_UNARY(node)) {
+    GTA_Ast_Node_Unary * unary = (GTA_Ast_Node_Unary *)node;
+    return (unary->operator_type == GTA_UNARY_TYPE_NEGATIVE)
+      && is_integer(frame, unary->expression);
+  }
+  return false;
+}
+
+/**
+ * Walk callback which excludes the candidates that are assigned an expression
+ * which is not proven to be an integer.
+ *
+ * @param self The node being visited.
+ * @param data The Type_Inference_Frame.
+ * @param return_value Unused.
+ */
+static void check_assignment(GTA_Ast_Node * self, void * data, void * return_value) {
+  (void)return_value;
+  Type_Inference_Frame * frame = (Type_Inference_Frame *)data;
+  if (!GTA_AST_IS_ASSIGN(self)) {
+    return;
+  }
+  GTA_Ast_Node_Assign * assign = (GTA_Ast_Node_Assign *)self;
+  size_t position;
+  if (find_slot(frame, assign->lhs, &position)
+    && (frame->states[position] == TYPE_INFERENCE_INTEGER)
+    && !is_integer(frame, assign->rhs)) {
+    frame->states[position] = TYPE_INFERENCE_EXCLUDED;
+    frame->changed = true;
+  }
+}
+
+/**
+ * Walk callback which marks the uses of the proven integers.
+ *
+ * @param self The node being visited.
+ * @param data The Type_Inference_Frame.
+ * @param return_value Unused.
+ */
+static void mark_integer(GTA_Ast_Node * self, void * data, void * return_value) {
+  (void)return_value;
+  Type_Inference_Frame * frame = (Type_Inference_Frame *)data;
+  size_t position;
+  if (find_slot(frame, self, &position) && (frame->states[position] == TYPE_INFERENCE_INTEGER)) {
+    self->possible_type = GTA_AST_POSSIBLE_TYPE_INTEGER;
+  }
+}
+
+/**
+ * Infer the proven integers of one frame.
+ *
+ * @param scope The scope of the frame.
+ * @param includes_globals Whether or not the frame is the program's frame.
+ * @param parameters The parameters of the function, or NULL.
+ * @param body The code of the frame.
+ * @return True on success, false if memory could not be allocated.
+ */
+static bool infer_frame(GTA_Variable_Scope * scope, bool includes_globals, GTA_VectorX * parameters, GTA_Ast_Node * body) {
+  assert(scope);
+  assert(scope->variable_positions);
+
+  size_t slot_count = GTA_HASHX_COUNT(scope->variable_positions);
+  if (!slot_count || !body) {
+    return true;
+  }
+
+  Type_Inference_Frame frame = {
+    .scope = scope,
+    .includes_globals = includes_globals,
+    .states = gcu_calloc(slot_count, sizeof(Type_Inference_State)),
+    .uses = gcu_calloc(slot_count, sizeof(size_t)),
+    .slot_count = slot_count,
+    .statement = 0,
+    .changed = false,
+  };
+  if (!frame.states || !frame.uses) {
+    goto CLEANUP;
+  }
+
+  // The parameters already hold the arguments.
+  size_t position;
+  for (size_t i = 0; parameters && (i < GTA_VECTORX_COUNT(parameters)); ++i) {
+    if (find_slot(&frame, (GTA_Ast_Node *)GTA_TYPEX_P(parameters->data[i]), &position)) {
+      frame.states[position] = TYPE_INFERENCE_EXCLUDED;
+    }
+  }
+
+  gta_ast_node_walk(body, count_use, &frame, 0);
+
+  // Find the candidates, one top-level statement at a time.
+  if (GTA_AST_IS_BLOCK(body)) {
+    GTA_VectorX * statements = ((GTA_Ast_Node_Block *)body)->statements;
+    for (size_t i = 0; i < GTA_VECTORX_COUNT(statements); ++i) {
+      frame.statement = (GTA_Ast_Node *)GTA_TYPEX_P(statements->data[i]);
+      gta_ast_node_walk(frame.statement, find_definition, &frame, 0);
+    }
+  }
+  else {
+    frame.statement = body;
+    gta_ast_node_walk(body, find_definition, &frame, 0);
+  }
+
+  // Excluding one candidate may disprove the assignments to another.
+  do {
+    frame.changed = false;
+    gta_ast_node_walk(body, check_assignment, &frame, 0);
+  } while (frame.changed);
+
+  gta_ast_node_walk(body, mark_integer, &frame, 0);
+
+  gcu_free(frame.states);
+  gcu_free(frame.uses);
+  return true;
+
+CLEANUP:
+  gcu_free(frame.states);
+  gcu_free(frame.uses);
+  return false;
+}
+
+/**
+ * The state of the walk over the whole program.
+ */
+typedef struct Type_Inference_Walk {
+  /**
+   * The binary operations, in the order that they were visited.
+   */
+  GTA_VectorX * binaries;
+  /**
+   * Whether or not memory could not be allocated.
+   */
+  bool failed;
+} Type_Inference_Walk;
+
+/**
+ * Walk callback which infers the proven integers of each function, and which
+ * collects the binary operations.
+ *
+ * @param self The node being visited.
+ * @param data The Type_Inference_Walk.
+ * @param return_value Unused.
+ */
+static void infer_function(GTA_Ast_Node * self, void * data, void * return_value) {
+  (void)return_value;
+  Type_Inference_Walk * walk = (Type_Inference_Walk *)data;
+  if (walk->failed) {
+    return;
+  }
+  if (GTA_AST_IS_FUNCTION(self)) {
+    GTA_Ast_Node_Function * function = (GTA_Ast_Node_Function *)self;
+    if (function->scope && !infer_frame(function->scope, false, function->parameters, function->block)) {
+      walk->failed = true;
+    }
+  }
+  else if (GTA_AST_IS_BINARY(self)) {
+    if (!GTA_VECTORX_APPEND(walk->binaries, GTA_TYPEX_MAKE_P(self))) {
+      walk->failed = true;
+    }
+  }
+}
+
+
+bool gta_type_inference_infer_integers(GTA_Program * program) {
+  assert(program);
+  assert(program->ast);
+  assert(program->scope);
+
+  if (!infer_frame(program->scope, true, 0, program->ast)) {
+    return false;
+  }
+
+  Type_Inference_Walk walk = {
+    .binaries = GTA_VECTORX_CREATE(32),
+    .failed = false,
+  };
+  if (!walk.binaries) {
+    return false;
+  }
+  gta_ast_node_walk(program->ast, infer_function, &walk, 0);
+
+  // The walk visits a node before its operands, so walking the binary
+  // operations backwards infers the operands first.
+  for (size_t i = GTA_VECTORX_COUNT(walk.binaries); !walk.failed && i; --i) {
+    GTA_Ast_Node_Binary * binary = (GTA_Ast_Node_Binary *)GTA_TYPEX_P(walk.binaries->data[i - 1]);
+    binary->base.possible_type = gta_ast_node_binary_infer_possible_type(binary);
+  }
+
+  GTA_VECTORX_DESTROY(walk.binaries);
+  return !walk.failed;
+}
@@ -1,5 +1,6 @@
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <string.h>
 #include <cutil/memory.h>
@@ -7,15 +8,268 @@
 #include <tang/computedValue/computedValueAll.h>
 #include <tang/library/library.h>
 #include <tang/program/bytecode.h>
+#include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
+#include <tang/program/inlineCache.h>
 #include <tang/program/virtualMachine.h>
 
+/**
+ * The largest magnitude that an immediate integer operand may have for the
+ * product of two of them to be guaranteed to also fit in an immediate.
+ */
+#define GTA_VM_IMMEDIATE_MULTIPLY_LIMIT ((GTA_Integer)1 << (sizeof(GTA_Integer) * 4 - 2))
+
+/**
+ * Whether two stack slots are both immediates, and at least one of them is a
+ * float, so that an arithmetic operation on them produces a float.
+ */
+#define GTA_VM_ARE_IMMEDIATE_FLOAT_OPERANDS(L, R) (GTA_VM_IS_IMMEDIATE(L) && GTA_VM_IS_IMMEDIATE(R) && (GTA_VM_IS_IMMEDIATE_FLOAT(L) || GTA_VM_IS_IMMEDIATE_FLOAT(R)))
+
+/*
+ * The bytecode interpreter uses direct-threaded dispatch when the compiler
+ * supports labels as values (GCC and Clang).  Each instruction handler jumps
+ * directly to the handler of the next instruction, so that each handler has
+ * its own (more predictable) indirect branch, rather than every instruction
+ * sharing the single indirect branch of the `switch`.
+ *
+ * The `switch` is still used as the portable fallback, and is also used to
+ * dispatch the first instruction and any instruction which follows a handler
+ * that exits with `break`.  Define GTA_VIRTUAL_MACHINE_DISABLE_COMPUTED_GOTO
+ * to always use the `switch`.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(GTA_VIRTUAL_MACHINE_DISABLE_COMPUTED_GOTO)
+#define GTA_VIRTUAL_MACHINE_COMPUTED_GOTO
+#endif
+
+#ifdef GTA_VIRTUAL_MACHINE_COMPUTED_GOTO
+
+/**
+ * Begin the handler for a bytecode instruction.
+ *
+ * @param OPCODE The bytecode.
+ */
+#define GTA_VM_CASE(OPCODE) case OPCODE: GTA_VM_TARGET_##OPCODE:
+
+/**
+ * Begin the handler for unknown bytecode instructions.
+ */
+#define GTA_VM_DEFAULT() default: GTA_VM_TARGET_DEFAULT:
+
+/**
+ * Finish the current handler and dispatch the next instruction.
+ *
+ * Must not be used if `next` may be NULL.
+ */
+#define GTA_VM_NEXT() \
+  current = next++; \
+  goto *(GTA_TYPEX_UI(*current) < GTA_BYTECODE_COUNT ? dispatch_table[GTA_TYPEX_UI(*current)] : &&GTA_VM_TARGET_DEFAULT)
+
+#else
+
+/**
+ * Begin the handler for a bytecode instruction.
+ *
+ * @param OPCODE The bytecode.
+ */
+#define GTA_VM_CASE(OPCODE) case OPCODE:
+
+/**
+ * Begin the handler for unknown bytecode instructions.
+ */
+#define GTA_VM_DEFAULT() default:
+
+/**
+ * Finish the current handler and dispatch the next instruction.
+ */
+#define GTA_VM_NEXT() break
+
+#endif // GTA_VIRTUAL_MACHINE_COMPUTED_GOTO
+
+/**
+ * Convert a stack slot into a computed value pointer, boxing it if necessary.
+ *
+ * If the slot holds an immediate integer or float, a new
+ * GTA_Computed_Value_Integer or GTA_Computed_Value_Float is created and the
+ * slot is overwritten with it, so that subsequent uses of the same slot do not
+ * allocate again.
+ *
+ * @param slot The stack slot.
+ * @param context The execution context.
+ * @return The computed value held in the slot, or an error value if the
+ *   number could not be boxed.
+ */
+static inline GTA_Computed_Value * gta_virtual_machine_box(GTA_TypeX_Union * slot, GTA_Execution_Context * context) {
+  if (!GTA_VM_IS_IMMEDIATE(*slot)) {
+    return GTA_TYPEX_P(*slot);
+  }
+  GTA_Computed_Value * boxed = GTA_VM_IS_IMMEDIATE_FLOAT(*slot)
+    ? (GTA_Computed_Value *)gta_computed_value_float_create(GTA_VM_IMMEDIATE_FLOAT_VALUE(*slot), context)
+    : (GTA_Computed_Value *)gta_computed_value_integer_create(GTA_VM_IMMEDIATE_INTEGER_VALUE(*slot), context);
+  if (!boxed) {
+    return gta_computed_value_error_out_of_memory;
+  }
+  *slot = GTA_TYPEX_MAKE_P(boxed);
+  return boxed;
+}
+
+
+/**
+ * Produce a stack slot for an integer value.
+ *
+ * The integer will be stored as an immediate if it fits, otherwise it will be
+ * boxed.
+ *
+ * @param value The integer value.
+ * @param context The execution context.
+ * @return The stack slot representing the value.
+ */
+static inline GTA_TypeX_Union gta_virtual_machine_make_integer(GTA_Integer value, GTA_Execution_Context * context) {
+  if (GTA_VM_IMMEDIATE_INTEGER_FITS(value)) {
+    return GTA_VM_MAKE_IMMEDIATE_INTEGER(value);
+  }
+  GTA_Computed_Value * boxed = (GTA_Computed_Value *)gta_computed_value_integer_create(value, context);
+  return GTA_TYPEX_MAKE_P(boxed ? boxed : gta_computed_value_error_out_of_memory);
+}
+
+
+/**
+ * Produce a stack slot for a float value.
+ *
+ * The float will be stored as an immediate if it fits, otherwise it will be
+ * boxed.
+ *
+ * @param value The float value.
+ * @param context The execution context.
+ * @return The stack slot representing the value.
+ */
+static inline GTA_TypeX_Union gta_virtual_machine_make_float(GTA_Float value, GTA_Execution_Context * context) {
+  GTA_UInteger rotated = GTA_VM_FLOAT_ROTATED(value);
+  if (GTA_VM_IMMEDIATE_FLOAT_FITS_ROTATED(rotated)) {
+    return GTA_VM_MAKE_IMMEDIATE_FLOAT_ROTATED(rotated);
+  }
+  GTA_Computed_Value * boxed = (GTA_Computed_Value *)gta_computed_value_float_create(value, context);
+  return GTA_TYPEX_MAKE_P(boxed ? boxed : gta_computed_value_error_out_of_memory);
+}
+
+
+/**
+ * Read an immediate number as a float.
+ *
+ * @param slot The stack slot, which must hold an immediate float or an
+ *   immediate integer.
+ * @return The value, converted to a float if necessary.
+ */
+static inline GTA_Float gta_virtual_machine_float_value(GTA_TypeX_Union slot) {
+  return GTA_VM_IS_IMMEDIATE_FLOAT(slot)
+    ? GTA_VM_IMMEDIATE_FLOAT_VALUE(slot)
+    : (GTA_Float)GTA_VM_IMMEDIATE_INTEGER_VALUE(slot);
+}
+
+
+/**
+ * Determine the truthiness of a stack slot without boxing it.
+ *
+ * @param slot The stack slot.
+ * @return The truthiness of the value.
+ */
+static inline bool gta_virtual_machine_is_true(GTA_TypeX_Union slot) {
+  return GTA_VM_IS_IMMEDIATE_INTEGER(slot)
+    ? (bool)GTA_VM_IMMEDIATE_INTEGER_VALUE(slot)
+    : GTA_VM_IS_IMMEDIATE_FLOAT(slot)
+      ? (bool)GTA_VM_IMMEDIATE_FLOAT_VALUE(slot)
+      : ((GTA_Computed_Value *)GTA_TYPEX_P(slot))->is_true;
+}
+
+
+/**
+ * Perform a comparison for a fused comparison instruction.
+ *
+ * @param comparison The comparison opcode (e.g., GTA_BYTECODE_LESS_THAN).
+ * @param lhs The left-hand side slot.  It will be boxed if necessary.
+ * @param rhs The right-hand side slot.  It will be boxed if necessary.
+ * @param context The execution context.
+ * @return The result of the comparison.
+ */
+static GTA_TypeX_Union gta_virtual_machine_compare(GTA_UInteger comparison, GTA_TypeX_Union * lhs, GTA_TypeX_Union * rhs, GTA_Execution_Context * context) {
+  if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs)) {
+    GTA_Integer lhs_value = GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs);
+    GTA_Integer rhs_value = GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs);
+    bool result = comparison == GTA_BYTECODE_LESS_THAN ? lhs_value < rhs_value
+      : comparison == GTA_BYTECODE_LESS_THAN_EQUAL ? lhs_value <= rhs_value
+      : comparison == GTA_BYTECODE_GREATER_THAN ? lhs_value > rhs_value
+      : comparison == GTA_BYTECODE_GREATER_THAN_EQUAL ? lhs_value >= rhs_value
+      : comparison == GTA_BYTECODE_EQUAL ? lhs_value == rhs_value
+      : lhs_value != rhs_value;
+    return GTA_TYPEX_MAKE_P(result
+      ? gta_computed_value_boolean_true
+      : gta_computed_value_boolean_false);
+  }
+  if (GTA_VM_ARE_IMMEDIATE_FLOAT_OPERANDS(*lhs, *rhs)) {
+    GTA_Float lhs_value = gta_virtual_machine_float_value(*lhs);
+    GTA_Float rhs_value = gta_virtual_machine_float_value(*rhs);
+    bool result = comparison == GTA_BYTECODE_LESS_THAN ? lhs_value < rhs_value
+      : comparison == GTA_BYTECODE_LESS_THAN_EQUAL ? lhs_value <= rhs_value
+      : comparison == GTA_BYTECODE_GREATER_THAN ? lhs_value > rhs_value
+      : comparison == GTA_BYTECODE_GREATER_THAN_EQUAL ? lhs_value >= rhs_value
+      : comparison == GTA_BYTECODE_EQUAL ? lhs_value == rhs_value
+      : lhs_value != rhs_value;
+    return GTA_TYPEX_MAKE_P(result
+      ? gta_computed_value_boolean_true
+      : gta_computed_value_boolean_false);
+  }
+  GTA_Computed_Value * rhs_value = gta_virtual_machine_box(rhs, context);
+  GTA_Computed_Value * lhs_value = gta_virtual_machine_box(lhs, context);
+  switch (comparison) {
+    case GTA_BYTECODE_LESS_THAN:
+      return GTA_TYPEX_MAKE_P(gta_computed_value_less_than(lhs_value, rhs_value, true, context));
+    case GTA_BYTECODE_LESS_THAN_EQUAL:
+      return GTA_TYPEX_MAKE_P(gta_computed_value_less_than_equal(lhs_value, rhs_value, true, context));
+    case GTA_BYTECODE_GREATER_THAN:
+      return GTA_TYPEX_MAKE_P(gta_computed_value_greater_than(lhs_value, rhs_value, true, context));
+    case GTA_BYTECODE_GREATER_THAN_EQUAL:
+      return GTA_TYPEX_MAKE_P(gta_computed_value_greater_than_equal(lhs_value, rhs_value, true, context));
+    case GTA_BYTECODE_EQUAL:
+      return GTA_TYPEX_MAKE_P(gta_computed_value_equal(lhs_value, rhs_value, true, context));
+    default:
+      return GTA_TYPEX_MAKE_P(gta_computed_value_not_equal(lhs_value, rhs_value, true, context));
+  }
+}
+
+
+/**
+ * Perform a garbage collection if one is due, and count the safepoint against
+ * the execution budget.
+ *
+ * This must only be called between instructions, when every live value is on
+ * the stack.  It is used at loop back-edges and function calls, so that
+ * long-running programs will periodically reclaim unreachable values, and so
+ * that runaway programs can be stopped.
+ *
+ * @param context The execution context.
+ * @return NULL if execution may continue, or the error with which the
+ *   execution must be aborted.
+ */
+static inline GTA_Computed_Value * gta_virtual_machine_safepoint(GTA_Execution_Context * context) {
+  if (GTA_GARBAGE_COLLECTOR_SHOULD_COLLECT(context)) {
+    gta_garbage_collector_collect(context, NULL);
+  }
+  return GTA_EXECUTION_CONTEXT_BUDGET_TICK(context)
+    ? gta_execution_context_budget_check(context)
+    : NULL;
+}
+
+
 bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
   if (!context || !context->program || !context->program->bytecode) {
     return false;
   }
-  // Only the bytecode interpreter uses the pc_stack, so
-  // initialize it here.
-  if (!(context->pc_stack = GTA_VECTORX_CREATE(32))) {
+  // Only the bytecode interpreter uses the pc_stack, so initialize it here.
+  // It is kept by the context, so that it can be reused if the context is
+  // reset and executed again.
+  if (context->pc_stack) {
+    context->pc_stack->count = 0;
+  }
+  else if (!(context->pc_stack = GTA_VECTORX_CREATE(32))) {
     return false;
   }
 
@@ -24,22 +278,100 @@ bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
   assert(context->stack);
   GTA_TypeX_Union * current = context->program->bytecode->data;
   GTA_TypeX_Union * next = current;
+  // The operands of LOAD and PERIOD are indices into the constants, which do
+  // not change once the bytecode has been compiled.
+  GTA_TypeX_Union * const constants = context->program->constants->data;
   // Note that the stack pointer is the count of the stack, not the index of
   // the top of the stack.  This is done for effieciency reasons.  Otherwise,
   // we would have to maintain a separate variable for the stack pointer and
   // update both of them on every push and pop.
   size_t * const sp = &context->stack->count;
+  // The reason that the execution was aborted, if it was.
+  GTA_Computed_Value * aborted = NULL;
+
+#ifdef GTA_VIRTUAL_MACHINE_COMPUTED_GOTO
+  // Labels as values are a GNU extension.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+  // Every bytecode must have an entry.  Bytecodes that the interpreter does
+  // not implement are sent to the default handler.
+  static const void * const dispatch_table[] = {
+    [GTA_BYTECODE_RETURN] = &&GTA_VM_TARGET_GTA_BYTECODE_RETURN,
+    [GTA_BYTECODE_NOP] = &&GTA_VM_TARGET_GTA_BYTECODE_NOP,
+    [GTA_BYTECODE_BOOLEAN] = &&GTA_VM_TARGET_GTA_BYTECODE_BOOLEAN,
+    [GTA_BYTECODE_FLOAT] = &&GTA_VM_TARGET_GTA_BYTECODE_FLOAT,
+    [GTA_BYTECODE_INTEGER] = &&GTA_VM_TARGET_GTA_BYTECODE_INTEGER,
+    [GTA_BYTECODE_NULL] = &&GTA_VM_TARGET_GTA_BYTECODE_NULL,
+    [GTA_BYTECODE_STRING] = &&GTA_VM_TARGET_GTA_BYTECODE_STRING,
+    [GTA_BYTECODE_ARRAY] = &&GTA_VM_TARGET_GTA_BYTECODE_ARRAY,
+    [GTA_BYTECODE_MAP] = &&GTA_VM_TARGET_GTA_BYTECODE_MAP,
+    [GTA_BYTECODE_CAST] = &&GTA_VM_TARGET_GTA_BYTECODE_CAST,
+    [GTA_BYTECODE_SET_NOT_TEMP] = &&GTA_VM_TARGET_GTA_BYTECODE_SET_NOT_TEMP,
+    [GTA_BYTECODE_ADOPT] = &&GTA_VM_TARGET_GTA_BYTECODE_ADOPT,
+    [GTA_BYTECODE_POP] = &&GTA_VM_TARGET_GTA_BYTECODE_POP,
+    [GTA_BYTECODE_PUSH_BP] = &&GTA_VM_TARGET_DEFAULT,
+    [GTA_BYTECODE_PUSH_PC] = &&GTA_VM_TARGET_DEFAULT,
+    [GTA_BYTECODE_POP_BP] = &&GTA_VM_TARGET_DEFAULT,
+    [GTA_BYTECODE_POP_PC] = &&GTA_VM_TARGET_DEFAULT,
+    [GTA_BYTECODE_PEEK_GLOBAL] = &&GTA_VM_TARGET_GTA_BYTECODE_PEEK_GLOBAL,
+    [GTA_BYTECODE_POKE_GLOBAL] = &&GTA_VM_TARGET_GTA_BYTECODE_POKE_GLOBAL,
+    [GTA_BYTECODE_PEEK_LOCAL] = &&GTA_VM_TARGET_GTA_BYTECODE_PEEK_LOCAL,
+    [GTA_BYTECODE_POKE_LOCAL] = &&GTA_VM_TARGET_GTA_BYTECODE_POKE_LOCAL,
+    [GTA_BYTECODE_MARK_FP] = &&GTA_VM_TARGET_GTA_BYTECODE_MARK_FP,
+    [GTA_BYTECODE_PUSH_FP] = &&GTA_VM_TARGET_GTA_BYTECODE_PUSH_FP,
+    [GTA_BYTECODE_POP_FP] = &&GTA_VM_TARGET_GTA_BYTECODE_POP_FP,
+    [GTA_BYTECODE_LOAD] = &&GTA_VM_TARGET_GTA_BYTECODE_LOAD,
+    [GTA_BYTECODE_LOAD_LIBRARY] = &&GTA_VM_TARGET_GTA_BYTECODE_LOAD_LIBRARY,
+    [GTA_BYTECODE_NEGATIVE] = &&GTA_VM_TARGET_GTA_BYTECODE_NEGATIVE,
+    [GTA_BYTECODE_NOT] = &&GTA_VM_TARGET_GTA_BYTECODE_NOT,
+    [GTA_BYTECODE_ADD] = &&GTA_VM_TARGET_GTA_BYTECODE_ADD,
+    [GTA_BYTECODE_SUBTRACT] = &&GTA_VM_TARGET_GTA_BYTECODE_SUBTRACT,
+    [GTA_BYTECODE_MULTIPLY] = &&GTA_VM_TARGET_GTA_BYTECODE_MULTIPLY,
+    [GTA_BYTECODE_DIVIDE] = &&GTA_VM_TARGET_GTA_BYTECODE_DIVIDE,
+    [GTA_BYTECODE_MODULO] = &&GTA_VM_TARGET_GTA_BYTECODE_MODULO,
+    [GTA_BYTECODE_LESS_THAN] = &&GTA_VM_TARGET_GTA_BYTECODE_LESS_THAN,
+    [GTA_BYTECODE_LESS_THAN_EQUAL] = &&GTA_VM_TARGET_GTA_BYTECODE_LESS_THAN_EQUAL,
+    [GTA_BYTECODE_GREATER_THAN] = &&GTA_VM_TARGET_GTA_BYTECODE_GREATER_THAN,
+    [GTA_BYTECODE_GREATER_THAN_EQUAL] = &&GTA_VM_TARGET_GTA_BYTECODE_GREATER_THAN_EQUAL,
+    [GTA_BYTECODE_EQUAL] = &&GTA_VM_TARGET_GTA_BYTECODE_EQUAL,
+    [GTA_BYTECODE_NOT_EQUAL] = &&GTA_VM_TARGET_GTA_BYTECODE_NOT_EQUAL,
+    [GTA_BYTECODE_AND] = &&GTA_VM_TARGET_DEFAULT,
+    [GTA_BYTECODE_OR] = &&GTA_VM_TARGET_DEFAULT,
+    [GTA_BYTECODE_JMP] = &&GTA_VM_TARGET_GTA_BYTECODE_JMP,
+    [GTA_BYTECODE_JMPF] = &&GTA_VM_TARGET_GTA_BYTECODE_JMPF,
+    [GTA_BYTECODE_JMPT] = &&GTA_VM_TARGET_GTA_BYTECODE_JMPT,
+    [GTA_BYTECODE_PRINT] = &&GTA_VM_TARGET_GTA_BYTECODE_PRINT,
+    [GTA_BYTECODE_INDEX] = &&GTA_VM_TARGET_GTA_BYTECODE_INDEX,
+    [GTA_BYTECODE_PERIOD] = &&GTA_VM_TARGET_GTA_BYTECODE_PERIOD,
+    [GTA_BYTECODE_SLICE] = &&GTA_VM_TARGET_GTA_BYTECODE_SLICE,
+    [GTA_BYTECODE_ASSIGN_INDEX] = &&GTA_VM_TARGET_GTA_BYTECODE_ASSIGN_INDEX,
+    [GTA_BYTECODE_ITERATOR] = &&GTA_VM_TARGET_GTA_BYTECODE_ITERATOR,
+    [GTA_BYTECODE_ITERATOR_NEXT] = &&GTA_VM_TARGET_GTA_BYTECODE_ITERATOR_NEXT,
+    [GTA_BYTECODE_CALL] = &&GTA_VM_TARGET_GTA_BYTECODE_CALL,
+    [GTA_BYTECODE_ADD_INT_INT] = &&GTA_VM_TARGET_GTA_BYTECODE_ADD_INT_INT,
+    [GTA_BYTECODE_LESS_THAN_INT_INT] = &&GTA_VM_TARGET_GTA_BYTECODE_LESS_THAN_INT_INT,
+    [GTA_BYTECODE_JMPF_BOOLEAN] = &&GTA_VM_TARGET_GTA_BYTECODE_JMPF_BOOLEAN,
+    [GTA_BYTECODE_INC_LOCAL_IMM] = &&GTA_VM_TARGET_GTA_BYTECODE_INC_LOCAL_IMM,
+    [GTA_BYTECODE_CMP_LOCAL_IMM_JMPF] = &&GTA_VM_TARGET_GTA_BYTECODE_CMP_LOCAL_IMM_JMPF,
+    [GTA_BYTECODE_ITERATOR_LOCAL] = &&GTA_VM_TARGET_GTA_BYTECODE_ITERATOR_LOCAL,
+    [GTA_BYTECODE_ITERATOR_NEXT_LOCAL] = &&GTA_VM_TARGET_GTA_BYTECODE_ITERATOR_NEXT_LOCAL,
+    [GTA_BYTECODE_RANGE] = &&GTA_VM_TARGET_GTA_BYTECODE_RANGE,
+  };
+  _Static_assert(sizeof(dispatch_table) / sizeof(dispatch_table[0]) == GTA_BYTECODE_COUNT, "Every bytecode must have a dispatch table entry.");
+#endif // GTA_VIRTUAL_MACHINE_COMPUTED_GOTO
 
   // Execute the bytecode.
   while (next) {
     current = next++;
     switch (GTA_TYPEX_UI(*current)) {
-      case GTA_BYTECODE_RETURN: {
-        context->result = GTA_TYPEX_P(context->stack->data[*sp - 1]);
+      GTA_VM_CASE(GTA_BYTECODE_RETURN) {
+        // The returned value may be an immediate, which does not need to be
+        // boxed until it escapes the interpreter.
+        GTA_TypeX_Union result = context->stack->data[*sp - 1];
         // Restore the stack by setting the stack pointer to the frame pointer.
         *sp = context->fp;
         // Push the result onto the stack.
-        if (!GTA_VECTORX_APPEND(context->stack, GTA_TYPEX_MAKE_P(context->result))) {
+        if (!GTA_VECTORX_APPEND(context->stack, result)) {
           context->result = gta_computed_value_error_out_of_memory;
         }
 
@@ -53,48 +385,48 @@ bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
           : 0;
         break;
       }
-      case GTA_BYTECODE_NOP: {
-        break;
+      GTA_VM_CASE(GTA_BYTECODE_NOP) {
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_BOOLEAN: {
+      GTA_VM_CASE(GTA_BYTECODE_BOOLEAN) {
         // Use boolean singletons to avoid memory allocation.
         if (!GTA_VECTORX_APPEND(context->stack, GTA_TYPEX_MAKE_P(GTA_TYPEX_B(*(next++))
           ? gta_computed_value_boolean_true
           : gta_computed_value_boolean_false))) {
           context->result = gta_computed_value_error_out_of_memory;
         }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_FLOAT: {
-        GTA_Computed_Value_Float * float_value = gta_computed_value_float_create(GTA_TYPEX_F(*next), context);
-        if (!float_value || !GTA_VECTORX_APPEND(context->stack, GTA_TYPEX_MAKE_P(float_value))) {
+      GTA_VM_CASE(GTA_BYTECODE_FLOAT) {
+        // Most floats are pushed as immediates to avoid memory allocation.
+        if (!GTA_VECTORX_APPEND(context->stack, gta_virtual_machine_make_float(GTA_TYPEX_F(*next), context))) {
           context->result = gta_computed_value_error_out_of_memory;
         }
         ++next;
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_INTEGER: {
-        GTA_Computed_Value_Integer * integer = gta_computed_value_integer_create(GTA_TYPEX_I(*next), context);
-        if (!integer || !GTA_VECTORX_APPEND(context->stack, GTA_TYPEX_MAKE_P(integer))) {
+      GTA_VM_CASE(GTA_BYTECODE_INTEGER) {
+        // Small integers are pushed as immediates to avoid memory allocation.
+        if (!GTA_VECTORX_APPEND(context->stack, gta_virtual_machine_make_integer(GTA_TYPEX_I(*next), context))) {
           context->result = gta_computed_value_error_out_of_memory;
         }
         ++next;
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_NULL: {
+      GTA_VM_CASE(GTA_BYTECODE_NULL) {
         if (!GTA_VECTORX_APPEND(context->stack, GTA_TYPEX_MAKE_P(gta_computed_value_null))) {
           context->result = gta_computed_value_error_out_of_memory;
         }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_STRING: {
+      GTA_VM_CASE(GTA_BYTECODE_STRING) {
         GTA_Computed_Value_String * string = gta_computed_value_string_create(GTA_TYPEX_P(*next++), false, context);
         if (!string || !GTA_VECTORX_APPEND(context->stack, GTA_TYPEX_MAKE_P(string))) {
           context->result = gta_computed_value_error_out_of_memory;
         }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_ARRAY: {
+      GTA_VM_CASE(GTA_BYTECODE_ARRAY) {
         size_t count = GTA_TYPEX_UI(*next++);
         GTA_Computed_Value_Array * array = (GTA_Computed_Value_Array *)gta_computed_value_array_create(count, context);
         // Move the stack pointer back by the count of elements.
@@ -106,7 +438,8 @@ bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
         if (count) {
           // Copy the elements from the stack to the array.
           for (size_t i = 0; i < count; ++i) {
-            GTA_Computed_Value * element = GTA_TYPEX_P(context->stack->data[*sp + i]);
+            // The element is escaping into the array, so it must be boxed.
+            GTA_Computed_Value * element = gta_virtual_machine_box(&context->stack->data[*sp + i], context);
             if (element->is_temporary || element->is_singleton) {
               element->is_temporary = false;
               array->elements->data[i] = GTA_TYPEX_MAKE_P(element);
@@ -130,9 +463,9 @@ bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
             context->result = gta_computed_value_error_out_of_memory;
           }
         }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_MAP: {
+      GTA_VM_CASE(GTA_BYTECODE_MAP) {
         size_t count = GTA_TYPEX_UI(*next++);
         GTA_Computed_Value_Map * map = (GTA_Computed_Value_Map *)gta_computed_value_map_create(count, context);
         // Move the stack pointer back by the count of elements.
@@ -145,32 +478,22 @@ bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
           // Copy the elements from the stack to the map.
           for (size_t i = 0; i < count; ++i) {
             GTA_Computed_Value * key = GTA_TYPEX_P(context->stack->data[*sp + (i * 2)]);
-            GTA_Computed_Value * value = GTA_TYPEX_P(context->stack->data[*sp + (i * 2) + 1]);
-            GTA_Computed_Value_String * key_string = (GTA_Computed_Value_String *)key;
-            GTA_Integer key_hash = gcu_string_hash_64(key_string->value->buffer, key_string->value->byte_length);
-            if (key->is_temporary || key->is_singleton) {
-              key->is_temporary = false;
-              GTA_HASHX_SET(map->key_hash, key_hash, GTA_TYPEX_MAKE_P(key));
+            // The value is escaping into the map, so it must be boxed.
+            GTA_Computed_Value * value = gta_virtual_machine_box(&context->stack->data[*sp + (i * 2) + 1], context);
+            if (!key->is_temporary && !key->is_singleton) {
+              key = gta_computed_value_deep_copy(key, context);
             }
-            else {
-              GTA_Computed_Value * key_copy = gta_computed_value_deep_copy(key, context);
-              if (!key_copy) {
-                context->result = gta_computed_value_error_out_of_memory;
-                break;
-              }
-              GTA_HASHX_SET(map->key_hash, key_hash, GTA_TYPEX_MAKE_P(key));
+            if (key && !value->is_temporary && !value->is_singleton) {
+              value = gta_computed_value_deep_copy(value, context);
             }
-            if (value->is_temporary || value->is_singleton) {
-              value->is_temporary = false;
-              GTA_HASHX_SET(map->value_hash, key_hash, GTA_TYPEX_MAKE_P(value));
+            if (!key || !value) {
+              context->result = gta_computed_value_error_out_of_memory;
+              break;
             }
-            else {
-              GTA_Computed_Value * value_copy = gta_computed_value_deep_copy(value, context);
-              if (!value_copy) {
-                context->result = gta_computed_value_error_out_of_memory;
-                break;
-              }
-              GTA_HASHX_SET(map->value_hash, key_hash, GTA_TYPEX_MAKE_P(value_copy));
+            GTA_Computed_Value * stored = gta_computed_value_map_set_key_val(map, key, value);
+            if (stored != value) {
+              context->result = stored;
+              break;
             }
           }
           // Push the map onto the stack.  We know that there is already room
@@ -182,20 +505,29 @@ bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
             context->result = gta_computed_value_error_out_of_memory;
           }
         }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_CAST: {
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_cast(context->stack->data[*sp-1].p, (GTA_Computed_Value_VTable *)(*next++).p, context));
-        break;
+      GTA_VM_CASE(GTA_BYTECODE_CAST) {
+        GTA_Computed_Value * value = gta_virtual_machine_box(&context->stack->data[*sp-1], context);
+        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_cast(value, gta_bytecode_cast_types[GTA_TYPEX_UI(*next++)], context));
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_SET_NOT_TEMP: {
+      GTA_VM_CASE(GTA_BYTECODE_SET_NOT_TEMP) {
         // Set the top of the stack to not be temporary.
+        // Immediates are values, not objects, so there is nothing to do.
+        if (GTA_VM_IS_IMMEDIATE(context->stack->data[*sp-1])) {
+          GTA_VM_NEXT();
+        }
         GTA_Computed_Value * value = GTA_TYPEX_P(context->stack->data[*sp-1]);
         value->is_temporary = false;
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_ADOPT: {
+      GTA_VM_CASE(GTA_BYTECODE_ADOPT) {
         // Adopt the top of the stack.
+        // Immediates are values, not objects, so there is nothing to adopt.
+        if (GTA_VM_IS_IMMEDIATE(context->stack->data[*sp-1])) {
+          GTA_VM_NEXT();
+        }
         GTA_Computed_Value * value = GTA_TYPEX_P(context->stack->data[*sp-1]);
         if (value->is_temporary || value->is_singleton) {
           value->is_temporary = false;
@@ -204,74 +536,76 @@ bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
           GTA_Computed_Value * value_copy = gta_computed_value_deep_copy(value, context);
           if (!value_copy) {
             context->result = gta_computed_value_error_out_of_memory;
-            break;
+            GTA_VM_NEXT();
           }
           context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(value_copy);
         }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_POP: {
+      GTA_VM_CASE(GTA_BYTECODE_POP) {
         // Simply decrease the stack pointer.  The garbage collector will take
         // care of the rest.
         --*sp;
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_PEEK_GLOBAL: {
+      GTA_VM_CASE(GTA_BYTECODE_PEEK_GLOBAL) {
         // Push a value on the stack, indexed by the base pointer.
         size_t index = GTA_TYPEX_UI(*next++);
         if (!GTA_VECTORX_APPEND(context->stack, context->stack->data[index])) {
           context->result = gta_computed_value_error_out_of_memory;
         }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_POKE_GLOBAL: {
+      GTA_VM_CASE(GTA_BYTECODE_POKE_GLOBAL) {
         // Poke a value into the stack, indexed by the base pointer.
         size_t index = GTA_TYPEX_UI(*next++);
         context->stack->data[index] = context->stack->data[*sp-1];
-        GTA_Computed_Value * value = GTA_TYPEX_P(context->stack->data[index]);
-        value->is_temporary = false;
-        break;
+        if (!GTA_VM_IS_IMMEDIATE(context->stack->data[index])) {
+          GTA_Computed_Value * value = GTA_TYPEX_P(context->stack->data[index]);
+          value->is_temporary = false;
+        }
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_PEEK_LOCAL: {
+      GTA_VM_CASE(GTA_BYTECODE_PEEK_LOCAL) {
         // Push a value on the stack, indexed by the frame pointer.
         size_t index = GTA_TYPEX_UI(*next++);
         if (!GTA_VECTORX_APPEND(context->stack, context->stack->data[context->fp + index])) {
           context->result = gta_computed_value_error_out_of_memory;
         }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_POKE_LOCAL: {
+      GTA_VM_CASE(GTA_BYTECODE_POKE_LOCAL) {
         // Poke a value into the stack, indexed by the frame pointer.
         size_t index = GTA_TYPEX_UI(*next++);
         context->stack->data[context->fp + index] = context->stack->data[*sp-1];
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_MARK_FP: {
+      GTA_VM_CASE(GTA_BYTECODE_MARK_FP) {
         // Mark the current stack pointer as the frame pointer.
         context->fp = *sp;
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_PUSH_FP: {
+      GTA_VM_CASE(GTA_BYTECODE_PUSH_FP) {
         // Push the frame pointer onto the stack.
         if (!GTA_VECTORX_APPEND(context->stack, GTA_TYPEX_MAKE_UI(context->fp))) {
           context->result = gta_computed_value_error_out_of_memory;
         }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_POP_FP: {
+      GTA_VM_CASE(GTA_BYTECODE_POP_FP) {
         // Pop the frame pointer from the stack.
         context->fp = GTA_TYPEX_UI(context->stack->data[--*sp]);
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_LOAD: {
-        // Load a value.
+      GTA_VM_CASE(GTA_BYTECODE_LOAD) {
+        // Load a value from the constants of the program.
         // The value will be left on the stack.
-        if (!GTA_VECTORX_APPEND(context->stack, *next++)) {
+        if (!GTA_VECTORX_APPEND(context->stack, constants[GTA_TYPEX_UI(*next++)])) {
           context->result = gta_computed_value_error_out_of_memory;
         }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_LOAD_LIBRARY: {
+      GTA_VM_CASE(GTA_BYTECODE_LOAD_LIBRARY) {
         // Load a library value.
         // The value will be left on the stack.
         GTA_Library_Callback func = gta_library_get_from_context(context, GTA_TYPEX_UI(*next++));
@@ -288,134 +622,393 @@ bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
         if (!GTA_VECTORX_APPEND(context->stack, GTA_TYPEX_MAKE_P(library_value))) {
           context->result = gta_computed_value_error_out_of_memory;
         }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_NEGATIVE: {
+      GTA_VM_CASE(GTA_BYTECODE_NEGATIVE) {
         // Perform a negation.
         // The value will be left on the stack.
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(context->stack->data[*sp-1])) {
+          context->stack->data[*sp-1] = gta_virtual_machine_make_integer(-GTA_VM_IMMEDIATE_INTEGER_VALUE(context->stack->data[*sp-1]), context);
+          GTA_VM_NEXT();
+        }
+        if (GTA_VM_IS_IMMEDIATE_FLOAT(context->stack->data[*sp-1])) {
+          context->stack->data[*sp-1] = gta_virtual_machine_make_float(-GTA_VM_IMMEDIATE_FLOAT_VALUE(context->stack->data[*sp-1]), context);
+          GTA_VM_NEXT();
+        }
         context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_negative(context->stack->data[*sp-1].p, false, context));
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_NOT: {
+      GTA_VM_CASE(GTA_BYTECODE_NOT) {
         // Perform a logical not.
         // The value will be left on the stack.
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(((GTA_Computed_Value *)context->stack->data[*sp-1].p)->is_true
+        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_virtual_machine_is_true(context->stack->data[*sp-1])
           ? gta_computed_value_boolean_false
           : gta_computed_value_boolean_true);
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_ADD: {
+      GTA_VM_CASE(GTA_BYTECODE_ADD_INT_INT) {
+        // Perform an addition of two integers.
+        // The value will be left on the stack.
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[*sp-1];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-2];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          --*sp;
+          // Immediates use one fewer bit than GTA_Integer, so this cannot
+          // overflow.
+          *lhs_slot = gta_virtual_machine_make_integer(GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot) + GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot), context);
+          GTA_VM_NEXT();
+        }
+        // An operand is a boxed integer, so use the generic implementation.
+        GTA_FALLTHROUGH;
+      }
+      GTA_VM_CASE(GTA_BYTECODE_ADD) {
         // Perform an addition.
         // The value will be left on the stack.
-        GTA_Computed_Value * rhs = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * lhs = GTA_TYPEX_P(context->stack->data[*sp-1]);
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_add(lhs, rhs, true, false, context));
-        break;
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[--*sp];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-1];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          // Immediates use one fewer bit than GTA_Integer, so this cannot
+          // overflow.
+          GTA_Integer lhs = GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot);
+          GTA_Integer rhs = GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot);
+          *lhs_slot = gta_virtual_machine_make_integer(lhs + rhs, context);
+          GTA_VM_NEXT();
+        }
+        if (GTA_VM_ARE_IMMEDIATE_FLOAT_OPERANDS(*lhs_slot, *rhs_slot)) {
+          *lhs_slot = gta_virtual_machine_make_float(gta_virtual_machine_float_value(*lhs_slot) + gta_virtual_machine_float_value(*rhs_slot), context);
+          GTA_VM_NEXT();
+        }
+        GTA_Computed_Value * rhs = gta_virtual_machine_box(rhs_slot, context);
+        GTA_Computed_Value * lhs = gta_virtual_machine_box(lhs_slot, context);
+        *lhs_slot = GTA_TYPEX_MAKE_P(gta_computed_value_add(lhs, rhs, true, false, context));
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_SUBTRACT: {
+      GTA_VM_CASE(GTA_BYTECODE_SUBTRACT) {
         // Perform a subtraction.
         // The value will be left on the stack.
-        GTA_Computed_Value * rhs = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * lhs = GTA_TYPEX_P(context->stack->data[*sp-1]);
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_subtract(lhs, rhs, true, false, context));
-        break;
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[--*sp];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-1];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          // Immediates use one fewer bit than GTA_Integer, so this cannot
+          // overflow.
+          GTA_Integer lhs = GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot);
+          GTA_Integer rhs = GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot);
+          *lhs_slot = gta_virtual_machine_make_integer(lhs - rhs, context);
+          GTA_VM_NEXT();
+        }
+        if (GTA_VM_ARE_IMMEDIATE_FLOAT_OPERANDS(*lhs_slot, *rhs_slot)) {
+          *lhs_slot = gta_virtual_machine_make_float(gta_virtual_machine_float_value(*lhs_slot) - gta_virtual_machine_float_value(*rhs_slot), context);
+          GTA_VM_NEXT();
+        }
+        GTA_Computed_Value * rhs = gta_virtual_machine_box(rhs_slot, context);
+        GTA_Computed_Value * lhs = gta_virtual_machine_box(lhs_slot, context);
+        *lhs_slot = GTA_TYPEX_MAKE_P(gta_computed_value_subtract(lhs, rhs, true, false, context));
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_MULTIPLY: {
+      GTA_VM_CASE(GTA_BYTECODE_MULTIPLY) {
         // Perform a multiplication.
         // The value will be left on the stack.
-        GTA_Computed_Value * rhs = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * lhs = GTA_TYPEX_P(context->stack->data[*sp-1]);
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_multiply(lhs, rhs, true, false, context));
-        break;
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[--*sp];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-1];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          GTA_Integer lhs = GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot);
+          GTA_Integer rhs = GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot);
+          // Larger operands might overflow, so use the generic implementation.
+          if ((lhs < GTA_VM_IMMEDIATE_MULTIPLY_LIMIT) && (lhs > -GTA_VM_IMMEDIATE_MULTIPLY_LIMIT) && (rhs < GTA_VM_IMMEDIATE_MULTIPLY_LIMIT) && (rhs > -GTA_VM_IMMEDIATE_MULTIPLY_LIMIT)) {
+            *lhs_slot = gta_virtual_machine_make_integer(lhs * rhs, context);
+            GTA_VM_NEXT();
+          }
+        }
+        if (GTA_VM_ARE_IMMEDIATE_FLOAT_OPERANDS(*lhs_slot, *rhs_slot)) {
+          *lhs_slot = gta_virtual_machine_make_float(gta_virtual_machine_float_value(*lhs_slot) * gta_virtual_machine_float_value(*rhs_slot), context);
+          GTA_VM_NEXT();
+        }
+        GTA_Computed_Value * rhs = gta_virtual_machine_box(rhs_slot, context);
+        GTA_Computed_Value * lhs = gta_virtual_machine_box(lhs_slot, context);
+        *lhs_slot = GTA_TYPEX_MAKE_P(gta_computed_value_multiply(lhs, rhs, true, false, context));
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_DIVIDE: {
+      GTA_VM_CASE(GTA_BYTECODE_DIVIDE) {
         // Perform a division.
         // The value will be left on the stack.
-        GTA_Computed_Value * rhs = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * lhs = GTA_TYPEX_P(context->stack->data[*sp-1]);
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_divide(lhs, rhs, true, false, context));
-        break;
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[--*sp];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-1];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          GTA_Integer lhs = GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot);
+          GTA_Integer rhs = GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot);
+          // Division by zero is reported by the generic implementation.
+          if (rhs) {
+            *lhs_slot = gta_virtual_machine_make_integer(lhs / rhs, context);
+            GTA_VM_NEXT();
+          }
+        }
+        if (GTA_VM_ARE_IMMEDIATE_FLOAT_OPERANDS(*lhs_slot, *rhs_slot)) {
+          GTA_Float lhs = gta_virtual_machine_float_value(*lhs_slot);
+          GTA_Float rhs = gta_virtual_machine_float_value(*rhs_slot);
+          // Division by zero is reported by the generic implementation.
+          if (rhs != 0) {
+            *lhs_slot = gta_virtual_machine_make_float(lhs / rhs, context);
+            GTA_VM_NEXT();
+          }
+        }
+        GTA_Computed_Value * rhs = gta_virtual_machine_box(rhs_slot, context);
+        GTA_Computed_Value * lhs = gta_virtual_machine_box(lhs_slot, context);
+        *lhs_slot = GTA_TYPEX_MAKE_P(gta_computed_value_divide(lhs, rhs, true, false, context));
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_MODULO: {
+      GTA_VM_CASE(GTA_BYTECODE_MODULO) {
         // Perform a modulo.
         // The value will be left on the stack.
-        GTA_Computed_Value * rhs = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * lhs = GTA_TYPEX_P(context->stack->data[*sp-1]);
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_modulo(lhs, rhs, true, false, context));
-        break;
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[--*sp];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-1];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          GTA_Integer lhs = GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot);
+          GTA_Integer rhs = GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot);
+          // Division by zero is reported by the generic implementation.
+          if (rhs) {
+            *lhs_slot = gta_virtual_machine_make_integer(lhs % rhs, context);
+            GTA_VM_NEXT();
+          }
+        }
+        GTA_Computed_Value * rhs = gta_virtual_machine_box(rhs_slot, context);
+        GTA_Computed_Value * lhs = gta_virtual_machine_box(lhs_slot, context);
+        *lhs_slot = GTA_TYPEX_MAKE_P(gta_computed_value_modulo(lhs, rhs, true, false, context));
+        GTA_VM_NEXT();
+      }
+      GTA_VM_CASE(GTA_BYTECODE_LESS_THAN_INT_INT) {
+        // Perform a less than comparison of two integers.
+        // The value will be left on the stack.
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[*sp-1];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-2];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          --*sp;
+          *lhs_slot = GTA_TYPEX_MAKE_P(GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot) < GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        // An operand is a boxed integer, so use the generic implementation.
+        GTA_FALLTHROUGH;
       }
-      case GTA_BYTECODE_LESS_THAN: {
+      GTA_VM_CASE(GTA_BYTECODE_LESS_THAN) {
         // Perform a less than comparison.
         // The value will be left on the stack.
-        GTA_Computed_Value * rhs = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * lhs = GTA_TYPEX_P(context->stack->data[*sp-1]);
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_less_than(lhs, rhs, true, context));
-        break;
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[--*sp];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-1];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          *lhs_slot = GTA_TYPEX_MAKE_P(GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot) < GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        if (GTA_VM_ARE_IMMEDIATE_FLOAT_OPERANDS(*lhs_slot, *rhs_slot)) {
+          *lhs_slot = GTA_TYPEX_MAKE_P(gta_virtual_machine_float_value(*lhs_slot) < gta_virtual_machine_float_value(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        GTA_Computed_Value * rhs = gta_virtual_machine_box(rhs_slot, context);
+        GTA_Computed_Value * lhs = gta_virtual_machine_box(lhs_slot, context);
+        *lhs_slot = GTA_TYPEX_MAKE_P(gta_computed_value_less_than(lhs, rhs, true, context));
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_LESS_THAN_EQUAL: {
+      GTA_VM_CASE(GTA_BYTECODE_LESS_THAN_EQUAL) {
         // Perform a less than or equal comparison.
         // The value will be left on the stack.
-        GTA_Computed_Value * rhs = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * lhs = GTA_TYPEX_P(context->stack->data[*sp-1]);
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_less_than_equal(lhs, rhs, true, context));
-        break;
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[--*sp];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-1];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          *lhs_slot = GTA_TYPEX_MAKE_P(GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot) <= GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        if (GTA_VM_ARE_IMMEDIATE_FLOAT_OPERANDS(*lhs_slot, *rhs_slot)) {
+          *lhs_slot = GTA_TYPEX_MAKE_P(gta_virtual_machine_float_value(*lhs_slot) <= gta_virtual_machine_float_value(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        GTA_Computed_Value * rhs = gta_virtual_machine_box(rhs_slot, context);
+        GTA_Computed_Value * lhs = gta_virtual_machine_box(lhs_slot, context);
+        *lhs_slot = GTA_TYPEX_MAKE_P(gta_computed_value_less_than_equal(lhs, rhs, true, context));
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_GREATER_THAN: {
+      GTA_VM_CASE(GTA_BYTECODE_GREATER_THAN) {
         // Perform a greater than comparison.
         // The value will be left on the stack.
-        GTA_Computed_Value * rhs = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * lhs = GTA_TYPEX_P(context->stack->data[*sp-1]);
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_greater_than(lhs, rhs, true, context));
-        break;
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[--*sp];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-1];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          *lhs_slot = GTA_TYPEX_MAKE_P(GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot) > GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        if (GTA_VM_ARE_IMMEDIATE_FLOAT_OPERANDS(*lhs_slot, *rhs_slot)) {
+          *lhs_slot = GTA_TYPEX_MAKE_P(gta_virtual_machine_float_value(*lhs_slot) > gta_virtual_machine_float_value(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        GTA_Computed_Value * rhs = gta_virtual_machine_box(rhs_slot, context);
+        GTA_Computed_Value * lhs = gta_virtual_machine_box(lhs_slot, context);
+        *lhs_slot = GTA_TYPEX_MAKE_P(gta_computed_value_greater_than(lhs, rhs, true, context));
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_GREATER_THAN_EQUAL: {
+      GTA_VM_CASE(GTA_BYTECODE_GREATER_THAN_EQUAL) {
         // Perform a greater than or equal comparison.
         // The value will be left on the stack.
-        GTA_Computed_Value * rhs = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * lhs = GTA_TYPEX_P(context->stack->data[*sp-1]);
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_greater_than_equal(lhs, rhs, true, context));
-        break;
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[--*sp];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-1];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          *lhs_slot = GTA_TYPEX_MAKE_P(GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot) >= GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        if (GTA_VM_ARE_IMMEDIATE_FLOAT_OPERANDS(*lhs_slot, *rhs_slot)) {
+          *lhs_slot = GTA_TYPEX_MAKE_P(gta_virtual_machine_float_value(*lhs_slot) >= gta_virtual_machine_float_value(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        GTA_Computed_Value * rhs = gta_virtual_machine_box(rhs_slot, context);
+        GTA_Computed_Value * lhs = gta_virtual_machine_box(lhs_slot, context);
+        *lhs_slot = GTA_TYPEX_MAKE_P(gta_computed_value_greater_than_equal(lhs, rhs, true, context));
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_EQUAL: {
+      GTA_VM_CASE(GTA_BYTECODE_EQUAL) {
         // Perform an equality comparison.
         // The value will be left on the stack.
-        GTA_Computed_Value * rhs = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * lhs = GTA_TYPEX_P(context->stack->data[*sp-1]);
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_equal(lhs, rhs, true, context));
-        break;
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[--*sp];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-1];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          *lhs_slot = GTA_TYPEX_MAKE_P(GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot) == GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        if (GTA_VM_ARE_IMMEDIATE_FLOAT_OPERANDS(*lhs_slot, *rhs_slot)) {
+          *lhs_slot = GTA_TYPEX_MAKE_P(gta_virtual_machine_float_value(*lhs_slot) == gta_virtual_machine_float_value(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        GTA_Computed_Value * rhs = gta_virtual_machine_box(rhs_slot, context);
+        GTA_Computed_Value * lhs = gta_virtual_machine_box(lhs_slot, context);
+        *lhs_slot = GTA_TYPEX_MAKE_P(gta_computed_value_equal(lhs, rhs, true, context));
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_NOT_EQUAL: {
+      GTA_VM_CASE(GTA_BYTECODE_NOT_EQUAL) {
         // Perform an inequality comparison.
         // The value will be left on the stack.
-        GTA_Computed_Value * rhs = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * lhs = GTA_TYPEX_P(context->stack->data[*sp-1]);
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_not_equal(lhs, rhs, true, context));
-        break;
+        GTA_TypeX_Union * rhs_slot = &context->stack->data[--*sp];
+        GTA_TypeX_Union * lhs_slot = &context->stack->data[*sp-1];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*lhs_slot) && GTA_VM_IS_IMMEDIATE_INTEGER(*rhs_slot)) {
+          *lhs_slot = GTA_TYPEX_MAKE_P(GTA_VM_IMMEDIATE_INTEGER_VALUE(*lhs_slot) != GTA_VM_IMMEDIATE_INTEGER_VALUE(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        if (GTA_VM_ARE_IMMEDIATE_FLOAT_OPERANDS(*lhs_slot, *rhs_slot)) {
+          *lhs_slot = GTA_TYPEX_MAKE_P(gta_virtual_machine_float_value(*lhs_slot) != gta_virtual_machine_float_value(*rhs_slot)
+            ? gta_computed_value_boolean_true
+            : gta_computed_value_boolean_false);
+          GTA_VM_NEXT();
+        }
+        GTA_Computed_Value * rhs = gta_virtual_machine_box(rhs_slot, context);
+        GTA_Computed_Value * lhs = gta_virtual_machine_box(lhs_slot, context);
+        *lhs_slot = GTA_TYPEX_MAKE_P(gta_computed_value_not_equal(lhs, rhs, true, context));
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_JMP: {
+      GTA_VM_CASE(GTA_BYTECODE_JMP) {
+        // A backwards jump is a loop back-edge.
+        if ((GTA_TYPEX_I(*next) < 0) && (aborted = gta_virtual_machine_safepoint(context))) {
+          goto EXECUTION_ABORTED;
+        }
         // Jump to the specified address.
         next += GTA_TYPEX_I(*next) + 1;
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_JMPF: {
+      GTA_VM_CASE(GTA_BYTECODE_JMPF_BOOLEAN) {
         // Jump to the specified address if the top of the stack is false.
         // The value will be left on the stack.
-        next += ((GTA_Computed_Value *)context->stack->data[*sp-1].p)->is_true
+        // The compiler has proven that the condition is a boolean (or an
+        // error, which is false), and booleans are always singletons.
+        if ((GTA_TYPEX_I(*next) < 0) && (aborted = gta_virtual_machine_safepoint(context))) {
+          goto EXECUTION_ABORTED;
+        }
+        next += (GTA_TYPEX_P(context->stack->data[*sp-1]) == gta_computed_value_boolean_true)
           ? 1
           : GTA_TYPEX_I(*next) + 1;
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_JMPT: {
+      GTA_VM_CASE(GTA_BYTECODE_JMPF) {
+        // Jump to the specified address if the top of the stack is false.
+        // The value will be left on the stack.
+        if ((GTA_TYPEX_I(*next) < 0) && (aborted = gta_virtual_machine_safepoint(context))) {
+          goto EXECUTION_ABORTED;
+        }
+        next += gta_virtual_machine_is_true(context->stack->data[*sp-1])
+          ? 1
+          : GTA_TYPEX_I(*next) + 1;
+        GTA_VM_NEXT();
+      }
+      GTA_VM_CASE(GTA_BYTECODE_JMPT) {
         // Jump to the specified address if the top of the stack is true.
         // The value will be left on the stack.
-        next += ((GTA_Computed_Value *)context->stack->data[*sp-1].p)->is_true
+        if ((GTA_TYPEX_I(*next) < 0) && (aborted = gta_virtual_machine_safepoint(context))) {
+          goto EXECUTION_ABORTED;
+        }
+        next += gta_virtual_machine_is_true(context->stack->data[*sp-1])
           ? GTA_TYPEX_I(*next) + 1
           : 1;
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_PRINT: {
+      GTA_VM_CASE(GTA_BYTECODE_INC_LOCAL_IMM) {
+        // Add an integer to a local variable, in place.
+        // Nothing is left on the stack.
+        GTA_TypeX_Union * slot = &context->stack->data[context->fp + GTA_TYPEX_UI(*next++)];
+        GTA_Integer increment = GTA_TYPEX_I(*next++);
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*slot)) {
+          // The optimizer only fuses increments which fit in an immediate, so
+          // this cannot overflow.
+          *slot = gta_virtual_machine_make_integer(GTA_VM_IMMEDIATE_INTEGER_VALUE(*slot) + increment, context);
+          GTA_VM_NEXT();
+        }
+        if (GTA_VM_IS_IMMEDIATE_FLOAT(*slot)) {
+          *slot = gta_virtual_machine_make_float(GTA_VM_IMMEDIATE_FLOAT_VALUE(*slot) + (GTA_Float)increment, context);
+          GTA_VM_NEXT();
+        }
+        GTA_TypeX_Union rhs_slot = GTA_VM_MAKE_IMMEDIATE_INTEGER(increment);
+        GTA_Computed_Value * rhs = gta_virtual_machine_box(&rhs_slot, context);
+        GTA_Computed_Value * lhs = gta_virtual_machine_box(slot, context);
+        *slot = GTA_TYPEX_MAKE_P(gta_computed_value_add(lhs, rhs, true, false, context));
+        GTA_VM_NEXT();
+      }
+      GTA_VM_CASE(GTA_BYTECODE_CMP_LOCAL_IMM_JMPF) {
+        // Compare a local variable to an integer, and jump to the specified
+        // address if the result is false.
+        // The result will be left on the stack.
+        GTA_TypeX_Union lhs_slot = context->stack->data[context->fp + GTA_TYPEX_UI(*next++)];
+        GTA_UInteger comparison = GTA_TYPEX_UI(*next++);
+        GTA_TypeX_Union rhs_slot = GTA_VM_MAKE_IMMEDIATE_INTEGER(GTA_TYPEX_I(*next++));
+        GTA_TypeX_Union result = gta_virtual_machine_compare(comparison, &lhs_slot, &rhs_slot, context);
+        if (!GTA_VECTORX_APPEND(context->stack, result)) {
+          context->result = gta_computed_value_error_out_of_memory;
+        }
+        if ((GTA_TYPEX_I(*next) < 0) && (aborted = gta_virtual_machine_safepoint(context))) {
+          goto EXECUTION_ABORTED;
+        }
+        next += gta_virtual_machine_is_true(result)
+          ? 1
+          : GTA_TYPEX_I(*next) + 1;
+        GTA_VM_NEXT();
+      }
+      GTA_VM_CASE(GTA_BYTECODE_PRINT) {
         // Print the top of the stack.
-        GTA_Computed_Value * value = GTA_TYPEX_P(context->stack->data[*sp-1]);
+        GTA_Computed_Value * value = gta_virtual_machine_box(&context->stack->data[*sp-1], context);
         // Assume this will succeed (most common case).
         context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_null);
         // Get the "printed" value.
@@ -427,87 +1020,70 @@ bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
             || (value->vtable->print == gta_computed_value_print_not_supported))) {
             // The print function was actually implemented, so it must have failed.
             context->result = gta_computed_value_error_out_of_memory;
-            break;
+            GTA_VM_NEXT();
           }
           // The print function was not implemented.  Do nothing.
-          break;
+          GTA_VM_NEXT();
         }
 
-        if (!(context->program->flags & GTA_PROGRAM_FLAG_PRINT_TO_STDOUT)) {
-          // Concatenate the string with the output.
-          if (context->output->byte_length == 0) {
-            // This is the first string to be printed, so we can just adopt it.
-            gta_unicode_string_destroy(context->output);
-            context->output = string;
-            break;
-          }
-          GTA_Unicode_String * new_string = gta_unicode_string_concat(context->output, string);
-          gta_unicode_string_destroy(string);
-          if (!new_string) {
-            // If it failed, it is because we ran out of memory.
-            context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_error_out_of_memory);
-          }
-          else {
-            // No failures, so adopt the new string.
-            gta_unicode_string_destroy(context->output);
-            context->output = new_string;
-          }
+        // Append the string to the output (the string is adopted).
+        GTA_Computed_Value * error = gta_execution_context_output_append(context, string);
+        if (error) {
+          context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(error);
         }
-        else {
-          // The string is already printed, so destroy it.
-          gta_unicode_string_destroy(string);
-        }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_INDEX: {
+      GTA_VM_CASE(GTA_BYTECODE_INDEX) {
         // Perform an index operation.
         // The value will be left on the stack.
-        GTA_Computed_Value * index = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * collection = GTA_TYPEX_P(context->stack->data[*sp-1]);
+        GTA_Computed_Value * index = gta_virtual_machine_box(&context->stack->data[--*sp], context);
+        GTA_Computed_Value * collection = gta_virtual_machine_box(&context->stack->data[*sp-1], context);
         context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_index(collection, index, context));
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_PERIOD: {
+      GTA_VM_CASE(GTA_BYTECODE_PERIOD) {
         // Perform a period operation.
         // The value will be left on the stack.
-        GTA_UInteger attribute_hash = GTA_TYPEX_UI(*next++);
-        GTA_Computed_Value * object = GTA_TYPEX_P(context->stack->data[*sp-1]);
-        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_period(object, attribute_hash, context));
-        ++next;
-        break;
+        // The attribute hash is also held by the inline cache, so only the
+        // index of the cache is needed.
+        GTA_Inline_Cache * cache = GTA_TYPEX_P(constants[GTA_TYPEX_UI(*(next + 1))]);
+        GTA_Computed_Value * object = gta_virtual_machine_box(&context->stack->data[*sp-1], context);
+        context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_inline_cache_period(object, cache, context));
+        next += 2;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_SLICE: {
+      GTA_VM_CASE(GTA_BYTECODE_SLICE) {
         // Perform a slice operation.
         // The value will be left on the stack.
-        GTA_Computed_Value * step = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * end = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * start = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * collection = GTA_TYPEX_P(context->stack->data[*sp-1]);
+        GTA_Computed_Value * step = gta_virtual_machine_box(&context->stack->data[--*sp], context);
+        GTA_Computed_Value * end = gta_virtual_machine_box(&context->stack->data[--*sp], context);
+        GTA_Computed_Value * start = gta_virtual_machine_box(&context->stack->data[--*sp], context);
+        GTA_Computed_Value * collection = gta_virtual_machine_box(&context->stack->data[*sp-1], context);
         context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_slice(collection, start, end, step, context));
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_ASSIGN_INDEX: {
+      GTA_VM_CASE(GTA_BYTECODE_ASSIGN_INDEX) {
         // Perform an index assignment.
         // The value will be left on the stack.
-        GTA_Computed_Value * value = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * index = GTA_TYPEX_P(context->stack->data[--*sp]);
-        GTA_Computed_Value * collection = GTA_TYPEX_P(context->stack->data[*sp-1]);
+        GTA_Computed_Value * value = gta_virtual_machine_box(&context->stack->data[--*sp], context);
+        GTA_Computed_Value * index = gta_virtual_machine_box(&context->stack->data[--*sp], context);
+        GTA_Computed_Value * collection = gta_virtual_machine_box(&context->stack->data[*sp-1], context);
         context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_assign_index(collection, index, value, context));
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_ITERATOR: {
+      GTA_VM_CASE(GTA_BYTECODE_ITERATOR) {
         // Perform an iterator operation.
         // The value will be left on the stack.
-        GTA_Computed_Value * collection = GTA_TYPEX_P(context->stack->data[*sp-1]);
+        GTA_Computed_Value * collection = gta_virtual_machine_box(&context->stack->data[*sp-1], context);
         context->stack->data[*sp-1] = GTA_TYPEX_MAKE_P(gta_computed_value_iterator_get(collection, context));
         if (!GTA_VECTORX_APPEND(context->stack, (GTA_TYPEX_MAKE_P(GTA_COMPUTED_VALUE_IS_ITERATOR(context->stack->data[*sp-1].p)
           ? gta_computed_value_boolean_true
           : gta_computed_value_boolean_false)))) {
           context->result = gta_computed_value_error_out_of_memory;
         }
-        break;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_ITERATOR_NEXT: {
+      GTA_VM_CASE(GTA_BYTECODE_ITERATOR_NEXT) {
         // Perform an iterator next operation.
         // The value will be left on the stack.
         GTA_Computed_Value * iterator = GTA_TYPEX_P(context->stack->data[*sp-1]);
@@ -517,16 +1093,117 @@ bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
           : gta_computed_value_boolean_false)))) {
           context->result = gta_computed_value_error_out_of_memory;
         }
-        break;
+        GTA_VM_NEXT();
+      }
+      GTA_VM_CASE(GTA_BYTECODE_ITERATOR_LOCAL) {
+        // Pop a collection and prepare to iterate over it.
+        // An array or a range is iterated directly, by position, so no
+        // iterator is created for it.  If the collection cannot be iterated,
+        // then the error is stored in place of the iterator.
+        // Nothing is left on the stack.
+        size_t iterator_index = context->fp + GTA_TYPEX_UI(*next++);
+        size_t index_index = context->fp + GTA_TYPEX_UI(*next++);
+        GTA_Computed_Value * collection = gta_virtual_machine_box(&context->stack->data[*sp-1], context);
+        --*sp;
+        context->stack->data[iterator_index] = GTA_TYPEX_MAKE_P((GTA_COMPUTED_VALUE_IS_ARRAY(collection) || GTA_COMPUTED_VALUE_IS_RANGE(collection))
+          ? collection
+          : gta_computed_value_iterator_get(collection, context));
+        context->stack->data[index_index] = GTA_VM_MAKE_IMMEDIATE_INTEGER(0);
+        GTA_VM_NEXT();
+      }
+      GTA_VM_CASE(GTA_BYTECODE_ITERATOR_NEXT_LOCAL) {
+        // Push the next value of the collection being iterated over.  If there
+        // is none, push the reason (usually the end of the iterator) and jump
+        // to the specified address.
+        GTA_Computed_Value * collection = GTA_TYPEX_P(context->stack->data[context->fp + GTA_TYPEX_UI(*next++)]);
+        GTA_TypeX_Union * index_slot = &context->stack->data[context->fp + GTA_TYPEX_UI(*next++)];
+        GTA_TypeX_Union value = GTA_TYPEX_MAKE_P(gta_computed_value_error_iterator_end);
+        bool has_value = false;
+        if (GTA_COMPUTED_VALUE_IS_ARRAY(collection)) {
+          // The elements are read afresh each time, because the block may
+          // change the array.
+          GTA_VectorX * elements = ((GTA_Computed_Value_Array *)collection)->elements;
+          GTA_Integer index = GTA_VM_IMMEDIATE_INTEGER_VALUE(*index_slot);
+          if (index < (GTA_Integer)elements->count) {
+            has_value = true;
+            *index_slot = GTA_VM_MAKE_IMMEDIATE_INTEGER(index + 1);
+            value = elements->data[index];
+            // A numeric element is given to the loop as an immediate, so
+            // that adopting it does not copy it.
+            GTA_Computed_Value * element = GTA_TYPEX_P(value);
+            if (GTA_COMPUTED_VALUE_IS_INTEGER(element)
+              && GTA_VM_IMMEDIATE_INTEGER_FITS(((GTA_Computed_Value_Integer *)element)->value)) {
+              value = GTA_VM_MAKE_IMMEDIATE_INTEGER(((GTA_Computed_Value_Integer *)element)->value);
+            }
+            else if (GTA_COMPUTED_VALUE_IS_FLOAT(element)
+              && GTA_VM_IMMEDIATE_FLOAT_FITS(((GTA_Computed_Value_Float *)element)->value)) {
+              value = GTA_VM_MAKE_IMMEDIATE_FLOAT(((GTA_Computed_Value_Float *)element)->value);
+            }
+          }
+        }
+        else if (GTA_COMPUTED_VALUE_IS_RANGE(collection)) {
+          // The index counts up from 0, and the length of the range is
+          // computed unsigned, so neither can overflow.
+          GTA_Computed_Value_Range * range = (GTA_Computed_Value_Range *)collection;
+          GTA_Integer index = GTA_VM_IMMEDIATE_INTEGER_VALUE(*index_slot);
+          if ((range->end > range->start)
+            && ((GTA_UInteger)index < (GTA_UInteger)range->end - (GTA_UInteger)range->start)) {
+            has_value = true;
+            *index_slot = GTA_VM_MAKE_IMMEDIATE_INTEGER(index + 1);
+            value = gta_virtual_machine_make_integer(range->start + index, context);
+          }
+        }
+        else if (GTA_COMPUTED_VALUE_IS_ITERATOR(collection)) {
+          value = GTA_TYPEX_MAKE_P(gta_computed_value_iterator_next(collection, context));
+          has_value = (GTA_TYPEX_P(value) != gta_computed_value_error_iterator_end);
+        }
+        else {
+          // The collection could not be iterated over.
+          value = GTA_TYPEX_MAKE_P(collection);
+        }
+        if (!GTA_VECTORX_APPEND(context->stack, value)) {
+          context->result = gta_computed_value_error_out_of_memory;
+        }
+        next += has_value
+          ? 1
+          : GTA_TYPEX_I(*next) + 1;
+        GTA_VM_NEXT();
       }
-      case GTA_BYTECODE_CALL: {
+      GTA_VM_CASE(GTA_BYTECODE_RANGE) {
+        // Create a range from the two integers on the stack.
+        // The value will be left on the stack.
+        GTA_TypeX_Union * end = &context->stack->data[--*sp];
+        GTA_TypeX_Union * start = &context->stack->data[*sp-1];
+        if (GTA_VM_IS_IMMEDIATE_INTEGER(*start) && GTA_VM_IS_IMMEDIATE_INTEGER(*end)) {
+          // Immediate bounds do not need to be boxed first.
+          GTA_Computed_Value * range = (GTA_Computed_Value *)gta_computed_value_range_create(GTA_VM_IMMEDIATE_INTEGER_VALUE(*start), GTA_VM_IMMEDIATE_INTEGER_VALUE(*end), context);
+          *start = GTA_TYPEX_MAKE_P(range
+            ? range
+            : gta_computed_value_error_out_of_memory);
+          GTA_VM_NEXT();
+        }
+        GTA_Computed_Value * end_value = gta_virtual_machine_box(end, context);
+        GTA_Computed_Value * start_value = gta_virtual_machine_box(start, context);
+        *start = GTA_TYPEX_MAKE_P(gta_computed_value_range_create_from_values(start_value, end_value, context));
+        GTA_VM_NEXT();
+      }
+      GTA_VM_CASE(GTA_BYTECODE_CALL) {
+        // The function and its arguments are still on the stack.
+        if ((aborted = gta_virtual_machine_safepoint(context))) {
+          goto EXECUTION_ABORTED;
+        }
         size_t num_arguments = GTA_TYPEX_UI(*next++);
 
         // Pop the function off the stack.
-        GTA_Computed_Value * potential_function = GTA_TYPEX_P(context->stack->data[--*sp]);
+        GTA_Computed_Value * potential_function = gta_virtual_machine_box(&context->stack->data[--*sp], context);
 
         if (GTA_COMPUTED_VALUE_IS_FUNCTION_NATIVE(potential_function)) {
           GTA_Computed_Value_Function_Native * function = (GTA_Computed_Value_Function_Native *)potential_function;
+          // The arguments are escaping into native code, so they must be
+          // boxed.
+          for (size_t i = *sp - num_arguments; i < *sp; ++i) {
+            gta_virtual_machine_box(&context->stack->data[i], context);
+          }
           // Call the function.
           GTA_Computed_Value * result = function->callback(function->bound_object, num_arguments, (GTA_Computed_Value * *)&context->stack->data[*sp - num_arguments], context);
           // Pop the arguments off the stack.
@@ -535,7 +1212,7 @@ bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
           if (!GTA_VECTORX_APPEND(context->stack, GTA_TYPEX_MAKE_P(result))) {
             context->result = gta_computed_value_error_out_of_memory;
           }
-          break;
+          GTA_VM_NEXT();
         }
 
         // Verify that it is a valid function.
@@ -567,26 +1244,43 @@ bool gta_virtual_machine_execute_bytecode(GTA_Execution_Context* context) {
           context->result = gta_computed_value_error_out_of_memory;
           break;
         }
+        // Count the calls of the functions of a tiered program which is still
+        // warming up.  A hot function makes the whole program hot.
+        if ((atomic_load_explicit(&context->program->tier, memory_order_relaxed) == GTA_PROGRAM_TIER_WARMING)
+          && (atomic_fetch_add_explicit(&function->invocations, 1, memory_order_relaxed) + 1 >= context->program->language->jit_threshold)) {
+          gta_program_mark_hot(context->program);
+        }
         // Set the frame pointer to the stack pointer minus the number of arguments.
         context->fp = *sp - num_arguments;
         // Set the pc to the function's address.
         next = &context->program->bytecode->data[function->pointer];
 
-        break;
+        GTA_VM_NEXT();
       }
-      default: {
+      GTA_VM_DEFAULT() {
         context->result = gta_computed_value_error_invalid_bytecode;
         break;
       }
     }
   }
 
+#ifdef GTA_VIRTUAL_MACHINE_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif // GTA_VIRTUAL_MACHINE_COMPUTED_GOTO
+
   // The top of the stack is the result.
   context->result = context->stack->count > 0
-    ? GTA_TYPEX_P(context->stack->data[context->stack->count - 1])
+    ? gta_virtual_machine_box(&context->stack->data[context->stack->count - 1], context)
     : 0;
-  GTA_VECTORX_DESTROY(context->pc_stack);
-  context->pc_stack = 0;
 
   return true;
+
+  // The execution was aborted at a safepoint.  The values on the stacks are
+  // abandoned, and the reason becomes the result.
+EXECUTION_ABORTED:
+  context->stack->count = 0;
+  context->pc_stack->count = 0;
+  context->fp = 0;
+  context->result = aborted;
+  return true;
 }
@@ -8,15 +8,15 @@
 #undef YY_HEADER_EXPORT_START_CONDITIONS
 
 #include <tang/macros.h>
+#include <tang/ast/astNodeGlobal.h>
 #include <tang/ast/astNodeIdentifier.h>
 #include <tang/ast/astNodeParseError.h>
 
 GTA_Ast_Node * gta_tang_parse(const char * source, bool is_template) {
   GTA_Ast_Node * primary = gta_tang_primary_parse(source, is_template);
-  return primary;
-    // NOTE: temporarily diabled because it does not pick up on global variable changes.
-    // ? gta_tang_simplify(primary)
-    // : 0;
+  return primary && !GTA_AST_IS_PARSE_ERROR(primary)
+    ? gta_tang_simplify(primary)
+    : primary;
 }
 
 
@@ -66,6 +66,46 @@ static void count_variables(GTA_Ast_Node * self, GTA_MAYBE_UNUSED(void * data),
 }
 
 
+/**
+ * Walk callback which collects the names that are declared `global`.
+ *
+ * @param self The node being visited.
+ * @param data The GCU_Hash64 in which to record the name hashes.
+ * @param return_value A bool which is set to false if a name could not be
+ *   recorded.
+ */
+static void collect_shared_names(GTA_Ast_Node * self, void * data, void * return_value) {
+  assert(self);
+  assert(data);
+  assert(return_value);
+  if (GTA_AST_IS_GLOBAL(self)) {
+    GTA_Ast_Node * identifier = ((GTA_Ast_Node_Global *) self)->identifier;
+    if (GTA_AST_IS_IDENTIFIER(identifier)
+      && !gcu_hash64_set((GCU_Hash64 *) data, ((GTA_Ast_Node_Identifier *) identifier)->hash, GCU_TYPE64_B(true))) {
+      *((bool *) return_value) = false;
+    }
+  }
+}
+
+
+/**
+ * Walk callback which marks the identifiers whose names are declared `global`
+ * as shared.
+ *
+ * @param self The node being visited.
+ * @param data The GCU_Hash64 of the name hashes.
+ * @param return_value Unused.
+ */
+static void mark_shared_names(GTA_Ast_Node * self, void * data, GTA_MAYBE_UNUSED(void * return_value)) {
+  assert(self);
+  assert(data);
+  if (GTA_AST_IS_IDENTIFIER(self)) {
+    GTA_Ast_Node_Identifier * identifier = (GTA_Ast_Node_Identifier *) self;
+    identifier->is_shared = gcu_hash64_contains((GCU_Hash64 *) data, identifier->hash);
+  }
+}
+
+
 GTA_Ast_Node * gta_tang_simplify(GTA_Ast_Node * node) {
   // Count the number of identifiers in the tree in order to pre-allocate space
   // in the variable map.  Although there may be overcount (e.g. if the same
@@ -75,9 +115,27 @@ GTA_Ast_Node * gta_tang_simplify(GTA_Ast_Node * node) {
 
   size_t variable_count = 0;
   gta_ast_node_walk(node, count_variables, 0, &variable_count);
+
+  // A variable which is declared `global` in any function may be changed by
+  // any function call, so the identifiers of those names are marked and their
+  // values are never propagated.  If this cannot be done, then the tree is
+  // left as it is, which is always correct.
+  GCU_Hash64 * shared_names = gcu_hash64_create(variable_count);
+  if (!shared_names) {
+    return node;
+  }
+  bool error_free = true;
+  gta_ast_node_walk(node, collect_shared_names, shared_names, &error_free);
+  if (!error_free) {
+    gcu_hash64_destroy(shared_names);
+    return node;
+  }
+  gta_ast_node_walk(node, mark_shared_names, shared_names, 0);
+  gcu_hash64_destroy(shared_names);
+
   GTA_Ast_Simplify_Variable_Map * variable_map = gcu_hash64_create(variable_count);
   if (!variable_map) {
-    return 0;
+    return node;
   }
   GTA_Ast_Node * simplified = gta_ast_node_simplify(node, variable_map);
   gcu_hash64_destroy(variable_map);
@@ -1,11 +1,14 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <string.h>
 #include <cutil/memory.h>
 #include <unicode/uconfig.h>
 #include <unicode/ustring.h>
 #include <unicode/ubrk.h>
+#include <unicode/utf16.h>
 #include <tang/unicodeString.h>
 
 #include <stdio.h>
@@ -15,121 +18,209 @@
  */
 struct {
   uint32_t type;
-  uint32_t grapheme_offset;
+  uint32_t byte_offset;
 } GCU_Type_Offset_Pair;
 
 
-bool gcu_unicode_string_get_grapheme_offsets(GCU_Vector32 * grapheme_offsets, const char * buffer, size_t length) {
-  assert(grapheme_offsets);
-  assert(buffer);
-
-  bool success = false;
+/**
+ * Determine whether or not a byte is a 7-bit ASCII character.
+ */
+#define IS_ASCII(X) (!((unsigned char)(X) & 0x80))
 
-  // Early exit for empty strings.
-  if (!length) {
-    if (!gcu_vector32_append(grapheme_offsets, GCU_TYPE32_UI32(0))) {
-      goto EARLY_ERROR;
+/**
+ * Find the length of the run of ASCII bytes at the start of a buffer.
+ *
+ * The buffer is examined eight bytes at a time until a word containing a
+ * non-ASCII byte is found, and then one byte at a time.
+ *
+ * @param buffer The buffer to scan.
+ * @param length The length of the buffer in bytes.
+ * @return The number of leading ASCII bytes.
+ */
+static size_t ascii_run_length(const char * buffer, size_t length) {
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, buffer + i, sizeof(uint64_t));
+    if (word & 0x8080808080808080ULL) {
+      break;
     }
-    success = true;
-    goto EARLY_SUCCESS;
   }
+  while (i < length && IS_ASCII(buffer[i])) {
+    ++i;
+  }
+  return i;
+}
 
-  // Worst case: string is standard ASCII.
-  if (!gcu_vector32_reserve(grapheme_offsets, length + 1)) {
-    goto EARLY_ERROR;
+
+/**
+ * Add the grapheme offsets for a run of ASCII text.
+ *
+ * Every ASCII character is its own grapheme, with the exception of "\r\n",
+ * which is a single grapheme.
+ *
+ * The caller must have already reserved enough space in the vector.
+ *
+ * @param grapheme_offsets The vector to add the offsets to.
+ * @param buffer The string buffer.
+ * @param start The byte offset of the start of the run.
+ * @param end The byte offset of the end of the run.
+ */
+static void append_ascii_grapheme_offsets(GCU_Vector32 * grapheme_offsets, const char * buffer, size_t start, size_t end) {
+  for (size_t i = start; i < end; ++i) {
+    if (buffer[i] == '\r' && i + 1 < end && buffer[i + 1] == '\n') {
+      ++i;
+    }
+    grapheme_offsets->data[grapheme_offsets->count++] = GCU_TYPE32_UI32(i + 1);
   }
+}
+
 
-  // Create an ICU Character Break Iterator to identify the graphemes.
+/**
+ * Add the grapheme offsets for a span of text that contains non-ASCII
+ * characters, using ICU to identify the grapheme boundaries.
+ *
+ * The span must begin and end on grapheme boundaries.
+ *
+ * The caller must have already reserved enough space in the vector.
+ *
+ * @param grapheme_offsets The vector to add the offsets to.
+ * @param iter The ICU character break iterator to use.
+ * @param u_buffer A buffer large enough to hold the span as UTF-16.
+ * @param u_capacity The capacity of `u_buffer`, in UChars.
+ * @param buffer The string buffer.
+ * @param start The byte offset of the start of the span.
+ * @param end The byte offset of the end of the span.
+ * @return True on success, false on failure (e.g., invalid UTF-8).
+ */
+static bool append_icu_grapheme_offsets(GCU_Vector32 * grapheme_offsets, UBreakIterator * iter, UChar * u_buffer, int32_t u_capacity, const char * buffer, size_t start, size_t end) {
   UErrorCode err = U_ZERO_ERROR;
-  UBreakIterator * iter = ubrk_open(UBRK_CHARACTER, NULL, NULL, 0, &err);
+  int32_t u_length = 0;
+  u_strFromUTF8(u_buffer, u_capacity, &u_length, buffer + start, (int32_t)(end - start), &err);
   if (!U_SUCCESS(err)) {
-    goto EARLY_ERROR;
+    return false;
+  }
+  ubrk_setText(iter, u_buffer, u_length, &err);
+  if (!U_SUCCESS(err)) {
+    return false;
+  }
+
+  // Find each grapheme boundary, and translate it from a UTF-16 index into a
+  // UTF-8 byte offset by summing the UTF-8 lengths of the code units in the
+  // grapheme.  The text came from valid UTF-8, so surrogates always come in
+  // pairs.
+  size_t byte_offset = start;
+  int32_t previous = 0;
+  for (int32_t current = ubrk_next(iter); current != UBRK_DONE; current = ubrk_next(iter)) {
+    for (int32_t i = previous; i < current; ++i) {
+      UChar c = u_buffer[i];
+      if (c < 0x80) {
+        byte_offset += 1;
+      }
+      else if (c < 0x800) {
+        byte_offset += 2;
+      }
+      else if (U16_IS_LEAD(c)) {
+        byte_offset += 4;
+        ++i;
+      }
+      else {
+        byte_offset += 3;
+      }
+    }
+    grapheme_offsets->data[grapheme_offsets->count++] = GCU_TYPE32_UI32(byte_offset);
+    previous = current;
+  }
+  assert(byte_offset == end);
+  return true;
+}
+
+
+bool gcu_unicode_string_get_grapheme_offsets(GCU_Vector32 * grapheme_offsets, const char * buffer, size_t length) {
+  assert(grapheme_offsets);
+  assert(!grapheme_offsets->count);
+  assert(buffer);
+
+  // Worst case: string is standard ASCII.
+  if (!gcu_vector32_reserve(grapheme_offsets, length + 1)) {
+    return false;
   }
 
   // Add the first offset.
   // This is always 0, even for an empty string.
-  if (!gcu_vector32_append(grapheme_offsets, GCU_TYPE32_UI32(0))) {
-    goto OFFSET_ADD_FAILED;
-  }
-
-  // Set the text to iterate through.
-  // Convert buffer (which is a char *) to a UChar * using ICU conversion
-  // functions.
-  // This is safe because the buffer is guaranteed to be UTF-8.
-  int32_t uLength = 0;
-  UChar * uBuffer = NULL;
-  // Pre-flight the conversion to determine the length of the resulting string.
-  u_strFromUTF8(NULL, 0, &uLength, buffer, length, &err);
-  if (err == U_BUFFER_OVERFLOW_ERROR) {
-    err = U_ZERO_ERROR;
-    uBuffer = gcu_malloc(sizeof(UChar) * (uLength + 1));
-    if (uBuffer == NULL) {
-      goto UBUFFER_CREATE_FAILED;
+  grapheme_offsets->data[grapheme_offsets->count++] = GCU_TYPE32_UI32(0);
+
+  // ICU is only needed if the string contains non-ASCII characters, so its
+  // resources are created on first use and then reused for every non-ASCII
+  // span in the string.
+  bool success = false;
+  UBreakIterator * iter = NULL;
+  UChar * u_buffer = NULL;
+
+  size_t i = 0;
+  while (i < length) {
+    // Find the end of the ASCII run.
+    size_t ascii_end = i + ascii_run_length(buffer + i, length - i);
+    if (ascii_end == length) {
+      append_ascii_grapheme_offsets(grapheme_offsets, buffer, i, length);
+      break;
     }
-    u_strFromUTF8(uBuffer, uLength + 1, NULL, buffer, length, &err);
-  }
-  if (!U_SUCCESS(err)) {
-    goto STRFROMUTF8_FAILED;
-  }
 
-  ubrk_setText(iter, uBuffer, uLength, &err);
-  if (!U_SUCCESS(err)) {
-    goto STRFROMUTF8_FAILED;
-  }
-
-  // Print out each uBuffer character.
-  // for (int32_t i = 0; i < uLength; ++i) {
-  //   printf("%d: %d\n", i, uBuffer[i]);
-  // }
-
-  // Find each grapheme offset one by one.  When we find the next offset, we
-  // can then determine the length of the previous grapheme in UTF-8 so that
-  // we can calculate the offset of the currently found grapheme.
-  int32_t previous_index_in_UTF16 = 0;
-  // NOTE: Workaround for a bug? in the ICU library.
-  // In the u_strToUTF8() call below, we *should* be able to leave the
-  // destination buffer as NULL and the length as 0 to pre-flight the
-  // conversion, but that causes bad results.  Instead, we will allocate a
-  // buffer and then throw it away.
-  // We know that the original string was valid UTF-8, so the maximum length
-  // required for any grapheme is the length of the original string.
-  char * dummyBuffer = gcu_malloc(length + 1);
-  if (dummyBuffer == NULL) {
-    goto DUMMY_BUFFER_CREATE_FAILED;
-  }
-  while (ubrk_next(iter) != UBRK_DONE) {
-    int32_t current_index_in_UTF16 = ubrk_current(iter);
-
-    // Find out how many bytes the grapheme is as UTF-8.
-    int32_t grapheme_length_in_UTF8;
-    u_strToUTF8(dummyBuffer, length + 1, &grapheme_length_in_UTF8, &uBuffer[previous_index_in_UTF16], current_index_in_UTF16 - previous_index_in_UTF16, &err);
-    // We do not check for an error because we already know that this is valid
-    // UTF-8, converted to UTF-16, and back to UTF-8, which is guaranteed to
-    // be valid and lossless.
-
-    // Add the offset to the vector.
-    if (!gcu_vector32_append(grapheme_offsets, GCU_TYPE32_UI32(grapheme_length_in_UTF8 + grapheme_offsets->data[grapheme_offsets->count - 1].ui32))) {
-      goto GRAPHEME_OFFSET_ADD_FAILED;
+    // The last ASCII character before the non-ASCII text (or a "\r\n" pair)
+    // may be combined with what follows it (e.g., a letter followed by a
+    // combining accent), so it must be handed to ICU as well.
+    size_t span_start = ascii_end;
+    if (span_start > i) {
+      --span_start;
+      if (span_start > i && buffer[span_start] == '\n' && buffer[span_start - 1] == '\r') {
+        --span_start;
+      }
+    }
+    append_ascii_grapheme_offsets(grapheme_offsets, buffer, i, span_start);
+
+    // Find the end of the non-ASCII span.  The span ends after an ASCII
+    // character which is followed by another ASCII character (other than
+    // "\r\n") or by the end of the string, because there is always a
+    // grapheme boundary between them.
+    size_t span_end = ascii_end;
+    while (span_end < length) {
+      bool is_boundary = IS_ASCII(buffer[span_end])
+        && ((span_end + 1 == length)
+          || (IS_ASCII(buffer[span_end + 1]) && !(buffer[span_end] == '\r' && buffer[span_end + 1] == '\n')));
+      ++span_end;
+      if (is_boundary) {
+        break;
+      }
     }
-    previous_index_in_UTF16 = current_index_in_UTF16;
-  }
 
+    if (!iter) {
+      UErrorCode err = U_ZERO_ERROR;
+      iter = ubrk_open(UBRK_CHARACTER, NULL, NULL, 0, &err);
+      if (!U_SUCCESS(err)) {
+        goto CLEANUP;
+      }
+      // The UTF-16 version of any span is never longer (in code units) than
+      // the UTF-8 version (in bytes).
+      u_buffer = gcu_malloc(sizeof(UChar) * (length + 1));
+      if (!u_buffer) {
+        goto CLEANUP;
+      }
+    }
+    if (!append_icu_grapheme_offsets(grapheme_offsets, iter, u_buffer, (int32_t)(length + 1), buffer, span_start, span_end)) {
+      goto CLEANUP;
+    }
+    i = span_end;
+  }
   success = true;
   // Fall-through for cleanup
 
-GRAPHEME_OFFSET_ADD_FAILED:
-  gcu_free(dummyBuffer);
-DUMMY_BUFFER_CREATE_FAILED:
-STRFROMUTF8_FAILED:
-  if (uBuffer) {
-    // Note: If the buffer was an empty string, then uBuffer will be NULL.
-    gcu_free(uBuffer);
-  }
-OFFSET_ADD_FAILED:
-UBUFFER_CREATE_FAILED:
-  ubrk_close(iter);
-EARLY_ERROR:
-EARLY_SUCCESS:
+CLEANUP:
+  if (u_buffer) {
+    gcu_free(u_buffer);
+  }
+  if (iter) {
+    ubrk_close(iter);
+  }
   return success;
 }
 
@@ -163,36 +254,14 @@ GTA_Unicode_String * gta_unicode_string_create_and_adopt(const char * source, si
   }
 
   // Adopt the buffer.
+  // The grapheme offsets are not computed until they are needed.
   string->buffer = source;
   string->byte_length = length;
 
-  // Create the grapheme offsets.
-  // For ease of use, we will add an extra offset at the end of the string
-  // that points to the end of the string.
-  // If the string only contains ASCII characters, then the grapheme offsets
-  // will be the same as the byte offsets and will require (length + 1)
-  // entries as a worst case.  If the string contains non-ASCII characters,
-  // then the grapheme offsets will be different from the byte offsets and
-  // will require fewer than (length + 1) entries, so we will allocate the
-  // worst-case number of entries to ensure that no allocation failures can
-  // happen later.
-  string->grapheme_offsets = gcu_vector32_create(length + 1);
-  if (string->grapheme_offsets == NULL) {
-    gcu_free(string);
-    return NULL;
-  }
-  if (!gcu_unicode_string_get_grapheme_offsets(string->grapheme_offsets, source, length)) {
-    gcu_vector32_destroy(string->grapheme_offsets);
-    gcu_free(string);
-    return NULL;
-  }
-  string->grapheme_length = gcu_vector32_count(string->grapheme_offsets) - 1;
-
   // Create the string type vector.
   // It will only contain one type, so we will allocate one entry.
   string->string_type = gcu_vector64_create(1);
   if (string->string_type == NULL) {
-    gcu_vector32_destroy(string->grapheme_offsets);
     gcu_free(string);
     return NULL;
   }
@@ -202,16 +271,133 @@ GTA_Unicode_String * gta_unicode_string_create_and_adopt(const char * source, si
 }
 
 
+GTA_Unicode_String * gta_unicode_string_create_borrowed(const char * source, size_t length, GTA_String_Type type) {
+  assert(source);
+  assert(!source[length]);
+
+  GTA_Unicode_String * string = gta_unicode_string_create_and_adopt(source, length, type);
+  if (string) {
+    string->is_borrowed = true;
+  }
+  return string;
+}
+
+
 void gta_unicode_string_destroy(GTA_Unicode_String * string) {
   assert(string);
 
-  gcu_vector32_destroy(string->grapheme_offsets);
+  GCU_Vector32 * grapheme_offsets = atomic_load_explicit(&string->grapheme_offsets, memory_order_acquire);
+  if (grapheme_offsets) {
+    gcu_vector32_destroy(grapheme_offsets);
+  }
   gcu_vector64_destroy(string->string_type);
-  gcu_free((void *)string->buffer);
+  if (!string->is_borrowed) {
+    gcu_free((void *)string->buffer);
+  }
   gcu_free(string);
 }
 
 
+bool gta_unicode_string_index_graphemes(const GTA_Unicode_String * string) {
+  assert(string);
+
+  if (atomic_load_explicit(&string->grapheme_offsets, memory_order_acquire)) {
+    return true;
+  }
+
+  // For ease of use, we will add an extra offset at the end of the string
+  // that points to the end of the string.
+  // If the string only contains ASCII characters, then the grapheme offsets
+  // will be the same as the byte offsets and will require (length + 1)
+  // entries as a worst case.  If the string contains non-ASCII characters,
+  // then the grapheme offsets will be different from the byte offsets and
+  // will require fewer than (length + 1) entries, so we will allocate the
+  // worst-case number of entries to ensure that no allocation failures can
+  // happen later.
+  GCU_Vector32 * grapheme_offsets = gcu_vector32_create(string->byte_length + 1);
+  if (grapheme_offsets == NULL) {
+    return false;
+  }
+  if (!gcu_unicode_string_get_grapheme_offsets(grapheme_offsets, string->buffer, string->byte_length)) {
+    gcu_vector32_destroy(grapheme_offsets);
+    return false;
+  }
+
+  // The index is a cache, so it may be filled in even when the string is
+  // otherwise treated as const.  Constant strings are shared between threads,
+  // so the length is stored before the offsets are published.  Every thread
+  // computes the same length, so a race to store it is harmless, and a thread
+  // which loses the race to publish the offsets discards its own copy.
+  GTA_Unicode_String * mutable_string = (GTA_Unicode_String *)string;
+  mutable_string->grapheme_length = gcu_vector32_count(grapheme_offsets) - 1;
+  GCU_Vector32 * expected = NULL;
+  if (!atomic_compare_exchange_strong_explicit(&mutable_string->grapheme_offsets, &expected, grapheme_offsets, memory_order_release, memory_order_acquire)) {
+    gcu_vector32_destroy(grapheme_offsets);
+  }
+  return true;
+}
+
+
+size_t gta_unicode_string_get_grapheme_length(const GTA_Unicode_String * string) {
+  assert(string);
+
+  return gta_unicode_string_index_graphemes(string)
+    ? string->grapheme_length
+    : SIZE_MAX;
+}
+
+
+bool gta_unicode_string_is_valid_utf8(const GTA_Unicode_String * string) {
+  assert(string);
+
+  // ASCII is always valid, so only the rest of the string is given to ICU.
+  size_t start = ascii_run_length(string->buffer, string->byte_length);
+  if (start == string->byte_length) {
+    return true;
+  }
+
+  // Preflight the conversion, which reports invalid UTF-8 without writing
+  // anything.
+  UErrorCode err = U_ZERO_ERROR;
+  int32_t u_length = 0;
+  u_strFromUTF8(NULL, 0, &u_length, string->buffer + start, (int32_t)(string->byte_length - start), &err);
+  return err != U_INVALID_CHAR_FOUND;
+}
+
+
+GTA_Unicode_String * gta_unicode_string_copy(const GTA_Unicode_String * string) {
+  assert(string);
+  assert(string->string_type);
+
+  GTA_Unicode_String * newString = gcu_calloc(sizeof(GTA_Unicode_String), 1);
+  if (newString == NULL) {
+    return NULL;
+  }
+  newString->buffer = gcu_malloc(string->byte_length + 1);
+  if (newString->buffer == NULL) {
+    goto BUFFER_CREATE_FAILED;
+  }
+  newString->string_type = gcu_vector64_create(string->string_type->count);
+  if (newString->string_type == NULL) {
+    goto STRING_TYPE_CREATE_FAILED;
+  }
+
+  // The space is already reserved, so the vector is manipulated directly.
+  memcpy((char *)newString->buffer, string->buffer, string->byte_length + 1);
+  newString->byte_length = string->byte_length;
+  memcpy(newString->string_type->data, string->string_type->data, string->string_type->count * sizeof(GCU_Type64_Union));
+  newString->string_type->count = string->string_type->count;
+  return newString;
+
+  // Failure conditions.
+STRING_TYPE_CREATE_FAILED:
+  gcu_free((void *)newString->buffer);
+BUFFER_CREATE_FAILED:
+  gcu_free(newString);
+  return NULL;
+}
+
+
 GTA_Unicode_String * gta_unicode_string_concat(const GTA_Unicode_String * string1, const GTA_Unicode_String * string2) {
   assert(string1);
   assert(string2);
@@ -223,6 +409,10 @@ GTA_Unicode_String * gta_unicode_string_concat(const GTA_Unicode_String * string
   }
 
   // Copy the source strings to the buffer.
+  // The grapheme offsets are not computed until they are needed.  They cannot
+  // simply be copied from the source strings anyway, because the last
+  // grapheme of the first string may combine with the first grapheme of the
+  // second string.
   newString->buffer = gcu_malloc(string1->byte_length + string2->byte_length + 1);
   if (newString->buffer == NULL) {
     gcu_free(newString);
@@ -237,41 +427,6 @@ GTA_Unicode_String * gta_unicode_string_concat(const GTA_Unicode_String * string
   newString->byte_length = string1->byte_length + string2->byte_length;
   ((char *)newString->buffer)[newString->byte_length] = '\0';
 
-  // Create the grapheme offsets.
-  // For ease of use, we will add an extra offset at the end of the string
-  // that points to the end of the string.
-  // If the string only contains ASCII characters, then the grapheme offsets
-  // will be the same as the byte offsets and will require (length + 1)
-  // entries as a worst case.  If the string contains non-ASCII characters,
-  // then the grapheme offsets will be different from the byte offsets and
-  // will require fewer than (length + 1) entries, so we will allocate the
-  // worst-case number of entries to ensure that no allocation failures can
-  // happen later.
-  newString->grapheme_offsets = gcu_vector32_create(string1->grapheme_length + string2->grapheme_length + 1);
-  if (newString->grapheme_offsets == NULL) {
-    gcu_free((void *)newString->buffer);
-    gcu_free(newString);
-    return NULL;
-  }
-  // Copy the grapheme offsets from the first string.
-  // The space is already reserved.
-  memcpy(newString->grapheme_offsets->data, string1->grapheme_offsets->data, string1->grapheme_length * sizeof(GCU_Type32_Union));
-  // Copy the grapheme offsets from the second string, adding the byte and
-  // grapheme offsets from the first string to the second string.
-  // The space is already reserved.
-  size_t byte_offset = string1->byte_length;
-  size_t grapheme_offset = string1->grapheme_length;
-  for (size_t i = 0; i < string2->grapheme_length; ++i) {
-    newString->grapheme_offsets->data[i + grapheme_offset] = GCU_TYPE32_UI32(string2->grapheme_offsets->data[i].ui32 + byte_offset);
-  }
-  // Add the final offset.
-  newString->grapheme_offsets->data[string1->grapheme_length + string2->grapheme_length] = GCU_TYPE32_UI32(string1->byte_length + string2->byte_length);
-  // Since we reached into the vector and manipulated data directly, we need to
-  // manually fix the count.
-  newString->grapheme_offsets->count = string1->grapheme_length + string2->grapheme_length + 1;
-  // Set the grapheme length.
-  newString->grapheme_length = string1->grapheme_length + string2->grapheme_length;
-
   // Create the string type vector.
   // Because the last type of the first string and the first type of the second
   // string may be the same, we may need to merge them.  We will allocate
@@ -279,7 +434,6 @@ GTA_Unicode_String * gta_unicode_string_concat(const GTA_Unicode_String * string
   // string and the first type of the second string are different.
   newString->string_type = gcu_vector64_create(string1->string_type->count + string2->string_type->count);
   if (newString->string_type == NULL) {
-    gcu_vector32_destroy(newString->grapheme_offsets);
     gcu_free((void *)newString->buffer);
     gcu_free(newString);
     return NULL;
@@ -297,19 +451,19 @@ GTA_Unicode_String * gta_unicode_string_concat(const GTA_Unicode_String * string
     newString->string_type->count = string1->string_type->count;
     types_copied_count = string1->string_type->count;
   }
-  // Copy the string types from the second string, adding the grapheme count
-  // from the first string to the second string's grapheme offsets.
+  // Copy the string types from the second string, adding the byte length of
+  // the first string to the second string's byte offsets.
   // The space is already reserved.
   if (string2->byte_length || !string1->byte_length) {
     size_t offset = strings_are_same_type ? 1 : 0;
     for (size_t i = offset; i < string2->string_type->count; ++i) {
       // Was originally:
       //   uint64_t currentUnion = string2->string_type->data[i].ui64;
-      //   GTA_UC_MAKE_TYPE_OFFSET_PAIR(GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(currentUnion), GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(currentUnion) + string1->grapheme_length)
+      //   GTA_UC_MAKE_TYPE_OFFSET_PAIR(GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(currentUnion), GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(currentUnion) + string1->byte_length)
       // but, since the union is a integer and the addition is happening to the
       // lower bytes, that simplifies to:
-      //   string2->string_type->data[i].ui64 + string1->grapheme_length
-      newString->string_type->data[types_copied_count + i - offset].ui64 = string2->string_type->data[i].ui64 + string1->grapheme_length;
+      //   string2->string_type->data[i].ui64 + string1->byte_length
+      newString->string_type->data[types_copied_count + i - offset].ui64 = string2->string_type->data[i].ui64 + string1->byte_length;
     }
     // Since we reached into the vector and manipulated data directly, we need to
     // manually fix the count.
@@ -320,51 +474,119 @@ GTA_Unicode_String * gta_unicode_string_concat(const GTA_Unicode_String * string
 }
 
 
+GTA_Unicode_String * gta_unicode_string_join(const GTA_Unicode_String * const * strings, size_t count) {
+  assert(count ? (bool)strings : true);
+
+  // Determine the size of the result so that everything can be allocated
+  // once.  Empty strings contribute nothing, not even their type.
+  size_t byte_length = 0;
+  size_t type_count = 0;
+  for (size_t i = 0; i < count; ++i) {
+    assert(strings[i]);
+    if (strings[i]->byte_length) {
+      byte_length += strings[i]->byte_length;
+      type_count += strings[i]->string_type->count;
+    }
+  }
+  if (!byte_length) {
+    return gta_unicode_string_create("", 0, GTA_UNICODE_STRING_TYPE_TRUSTED);
+  }
+
+  // Allocate space for the new string.
+  // As with gta_unicode_string_concat(), the grapheme offsets are not computed
+  // until they are needed.
+  GTA_Unicode_String * newString = gcu_calloc(sizeof(GTA_Unicode_String), 1);
+  if (newString == NULL) {
+    return NULL;
+  }
+  newString->buffer = gcu_malloc(byte_length + 1);
+  if (newString->buffer == NULL) {
+    goto BUFFER_CREATE_FAILED;
+  }
+  newString->string_type = gcu_vector64_create(type_count);
+  if (newString->string_type == NULL) {
+    goto STRING_TYPE_CREATE_FAILED;
+  }
+
+  // Copy each string, shifting its type offsets by the number of bytes
+  // already copied.  Adjacent type runs of the same type are merged.
+  // The space is already reserved, so the vector is manipulated directly.
+  size_t byte_offset = 0;
+  size_t types_copied_count = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const GTA_Unicode_String * string = strings[i];
+    if (!string->byte_length) {
+      continue;
+    }
+    memcpy((char *)newString->buffer + byte_offset, string->buffer, string->byte_length);
+    size_t first_type = (types_copied_count
+      && (GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(newString->string_type->data[types_copied_count - 1]) == GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(string->string_type->data[0])))
+      ? 1
+      : 0;
+    for (size_t j = first_type; j < string->string_type->count; ++j) {
+      // See gta_unicode_string_concat() for why this simple addition works.
+      newString->string_type->data[types_copied_count++].ui64 = string->string_type->data[j].ui64 + byte_offset;
+    }
+    byte_offset += string->byte_length;
+  }
+  ((char *)newString->buffer)[byte_length] = '\0';
+  newString->string_type->count = types_copied_count;
+  newString->byte_length = byte_length;
+  return newString;
+
+  // Failure conditions.
+STRING_TYPE_CREATE_FAILED:
+  gcu_free((void *)newString->buffer);
+BUFFER_CREATE_FAILED:
+  gcu_free(newString);
+  return NULL;
+}
+
+
 GTA_Unicode_String * gta_unicode_string_substring(const GTA_Unicode_String * string, size_t grapheme_start, size_t grapheme_count) {
   assert(string);
 
+  // An empty request does not need the grapheme index.
+  if (!string->byte_length || !grapheme_count) {
+    return gta_unicode_string_create("", 0, GTA_UNICODE_STRING_TYPE_TRUSTED);
+  }
+  if (!gta_unicode_string_index_graphemes(string)) {
+    return NULL;
+  }
+
   // If grapheme start is beyond the end of the string, then return an empty
   // string.
-  if ((grapheme_start >= string->grapheme_length) || (grapheme_count == 0)) {
+  if (grapheme_start >= string->grapheme_length) {
     return gta_unicode_string_create("", 0, GTA_UNICODE_STRING_TYPE_TRUSTED);
   }
 
   // Determine the byte offset of the start of the substring.
-  size_t byte_start = string->grapheme_offsets->data[grapheme_start].ui32;
+  GCU_Vector32 * grapheme_offsets = atomic_load_explicit(&string->grapheme_offsets, memory_order_acquire);
+  size_t byte_start = grapheme_offsets->data[grapheme_start].ui32;
 
   // Determine the byte offset of the end of the substring.
-  size_t byte_end = (grapheme_start + grapheme_count >= string->grapheme_length)
-    ? string->grapheme_offsets->data[string->grapheme_length].ui32
-    : string->grapheme_offsets->data[grapheme_start + grapheme_count].ui32;
+  size_t byte_end = (grapheme_count >= string->grapheme_length - grapheme_start)
+    ? grapheme_offsets->data[string->grapheme_length].ui32
+    : grapheme_offsets->data[grapheme_start + grapheme_count].ui32;
 
-  // Determine the actual last grapheme to be copied from the original string.
-  size_t end_grapheme = (grapheme_start + grapheme_count >= string->grapheme_length)
-    ? string->grapheme_length
-    : grapheme_start + grapheme_count;
-
-  // Determine the type of the substring by finding the first index whose range
-  // includes the start grapheme.
-  GTA_String_Type newStringType = GTA_UNICODE_STRING_TYPE_TRUSTED;
+  // Determine the type of the substring by finding the last type run which
+  // starts at or before the first byte.
   size_t first_string_type_index_to_include = 0;
-  size_t iterator = 0;
-  while ((iterator < string->string_type->count) && (GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(string->string_type->data[iterator]) >= grapheme_start)) {
-    newStringType = GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(string->string_type->data[iterator]);
-    first_string_type_index_to_include = iterator;
-    ++iterator;
+  while ((first_string_type_index_to_include + 1 < string->string_type->count) && (GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(string->string_type->data[first_string_type_index_to_include + 1]) <= byte_start)) {
+    ++first_string_type_index_to_include;
   }
+  GTA_String_Type newStringType = GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(string->string_type->data[first_string_type_index_to_include]);
+
   // Create a new string.
   GTA_Unicode_String * newString = gta_unicode_string_create(string->buffer + byte_start, byte_end - byte_start, newStringType);
   if (newString == NULL) {
     return NULL;
   }
 
-  // Determine the last string type offset that is less than the last grapheme
-  // to be copied from the original string.
+  // Determine the last type run which starts before the end of the substring.
   size_t last_string_type_index_to_include = first_string_type_index_to_include;
-  iterator = first_string_type_index_to_include;
-  while ((iterator < string->string_type->count) && (GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(string->string_type->data[iterator]) <= end_grapheme)) {
-    last_string_type_index_to_include = iterator;
-    ++iterator;
+  while ((last_string_type_index_to_include + 1 < string->string_type->count) && (GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(string->string_type->data[last_string_type_index_to_include + 1]) < byte_end)) {
+    ++last_string_type_index_to_include;
   }
 
   // Add the remaining string types.
@@ -379,7 +601,7 @@ GTA_Unicode_String * gta_unicode_string_substring(const GTA_Unicode_String * str
     // The original string_type already contains the correct type, but the
     // offset is relative to the start of the original string, so we need to
     // subtract the start of the substring.
-    gcu_vector64_append(newString->string_type, GCU_TYPE64_I64(string->string_type->data[i].ui64 - grapheme_start));
+    gcu_vector64_append(newString->string_type, GCU_TYPE64_UI64(string->string_type->data[i].ui64 - byte_start));
   }
   return newString;
 }
@@ -409,14 +631,12 @@ GTA_Unicode_Rendered_String gta_unicode_string_render(const GTA_Unicode_String *
 
   // Loop through the string types and render the string.
   for (size_t i = 0; i < string->string_type->count; ++i) {
-    // Compute the offsets for the current and next graphemes.
+    // Compute the byte offsets for the current and next type runs.
     GTA_String_Type type = GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(string->string_type->data[i]);
-    size_t source_grapheme_offset = GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(string->string_type->data[i]);
-    size_t next_source_grapheme_offset = (i + 1 < string->string_type->count)
+    size_t source_byte_offset = GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(string->string_type->data[i]);
+    size_t next_source_byte_offset = (i + 1 < string->string_type->count)
       ? GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(string->string_type->data[i + 1])
-      : string->grapheme_length;
-    size_t source_byte_offset = string->grapheme_offsets->data[source_grapheme_offset].ui32;
-    size_t next_source_byte_offset = string->grapheme_offsets->data[next_source_grapheme_offset].ui32;
+      : string->byte_length;
 
     // Render the string based on the type.
     switch (type) {
@@ -9,6 +9,7 @@
 #include <gtest/gtest.h>
 #include <cutil/vector.h>
 #include <tang/program/binary.h>
+#include <tang/program/codeArena.h>
 #include <iostream>
 
 using namespace std;
@@ -69,6 +70,27 @@ TEST(x86_64, add_reg_imm) {
 }
 
 
+TEST(x86_64, add_reg_reg) {
+  // General case. r32, r32
+  JIT(gta_add_reg_reg__x86_64(v, GTA_REG_EAX, GTA_REG_EDX), "\x01\xD0");
+  // General case. r64, r64
+  JIT(gta_add_reg_reg__x86_64(v, GTA_REG_RAX, GTA_REG_RBX), "\x48\x01\xD8");
+  JIT(gta_add_reg_reg__x86_64(v, GTA_REG_R10, GTA_REG_RCX), "\x49\x01\xCA");
+  JIT(gta_add_reg_reg__x86_64(v, GTA_REG_RCX, GTA_REG_R9), "\x4C\x01\xC9");
+  JIT_FAIL(gta_add_reg_reg__x86_64(v, GTA_REG_RAX, GTA_REG_EAX));
+  JIT_FAIL(gta_add_reg_reg__x86_64(v, GTA_REG_XMM0, GTA_REG_XMM1));
+}
+
+
+TEST(x86_64, addsd_reg_reg) {
+  // General case. xmm, xmm
+  JIT(gta_addsd_reg_reg__x86_64(v, GTA_REG_XMM0, GTA_REG_XMM1), "\xF2\x0F\x58\xC1");
+  JIT(gta_addsd_reg_reg__x86_64(v, GTA_REG_XMM9, GTA_REG_XMM2), "\xF2\x44\x0F\x58\xCA");
+  JIT(gta_addsd_reg_reg__x86_64(v, GTA_REG_XMM3, GTA_REG_XMM12), "\xF2\x41\x0F\x58\xDC");
+  JIT_FAIL(gta_addsd_reg_reg__x86_64(v, GTA_REG_XMM0, GTA_REG_RAX));
+}
+
+
 TEST(x86_64, and_reg_imm) {
   // Special cases for forms of the AX register.
   JIT(gta_and_reg_imm__x86_64(v, GTA_REG_AL, (int8_t)0xDE), "\x24\xDE");
@@ -212,6 +234,17 @@ TEST(x86_64, cmp_reg_reg) {
 }
 
 
+TEST(x86_64, imul_reg_reg) {
+  // General case. r32, r32
+  JIT(gta_imul_reg_reg__x86_64(v, GTA_REG_EAX, GTA_REG_EDX), "\x0F\xAF\xC2");
+  // General case. r64, r64
+  JIT(gta_imul_reg_reg__x86_64(v, GTA_REG_RAX, GTA_REG_RBX), "\x48\x0F\xAF\xC3");
+  JIT(gta_imul_reg_reg__x86_64(v, GTA_REG_R10, GTA_REG_RCX), "\x4C\x0F\xAF\xD1");
+  JIT(gta_imul_reg_reg__x86_64(v, GTA_REG_RCX, GTA_REG_R9), "\x49\x0F\xAF\xC9");
+  JIT_FAIL(gta_imul_reg_reg__x86_64(v, GTA_REG_RAX, GTA_REG_EAX));
+}
+
+
 TEST(x86_64, jcc) {
   // General case.
   JIT(gta_jcc__x86_64(v, GTA_CC_A, 0x12345678), "\x0F\x87\x78\x56\x34\x12");
@@ -542,6 +575,8 @@ TEST(x86_64, movq_reg_reg) {
   JIT(gta_movq_reg_reg__x86_64(v, GTA_REG_XMM0, GTA_REG_RAX), "\x66\x48\x0F\x6E\xC0");
   JIT(gta_movq_reg_reg__x86_64(v, GTA_REG_XMM1, GTA_REG_R9), "\x66\x49\x0F\x6E\xC9");
   JIT(gta_movq_reg_reg__x86_64(v, GTA_REG_XMM2, GTA_REG_R10), "\x66\x49\x0F\x6E\xD2");
+  JIT(gta_movq_reg_reg__x86_64(v, GTA_REG_XMM1, GTA_REG_RAX), "\x66\x48\x0F\x6E\xC8");
+  JIT(gta_movq_reg_reg__x86_64(v, GTA_REG_XMM10, GTA_REG_RCX), "\x66\x4C\x0F\x6E\xD1");
   // General case. r64, xmm
   JIT(gta_movq_reg_reg__x86_64(v, GTA_REG_RBX, GTA_REG_XMM3), "\x66\x48\x0F\x7E\xDB");
   JIT(gta_movq_reg_reg__x86_64(v, GTA_REG_R12, GTA_REG_XMM4), "\x66\x49\x0F\x7E\xE4");
@@ -549,6 +584,14 @@ TEST(x86_64, movq_reg_reg) {
 }
 
 
+TEST(x86_64, mulsd_reg_reg) {
+  // General case. xmm, xmm
+  JIT(gta_mulsd_reg_reg__x86_64(v, GTA_REG_XMM0, GTA_REG_XMM1), "\xF2\x0F\x59\xC1");
+  JIT(gta_mulsd_reg_reg__x86_64(v, GTA_REG_XMM3, GTA_REG_XMM12), "\xF2\x41\x0F\x59\xDC");
+  JIT_FAIL(gta_mulsd_reg_reg__x86_64(v, GTA_REG_RAX, GTA_REG_XMM1));
+}
+
+
 TEST(x86_64, nop) {
   // General case.
   JIT(gta_nop__x86_64(v), "\x90");
@@ -604,6 +647,25 @@ TEST(x86_64, ret) {
 }
 
 
+TEST(x86_64, sub_reg_reg) {
+  // General case. r32, r32
+  JIT(gta_sub_reg_reg__x86_64(v, GTA_REG_EAX, GTA_REG_EDX), "\x29\xD0");
+  // General case. r64, r64
+  JIT(gta_sub_reg_reg__x86_64(v, GTA_REG_RAX, GTA_REG_RBX), "\x48\x29\xD8");
+  JIT(gta_sub_reg_reg__x86_64(v, GTA_REG_R10, GTA_REG_RCX), "\x49\x29\xCA");
+  JIT(gta_sub_reg_reg__x86_64(v, GTA_REG_RCX, GTA_REG_R9), "\x4C\x29\xC9");
+  JIT_FAIL(gta_sub_reg_reg__x86_64(v, GTA_REG_EAX, GTA_REG_RAX));
+}
+
+
+TEST(x86_64, subsd_reg_reg) {
+  // General case. xmm, xmm
+  JIT(gta_subsd_reg_reg__x86_64(v, GTA_REG_XMM0, GTA_REG_XMM1), "\xF2\x0F\x5C\xC1");
+  JIT(gta_subsd_reg_reg__x86_64(v, GTA_REG_XMM9, GTA_REG_XMM2), "\xF2\x44\x0F\x5C\xCA");
+  JIT_FAIL(gta_subsd_reg_reg__x86_64(v, GTA_REG_XMM0, GTA_REG_RBX));
+}
+
+
 TEST(x86_64, test_reg_reg) {
   // General case. r8, r8
   JIT(gta_test_reg_reg__x86_64(v, GTA_REG_AL, GTA_REG_BL), "\x84\xD8");
@@ -624,6 +686,14 @@ TEST(x86_64, test_reg_reg) {
 }
 
 
+TEST(x86_64, ucomisd_reg_reg) {
+  // General case. xmm, xmm
+  JIT(gta_ucomisd_reg_reg__x86_64(v, GTA_REG_XMM0, GTA_REG_XMM1), "\x66\x0F\x2E\xC1");
+  JIT(gta_ucomisd_reg_reg__x86_64(v, GTA_REG_XMM10, GTA_REG_XMM3), "\x66\x44\x0F\x2E\xD3");
+  JIT_FAIL(gta_ucomisd_reg_reg__x86_64(v, GTA_REG_XMM0, GTA_REG_RAX));
+}
+
+
 TEST(x86_64, xor_reg_reg) {
   // General case. r8, r8
   JIT(gta_xor_reg_reg__x86_64(v, GTA_REG_AL, GTA_REG_BL), "\x30\xD8");
@@ -647,6 +717,68 @@ TEST(x86_64, xor_reg_reg) {
 }
 
 
+TEST(CodeArena, Reuse) {
+  GTA_Code_Arena * arena = gta_code_arena_create();
+  ASSERT_TRUE(arena);
+  GTA_Code_Arena_Stats stats;
+  gta_code_arena_get_stats(arena, &stats);
+  EXPECT_EQ(stats.chunks, 0);
+
+  // mov eax, 42
+  // ret
+  const unsigned char code[] = {0xB8, 0x2A, 0x00, 0x00, 0x00, 0xC3};
+  void * first = gta_code_arena_allocate(arena, code, sizeof(code));
+  void * second = gta_code_arena_allocate(arena, code, sizeof(code));
+  void * third = gta_code_arena_allocate(arena, code, sizeof(code));
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  ASSERT_TRUE(third);
+  EXPECT_EQ((uintptr_t)first % GTA_CODE_ARENA_ALIGNMENT, 0);
+  EXPECT_EQ(memcmp(second, code, sizeof(code)), 0);
+#if defined(__x86_64__) || defined(_M_X64)
+  EXPECT_EQ(((int (*)(void))second)(), 42);
+#endif
+
+  // All of the code shares a single chunk.
+  gta_code_arena_get_stats(arena, &stats);
+  EXPECT_EQ(stats.chunks, 1);
+  EXPECT_EQ(stats.allocations, 3);
+  EXPECT_GE(stats.bytes_used, 3 * sizeof(code));
+  EXPECT_EQ(stats.bytes_used + stats.bytes_free, stats.bytes_reserved);
+  EXPECT_EQ(stats.fragmentation, 0);
+
+  // A freed block is reused.
+  gta_code_arena_free(arena, second, sizeof(code));
+  gta_code_arena_get_stats(arena, &stats);
+  EXPECT_EQ(stats.allocations, 2);
+  EXPECT_GT(stats.fragmentation, 0);
+  void * reused = gta_code_arena_allocate(arena, code, sizeof(code));
+  EXPECT_EQ(reused, second);
+
+  // Code which is larger than a chunk is given its own chunk, which is
+  // unmapped when the code is freed.
+  std::string large(GTA_CODE_ARENA_CHUNK_SIZE + 1, '\xC3');
+  void * big = gta_code_arena_allocate(arena, large.data(), large.size());
+  ASSERT_TRUE(big);
+  gta_code_arena_get_stats(arena, &stats);
+  EXPECT_EQ(stats.chunks, 2);
+  gta_code_arena_free(arena, big, large.size());
+
+  // Freeing everything leaves a single empty chunk.
+  gta_code_arena_free(arena, first, sizeof(code));
+  gta_code_arena_free(arena, reused, sizeof(code));
+  gta_code_arena_free(arena, third, sizeof(code));
+  gta_code_arena_get_stats(arena, &stats);
+  EXPECT_EQ(stats.chunks, 1);
+  EXPECT_EQ(stats.allocations, 0);
+  EXPECT_EQ(stats.bytes_used, 0);
+  EXPECT_EQ(stats.bytes_free, stats.bytes_reserved);
+  EXPECT_EQ(stats.fragmentation, 0);
+
+  gta_code_arena_destroy(arena);
+}
+
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
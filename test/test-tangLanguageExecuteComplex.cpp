@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <cutil/memory.h>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 #include <unicode/uclean.h>
 
@@ -7,9 +9,13 @@
 #include <tang/macros.h>
 #include <tang/computedValue/computedValueAll.h>
 #include <tang/program/program.h>
+#include <tang/program/bundle.h>
 #include <tang/program/bytecode.h>
+#include <tang/program/bytecodeImage.h>
 #include <tang/program/executionContext.h>
+#include <tang/program/garbageCollector.h>
 #include <tang/program/variable.h>
+#include <tang/tangLanguage.h>
 #include <tang/unicodeString.h>
 
 using namespace std;
@@ -63,6 +69,12 @@ GTA_Language * language;
   TEST_REUSABLE_PROGRAM(code, GTA_PROGRAM_FLAG_IS_TEMPLATE); \
   TEST_CONTEXT_SETUP();
 
+#define TEST_BYTECODE_SETUP(code) \
+  TEST_REUSABLE_PROGRAM(code, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT); \
+  TEST_CONTEXT_SETUP(); \
+  ASSERT_TRUE(gta_program_execute(context)); \
+  ASSERT_TRUE(context->result);
+
 
 TEST(ControlFlow, IF) {
   {
@@ -76,7 +88,7 @@ TEST(ControlFlow, IF) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start true end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start true end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -90,7 +102,7 @@ TEST(ControlFlow, IF) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start false end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start false end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -102,7 +114,7 @@ TEST(ControlFlow, IF) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start true end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start true end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -114,7 +126,7 @@ TEST(ControlFlow, IF) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start  end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start  end");
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -131,7 +143,7 @@ TEST(ControlFlow, While) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 012 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 012 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -145,7 +157,7 @@ TEST(ControlFlow, While) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start  end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start  end");
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -162,7 +174,7 @@ TEST(ControlFlow, DoWhile) {
       } while (i < 3);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 012 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 012 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -176,7 +188,7 @@ TEST(ControlFlow, DoWhile) {
       } while (i < 3);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 3 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 3 end");
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -191,7 +203,7 @@ TEST(ControlFlow, For) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 012 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 012 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -203,7 +215,7 @@ TEST(ControlFlow, For) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start  end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start  end");
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -218,7 +230,7 @@ TEST(ControlFlow, RangedFor) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 012 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 012 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -230,11 +242,248 @@ TEST(ControlFlow, RangedFor) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start  end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start  end");
     TEST_PROGRAM_TEARDOWN();
   }
 }
 
+TEST(ControlFlow, RangedForArray) {
+  for (GTA_Program_Flags flags : {GTA_PROGRAM_FLAG_DEFAULT, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT}) {
+    {
+      // Break and continue.
+      TEST_REUSABLE_PROGRAM(R"(
+        for (x : [1, 2, 3, 4, 5]) {
+          if (x == 2) {
+            continue;
+          }
+          if (x == 4) {
+            break;
+          }
+          print(x);
+        }
+      )", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "13");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // Nested loops each keep their own position.
+      TEST_REUSABLE_PROGRAM(R"(
+        for (x : [1, 2]) {
+          for (y : ["a", "b"]) {
+            print(x);
+            print(y);
+          }
+        }
+      )", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "1a1b2a2b");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // The loop variable is a copy of the element, and the loop works
+      // within a function.
+      TEST_REUSABLE_PROGRAM(R"(
+        function total(a) {
+          t = 0;
+          for (x : a) {
+            t = t + x[0];
+            x[0] = 100;
+          }
+          return t;
+        }
+        a = [[1], [2], [3]];
+        print(total(a));
+        print(a[0][0]);
+      )", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "61");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // A value which cannot be iterated over skips the loop.
+      TEST_REUSABLE_PROGRAM(R"(for (x : 5) { print(x); } print("end");)", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "end");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+  }
+  {
+    // The bytecode iterates in place, without an iterator object.
+    TEST_BYTECODE_SETUP(R"(
+      t = 0;
+      for (x : [1, 2, 3]) {
+        t = t + x;
+      }
+      t;
+    )");
+    auto contains = [&](GTA_Bytecode opcode) {
+      for (size_t i = 0; i < program->bytecode->count; i += gta_bytecode_instruction_size(GTA_TYPEX_UI(program->bytecode->data[i]))) {
+        if (GTA_TYPEX_UI(program->bytecode->data[i]) == opcode) {
+          return true;
+        }
+      }
+      return false;
+    };
+    EXPECT_TRUE(contains(GTA_BYTECODE_ITERATOR_NEXT_LOCAL));
+    EXPECT_FALSE(contains(GTA_BYTECODE_ITERATOR));
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(context->result));
+    ASSERT_EQ(((GTA_Computed_Value_Integer *)context->result)->value, 6);
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(ControlFlow, RangedForMapAndString) {
+  for (GTA_Program_Flags flags : {GTA_PROGRAM_FLAG_DEFAULT, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT}) {
+    {
+      // A map yields [key, value] pairs in insertion order.
+      TEST_REUSABLE_PROGRAM(R"(
+        m = {b: 1, a: 2};
+        m["c"] = 3;
+        for (p : m) {
+          print(p[0]);
+          print(p[1]);
+        }
+      )", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "b1a2c3");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // A pair that is kept is not overwritten by the next step, and writing
+      // to a pair does not change the map.
+      TEST_REUSABLE_PROGRAM(R"(
+        m = {a: [1], b: [2]};
+        n = 0;
+        for (p : m) {
+          if (n == 0) {
+            first = p;
+          }
+          n = n + 1;
+          p[1][0] = 42;
+        }
+        print(first[0]);
+        print(m["a"][0]);
+        print(m["b"][0]);
+      )", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "a12");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // A string yields its graphemes.
+      TEST_REUSABLE_PROGRAM("for (g : \"ae\xCC\x81" "b\") { print(g); print(\"|\"); }", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "a|e\xCC\x81" "|b|");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // An empty string and an empty map yield nothing.
+      TEST_REUSABLE_PROGRAM(R"(for (g : "") { print(g); } for (p : {:}) { print(p); } print("end");)", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "end");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+  }
+}
+
+TEST(ControlFlow, RangedForRange) {
+  for (GTA_Program_Flags flags : {GTA_PROGRAM_FLAG_DEFAULT, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT}) {
+    {
+      // The range includes the start and excludes the end.
+      TEST_REUSABLE_PROGRAM(R"(for (i : 0..5) { print(i); })", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "01234");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // An empty range skips the loop.
+      TEST_REUSABLE_PROGRAM(R"(for (i : 5..2) { print(i); } print("end");)", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "end");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // The bounds may be expressions, and changing the loop variable does
+      // not change the sequence.
+      TEST_REUSABLE_PROGRAM(R"(
+        n = 3;
+        for (i : -1..n + 1) {
+          if (i == 0) {
+            continue;
+          }
+          if (i == 3) {
+            break;
+          }
+          print(i);
+          i = 10;
+        }
+      )", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "-112");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // Each value is distinct, and the loop works within a function.
+      TEST_REUSABLE_PROGRAM(R"(
+        function squares(n) {
+          a = [];
+          for (i : 0..n) {
+            a[i] = i * i;
+          }
+          return a;
+        }
+        print(squares(4));
+      )", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "[0, 1, 4, 9]");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // A range is a value.
+      TEST_REUSABLE_PROGRAM(R"(r = 2..4; print(r); for (i : r) { print(i); })", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "2..423");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // The bounds must be integers.
+      TEST_REUSABLE_PROGRAM(R"(1.5..3;)", flags);
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_EQ(context->result, gta_computed_value_error_range_bounds_not_integer);
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+  }
+}
+
 TEST(ControlFlow, Break) {
   {
     // Break in a while loop.
@@ -250,7 +499,7 @@ TEST(ControlFlow, Break) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 12 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 12 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -267,7 +516,7 @@ TEST(ControlFlow, Break) {
       } while (i < 4);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 12 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 12 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -282,7 +531,7 @@ TEST(ControlFlow, Break) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 01 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 01 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -294,7 +543,7 @@ TEST(ControlFlow, Break) {
     )");
     ASSERT_TRUE(context->result);
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_NULL(context->result));
-    ASSERT_STREQ(context->output->buffer, "start ");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start ");
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -314,7 +563,7 @@ TEST(ControlFlow, Continue) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 13 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 13 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -331,7 +580,7 @@ TEST(ControlFlow, Continue) {
       } while (i < 3);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 13 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 13 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -346,7 +595,7 @@ TEST(ControlFlow, Continue) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 02 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 02 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -358,7 +607,7 @@ TEST(ControlFlow, Continue) {
     )");
     ASSERT_TRUE(context->result);
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_NULL(context->result));
-    ASSERT_STREQ(context->output->buffer, "start ");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start ");
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -374,7 +623,7 @@ TEST(Function, Simple) {
       foo();
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start foo end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start foo end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -387,7 +636,7 @@ TEST(Function, Simple) {
       foo(1, 2);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 3 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 3 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -400,7 +649,7 @@ TEST(Function, Simple) {
       print(foo(1, 2));
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 3 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 3 end");
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -414,7 +663,7 @@ TEST(ControlFlowEdgeCases, Break) {
       break;
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start ");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start ");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -429,7 +678,7 @@ TEST(ControlFlowEdgeCases, Break) {
       foo();
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start foo end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start foo end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -455,7 +704,7 @@ TEST(ControlFlowEdgeCases, Break) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 01a end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 01a end");
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -469,7 +718,7 @@ TEST(ControlFlowEdgeCases, Continue) {
       continue;
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start ");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start ");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -484,7 +733,7 @@ TEST(ControlFlowEdgeCases, Continue) {
       foo();
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start foo end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start foo end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -510,7 +759,7 @@ TEST(ControlFlowEdgeCases, Continue) {
       }
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 13aa end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 13aa end");
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -531,7 +780,7 @@ TEST(VariableScope, Global) {
       print(a);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 121 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 121 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -550,7 +799,7 @@ TEST(VariableScope, Global) {
       print(a);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 1122 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 1122 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -567,7 +816,7 @@ TEST(VariableScope, Global) {
       print(a);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 122 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 122 end");
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -629,7 +878,7 @@ TEST(NativeFunction, Library) {
     ASSERT_TRUE(gta_library_add_library_from_string(context->library, "a", make_int_3));
     ASSERT_TRUE(gta_program_execute(context));
     ASSERT_TRUE(context->result);
-    ASSERT_STREQ(context->output->buffer, "start 3 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 3 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -643,7 +892,7 @@ TEST(NativeFunction, Library) {
     ASSERT_TRUE(gta_library_add_library_from_string(context->library, "a", make_add));
     ASSERT_TRUE(gta_program_execute(context));
     ASSERT_TRUE(context->result);
-    ASSERT_STREQ(context->output->buffer, "start 3 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 3 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -657,7 +906,7 @@ TEST(NativeFunction, Library) {
     ASSERT_TRUE(gta_library_add_library_from_string(context->library, "a", make_str_len));
     ASSERT_TRUE(gta_program_execute(context));
     ASSERT_TRUE(context->result);
-    ASSERT_STREQ(context->output->buffer, "start 3 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 3 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -670,7 +919,7 @@ TEST(NativeFunction, Library) {
     )");
     ASSERT_TRUE(gta_program_execute(context));
     ASSERT_TRUE(context->result);
-    ASSERT_STREQ(context->output->buffer, "start  end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start  end");
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -685,7 +934,7 @@ TEST(Attributes, String) {
       print("$\xF0\x9F\x8F\xB4\xF3\xA0\x81\xA7\xF3\xA0\x81\xA2\xF3\xA0\x81\xB3\xF3\xA0\x81\xA3\xF3\xA0\x81\xB4\xF3\xA0\x81\xBF.".length);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 3 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 3 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -695,7 +944,7 @@ TEST(Attributes, String) {
       print("$\xF0\x9F\x8F\xB4\xF3\xA0\x81\xA7\xF3\xA0\x81\xA2\xF3\xA0\x81\xB3\xF3\xA0\x81\xA3\xF3\xA0\x81\xB4\xF3\xA0\x81\xBF.".byte_length);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 30 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 30 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -705,7 +954,7 @@ TEST(Attributes, String) {
       print("a&b".html);
       print(" end");
     )");
-    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(context->output);
+    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(gta_execution_context_get_output(context));
     ASSERT_TRUE(rendered.buffer);
     ASSERT_STREQ(rendered.buffer, "start a&amp;b end");
     gcu_free(rendered.buffer);
@@ -718,7 +967,7 @@ TEST(Attributes, String) {
       print("a&b\"'".html.raw);
       print(" end");
     )");
-    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(context->output);
+    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(gta_execution_context_get_output(context));
     ASSERT_TRUE(rendered.buffer);
     ASSERT_STREQ(rendered.buffer, "start a&b\"' end");
     gcu_free(rendered.buffer);
@@ -731,7 +980,7 @@ TEST(Attributes, String) {
       print("a&b".html.render.html);
       print(" end");
     )");
-    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(context->output);
+    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(gta_execution_context_get_output(context));
     ASSERT_TRUE(rendered.buffer);
     ASSERT_STREQ(rendered.buffer, "start a&amp;amp;b end");
     gcu_free(rendered.buffer);
@@ -744,7 +993,7 @@ TEST(Attributes, String) {
       print("a&b\"'".html_attribute);
       print(" end");
     )");
-    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(context->output);
+    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(gta_execution_context_get_output(context));
     ASSERT_TRUE(rendered.buffer);
     ASSERT_STREQ(rendered.buffer, "start a&amp;b&quot;&#39; end");
     gcu_free(rendered.buffer);
@@ -757,7 +1006,7 @@ TEST(Attributes, String) {
       print("a & b".percent);
       print(" end");
     )");
-    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(context->output);
+    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(gta_execution_context_get_output(context));
     ASSERT_TRUE(rendered.buffer);
     ASSERT_STREQ(rendered.buffer, "start a+%26+b end");
     gcu_free(rendered.buffer);
@@ -770,7 +1019,7 @@ TEST(Attributes, String) {
       print("a&b\"'\n".javascript);
       print(" end");
     )");
-    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(context->output);
+    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(gta_execution_context_get_output(context));
     ASSERT_TRUE(rendered.buffer);
     ASSERT_STREQ(rendered.buffer, "start a\\u0026b\\\"\\'\\n end");
     gcu_free(rendered.buffer);
@@ -787,7 +1036,7 @@ TEST(Attributes, Array) {
       print([].size);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 0 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 0 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -797,7 +1046,7 @@ TEST(Attributes, Array) {
       print([1, 2, 3].size);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 3 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 3 end");
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -808,11 +1057,46 @@ TEST(Attributes, Array) {
       print(a[-2:].size);
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 2 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 2 end");
     TEST_PROGRAM_TEARDOWN();
   }
 }
 
+static GTA_Computed_Value * GTA_CALL string_size(GTA_MAYBE_UNUSED(GTA_Computed_Value * self), GTA_MAYBE_UNUSED(GTA_Execution_Context * context)) {
+  return gta_computed_value_boolean_true;
+}
+
+TEST(Attributes, InlineCache) {
+  for (GTA_Program_Flags flags : {GTA_PROGRAM_FLAG_DEFAULT, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT}) {
+    // A single call site sees several types, only some of which have the
+    // attribute.  The program is executed more than once, so that the second
+    // execution uses the filled caches.
+    TEST_REUSABLE_PROGRAM(R"(
+      values = [[1], "ab", 3, [1, 2], 1.5, true, null, [1, 2, 3]];
+      for (v : values) {
+        print(v.size);
+        print(",");
+      }
+    )", flags);
+    for (int i = 0; i < 2; ++i) {
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "1,,,2,,,,3,");
+      TEST_CONTEXT_TEARDOWN();
+    }
+
+    // Changing an attribute invalidates the caches.
+    ASSERT_TRUE(gta_program_set_type_attribute(program, &gta_computed_value_string_vtable, GTA_STRING_HASH("size", 4), string_size));
+    {
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "1,true,,2,,,,3,");
+      TEST_CONTEXT_TEARDOWN();
+    }
+    TEST_REUSABLE_PROGRAM_TEARDOWN();
+  }
+}
+
 TEST(Recursion, Fibonacci) {
   {
     // Fibonacci sequence.
@@ -830,9 +1114,1076 @@ TEST(Recursion, Fibonacci) {
       print(fib(10));
       print(" end");
     )");
-    ASSERT_STREQ(context->output->buffer, "start 55 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 55 end");
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(Binary, UnboxedArithmetic) {
+  {
+    // Integer arithmetic and comparisons on variables and literals are
+    // computed in registers, and only the result is boxed.
+    TEST_PROGRAM_SETUP(R"(
+      b = 0;
+      for (i = 0; i < 10; i = i + 1) {
+        if (i * 3 - 2 >= 7 && i != 8) {
+          b = b + (i - 1) * 2;
+        }
+      }
+      b;
+    )");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(context->result));
+    ASSERT_EQ(((GTA_Computed_Value_Integer *)context->result)->value, 56);
     TEST_PROGRAM_TEARDOWN();
   }
+  {
+    // Float arithmetic, including integer literals in a float expression.
+    TEST_PROGRAM_SETUP(R"(
+      x = 0.5;
+      for (i = 0; i < 4; i = i + 1) {
+        x = x * 2.0 - 0.25;
+      }
+      print(x + 1);
+      print(" ");
+      print(x < 5.5);
+      print(" ");
+      print(x <= 4.25);
+      print(" ");
+      print(x == 4.25);
+      print(" ");
+      print(2.5 > x);
+    )");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "5.250000 true true true false");
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // The guards fall back to the generic operations when a variable does not
+    // hold the expected type.
+    TEST_PROGRAM_SETUP(R"(
+      a = 1.5;
+      b = 2;
+      print(a * 2 + 1);
+      print(" ");
+      print(b * 1.5);
+      print(" ");
+      print(a < 2);
+      print(" ");
+      print(b == 2.0);
+      print(" ");
+      print(b - 3 + a);
+    )");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "4.000000 3.000000 true true 0.500000");
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(Binary, RegisterCache) {
+  {
+    // The loop variables of both the program and the function are held in
+    // registers.  The function uses the same registers and assigns to a
+    // global that the program holds in a register, so the program must
+    // reload its registers after each call.
+    TEST_PROGRAM_SETUP(R"(
+      total = 0;
+      function sum(n) {
+        global total;
+        s = 0;
+        for (i = 0; i < n; i = i + 1) {
+          s = s + i;
+        }
+        total = total + s;
+        return s;
+      }
+      for (j = 1; j <= 4; j = j + 1) {
+        print(sum(j));
+        print(" ");
+        print(total);
+        print(" ");
+      }
+    )");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "0 0 1 1 3 4 6 10 ");
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // The ranged-for variable is written through to its register.
+    TEST_PROGRAM_SETUP(R"(
+      sum = 0;
+      for (x : [1, 2, 3]) {
+        sum = sum + x * 2;
+      }
+      sum;
+    )");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(context->result));
+    ASSERT_EQ(((GTA_Computed_Value_Integer *)context->result)->value, 12);
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(Bytecode, ImmediateIntegers) {
+  {
+    // Integer arithmetic and comparisons in the VM.
+    TEST_BYTECODE_SETUP(R"(
+      a = 7;
+      b = a * 6 - 2;
+      print(b / 4);
+      print(" ");
+      print(b % 4);
+      print(" ");
+      print(-a < a);
+      print(" ");
+      print(a + 0.5);
+    )");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "10 0 true 7.500000");
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Results that do not fit in an immediate are boxed.
+    TEST_BYTECODE_SETUP(R"(
+      a = 4611686018427387903;
+      a + a;
+    )");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(context->result));
+    ASSERT_EQ(((GTA_Computed_Value_Integer *)context->result)->value, 9223372036854775806);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Integers escaping into an array are boxed.
+    TEST_BYTECODE_SETUP(R"(
+      a = 3;
+      [a, a + 1];
+    )");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_ARRAY(context->result));
+    GTA_Computed_Value_Array * array = (GTA_Computed_Value_Array *)context->result;
+    ASSERT_EQ(array->elements->count, 2);
+    GTA_Computed_Value * value = (GTA_Computed_Value *)GTA_TYPEX_P(array->elements->data[1]);
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(value));
+    ASSERT_EQ(((GTA_Computed_Value_Integer *)value)->value, 4);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Fibonacci, which returns immediates through function calls.
+    TEST_BYTECODE_SETUP(R"(
+      function fib(n) {
+        if (n <= 2) {
+          return 1;
+        }
+        return fib(n - 1) + fib(n - 2);
+      }
+      fib(20);
+    )");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(context->result));
+    ASSERT_EQ(((GTA_Computed_Value_Integer *)context->result)->value, 6765);
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(Bytecode, ImmediateFloats) {
+  auto contains = [](GTA_Program * program, GTA_Bytecode opcode) {
+    for (size_t i = 0; i < program->bytecode->count; ++i) {
+      if (GTA_TYPEX_UI(program->bytecode->data[i]) == opcode) {
+        return true;
+      }
+    }
+    return false;
+  };
+  {
+    // Float arithmetic, mixed with integers, and comparisons in the VM.
+    TEST_BYTECODE_SETUP(R"(
+      a = 1.5;
+      b = a * 2 - 0.25;
+      print(b / 2);
+      print(" ");
+      print(-a);
+      print(" ");
+      print(3 / a);
+      print(" ");
+      print(a < 2);
+      print(" ");
+      print(2.0 >= a);
+      print(" ");
+      print(a == 1.5);
+      print(" ");
+      print(!(a - a));
+    )");
+    EXPECT_TRUE(contains(program, GTA_BYTECODE_FLOAT));
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "1.375000 -1.500000 2.000000 true true true true");
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Floats in a loop, including increments fused by the optimizer and
+    // elements of an array.
+    TEST_BYTECODE_SETUP(R"(
+      x = 0.5;
+      for (i = 0; i < 10; i = i + 1) {
+        x = x + 1;
+      }
+      for (y : [0.25, 0.125]) {
+        x = x + y;
+      }
+      x;
+    )");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_FLOAT(context->result));
+    ASSERT_EQ(((GTA_Computed_Value_Float *)context->result)->value, 10.875);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Division by zero is still reported.
+    TEST_BYTECODE_SETUP(R"(
+      a = 1.5;
+      b = 0.0;
+      a / b;
+    )");
+    ASSERT_EQ(context->result, gta_computed_value_error_divide_by_zero);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Floats that are too large for an immediate are boxed, both as literals
+    // and as results.
+    TEST_BYTECODE_SETUP(R"(
+      a = 100000000000000000000000000000000000000000000000000000000000000000000000000000000000000.0;
+      b = 4611686018427387904.0;
+      c = b * b * b * b * b;
+      print(a > c);
+      print(" ");
+      print(c / b / b / b / b);
+      [c, c * 0.5];
+    )");
+    EXPECT_TRUE(contains(program, GTA_BYTECODE_LOAD));
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "false 4611686018427387904.000000");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_ARRAY(context->result));
+    GTA_Computed_Value_Array * array = (GTA_Computed_Value_Array *)context->result;
+    ASSERT_EQ(array->elements->count, 2);
+    GTA_Computed_Value * value = (GTA_Computed_Value *)GTA_TYPEX_P(array->elements->data[1]);
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_FLOAT(value));
+    ASSERT_EQ(((GTA_Computed_Value_Float *)value)->value, ldexp(1, 309));
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(Bytecode, SpecializedOpcodes) {
+  {
+    // Boolean-specialized jumps are used when the condition is known to be a
+    // boolean.
+    TEST_BYTECODE_SETUP(R"(
+      b = 0;
+      for (i = 0; i < 10; i = i + 1) {
+        if (!(i == 5)) {
+          b = b + i;
+        }
+      }
+      b;
+    )");
+    auto contains = [&](GTA_Bytecode opcode) {
+      for (size_t i = 0; i < program->bytecode->count; ++i) {
+        if (GTA_TYPEX_UI(program->bytecode->data[i]) == opcode) {
+          return true;
+        }
+      }
+      return false;
+    };
+    EXPECT_TRUE(contains(GTA_BYTECODE_JMPF_BOOLEAN));
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(context->result));
+    ASSERT_EQ(((GTA_Computed_Value_Integer *)context->result)->value, 40);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // The immediate integer fast paths fall back to the generic operations
+    // when an operand is not an immediate integer.
+    TEST_BYTECODE_SETUP(R"(
+      a = 1.5;
+      b = 4611686018427387904;
+      print(a + 1);
+      print(" ");
+      print(a < 2);
+      print(" ");
+      print(b - 1);
+      print(" ");
+      print(1 != b);
+    )");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "2.500000 true 4611686018427387903 true");
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(Bytecode, IntegerOpcodes) {
+  {
+    // Loop counters (and the variables which are only assigned sums of them)
+    // are proven to be integers, both at the top level and within a function.
+    TEST_BYTECODE_SETUP(R"(
+      function triangle(n) {
+        t = 0;
+        for (k = 0; k < n; k = k + 1) {
+          t = t + k;
+        }
+        return t;
+      }
+      s = 0;
+      for (i = 0; i < 10; i = i + 1) {
+        for (j = 0; j < i; j = j + 1) {
+          s = s + j;
+        }
+      }
+      s + triangle(4);
+    )");
+    testing::internal::CaptureStdout();
+    gta_bytecode_print(program->bytecode);
+    std::string dump = testing::internal::GetCapturedStdout();
+    EXPECT_NE(dump.find("LESS_THAN_INT_INT"), std::string::npos) << dump;
+    EXPECT_NE(dump.find("ADD_INT_INT"), std::string::npos) << dump;
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(context->result));
+    ASSERT_EQ(((GTA_Computed_Value_Integer *)context->result)->value, 126);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // A variable which may be read before it is assigned, or which is
+    // assigned something other than an integer, is not specialized.
+    TEST_BYTECODE_SETUP(R"(
+      a = 0;
+      for (i : [0, 1, 2]) {
+        a = a + 1;
+        if (i == 1) {
+          a = 0.5;
+        }
+      }
+      b = 1;
+      while (b < 5) {
+        if (b > 1) {
+          b = b + c;
+        }
+        c = 1;
+        b = b + 1;
+      }
+      a + b;
+    )");
+    auto contains = [&](GTA_Bytecode opcode) {
+      for (size_t i = 0; i < program->bytecode->count; ++i) {
+        if (GTA_TYPEX_UI(program->bytecode->data[i]) == opcode) {
+          return true;
+        }
+      }
+      return false;
+    };
+    EXPECT_FALSE(contains(GTA_BYTECODE_ADD_INT_INT));
+    EXPECT_FALSE(contains(GTA_BYTECODE_LESS_THAN_INT_INT));
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_FLOAT(context->result));
+    ASSERT_EQ(((GTA_Computed_Value_Float *)context->result)->value, 7.5);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // A proven integer may still be boxed, in which case the specialized
+    // opcodes fall back to the generic operations.
+    TEST_BYTECODE_SETUP(R"(
+      a = 3074457345618258602;
+      b = 0;
+      for (i = 0; i < 3; i = i + 1) {
+        b = b + a;
+      }
+      print(b);
+      print(" ");
+      print(b - 1 < b);
+    )");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "9223372036854775806 true");
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(Bytecode, Superinstructions) {
+  {
+    // Loop counters are incremented and tested in place, both at the top
+    // level and within a function.
+    TEST_BYTECODE_SETUP(R"(
+      function sum(n) {
+        total = 0;
+        for (j = 0; j < 5; j = j + 1) {
+          total = total + n;
+        }
+        return total;
+      }
+      b = 0;
+      for (i = 0; i < 10; i = i + 1) {
+        b = b + sum(i);
+      }
+      b;
+    )");
+    auto contains = [&](GTA_Bytecode opcode) {
+      for (size_t i = 0; i < program->bytecode->count; i += gta_bytecode_instruction_size(GTA_TYPEX_UI(program->bytecode->data[i]))) {
+        if (GTA_TYPEX_UI(program->bytecode->data[i]) == opcode) {
+          return true;
+        }
+      }
+      return false;
+    };
+    EXPECT_TRUE(contains(GTA_BYTECODE_INC_LOCAL_IMM));
+    EXPECT_TRUE(contains(GTA_BYTECODE_CMP_LOCAL_IMM_JMPF));
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(context->result));
+    ASSERT_EQ(((GTA_Computed_Value_Integer *)context->result)->value, 225);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // The superinstructions fall back to the generic operations when the
+    // local variable is not an immediate integer.
+    TEST_BYTECODE_SETUP(R"(
+      a = 0.5;
+      while (a < 3) {
+        a = a + 1;
+      }
+      print(a);
+    )");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "3.500000");
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(Bytecode, Image) {
+  const char * code = R"(
+    use math;
+    function add(a, b) {
+      return a + b;
+    }
+    s = "héllo";
+    print(add(1, 2));
+    print(" ");
+    print(s.length);
+    print(" ");
+    print(add(1.5, 0.25));
+    print(" ");
+    print(4611686018427387904 - 1);
+    print(" ");
+    print(math.pi > 3);
+    print(" ");
+    print(("7" as int) + 1);
+    s;
+  )";
+  const char * expected = "3 5 1.750000 4611686018427387903 true 8";
+  std::string path = ::testing::TempDir() + "tang-bytecode-image.tbc";
+  {
+    // A saved program produces the same output as the original when loaded.
+    TEST_REUSABLE_PROGRAM(code, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT);
+    ASSERT_TRUE(gta_program_save(program, path.c_str()));
+    TEST_REUSABLE_PROGRAM_TEARDOWN();
+  }
+  {
+    gcu_memory_reset_counts();
+    GTA_Program * program = gta_program_load(language, path.c_str(), GTA_PROGRAM_FLAG_DEFAULT);
+    ASSERT_TRUE(program);
+    size_t alloc_count = gcu_get_alloc_count();
+    size_t free_count = gcu_get_free_count();
+    EXPECT_FALSE(program->ast);
+    EXPECT_FALSE(program->binary);
+    ASSERT_TRUE(program->bytecode);
+    for (int i = 0; i < 2; ++i) {
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, expected);
+      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_STRING(context->result));
+      ASSERT_STREQ(((GTA_Computed_Value_String *)context->result)->value->buffer, "héllo");
+      TEST_CONTEXT_TEARDOWN();
+    }
+    TEST_REUSABLE_PROGRAM_TEARDOWN();
+  }
+  std::remove(path.c_str());
+  {
+    // A program can be loaded from an image in memory, and a corrupt image
+    // is rejected.
+    TEST_REUSABLE_PROGRAM(code, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT);
+    GCU_Vector64 * image = gta_bytecode_image_create(program);
+    ASSERT_TRUE(image);
+    size_t length = image->count * sizeof(GCU_Type64_Union);
+    GTA_Program * loaded = gta_program_create_from_image(language, image->data, length, GTA_PROGRAM_FLAG_DEFAULT);
+    ASSERT_TRUE(loaded);
+    GTA_Execution_Context * context = gta_execution_context_create(loaded);
+    ASSERT_TRUE(context);
+    ASSERT_TRUE(gta_program_execute(context));
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, expected);
+    gta_execution_context_destroy(context);
+    gta_program_destroy(loaded);
+    EXPECT_FALSE(gta_program_create_from_image(language, image->data, length - sizeof(GCU_Type64_Union), GTA_PROGRAM_FLAG_DEFAULT));
+    image->data[0].ui64 = 0;
+    EXPECT_FALSE(gta_program_create_from_image(language, image->data, length, GTA_PROGRAM_FLAG_DEFAULT));
+    gcu_vector64_destroy(image);
+    TEST_REUSABLE_PROGRAM_TEARDOWN();
+  }
+  {
+    // Templates remain templates.
+    TEST_REUSABLE_PROGRAM("a<%= 1 + 2 %>b", GTA_PROGRAM_FLAG_IS_TEMPLATE | GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT);
+    GCU_Vector64 * image = gta_bytecode_image_create(program);
+    ASSERT_TRUE(image);
+    GTA_Program * loaded = gta_program_create_from_image(language, image->data, image->count * sizeof(GCU_Type64_Union), GTA_PROGRAM_FLAG_DEFAULT);
+    ASSERT_TRUE(loaded);
+    EXPECT_TRUE(loaded->flags & GTA_PROGRAM_FLAG_IS_TEMPLATE);
+    GTA_Execution_Context * context = gta_execution_context_create(loaded);
+    ASSERT_TRUE(context);
+    ASSERT_TRUE(gta_program_execute(context));
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "a3b");
+    gta_execution_context_destroy(context);
+    gta_program_destroy(loaded);
+    gcu_vector64_destroy(image);
+    TEST_REUSABLE_PROGRAM_TEARDOWN();
+  }
+  {
+    // A program without bytecode cannot be saved.
+    TEST_REUSABLE_PROGRAM("print(1);", GTA_PROGRAM_FLAG_DEFAULT);
+    if (!program->bytecode) {
+      EXPECT_FALSE(gta_bytecode_image_create(program));
+      EXPECT_FALSE(gta_program_save(program, path.c_str()));
+    }
+    TEST_REUSABLE_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(Bytecode, Bundle) {
+  std::string path = ::testing::TempDir() + "tang-bundle.tbb";
+  const GTA_Program_Flags flags = GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT;
+  {
+    // Build a bundle of several programs.
+    GTA_Bundle_Builder * builder = gta_bundle_builder_create();
+    ASSERT_TRUE(builder);
+    GTA_Program * script = gta_program_create_with_flags(language, R"(print("script");)", flags);
+    GTA_Program * page = gta_program_create_with_flags(language, "<p><%= 6 * 7 %></p>", flags | GTA_PROGRAM_FLAG_IS_TEMPLATE);
+    GTA_Program * function = gta_program_create_with_flags(language, R"(
+      function f(n) {
+        return n < 2 ? n : f(n - 1) + f(n - 2);
+      }
+      print(f(10));
+    )", flags);
+    ASSERT_TRUE(script);
+    ASSERT_TRUE(page);
+    ASSERT_TRUE(function);
+    EXPECT_TRUE(gta_bundle_builder_add(builder, "script", script));
+    EXPECT_TRUE(gta_bundle_builder_add(builder, "templates/page", page));
+    EXPECT_FALSE(gta_bundle_builder_add(builder, "script", function));
+    GCU_Vector64 * image = gta_bytecode_image_create(function);
+    ASSERT_TRUE(image);
+    EXPECT_TRUE(gta_bundle_builder_add_image(builder, "function", image->data, image->count * sizeof(GCU_Type64_Union)));
+    gcu_vector64_destroy(image);
+    gta_program_destroy(script);
+    gta_program_destroy(page);
+    gta_program_destroy(function);
+    ASSERT_TRUE(gta_bundle_builder_save(builder, path.c_str()));
+    gta_bundle_builder_destroy(builder);
+  }
+  {
+    // Each program can be loaded by name from the mapped bundle.
+    GTA_Bundle * bundle = gta_bundle_create(path.c_str());
+    ASSERT_TRUE(bundle);
+    EXPECT_EQ(gta_bundle_count(bundle), 3);
+    EXPECT_TRUE(gta_bundle_contains(bundle, "templates/page"));
+    EXPECT_FALSE(gta_bundle_contains(bundle, "templates"));
+    EXPECT_FALSE(gta_bundle_load_program(bundle, language, "missing", GTA_PROGRAM_FLAG_DEFAULT));
+    size_t found = 0;
+    for (size_t i = 0; i < gta_bundle_count(bundle); ++i) {
+      size_t length;
+      const char * name = gta_bundle_get_name(bundle, i, &length);
+      found += std::string(name, length) == "function";
+    }
+    EXPECT_EQ(found, 1);
+
+    std::pair<const char *, const char *> expected[] = {
+      {"script", "script"},
+      {"templates/page", "<p>42</p>"},
+      {"function", "55"},
+    };
+    for (auto & [name, output] : expected) {
+      gcu_memory_reset_counts();
+      GTA_Program * program = gta_bundle_load_program(bundle, language, name, GTA_PROGRAM_FLAG_DEFAULT);
+      ASSERT_TRUE(program);
+      size_t alloc_count = gcu_get_alloc_count();
+      size_t free_count = gcu_get_free_count();
+      TEST_CONTEXT_SETUP();
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, output);
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    gta_bundle_destroy(bundle);
+  }
+  {
+    // A loaded program uses the bytecode and the string literals of the
+    // mapped file in place, and keeps the file mapped after the bundle has
+    // been destroyed.
+    GTA_Bundle * bundle = gta_bundle_create(path.c_str());
+    ASSERT_TRUE(bundle);
+    GTA_Program * program = gta_bundle_load_program(bundle, language, "script", GTA_PROGRAM_FLAG_DEFAULT);
+    ASSERT_TRUE(program);
+    gta_bundle_destroy(bundle);
+    EXPECT_EQ(program->bundle, bundle);
+    ASSERT_TRUE(program->bytecode);
+    if (sizeof(GTA_TypeX_Union) == sizeof(uint64_t)) {
+      EXPECT_NE((void *)program->bytecode->data, (void *)(program->bytecode + 1));
+    }
+    size_t strings = 0;
+    for (size_t i = 0; i < program->constants->count; ++i) {
+      GTA_Computed_Value * value = (GTA_Computed_Value *)GTA_TYPEX_P(program->constants->data[i]);
+      if (value && GTA_COMPUTED_VALUE_IS_STRING(value)) {
+        EXPECT_TRUE(((GTA_Computed_Value_String *)value)->value->is_borrowed);
+        ++strings;
+      }
+    }
+    EXPECT_EQ(strings, 1);
+    GTA_Execution_Context * context = gta_execution_context_create(program);
+    ASSERT_TRUE(context);
+    ASSERT_TRUE(gta_program_execute(context));
+    EXPECT_STREQ(gta_execution_context_get_output(context)->buffer, "script");
+    gta_execution_context_destroy(context);
+    gta_program_destroy(program);
+  }
+  std::remove(path.c_str());
+  EXPECT_FALSE(gta_bundle_create(path.c_str()));
+}
+
+TEST(Tiered, Execution) {
+  const GTA_Program_Flags flags = GTA_PROGRAM_FLAG_TIERED | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT;
+  size_t threshold = language->jit_threshold;
+  language->jit_threshold = 3;
+
+  // Whether or not the JIT is available on this platform.
+  GTA_Program * probe = gta_program_create_with_flags(language, "1;", GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT);
+  ASSERT_TRUE(probe);
+  bool has_binary = probe->binary;
+  gta_program_destroy(probe);
+
+  auto run = [](GTA_Program * program, const char * expected) {
+    GTA_Execution_Context * context = gta_execution_context_create(program);
+    ASSERT_TRUE(context);
+    ASSERT_TRUE(gta_program_execute(context));
+    EXPECT_STREQ(gta_execution_context_get_output(context)->buffer, expected);
+    gta_execution_context_destroy(context);
+  };
+  {
+    // The program is compiled once it has been executed enough times.
+    gcu_memory_reset_counts();
+    GTA_Program * program = gta_program_create_with_flags(language, R"(
+      function twice(n) {
+        return n * 2;
+      }
+      print(twice(21));
+    )", flags);
+    ASSERT_TRUE(program);
+    ASSERT_TRUE(program->bytecode);
+    EXPECT_EQ(program->tier, GTA_PROGRAM_TIER_WARMING);
+    for (size_t i = 1; i < 3; ++i) {
+      run(program, "42");
+      EXPECT_FALSE(program->binary);
+    }
+    run(program, "42");
+    EXPECT_EQ(program->tier, GTA_PROGRAM_TIER_FINAL);
+    EXPECT_EQ((bool)program->binary, has_binary);
+    run(program, "42");
+    gta_program_destroy(program);
+    EXPECT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
+  }
+  {
+    // A hot function makes the program hot, and it is compiled the next time
+    // that it is executed.
+    GTA_Program * program = gta_program_create_with_flags(language, R"(
+      function twice(n) {
+        return n * 2;
+      }
+      total = 0;
+      for (i = 0; i < 5; i = i + 1) {
+        total = total + twice(i);
+      }
+      print(total);
+    )", flags);
+    ASSERT_TRUE(program);
+    run(program, "20");
+    EXPECT_EQ(program->tier, GTA_PROGRAM_TIER_HOT);
+    EXPECT_FALSE(program->binary);
+    run(program, "20");
+    EXPECT_EQ(program->tier, GTA_PROGRAM_TIER_FINAL);
+    EXPECT_EQ((bool)program->binary, has_binary);
+    run(program, "20");
+    gta_program_destroy(program);
+  }
+  {
+    // Tiering does nothing if the binary is disabled.
+    GTA_Program * program = gta_program_create_with_flags(language, "print(1);", flags | GTA_PROGRAM_FLAG_DISABLE_BINARY);
+    ASSERT_TRUE(program);
+    EXPECT_EQ(program->tier, GTA_PROGRAM_TIER_FINAL);
+    for (size_t i = 0; i < 5; ++i) {
+      run(program, "1");
+    }
+    EXPECT_FALSE(program->binary);
+    gta_program_destroy(program);
+  }
+
+  language->jit_threshold = threshold;
+}
+
+TEST(Simplify, Execution) {
+  const GTA_Program_Flags flags[] = {
+    GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT,
+    GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT | GTA_PROGRAM_FLAG_DISABLE_SIMPLIFY,
+  };
+  auto run = [](const char * code, GTA_Program_Flags flags, const char * expected) {
+    gcu_memory_reset_counts();
+    GTA_Program * program = gta_program_create_with_flags(language, code, flags);
+    ASSERT_TRUE(program);
+    GTA_Execution_Context * context = gta_execution_context_create(program);
+    ASSERT_TRUE(context);
+    ASSERT_TRUE(gta_program_execute(context));
+    EXPECT_STREQ(gta_execution_context_get_output(context)->buffer, expected);
+    gta_execution_context_destroy(context);
+    gta_program_destroy(program);
+    EXPECT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
+  };
+  for (GTA_Program_Flags flag : flags) {
+    // Constant expressions and known variables.
+    run(R"(
+      width = 4;
+      print(width * 2 + 1);
+    )", flag, "9");
+    // A global that a function changes is not propagated.
+    run(R"(
+      a = 1;
+      function increment() {
+        global a;
+        a = a + 1;
+      }
+      increment();
+      print(a);
+      while (a < 5) {
+        increment();
+      }
+      print(a);
+    )", flag, "25");
+    // `&&` and `||` result in one of their operands.
+    run(R"(
+      print(1 && 2);
+      print(0 || "b");
+      print(0 && 3);
+    )", flag, "2b0");
+    // A skipped assignment does not change the variable.
+    run(R"(
+      x = 3;
+      1 || (x = 2);
+      print(x);
+    )", flag, "3");
+  }
+  {
+    // The constant expression is folded unless simplification is disabled.
+    GTA_Program * simplified = gta_program_create_with_flags(language, "print(2 * 3 + 1);", flags[0]);
+    GTA_Program * original = gta_program_create_with_flags(language, "print(2 * 3 + 1);", flags[1]);
+    ASSERT_TRUE(simplified);
+    ASSERT_TRUE(original);
+    EXPECT_EQ(gta_tang_node_count(simplified->ast) + 4, gta_tang_node_count(original->ast));
+    gta_program_destroy(simplified);
+    gta_program_destroy(original);
+  }
+}
+
+TEST(Execute, OutputChunks) {
+  for (GTA_Program_Flags flags : {GTA_PROGRAM_FLAG_DEFAULT, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT}) {
+    // Each print is kept as a separate chunk until the output is requested.
+    TEST_REUSABLE_PROGRAM(R"(
+      for (i = 0; i < 1000; i = i + 1) {
+        print(i % 10);
+      }
+    )", flags);
+    TEST_CONTEXT_SETUP();
+    ASSERT_TRUE(gta_program_execute(context));
+    ASSERT_EQ(context->output->count, 1000);
+    ASSERT_EQ(context->output_byte_length, 1000);
+    GTA_Unicode_String * output = gta_execution_context_get_output(context);
+    ASSERT_TRUE(output);
+    ASSERT_EQ(output->byte_length, 1000);
+    ASSERT_EQ(string(output->buffer, 10), "0123456789");
+    ASSERT_EQ(context->output->count, 1);
+    // Requesting the output again does not combine anything.
+    ASSERT_EQ(gta_execution_context_get_output(context), output);
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+static bool collect_output(void * sink_data, const char * buffer, size_t length) {
+  ((vector<string> *)sink_data)->emplace_back(buffer, length);
+  return true;
+}
+
+TEST(Execute, OutputSink) {
+  for (GTA_Program_Flags flags : {GTA_PROGRAM_FLAG_DEFAULT, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT}) {
+    // Rendered output is passed to the sink in buffer-sized pieces, and
+    // output which is larger than the buffer bypasses it.
+    TEST_REUSABLE_PROGRAM(R"(
+      for (i = 0; i < 10; i = i + 1) {
+        print(i);
+        print(!"<b>");
+      }
+      print("0123456789abcdefghij");
+    )", flags);
+    TEST_CONTEXT_SETUP();
+    vector<string> chunks;
+    ASSERT_TRUE(gta_execution_context_set_output_sink(context, collect_output, &chunks, 16));
+    ASSERT_TRUE(gta_program_execute(context));
+    ASSERT_EQ(context->output->count, 0);
+    ASSERT_GT(chunks.size(), 1);
+    string output;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      if (i + 1 < chunks.size()) {
+        EXPECT_LE(chunks[i].size(), 16);
+      }
+      output += chunks[i];
+    }
+    EXPECT_EQ(chunks.back(), "0123456789abcdefghij");
+    string expected;
+    for (int i = 0; i < 10; ++i) {
+      expected += to_string(i) + "&lt;b&gt;";
+    }
+    expected += "0123456789abcdefghij";
+    EXPECT_EQ(output, expected);
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+static bool fail_output(void *, const char *, size_t) {
+  return false;
+}
+
+TEST(Execute, OutputSinkFailure) {
+  for (GTA_Program_Flags flags : {GTA_PROGRAM_FLAG_DEFAULT, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT}) {
+    // A failing sink is reported with its own error, not as out of memory.
+    TEST_REUSABLE_PROGRAM(R"(
+      print("abc");
+    )", flags);
+    TEST_CONTEXT_SETUP();
+    ASSERT_TRUE(gta_execution_context_set_output_sink(context, fail_output, 0, 0));
+    ASSERT_TRUE(gta_program_execute(context));
+    EXPECT_EQ(context->result, gta_computed_value_error_output_sink_failed);
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(Execute, Reset) {
+  for (GTA_Program_Flags flags : {GTA_PROGRAM_FLAG_DEFAULT, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT}) {
+    // A reset context can execute the program again, and keeps the memory
+    // that it has already allocated.
+    TEST_REUSABLE_PROGRAM(R"(
+      a = [1, 2, 3];
+      for (i = 0; i < 3; i = i + 1) {
+        print(a[i]);
+      }
+      a;
+    )", flags);
+    TEST_CONTEXT_SETUP();
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_ARRAY(context->result));
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "123");
+      size_t stack_capacity = context->stack->capacity;
+      size_t gc_capacity = context->garbage_collection->capacity;
+      gta_execution_context_reset(context);
+      EXPECT_FALSE(context->result);
+      EXPECT_EQ(context->output->count, 0);
+      EXPECT_EQ(context->output_byte_length, 0);
+      EXPECT_EQ(context->garbage_collection->count, 0);
+      EXPECT_EQ(context->gc_bytes_live, 0);
+      EXPECT_EQ(context->stack->count, 0);
+      EXPECT_EQ(context->stack->capacity, stack_capacity);
+      EXPECT_EQ(context->garbage_collection->capacity, gc_capacity);
+    }
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Output which is still buffered for the sink is flushed, not lost.
+    TEST_REUSABLE_PROGRAM(R"(print("a");)", GTA_PROGRAM_FLAG_DEFAULT);
+    TEST_CONTEXT_SETUP();
+    vector<string> chunks;
+    ASSERT_TRUE(gta_execution_context_set_output_sink(context, collect_output, &chunks, 16));
+    ASSERT_FALSE(gta_execution_context_output_append(context, gta_unicode_string_create("abc", 3, GTA_UNICODE_STRING_TYPE_TRUSTED)));
+    EXPECT_TRUE(chunks.empty());
+    gta_execution_context_reset(context);
+    ASSERT_EQ(chunks.size(), 1);
+    EXPECT_EQ(chunks[0], "abc");
+    EXPECT_EQ(context->output_sink_buffer_length, 0);
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(Execute, ContextPool) {
+  TEST_REUSABLE_PROGRAM(R"(print("a");)", GTA_PROGRAM_FLAG_DEFAULT);
+  GTA_Program * other = gta_program_create(language, R"(print("b");)");
+  ASSERT_TRUE(other);
+  gcu_memory_reset_counts();
+  {
+    // A released context is handed out again for the same program only.
+    GTA_Execution_Context * context = gta_execution_context_pool_acquire(program);
+    ASSERT_TRUE(context);
+    ASSERT_TRUE(gta_program_execute(context));
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "a");
+    gta_execution_context_pool_release(context);
+
+    GTA_Execution_Context * other_context = gta_execution_context_pool_acquire(other);
+    ASSERT_TRUE(other_context);
+    EXPECT_NE(other_context, context);
+    EXPECT_EQ(other_context->program, other);
+
+    GTA_Execution_Context * reused = gta_execution_context_pool_acquire(program);
+    EXPECT_EQ(reused, context);
+    EXPECT_EQ(reused->output->count, 0);
+    ASSERT_TRUE(gta_program_execute(reused));
+    ASSERT_STREQ(gta_execution_context_get_output(reused)->buffer, "a");
+    gta_execution_context_pool_release(reused);
+    gta_execution_context_pool_release(other_context);
+
+    // Clearing the pool for one program leaves the others.
+    gta_execution_context_pool_clear(other);
+    EXPECT_EQ(gta_execution_context_pool_acquire(program), context);
+    gta_execution_context_pool_release(context);
+    gta_execution_context_pool_clear(NULL);
+  }
+  ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
+  gta_program_destroy(other);
+  TEST_REUSABLE_PROGRAM_TEARDOWN();
+}
+
+TEST(GarbageCollector, Collect) {
+  for (GTA_Program_Flags flags : {GTA_PROGRAM_FLAG_DEFAULT, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT}) {
+    // Unreachable values are freed while the program runs, and reachable
+    // (nested) values are retained.
+    TEST_REUSABLE_PROGRAM(R"(
+      a = [];
+      b = 0;
+      for (i = 0; i < 1000; i = i + 1) {
+        a = [i, [i, i + 1]];
+        b = b + a[1][0];
+      }
+      print(b);
+      print(" ");
+      print(a);
+    )", flags);
+    TEST_CONTEXT_SETUP();
+    // Collect at every safe point.
+    gta_garbage_collector_set_threshold(context, 0);
+    ASSERT_TRUE(gta_program_execute(context));
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "499500 [999, [999, 1000]]");
+    ASSERT_LT(context->garbage_collection->count, 100);
+    ASSERT_EQ(context->garbage_collection->count, context->garbage_collection_sizes->count);
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(GarbageCollector, Quota) {
+  for (GTA_Program_Flags flags : {GTA_PROGRAM_FLAG_DEFAULT, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT}) {
+    {
+      // Values which are kept alive exceed the quota, and the output so far
+      // is kept.
+      TEST_REUSABLE_PROGRAM(R"(
+        print("a");
+        a = [];
+        for (i = 0; i < 10000; i = i + 1) {
+          a = [a, i];
+        }
+        print("b");
+      )", flags);
+      TEST_CONTEXT_SETUP();
+      gta_garbage_collector_set_quota(context, 64 * 1024);
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_EQ(context->result, gta_computed_value_error_memory_quota_exceeded);
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "a");
+      ASSERT_GT(gta_garbage_collector_get_bytes_live(context), (size_t)64 * 1024);
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // Garbage is collected before the quota is enforced.
+      TEST_REUSABLE_PROGRAM(R"(
+        a = [];
+        for (i = 0; i < 10000; i = i + 1) {
+          a = [i, i];
+        }
+        a;
+      )", flags);
+      TEST_CONTEXT_SETUP();
+      gta_garbage_collector_set_quota(context, 64 * 1024);
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_FALSE(GTA_COMPUTED_VALUE_IS_ERROR(context->result));
+      ASSERT_LE(gta_garbage_collector_get_bytes_live(context), (size_t)64 * 1024);
+      ASSERT_GT(gta_garbage_collector_get_bytes_peak(context), (size_t)64 * 1024);
+
+      // The peak is reset with the context, but the quota is kept.
+      gta_execution_context_reset(context);
+      ASSERT_EQ(gta_garbage_collector_get_bytes_peak(context), (size_t)0);
+      ASSERT_EQ(context->gc_quota, (size_t)64 * 1024);
+      gta_garbage_collector_set_quota(context, SIZE_MAX);
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_FALSE(GTA_COMPUTED_VALUE_IS_ERROR(context->result));
+      ASSERT_GE(gta_garbage_collector_get_bytes_peak(context), gta_garbage_collector_get_bytes_live(context));
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+  }
+}
+
+TEST(Execute, Budget) {
+  for (GTA_Program_Flags flags : {GTA_PROGRAM_FLAG_DEFAULT, GTA_PROGRAM_FLAG_DISABLE_BINARY | GTA_PROGRAM_FLAG_IGNORE_ENVIRONMENT}) {
+    {
+      // A runaway loop is aborted, and the output so far is kept.
+      TEST_REUSABLE_PROGRAM(R"(print("a"); while (true) {} print("b");)", flags);
+      TEST_CONTEXT_SETUP();
+      gta_execution_context_set_budget(context, 10000, 0);
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_EQ(context->result, gta_computed_value_error_execution_budget_exceeded);
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "a");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // Runaway recursion is aborted from within the nested calls.
+      TEST_REUSABLE_PROGRAM(R"(
+        function f(n) {
+          return f(n + 1);
+        }
+        print("a");
+        f(0);
+        print("b");
+      )", flags);
+      TEST_CONTEXT_SETUP();
+      gta_execution_context_set_budget(context, 1000, 0);
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_EQ(context->result, gta_computed_value_error_execution_budget_exceeded);
+      ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "a");
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // A runaway loop is aborted at the deadline.
+      TEST_REUSABLE_PROGRAM(R"(
+        function f() {
+          while (true) {}
+        }
+        f();
+      )", flags);
+      TEST_CONTEXT_SETUP();
+      gta_execution_context_set_budget(context, GTA_EXECUTION_CONTEXT_BUDGET_UNLIMITED, 10 * 1000 * 1000);
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_EQ(context->result, gta_computed_value_error_execution_deadline_exceeded);
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+    {
+      // The budget applies to each execution separately.
+      TEST_REUSABLE_PROGRAM(R"(
+        t = 0;
+        for (i = 0; i < 10; i = i + 1) {
+          t = t + i;
+        }
+        t;
+      )", flags);
+      TEST_CONTEXT_SETUP();
+      gta_execution_context_set_budget(context, 20, 0);
+      for (int i = 0; i < 2; ++i) {
+        ASSERT_TRUE(gta_program_execute(context));
+        ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(context->result));
+        ASSERT_EQ(((GTA_Computed_Value_Integer *)context->result)->value, 45);
+        gta_execution_context_reset(context);
+      }
+      gta_execution_context_set_budget(context, 5, 0);
+      ASSERT_TRUE(gta_program_execute(context));
+      ASSERT_EQ(context->result, gta_computed_value_error_execution_budget_exceeded);
+      TEST_CONTEXT_TEARDOWN();
+      TEST_REUSABLE_PROGRAM_TEARDOWN();
+    }
+  }
 }
 
 TEST(Execute, Template) {
@@ -850,7 +2201,7 @@ TEST(Execute, Template) {
       }
       num = fib(10);
     %>start <%= num %> end)");
-    ASSERT_STREQ(context->output->buffer, "start 55 end");
+    ASSERT_STREQ(gta_execution_context_get_output(context)->buffer, "start 55 end");
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -318,8 +318,7 @@ TEST(Declare, Map) {
     TEST_PROGRAM_SETUP("{:}");
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_MAP(context->result));
     GTA_Computed_Value_Map * map = (GTA_Computed_Value_Map *)context->result;
-    ASSERT_EQ(map->key_hash->entries, 0);
-    ASSERT_EQ(map->value_hash->entries, 0);
+    ASSERT_EQ(map->table->count, 0);
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -327,8 +326,7 @@ TEST(Declare, Map) {
     TEST_PROGRAM_SETUP(R"({number: 4.5, greeting: "hello"})");
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_MAP(context->result));
     GTA_Computed_Value_Map * map = (GTA_Computed_Value_Map *)context->result;
-    ASSERT_EQ(map->key_hash->entries, 2);
-    ASSERT_EQ(map->value_hash->entries, 2);
+    ASSERT_EQ(map->table->count, 2);
     GTA_Computed_Value * val1 = gta_computed_value_map_get_from_cstring(map, "number");
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_FLOAT(val1));
     ASSERT_EQ(((GTA_Computed_Value_Float *)val1)->value, 4.5);
@@ -2098,6 +2096,12 @@ TEST(Index, String) {
     ASSERT_EQ(context->result, gta_computed_value_error_invalid_index);
     TEST_PROGRAM_TEARDOWN();
   }
+  {
+    // A string which is not valid UTF-8 cannot be split into graphemes.
+    TEST_PROGRAM_SETUP(R"(a = "h\xFFllo"; a[1];)");
+    ASSERT_EQ(context->result, gta_computed_value_error_string_invalid_utf8);
+    TEST_PROGRAM_TEARDOWN();
+  }
 }
 
 TEST(Index, Map) {
@@ -2264,59 +2268,38 @@ TEST(Assignment, MapIndex) {
     ASSERT_TRUE(context->result);
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_MAP(context->result));
     GTA_Computed_Value_Map * result = (GTA_Computed_Value_Map *)context->result;
-    ASSERT_EQ(4, result->key_hash->entries);
-    ASSERT_EQ(4, result->value_hash->entries);
+    ASSERT_EQ(4, result->table->count);
     {
       // foo
       const char * key = "foo";
-      GTA_Integer key_hash = gcu_string_hash_64(key, strlen(key));
-      GTA_HashX_Value key_result = GTA_HASHX_GET(result->key_hash, key_hash);
-      ASSERT_TRUE(key_result.exists);
-      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_STRING(GTA_TYPEX_P(key_result.value)));
-      ASSERT_STREQ(key, ((GTA_Computed_Value_String *)GTA_TYPEX_P(key_result.value))->value->buffer);
-      GTA_HashX_Value value_result = GTA_HASHX_GET(result->value_hash, key_hash);
-      ASSERT_TRUE(value_result.exists);
-      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(GTA_TYPEX_P(value_result.value)));
-      ASSERT_EQ(3, ((GTA_Computed_Value_Integer *)GTA_TYPEX_P(value_result.value))->value);
+      GTA_Computed_Value * value_result = gta_computed_value_map_get_from_cstring(result, key);
+      ASSERT_NE(gta_computed_value_error_map_key_not_found, value_result);
+      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(value_result));
+      ASSERT_EQ(3, ((GTA_Computed_Value_Integer *)value_result)->value);
     }
     {
       // bar
       const char * key = "bar";
-      GTA_Integer key_hash = gcu_string_hash_64(key, strlen(key));
-      GTA_HashX_Value key_result = GTA_HASHX_GET(result->key_hash, key_hash);
-      ASSERT_TRUE(key_result.exists);
-      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_STRING(GTA_TYPEX_P(key_result.value)));
-      ASSERT_STREQ(key, ((GTA_Computed_Value_String *)GTA_TYPEX_P(key_result.value))->value->buffer);
-      GTA_HashX_Value value_result = GTA_HASHX_GET(result->value_hash, key_hash);
-      ASSERT_TRUE(value_result.exists);
-      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_FLOAT(GTA_TYPEX_P(value_result.value)));
-      ASSERT_EQ(4.5, ((GTA_Computed_Value_Float *)GTA_TYPEX_P(value_result.value))->value);
+      GTA_Computed_Value * value_result = gta_computed_value_map_get_from_cstring(result, key);
+      ASSERT_NE(gta_computed_value_error_map_key_not_found, value_result);
+      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_FLOAT(value_result));
+      ASSERT_EQ(4.5, ((GTA_Computed_Value_Float *)value_result)->value);
     }
     {
       // baz
       const char * key = "baz";
-      GTA_Integer key_hash = gcu_string_hash_64(key, strlen(key));
-      GTA_HashX_Value key_result = GTA_HASHX_GET(result->key_hash, key_hash);
-      ASSERT_TRUE(key_result.exists);
-      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_STRING(GTA_TYPEX_P(key_result.value)));
-      ASSERT_STREQ(key, ((GTA_Computed_Value_String *)GTA_TYPEX_P(key_result.value))->value->buffer);
-      GTA_HashX_Value value_result = GTA_HASHX_GET(result->value_hash, key_hash);
-      ASSERT_TRUE(value_result.exists);
-      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_BOOLEAN(GTA_TYPEX_P(value_result.value)));
-      ASSERT_FALSE(((GTA_Computed_Value_Boolean *)GTA_TYPEX_P(value_result.value))->value);
+      GTA_Computed_Value * value_result = gta_computed_value_map_get_from_cstring(result, key);
+      ASSERT_NE(gta_computed_value_error_map_key_not_found, value_result);
+      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_BOOLEAN(value_result));
+      ASSERT_FALSE(((GTA_Computed_Value_Boolean *)value_result)->value);
     }
     {
       // qux
       const char * key = "qux";
-      GTA_Integer key_hash = gcu_string_hash_64(key, strlen(key));
-      GTA_HashX_Value key_result = GTA_HASHX_GET(result->key_hash, key_hash);
-      ASSERT_TRUE(key_result.exists);
-      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_STRING(GTA_TYPEX_P(key_result.value)));
-      ASSERT_STREQ(key, ((GTA_Computed_Value_String *)GTA_TYPEX_P(key_result.value))->value->buffer);
-      GTA_HashX_Value value_result = GTA_HASHX_GET(result->value_hash, key_hash);
-      ASSERT_TRUE(value_result.exists);
-      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_STRING(GTA_TYPEX_P(value_result.value)));
-      ASSERT_STREQ("hello", ((GTA_Computed_Value_String *)GTA_TYPEX_P(value_result.value))->value->buffer);
+      GTA_Computed_Value * value_result = gta_computed_value_map_get_from_cstring(result, key);
+      ASSERT_NE(gta_computed_value_error_map_key_not_found, value_result);
+      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_STRING(value_result));
+      ASSERT_STREQ("hello", ((GTA_Computed_Value_String *)value_result)->value->buffer);
     }
     TEST_PROGRAM_TEARDOWN();
   }
@@ -2331,36 +2314,124 @@ TEST(Assignment, MapIndex) {
     ASSERT_TRUE(context->result);
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_MAP(context->result));
     GTA_Computed_Value_Map * result = (GTA_Computed_Value_Map *)context->result;
-    ASSERT_EQ(2, result->key_hash->entries);
-    ASSERT_EQ(2, result->value_hash->entries);
+    ASSERT_EQ(2, result->table->count);
     {
       // foo
       const char * key = "foo";
-      GTA_Integer key_hash = gcu_string_hash_64(key, strlen(key));
-      GTA_HashX_Value key_result = GTA_HASHX_GET(result->key_hash, key_hash);
-      ASSERT_TRUE(key_result.exists);
-      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_STRING(GTA_TYPEX_P(key_result.value)));
-      ASSERT_STREQ(key, ((GTA_Computed_Value_String *)GTA_TYPEX_P(key_result.value))->value->buffer);
-      GTA_HashX_Value value_result = GTA_HASHX_GET(result->value_hash, key_hash);
-      ASSERT_TRUE(value_result.exists);
-      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(GTA_TYPEX_P(value_result.value)));
-      ASSERT_EQ(3, ((GTA_Computed_Value_Integer *)GTA_TYPEX_P(value_result.value))->value);
+      GTA_Computed_Value * value_result = gta_computed_value_map_get_from_cstring(result, key);
+      ASSERT_NE(gta_computed_value_error_map_key_not_found, value_result);
+      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(value_result));
+      ASSERT_EQ(3, ((GTA_Computed_Value_Integer *)value_result)->value);
     }
     {
       // bar
       const char * key = "bar";
-      GTA_Integer key_hash = gcu_string_hash_64(key, strlen(key));
-      GTA_HashX_Value key_result = GTA_HASHX_GET(result->key_hash, key_hash);
-      ASSERT_TRUE(key_result.exists);
-      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_STRING(GTA_TYPEX_P(key_result.value)));
-      ASSERT_STREQ(key, ((GTA_Computed_Value_String *)GTA_TYPEX_P(key_result.value))->value->buffer);
-      GTA_HashX_Value value_result = GTA_HASHX_GET(result->value_hash, key_hash);
-      ASSERT_TRUE(value_result.exists);
-      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(GTA_TYPEX_P(value_result.value)));
-      ASSERT_EQ(42, ((GTA_Computed_Value_Integer *)GTA_TYPEX_P(value_result.value))->value);
+      GTA_Computed_Value * value_result = gta_computed_value_map_get_from_cstring(result, key);
+      ASSERT_NE(gta_computed_value_error_map_key_not_found, value_result);
+      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(value_result));
+      ASSERT_EQ(42, ((GTA_Computed_Value_Integer *)value_result)->value);
     }
     TEST_PROGRAM_TEARDOWN();
   }
+  {
+    // Keys keep the order in which they were first inserted, including when
+    // the map grows and when an existing key is assigned to.
+    TEST_PROGRAM_SETUP(R"(
+      a = {k0: 0};
+      a["k1"] = 1; a["k2"] = 2; a["k3"] = 3; a["k4"] = 4;
+      a["k5"] = 5; a["k6"] = 6; a["k7"] = 7; a["k8"] = 8;
+      a["k0"] = 42;
+      a;)");
+    ASSERT_TRUE(context->result);
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_MAP(context->result));
+    GTA_Computed_Value_Map * result = (GTA_Computed_Value_Map *)context->result;
+    ASSERT_EQ(9, result->table->count);
+    for (size_t i = 0; i < result->table->count; ++i) {
+      std::string key = "k" + std::to_string(i);
+      ASSERT_STREQ(key.c_str(), ((GTA_Computed_Value_String *)result->table->entries[i].key)->value->buffer);
+      GTA_Computed_Value * value = gta_computed_value_map_get_from_cstring(result, key.c_str());
+      ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(value));
+      ASSERT_EQ(i ? (GTA_Integer)i : 42, ((GTA_Computed_Value_Integer *)value)->value);
+    }
+    TEST_PROGRAM_TEARDOWN();
+  }
+}
+
+TEST(Assignment, CopyOnWrite) {
+  {
+    // A copy of an array shares the elements of the original.
+    TEST_PROGRAM_SETUP(R"(a = [3, 4, 5]; b = a; b;)");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_ARRAY(context->result));
+    GTA_Computed_Value_Array * result = (GTA_Computed_Value_Array *)context->result;
+    ASSERT_TRUE(result->shared_count);
+    ASSERT_GE(*result->shared_count, 2);
+    ASSERT_EQ(3, result->elements->count);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Writing to a copy of an array does not change the original.
+    TEST_PROGRAM_SETUP(R"(a = [3, 4, 5]; b = a; b[0] = 42; b[3] = 6; a;)");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_ARRAY(context->result));
+    GTA_Computed_Value_Array * result = (GTA_Computed_Value_Array *)context->result;
+    ASSERT_EQ(3, result->elements->count);
+    ASSERT_EQ(3, ((GTA_Computed_Value_Integer *)result->elements->data[0].p)->value);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Writing to the original array does not change the copy.
+    TEST_PROGRAM_SETUP(R"(a = [3, 4, 5]; b = a; a[0] = 42; b;)");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_ARRAY(context->result));
+    GTA_Computed_Value_Array * result = (GTA_Computed_Value_Array *)context->result;
+    ASSERT_EQ(3, ((GTA_Computed_Value_Integer *)result->elements->data[0].p)->value);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Writing to a nested array of a copy does not change the original.
+    TEST_PROGRAM_SETUP(R"(a = [[3, 4], 5]; b = a; b[0][0] = 42; a;)");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_ARRAY(context->result));
+    GTA_Computed_Value_Array * result = (GTA_Computed_Value_Array *)context->result;
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_ARRAY(result->elements->data[0].p));
+    GTA_Computed_Value_Array * inner = (GTA_Computed_Value_Array *)result->elements->data[0].p;
+    ASSERT_EQ(3, ((GTA_Computed_Value_Integer *)inner->elements->data[0].p)->value);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Writing to an array argument does not change the caller's array.
+    TEST_PROGRAM_SETUP(R"(
+      function f(x) {
+        x[0] = 42;
+        return x[0];
+      }
+      a = [3];
+      f(a);
+      a;)");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_ARRAY(context->result));
+    GTA_Computed_Value_Array * result = (GTA_Computed_Value_Array *)context->result;
+    ASSERT_EQ(3, ((GTA_Computed_Value_Integer *)result->elements->data[0].p)->value);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Writing to a copy of a map does not change the original.
+    TEST_PROGRAM_SETUP(R"(a = {foo: 3}; b = a; b["foo"] = 42; b["bar"] = 5; a;)");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_MAP(context->result));
+    GTA_Computed_Value_Map * result = (GTA_Computed_Value_Map *)context->result;
+    ASSERT_EQ(1, result->table->count);
+    GTA_Computed_Value * foo = gta_computed_value_map_get_from_cstring(result, "foo");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_INTEGER(foo));
+    ASSERT_EQ(3, ((GTA_Computed_Value_Integer *)foo)->value);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Writing to a nested array of a copy of a map does not change the
+    // original.
+    TEST_PROGRAM_SETUP(R"(a = {foo: [3]}; b = a; b["foo"][0] = 42; a;)");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_MAP(context->result));
+    GTA_Computed_Value * foo = gta_computed_value_map_get_from_cstring((GTA_Computed_Value_Map *)context->result, "foo");
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_ARRAY(foo));
+    GTA_Computed_Value_Array * inner = (GTA_Computed_Value_Array *)foo;
+    ASSERT_EQ(3, ((GTA_Computed_Value_Integer *)inner->elements->data[0].p)->value);
+    TEST_PROGRAM_TEARDOWN();
+  }
 }
 
 TEST(Slice, Array) {
@@ -2499,7 +2570,7 @@ TEST(Print, Simple) {
     TEST_PROGRAM_SETUP("print(42);");
     ASSERT_TRUE(context->result);
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_NULL(context->result));
-    ASSERT_STREQ("42", context->output->buffer);
+    ASSERT_STREQ("42", gta_execution_context_get_output(context)->buffer);
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -2507,7 +2578,7 @@ TEST(Print, Simple) {
     TEST_PROGRAM_SETUP("print(3.5);");
     ASSERT_TRUE(context->result);
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_NULL(context->result));
-    ASSERT_STREQ("3.5", context->output->buffer);
+    ASSERT_STREQ("3.5", gta_execution_context_get_output(context)->buffer);
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -2515,7 +2586,7 @@ TEST(Print, Simple) {
     TEST_PROGRAM_SETUP("print(\"hello\");");
     ASSERT_TRUE(context->result);
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_NULL(context->result));
-    ASSERT_STREQ("hello", context->output->buffer);
+    ASSERT_STREQ("hello", gta_execution_context_get_output(context)->buffer);
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -2523,7 +2594,7 @@ TEST(Print, Simple) {
     TEST_PROGRAM_SETUP("print(null);");
     ASSERT_TRUE(context->result);
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_NULL(context->result));
-    ASSERT_STREQ("", context->output->buffer);
+    ASSERT_STREQ("", gta_execution_context_get_output(context)->buffer);
     TEST_PROGRAM_TEARDOWN();
   }
   {
@@ -2531,7 +2602,16 @@ TEST(Print, Simple) {
     TEST_PROGRAM_SETUP("print(42); print(3.5); print(\"hello\"); print(null); print(-42);");
     ASSERT_TRUE(context->result);
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_NULL(context->result));
-    ASSERT_STREQ("423.5hello-42", context->output->buffer);
+    ASSERT_STREQ("423.5hello-42", gta_execution_context_get_output(context)->buffer);
+    TEST_PROGRAM_TEARDOWN();
+  }
+  {
+    // Print a map, in the order in which its keys were inserted.  String
+    // values are quoted, like the keys.
+    TEST_PROGRAM_SETUP(R"(print({b: 1, a: "hello", c: "2"});)");
+    ASSERT_TRUE(context->result);
+    ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_NULL(context->result));
+    ASSERT_STREQ("{\n  \"b\": 1,\n  \"a\": \"hello\",\n  \"c\": \"2\",\n}", gta_execution_context_get_output(context)->buffer);
     TEST_PROGRAM_TEARDOWN();
   }
 }
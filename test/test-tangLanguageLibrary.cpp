@@ -83,7 +83,7 @@ TEST(Math, Constants) {
     // Pi
     TEST_PROGRAM_SETUP("use math; print(math.pi);");
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_NULL(context->result));
-    ASSERT_STREQ("3.141593", context->output->buffer);
+    ASSERT_STREQ("3.141593", gta_execution_context_get_output(context)->buffer);
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -103,14 +103,14 @@ TEST(Library, UseAs) {
     // math.pi, with library aliased.
     TEST_PROGRAM_SETUP("use math as m; print(m.pi);");
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_NULL(context->result));
-    ASSERT_STREQ("3.141593", context->output->buffer);
+    ASSERT_STREQ("3.141593", gta_execution_context_get_output(context)->buffer);
     TEST_PROGRAM_TEARDOWN();
   }
   {
     // math.pi, with pi aliased.
     TEST_PROGRAM_SETUP("use math.pi as pi; print(pi);");
     ASSERT_TRUE(GTA_COMPUTED_VALUE_IS_NULL(context->result));
-    ASSERT_STREQ("3.141593", context->output->buffer);
+    ASSERT_STREQ("3.141593", gta_execution_context_get_output(context)->buffer);
     TEST_PROGRAM_TEARDOWN();
   }
 }
@@ -158,6 +158,7 @@ TEST(Binary, Boolean) {
   }
   {
     // Boolean (true).
+    // The result of `||` is the operand that decided it.
     gcu_memory_reset_counts();
     GTA_Ast_Node * ast = gta_tang_parse_script("true && false || 3");
     ASSERT_NE(ast, nullptr);
@@ -165,7 +166,8 @@ TEST(Binary, Boolean) {
     ast = gta_tang_simplify(ast);
     ASSERT_NE(ast, nullptr);
     ASSERT_EQ(1, gta_tang_node_count(ast));
-    ASSERT_TRUE(((GTA_Ast_Node_Boolean *)ast)->value);
+    ASSERT_TRUE(GTA_AST_IS_INTEGER(ast));
+    ASSERT_EQ(3, ((GTA_Ast_Node_Integer *)ast)->value);
     gta_ast_node_destroy(ast);
     ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
   }
@@ -178,52 +180,68 @@ TEST(Binary, Boolean) {
     ast = gta_tang_simplify(ast);
     ASSERT_NE(ast, nullptr);
     ASSERT_EQ(1, gta_tang_node_count(ast));
+    ASSERT_TRUE(GTA_AST_IS_BOOLEAN(ast));
     ASSERT_FALSE(((GTA_Ast_Node_Boolean *)ast)->value);
     gta_ast_node_destroy(ast);
     ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
   }
+  {
+    // The RHS is not always evaluated, so an assignment in it invalidates the
+    // cached value of the assigned variable.
+    gcu_memory_reset_counts();
+    GTA_Ast_Node * ast = gta_tang_parse_script(R"(
+      x = 3;
+      z && (x = 2);
+      y = x + 1;
+    )");
+    ASSERT_NE(ast, nullptr);
+    ASSERT_EQ(14, gta_tang_node_count(ast));
+    ast = gta_tang_simplify(ast);
+    ASSERT_NE(ast, nullptr);
+    ASSERT_EQ(14, gta_tang_node_count(ast));
+    gta_ast_node_destroy(ast);
+    ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
+  }
 }
 
 TEST(Binary, String) {
   {
-    // String concatenation.
+    // String concatenation is not implemented by the runtime.
+    // Should not simplify.
     gcu_memory_reset_counts();
     GTA_Ast_Node * ast = gta_tang_parse_script(R"("a" + "b" + "c")");
     ASSERT_NE(ast, nullptr);
     ASSERT_EQ(5, gta_tang_node_count(ast));
     ast = gta_tang_simplify(ast);
     ASSERT_NE(ast, nullptr);
-    ASSERT_EQ(1, gta_tang_node_count(ast));
-    ASSERT_TRUE(GTA_AST_IS_STRING(ast));
-    ASSERT_STREQ("abc", ((GTA_Ast_Node_String *)ast)->string->buffer);
+    ASSERT_EQ(5, gta_tang_node_count(ast));
     gta_ast_node_destroy(ast);
     ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
   }
   {
-    // String comparison of different values.
+    // String comparison is not implemented by the runtime.
+    // Should not simplify.
     gcu_memory_reset_counts();
-    GTA_Ast_Node * ast = gta_tang_parse_script(R"("a" == "b")");
+    GTA_Ast_Node * ast = gta_tang_parse_script(R"("a" == "a")");
     ASSERT_NE(ast, nullptr);
     ASSERT_EQ(3, gta_tang_node_count(ast));
     ast = gta_tang_simplify(ast);
     ASSERT_NE(ast, nullptr);
-    ASSERT_EQ(1, gta_tang_node_count(ast));
-    ASSERT_TRUE(GTA_AST_IS_BOOLEAN(ast));
-    ASSERT_FALSE(((GTA_Ast_Node_Boolean *)ast)->value);
+    ASSERT_EQ(3, gta_tang_node_count(ast));
     gta_ast_node_destroy(ast);
     ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
   }
   {
-    // String comparison of same values.
+    // A string is true if it is not empty.
     gcu_memory_reset_counts();
-    GTA_Ast_Node * ast = gta_tang_parse_script(R"("a" == "a")");
+    GTA_Ast_Node * ast = gta_tang_parse_script(R"("" || "a")");
     ASSERT_NE(ast, nullptr);
     ASSERT_EQ(3, gta_tang_node_count(ast));
     ast = gta_tang_simplify(ast);
     ASSERT_NE(ast, nullptr);
     ASSERT_EQ(1, gta_tang_node_count(ast));
-    ASSERT_TRUE(GTA_AST_IS_BOOLEAN(ast));
-    ASSERT_TRUE(((GTA_Ast_Node_Boolean *)ast)->value);
+    ASSERT_TRUE(GTA_AST_IS_STRING(ast));
+    ASSERT_STREQ("a", ((GTA_Ast_Node_String *)ast)->string->buffer);
     gta_ast_node_destroy(ast);
     ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
   }
@@ -449,6 +467,53 @@ TEST(Variable, DetectEmbeddedConditionalAssignment) {
   }
 }
 
+TEST(Variable, DetectSharedGlobals) {
+  {
+    // A variable which a function declares `global` may be changed by any
+    // function call, so its value should not be propagated.
+    gcu_memory_reset_counts();
+    GTA_Ast_Node * ast = gta_tang_parse_script(R"(
+      x = 3;
+      function f() {
+        global x;
+        x = 4;
+      }
+      f();
+      y = x + 1;
+    )");
+    ASSERT_NE(ast, nullptr);
+    size_t count = gta_tang_node_count(ast);
+    ast = gta_tang_simplify(ast);
+    ASSERT_NE(ast, nullptr);
+    ASSERT_EQ(count, gta_tang_node_count(ast));
+    gta_ast_node_destroy(ast);
+    ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
+  }
+  {
+    // Other variables are still propagated.
+    gcu_memory_reset_counts();
+    GTA_Ast_Node * ast = gta_tang_parse_script(R"(
+      x = 3;
+      w = 5;
+      function f() {
+        global x;
+        x = 4;
+      }
+      f();
+      y = x + 1;
+      z = w + 1;
+    )");
+    ASSERT_NE(ast, nullptr);
+    size_t count = gta_tang_node_count(ast);
+    ast = gta_tang_simplify(ast);
+    ASSERT_NE(ast, nullptr);
+    // Only `w + 1` is folded.
+    ASSERT_EQ(count - 2, gta_tang_node_count(ast));
+    gta_ast_node_destroy(ast);
+    ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
+  }
+}
+
 TEST(Variable, DetectEmbeddedLoopAssignments) {
   {
     // Assignment inside a while() statement should invalidate the cached
@@ -899,7 +964,7 @@ TEST(String, EscapedCharacters) {
     ASSERT_EQ(1, gta_tang_node_count(ast));
     ASSERT_TRUE(GTA_AST_IS_STRING(ast));
     ASSERT_STREQ("$\xF0\x9F\x8F\xB4\xF3\xA0\x81\xA7\xF3\xA0\x81\xA2\xF3\xA0\x81\xB3\xF3\xA0\x81\xA3\xF3\xA0\x81\xB4\xF3\xA0\x81\xBF.", ((GTA_Ast_Node_String *)ast)->string->buffer);
-    ASSERT_EQ(3, ((GTA_Ast_Node_String *)ast)->string->grapheme_length);
+    ASSERT_EQ(3, gta_unicode_string_get_grapheme_length(((GTA_Ast_Node_String *)ast)->string));
     ASSERT_EQ(30, ((GTA_Ast_Node_String *)ast)->string->byte_length);
     gta_ast_node_destroy(ast);
     ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
@@ -8,6 +8,8 @@
 #include <cutil/memory.h>
 #include <unicode/uclean.h>
 #include <iostream>
+#include <thread>
+#include <vector>
 #include <tang/unicodeString.h>
 
 using namespace std;
@@ -207,7 +209,7 @@ TEST(UnicodeString, ByteAndGraphemeCount) {
     auto s = gta_unicode_string_create("", 0, GTA_UNICODE_STRING_TYPE_TRUSTED);
     EXPECT_NE(nullptr, s);
     EXPECT_EQ(0, s->byte_length);
-    EXPECT_EQ(0, s->grapheme_length);
+    EXPECT_EQ(0, gta_unicode_string_get_grapheme_length(s));
     gta_unicode_string_destroy(s);
     ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
   }
@@ -217,7 +219,7 @@ TEST(UnicodeString, ByteAndGraphemeCount) {
     auto s = gta_unicode_string_create("abc", 3, GTA_UNICODE_STRING_TYPE_TRUSTED);
     EXPECT_NE(nullptr, s);
     EXPECT_EQ(3, s->byte_length);
-    EXPECT_EQ(3, s->grapheme_length);
+    EXPECT_EQ(3, gta_unicode_string_get_grapheme_length(s));
     gta_unicode_string_destroy(s);
     ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
   }
@@ -227,7 +229,7 @@ TEST(UnicodeString, ByteAndGraphemeCount) {
     auto s = gta_unicode_string_create("\u00A3", 2, GTA_UNICODE_STRING_TYPE_TRUSTED);
     EXPECT_NE(nullptr, s);
     EXPECT_EQ(2, s->byte_length);
-    EXPECT_EQ(1, s->grapheme_length);
+    EXPECT_EQ(1, gta_unicode_string_get_grapheme_length(s));
     gta_unicode_string_destroy(s);
     ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
   }
@@ -238,7 +240,7 @@ TEST(UnicodeString, ByteAndGraphemeCount) {
     auto s = gta_unicode_string_create(str, strlen(str), GTA_UNICODE_STRING_TYPE_TRUSTED);
     EXPECT_NE(nullptr, s);
     EXPECT_EQ(strlen(str), s->byte_length);
-    EXPECT_EQ(2, s->grapheme_length);
+    EXPECT_EQ(2, gta_unicode_string_get_grapheme_length(s));
     gta_unicode_string_destroy(s);
     ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
   }
@@ -251,7 +253,25 @@ TEST(UnicodeString, ByteAndGraphemeCount) {
     auto s = gta_unicode_string_create(str, strlen(str), GTA_UNICODE_STRING_TYPE_TRUSTED);
     EXPECT_NE(nullptr, s);
     EXPECT_EQ(strlen(str), s->byte_length);
-    EXPECT_EQ(3, s->grapheme_length);
+    EXPECT_EQ(3, gta_unicode_string_get_grapheme_length(s));
+    gta_unicode_string_destroy(s);
+    ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
+  }
+  {
+    gcu_memory_reset_counts();
+    // Testing ASCII text mixed with non-ASCII text.  The ASCII character
+    // before a combining accent (U+0301) is part of the same grapheme, and
+    // "\r\n" is a single grapheme.
+    const char * str = "Hello, world!\r\nCafe\xCC\x81 \xC3\xA9t\xC3\xA9\r\n";
+    auto s = gta_unicode_string_create(str, strlen(str), GTA_UNICODE_STRING_TYPE_TRUSTED);
+    EXPECT_NE(nullptr, s);
+    EXPECT_EQ(strlen(str), s->byte_length);
+    EXPECT_EQ(23, gta_unicode_string_get_grapheme_length(s));
+    uint32_t expected[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 15, 16, 17, 18, 21, 22, 24, 25, 27, 29};
+    ASSERT_EQ(sizeof(expected) / sizeof(expected[0]), s->grapheme_offsets->count);
+    for (size_t i = 0; i < s->grapheme_offsets->count; ++i) {
+      EXPECT_EQ(expected[i], s->grapheme_offsets->data[i].ui32);
+    }
     gta_unicode_string_destroy(s);
     ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
   }
@@ -265,6 +285,7 @@ TEST(UnicodeString, Substring) {
     size_t free_running_count = 0;
     auto s = gta_unicode_string_create("", 0, GTA_UNICODE_STRING_TYPE_TRUSTED);
     EXPECT_NE(nullptr, s);
+    ASSERT_TRUE(gta_unicode_string_index_graphemes(s));
     {
       // Requesting a substring of length 0.
       alloc_running_count += gcu_get_alloc_count();
@@ -273,7 +294,7 @@ TEST(UnicodeString, Substring) {
       auto s2 = gta_unicode_string_substring(s, 0, 0);
       EXPECT_NE(nullptr, s2);
       EXPECT_EQ(0, s2->byte_length);
-      EXPECT_EQ(0, s2->grapheme_length);
+      EXPECT_EQ(0, gta_unicode_string_get_grapheme_length(s2));
       EXPECT_EQ(1, s2->string_type->count);
       gta_unicode_string_destroy(s2);
       ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
@@ -286,7 +307,7 @@ TEST(UnicodeString, Substring) {
       auto s2 = gta_unicode_string_substring(s, 0, 1);
       EXPECT_NE(nullptr, s2);
       EXPECT_EQ(0, s2->byte_length);
-      EXPECT_EQ(0, s2->grapheme_length);
+      EXPECT_EQ(0, gta_unicode_string_get_grapheme_length(s2));
       EXPECT_EQ(1, s2->string_type->count);
       gta_unicode_string_destroy(s2);
       ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
@@ -299,7 +320,7 @@ TEST(UnicodeString, Substring) {
       auto s2 = gta_unicode_string_substring(s, 1, 1);
       EXPECT_NE(nullptr, s2);
       EXPECT_EQ(0, s2->byte_length);
-      EXPECT_EQ(0, s2->grapheme_length);
+      EXPECT_EQ(0, gta_unicode_string_get_grapheme_length(s2));
       EXPECT_EQ(1, s2->string_type->count);
       gta_unicode_string_destroy(s2);
       ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
@@ -316,6 +337,7 @@ TEST(UnicodeString, Substring) {
     size_t free_running_count = 0;
     auto s = gta_unicode_string_create("abc", 3, GTA_UNICODE_STRING_TYPE_TRUSTED);
     EXPECT_NE(nullptr, s);
+    ASSERT_TRUE(gta_unicode_string_index_graphemes(s));
     {
       // Requesting a substring of length 0.
       alloc_running_count += gcu_get_alloc_count();
@@ -324,7 +346,7 @@ TEST(UnicodeString, Substring) {
       auto s2 = gta_unicode_string_substring(s, 0, 0);
       EXPECT_NE(nullptr, s2);
       EXPECT_EQ(0, s2->byte_length);
-      EXPECT_EQ(0, s2->grapheme_length);
+      EXPECT_EQ(0, gta_unicode_string_get_grapheme_length(s2));
       EXPECT_EQ(1, s2->string_type->count);
       EXPECT_EQ(string{}, string{s2->buffer});
       gta_unicode_string_destroy(s2);
@@ -338,7 +360,7 @@ TEST(UnicodeString, Substring) {
       auto s2 = gta_unicode_string_substring(s, 0, 4);
       EXPECT_NE(nullptr, s2);
       EXPECT_EQ(3, s2->byte_length);
-      EXPECT_EQ(3, s2->grapheme_length);
+      EXPECT_EQ(3, gta_unicode_string_get_grapheme_length(s2));
       EXPECT_EQ(1, s2->string_type->count);
       EXPECT_EQ(string{"abc"}, string{s2->buffer});
       gta_unicode_string_destroy(s2);
@@ -352,7 +374,7 @@ TEST(UnicodeString, Substring) {
       auto s2 = gta_unicode_string_substring(s, 4, 1);
       EXPECT_NE(nullptr, s2);
       EXPECT_EQ(0, s2->byte_length);
-      EXPECT_EQ(0, s2->grapheme_length);
+      EXPECT_EQ(0, gta_unicode_string_get_grapheme_length(s2));
       EXPECT_EQ(1, s2->string_type->count);
       EXPECT_EQ(string{}, string{s2->buffer});
       gta_unicode_string_destroy(s2);
@@ -366,7 +388,7 @@ TEST(UnicodeString, Substring) {
       auto s2 = gta_unicode_string_substring(s, 1, 1);
       EXPECT_NE(nullptr, s2);
       EXPECT_EQ(1, s2->byte_length);
-      EXPECT_EQ(1, s2->grapheme_length);
+      EXPECT_EQ(1, gta_unicode_string_get_grapheme_length(s2));
       EXPECT_EQ(1, s2->string_type->count);
       EXPECT_EQ(string{"b"}, string{s2->buffer});
       gta_unicode_string_destroy(s2);
@@ -387,6 +409,7 @@ TEST(UnicodeString, Substring) {
     const char * str = "$\xF0\x9F\x8F\xB4\xF3\xA0\x81\xA7\xF3\xA0\x81\xA2\xF3\xA0\x81\xB3\xF3\xA0\x81\xA3\xF3\xA0\x81\xB4\xF3\xA0\x81\xBF.";
     auto s = gta_unicode_string_create(str, strlen(str), GTA_UNICODE_STRING_TYPE_TRUSTED);
     EXPECT_NE(nullptr, s);
+    ASSERT_TRUE(gta_unicode_string_index_graphemes(s));
     {
       // Requesting a substring of the first two graphemes.
       alloc_running_count += gcu_get_alloc_count();
@@ -395,7 +418,7 @@ TEST(UnicodeString, Substring) {
       auto s2 = gta_unicode_string_substring(s, 0, 2);
       EXPECT_NE(nullptr, s2);
       EXPECT_EQ(29, s2->byte_length);
-      EXPECT_EQ(2, s2->grapheme_length);
+      EXPECT_EQ(2, gta_unicode_string_get_grapheme_length(s2));
       EXPECT_EQ(1, s2->string_type->count);
       EXPECT_EQ(string{"$\xF0\x9F\x8F\xB4\xF3\xA0\x81\xA7\xF3\xA0\x81\xA2\xF3\xA0\x81\xB3\xF3\xA0\x81\xA3\xF3\xA0\x81\xB4\xF3\xA0\x81\xBF"}, string{s2->buffer});
       gta_unicode_string_destroy(s2);
@@ -409,7 +432,7 @@ TEST(UnicodeString, Substring) {
       auto s2 = gta_unicode_string_substring(s, 1, 2);
       EXPECT_NE(nullptr, s2);
       EXPECT_EQ(29, s2->byte_length);
-      EXPECT_EQ(2, s2->grapheme_length);
+      EXPECT_EQ(2, gta_unicode_string_get_grapheme_length(s2));
       EXPECT_EQ(1, s2->string_type->count);
       EXPECT_EQ(string{"\xF0\x9F\x8F\xB4\xF3\xA0\x81\xA7\xF3\xA0\x81\xA2\xF3\xA0\x81\xB3\xF3\xA0\x81\xA3\xF3\xA0\x81\xB4\xF3\xA0\x81\xBF."}, string{s2->buffer});
       gta_unicode_string_destroy(s2);
@@ -423,7 +446,7 @@ TEST(UnicodeString, Substring) {
       auto s2 = gta_unicode_string_substring(s, 1, 1);
       EXPECT_NE(nullptr, s2);
       EXPECT_EQ(28, s2->byte_length);
-      EXPECT_EQ(1, s2->grapheme_length);
+      EXPECT_EQ(1, gta_unicode_string_get_grapheme_length(s2));
       EXPECT_EQ(1, s2->string_type->count);
       EXPECT_EQ(string{"\xF0\x9F\x8F\xB4\xF3\xA0\x81\xA7\xF3\xA0\x81\xA2\xF3\xA0\x81\xB3\xF3\xA0\x81\xA3\xF3\xA0\x81\xB4\xF3\xA0\x81\xBF"}, string{s2->buffer});
       gta_unicode_string_destroy(s2);
@@ -463,7 +486,7 @@ TEST(UnicodeString, Concat) {
     auto s5 = gta_unicode_string_concat(s1, s1);
     EXPECT_NE(nullptr, s5);
     EXPECT_EQ(0, s5->byte_length);
-    EXPECT_EQ(0, s5->grapheme_length);
+    EXPECT_EQ(0, gta_unicode_string_get_grapheme_length(s5));
     EXPECT_EQ(1, s5->string_type->count);
     EXPECT_EQ(string{}, string{s5->buffer});
     EXPECT_EQ((uint32_t)GTA_UNICODE_STRING_TYPE_HTML, GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(s5->string_type->data[0]));
@@ -480,7 +503,7 @@ TEST(UnicodeString, Concat) {
     char expected[] = "abc";
     EXPECT_NE(nullptr, s5);
     EXPECT_EQ(strlen(expected), s5->byte_length);
-    EXPECT_EQ(3, s5->grapheme_length);
+    EXPECT_EQ(3, gta_unicode_string_get_grapheme_length(s5));
     EXPECT_EQ(1, s5->string_type->count);
     EXPECT_EQ(string{"abc"}, string{s5->buffer});
     EXPECT_EQ((uint32_t)GTA_UNICODE_STRING_TYPE_TRUSTED, GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(s5->string_type->data[0]));
@@ -497,7 +520,7 @@ TEST(UnicodeString, Concat) {
     char expected[] = "abc";
     EXPECT_NE(nullptr, s5);
     EXPECT_EQ(strlen(expected), s5->byte_length);
-    EXPECT_EQ(3, s5->grapheme_length);
+    EXPECT_EQ(3, gta_unicode_string_get_grapheme_length(s5));
     EXPECT_EQ(1, s5->string_type->count);
     EXPECT_EQ(string{expected}, string{s5->buffer});
     EXPECT_EQ((uint32_t)GTA_UNICODE_STRING_TYPE_TRUSTED, GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(s5->string_type->data[0]));
@@ -515,7 +538,7 @@ TEST(UnicodeString, Concat) {
     char expected[] = "abc\u00A3";
     EXPECT_NE(nullptr, s5);
     EXPECT_EQ(strlen(expected), s5->byte_length);
-    EXPECT_EQ(4, s5->grapheme_length);
+    EXPECT_EQ(4, gta_unicode_string_get_grapheme_length(s5));
     EXPECT_EQ(1, s5->string_type->count);
     EXPECT_EQ(string{expected}, string{s5->buffer});
     EXPECT_EQ((uint32_t)GTA_UNICODE_STRING_TYPE_TRUSTED, GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(s5->string_type->data[0]));
@@ -532,7 +555,7 @@ TEST(UnicodeString, Concat) {
     char expected[] = "abc$\xF0\x9F\x8F\xB4\xF3\xA0\x81\xA7\xF3\xA0\x81\xA2\xF3\xA0\x81\xB3\xF3\xA0\x81\xA3\xF3\xA0\x81\xB4\xF3\xA0\x81\xBF.";
     EXPECT_NE(nullptr, s5);
     EXPECT_EQ(strlen(expected), s5->byte_length);
-    EXPECT_EQ(6, s5->grapheme_length);
+    EXPECT_EQ(6, gta_unicode_string_get_grapheme_length(s5));
     EXPECT_EQ(2, s5->string_type->count);
     EXPECT_EQ(string{expected}, string{s5->buffer});
     EXPECT_EQ((uint32_t)GTA_UNICODE_STRING_TYPE_TRUSTED, GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(s5->string_type->data[0]));
@@ -556,7 +579,7 @@ TEST(UnicodeString, Concat) {
     auto s8 = gta_unicode_string_concat(s7, s4);
     EXPECT_NE(nullptr, s8);
     EXPECT_EQ(strlen(expected), s8->byte_length);
-    EXPECT_EQ(13, s8->grapheme_length);
+    EXPECT_EQ(13, gta_unicode_string_get_grapheme_length(s8));
     EXPECT_EQ(4, s8->string_type->count);
     EXPECT_EQ(string{expected}, string{s8->buffer});
     EXPECT_EQ((uint32_t)GTA_UNICODE_STRING_TYPE_TRUSTED, GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(s8->string_type->data[0]));
@@ -565,8 +588,8 @@ TEST(UnicodeString, Concat) {
     EXPECT_EQ((uint32_t)GTA_UNICODE_STRING_TYPE_HTML, GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(s8->string_type->data[3]));
     EXPECT_EQ(0, GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(s8->string_type->data[0]));
     EXPECT_EQ(3, GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(s8->string_type->data[1]));
-    EXPECT_EQ(6, GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(s8->string_type->data[2]));
-    EXPECT_EQ(10, GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(s8->string_type->data[3]));
+    EXPECT_EQ(33, GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(s8->string_type->data[2]));
+    EXPECT_EQ(38, GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(s8->string_type->data[3]));
     gta_unicode_string_destroy(s8);
     gta_unicode_string_destroy(s7);
     gta_unicode_string_destroy(s6);
@@ -582,6 +605,119 @@ TEST(UnicodeString, Concat) {
   ASSERT_EQ(alloc_running_count, free_running_count);
 }
 
+TEST(UnicodeString, Join) {
+  gcu_memory_reset_counts();
+  auto s1 = gta_unicode_string_create("", 0, GTA_UNICODE_STRING_TYPE_HTML);
+  auto s2 = gta_unicode_string_create("abc", 3, GTA_UNICODE_STRING_TYPE_TRUSTED);
+  auto s3 = gta_unicode_string_create("\u00A3", 2, GTA_UNICODE_STRING_TYPE_TRUSTED);
+  auto s4 = gta_unicode_string_create("<d>", 3, GTA_UNICODE_STRING_TYPE_HTML);
+  ASSERT_TRUE(s1 && s2 && s3 && s4);
+  {
+    // Joining nothing produces an empty string.
+    auto joined = gta_unicode_string_join(nullptr, 0);
+    ASSERT_NE(nullptr, joined);
+    EXPECT_EQ(0, joined->byte_length);
+    EXPECT_EQ(string{}, string{joined->buffer});
+    gta_unicode_string_destroy(joined);
+  }
+  {
+    // Joining must produce the same result as repeated concatenation,
+    // including the merging of adjacent runs of the same type.
+    const GTA_Unicode_String * strings[] = {s2, s1, s4, s2, s3, s1, s4};
+    size_t count = sizeof(strings) / sizeof(strings[0]);
+    auto joined = gta_unicode_string_join(strings, count);
+    ASSERT_NE(nullptr, joined);
+    auto expected = gta_unicode_string_concat(strings[0], strings[1]);
+    for (size_t i = 2; i < count; ++i) {
+      auto next = gta_unicode_string_concat(expected, strings[i]);
+      gta_unicode_string_destroy(expected);
+      expected = next;
+    }
+    ASSERT_NE(nullptr, expected);
+    EXPECT_EQ(string{"abc<d>abc\u00A3<d>"}, string{joined->buffer});
+    EXPECT_EQ(expected->byte_length, joined->byte_length);
+    EXPECT_EQ(gta_unicode_string_get_grapheme_length(expected), gta_unicode_string_get_grapheme_length(joined));
+    ASSERT_EQ(expected->grapheme_offsets->count, joined->grapheme_offsets->count);
+    for (size_t i = 0; i < expected->grapheme_offsets->count; ++i) {
+      EXPECT_EQ(expected->grapheme_offsets->data[i].ui32, joined->grapheme_offsets->data[i].ui32);
+    }
+    ASSERT_EQ(4, joined->string_type->count);
+    ASSERT_EQ(expected->string_type->count, joined->string_type->count);
+    for (size_t i = 0; i < expected->string_type->count; ++i) {
+      EXPECT_EQ(expected->string_type->data[i].ui64, joined->string_type->data[i].ui64);
+    }
+    gta_unicode_string_destroy(expected);
+    gta_unicode_string_destroy(joined);
+  }
+  gta_unicode_string_destroy(s1);
+  gta_unicode_string_destroy(s2);
+  gta_unicode_string_destroy(s3);
+  gta_unicode_string_destroy(s4);
+  ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
+}
+
+TEST(UnicodeString, LazyGraphemeIndex) {
+  gcu_memory_reset_counts();
+  auto s1 = gta_unicode_string_create("abc", 3, GTA_UNICODE_STRING_TYPE_TRUSTED);
+  auto s2 = gta_unicode_string_create("<\u00A3>", 4, GTA_UNICODE_STRING_TYPE_HTML);
+  ASSERT_TRUE(s1 && s2);
+  {
+    // Concatenating and rendering do not build the grapheme index.
+    auto s3 = gta_unicode_string_concat(s1, s2);
+    ASSERT_NE(nullptr, s3);
+    GTA_Unicode_Rendered_String rendered = gta_unicode_string_render(s3);
+    ASSERT_TRUE(rendered.buffer);
+    EXPECT_EQ(string{"abc&lt;\u00A3&gt;"}, string{rendered.buffer});
+    gcu_free(rendered.buffer);
+    EXPECT_EQ(nullptr, s1->grapheme_offsets);
+    EXPECT_EQ(nullptr, s2->grapheme_offsets);
+    EXPECT_EQ(nullptr, s3->grapheme_offsets);
+
+    // The index is built on demand.
+    EXPECT_EQ(6, gta_unicode_string_get_grapheme_length(s3));
+    ASSERT_NE(nullptr, s3->grapheme_offsets);
+    EXPECT_EQ(7, s3->grapheme_offsets->count);
+
+    // A substring which spans both types keeps both types, with the offsets
+    // adjusted to the start of the substring.
+    auto s4 = gta_unicode_string_substring(s3, 2, 3);
+    ASSERT_NE(nullptr, s4);
+    EXPECT_EQ(string{"c<\u00A3"}, string{s4->buffer});
+    ASSERT_EQ(2, s4->string_type->count);
+    EXPECT_EQ((uint32_t)GTA_UNICODE_STRING_TYPE_TRUSTED, GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(s4->string_type->data[0]));
+    EXPECT_EQ(0, GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(s4->string_type->data[0]));
+    EXPECT_EQ((uint32_t)GTA_UNICODE_STRING_TYPE_HTML, GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(s4->string_type->data[1]));
+    EXPECT_EQ(1, GTA_UC_GET_OFFSET_FROM_TYPE_OFFSET_PAIR(s4->string_type->data[1]));
+
+    // A substring which is entirely within the second type only has that
+    // type.
+    auto s5 = gta_unicode_string_substring(s3, 4, 2);
+    ASSERT_NE(nullptr, s5);
+    EXPECT_EQ(string{"\u00A3>"}, string{s5->buffer});
+    ASSERT_EQ(1, s5->string_type->count);
+    EXPECT_EQ((uint32_t)GTA_UNICODE_STRING_TYPE_HTML, GTA_UC_GET_TYPE_FROM_TYPE_OFFSET_PAIR(s5->string_type->data[0]));
+
+    // A copy has the same types, but no index.
+    auto s6 = gta_unicode_string_copy(s3);
+    ASSERT_NE(nullptr, s6);
+    EXPECT_EQ(string{s3->buffer}, string{s6->buffer});
+    EXPECT_EQ(s3->byte_length, s6->byte_length);
+    EXPECT_EQ(nullptr, s6->grapheme_offsets);
+    ASSERT_EQ(s3->string_type->count, s6->string_type->count);
+    for (size_t i = 0; i < s3->string_type->count; ++i) {
+      EXPECT_EQ(s3->string_type->data[i].ui64, s6->string_type->data[i].ui64);
+    }
+
+    gta_unicode_string_destroy(s6);
+    gta_unicode_string_destroy(s5);
+    gta_unicode_string_destroy(s4);
+    gta_unicode_string_destroy(s3);
+  }
+  gta_unicode_string_destroy(s1);
+  gta_unicode_string_destroy(s2);
+  ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
+}
+
 #define DO_ALL_TEST(SOURCE, EXPECTED, TYPE) \
   { \
     gcu_memory_reset_counts(); \
@@ -597,6 +733,45 @@ TEST(UnicodeString, Concat) {
   }
 
 
+TEST(UnicodeString, ConcurrentGraphemeIndex) {
+  // Constant strings are shared between threads, so several threads may
+  // build the index of the same string at once.
+  auto s = gta_unicode_string_create("a\u00A3b\u00A3c", 7, GTA_UNICODE_STRING_TYPE_TRUSTED);
+  ASSERT_TRUE(s);
+  vector<size_t> lengths(8, 0);
+  vector<thread> threads;
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    threads.emplace_back([s, &lengths, i]() {
+      lengths[i] = gta_unicode_string_get_grapheme_length(s);
+    });
+  }
+  for (auto & t : threads) {
+    t.join();
+  }
+  for (size_t length : lengths) {
+    EXPECT_EQ(5, length);
+  }
+  ASSERT_NE(nullptr, s->grapheme_offsets);
+  EXPECT_EQ(6, s->grapheme_offsets->count);
+  EXPECT_EQ(7, s->grapheme_offsets->data[5].ui32);
+  gta_unicode_string_destroy(s);
+}
+
+TEST(UnicodeString, InvalidUtf8) {
+  gcu_memory_reset_counts();
+  auto valid = gta_unicode_string_create("a\u00A3b", 4, GTA_UNICODE_STRING_TYPE_TRUSTED);
+  auto invalid = gta_unicode_string_create("a\xC2" "b", 3, GTA_UNICODE_STRING_TYPE_TRUSTED);
+  ASSERT_TRUE(valid && invalid);
+  EXPECT_TRUE(gta_unicode_string_is_valid_utf8(valid));
+  EXPECT_FALSE(gta_unicode_string_is_valid_utf8(invalid));
+  // The grapheme index of an invalid string cannot be built.
+  EXPECT_EQ(SIZE_MAX, gta_unicode_string_get_grapheme_length(invalid));
+  EXPECT_EQ(nullptr, invalid->grapheme_offsets);
+  gta_unicode_string_destroy(valid);
+  gta_unicode_string_destroy(invalid);
+  ASSERT_EQ(gcu_get_alloc_count(), gcu_get_free_count());
+}
+
 TEST(Render, Trusted) {
   // Testing an empty string.
   DO_ALL_TEST("", "", GTA_UNICODE_STRING_TYPE_TRUSTED);